@@ -0,0 +1,80 @@
+#pragma once
+
+#if defined(__GNUC__) && !defined(__XCC)
+
+#include_next <arm_neon.h>
+
+#else
+
+// NEON intrinsics (128bit registers) on top of the generic vector extension.
+
+#include <stdint.h>
+
+typedef int8_t int8x16_t __attribute__((vector_size(16)));
+typedef int16_t int16x8_t __attribute__((vector_size(16)));
+typedef int32_t int32x4_t __attribute__((vector_size(16)));
+typedef int64_t int64x2_t __attribute__((vector_size(16)));
+typedef uint8_t uint8x16_t __attribute__((vector_size(16)));
+typedef uint16_t uint16x8_t __attribute__((vector_size(16)));
+typedef uint32_t uint32x4_t __attribute__((vector_size(16)));
+typedef uint64_t uint64x2_t __attribute__((vector_size(16)));
+typedef float float32x4_t __attribute__((vector_size(16)));
+typedef double float64x2_t __attribute__((vector_size(16)));
+
+// Operations common to all lane types.
+#define __NEON_DEFINE_OPS(vt, et, sfx, n) \
+  static inline vt vld1q_##sfx(const et *p) { return *(const vt*)p; } \
+  static inline void vst1q_##sfx(et *p, vt a) { *(vt*)p = a; } \
+  static inline vt vdupq_n_##sfx(et a) { vt r; for (int i = 0; i < n; ++i) r[i] = a; return r; } \
+  static inline et vgetq_lane_##sfx(vt a, int lane) { return a[lane]; } \
+  static inline vt vsetq_lane_##sfx(et x, vt a, int lane) { a[lane] = x; return a; } \
+  static inline vt vaddq_##sfx(vt a, vt b) { return a + b; } \
+  static inline vt vsubq_##sfx(vt a, vt b) { return a - b; } \
+
+// Bitwise operations for integer lanes.
+#define __NEON_DEFINE_BITOPS(vt, sfx) \
+  static inline vt vandq_##sfx(vt a, vt b) { return a & b; } \
+  static inline vt vorrq_##sfx(vt a, vt b) { return a | b; } \
+  static inline vt veorq_##sfx(vt a, vt b) { return a ^ b; } \
+
+#define __NEON_DEFINE_MUL(vt, sfx) \
+  static inline vt vmulq_##sfx(vt a, vt b) { return a * b; } \
+
+__NEON_DEFINE_OPS(int8x16_t, int8_t, s8, 16)
+__NEON_DEFINE_OPS(int16x8_t, int16_t, s16, 8)
+__NEON_DEFINE_OPS(int32x4_t, int32_t, s32, 4)
+__NEON_DEFINE_OPS(int64x2_t, int64_t, s64, 2)
+__NEON_DEFINE_OPS(uint8x16_t, uint8_t, u8, 16)
+__NEON_DEFINE_OPS(uint16x8_t, uint16_t, u16, 8)
+__NEON_DEFINE_OPS(uint32x4_t, uint32_t, u32, 4)
+__NEON_DEFINE_OPS(uint64x2_t, uint64_t, u64, 2)
+__NEON_DEFINE_OPS(float32x4_t, float, f32, 4)
+__NEON_DEFINE_OPS(float64x2_t, double, f64, 2)
+
+__NEON_DEFINE_BITOPS(int8x16_t, s8)
+__NEON_DEFINE_BITOPS(int16x8_t, s16)
+__NEON_DEFINE_BITOPS(int32x4_t, s32)
+__NEON_DEFINE_BITOPS(int64x2_t, s64)
+__NEON_DEFINE_BITOPS(uint8x16_t, u8)
+__NEON_DEFINE_BITOPS(uint16x8_t, u16)
+__NEON_DEFINE_BITOPS(uint32x4_t, u32)
+__NEON_DEFINE_BITOPS(uint64x2_t, u64)
+
+// No 64bit lane multiplication in NEON.
+__NEON_DEFINE_MUL(int8x16_t, s8)
+__NEON_DEFINE_MUL(int16x8_t, s16)
+__NEON_DEFINE_MUL(int32x4_t, s32)
+__NEON_DEFINE_MUL(uint8x16_t, u8)
+__NEON_DEFINE_MUL(uint16x8_t, u16)
+__NEON_DEFINE_MUL(uint32x4_t, u32)
+__NEON_DEFINE_MUL(float32x4_t, f32)
+__NEON_DEFINE_MUL(float64x2_t, f64)
+
+static inline float32x4_t vdivq_f32(float32x4_t a, float32x4_t b) { return a / b; }
+static inline float64x2_t vdivq_f64(float64x2_t a, float64x2_t b) { return a / b; }
+
+#undef __NEON_DEFINE_OPS
+#undef __NEON_DEFINE_BITOPS
+#undef __NEON_DEFINE_MUL
+
+#endif
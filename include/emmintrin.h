@@ -0,0 +1,74 @@
+#pragma once
+
+#if defined(__GNUC__) && !defined(__XCC)
+
+#include_next <emmintrin.h>
+
+#else
+
+// SSE2 intrinsics on top of the generic vector extension.
+
+#include <xmmintrin.h>
+
+typedef long long __m128i __attribute__((vector_size(16)));
+typedef double __m128d __attribute__((vector_size(16)));
+
+typedef long long __v2di __attribute__((vector_size(16)));
+typedef int __v4si __attribute__((vector_size(16)));
+typedef short __v8hi __attribute__((vector_size(16)));
+typedef char __v16qi __attribute__((vector_size(16)));
+
+static inline __m128i _mm_setzero_si128(void) { return (__m128i){0, 0}; }
+static inline __m128i _mm_set1_epi64x(long long a) { return (__m128i){a, a}; }
+static inline __m128i _mm_set1_epi32(int a) { return (__m128i)(__v4si){a, a, a, a}; }
+static inline __m128i _mm_set1_epi16(short a) { return (__m128i)(__v8hi){a, a, a, a, a, a, a, a}; }
+static inline __m128i _mm_set1_epi8(char a) {
+  return (__m128i)(__v16qi){a, a, a, a, a, a, a, a, a, a, a, a, a, a, a, a};
+}
+static inline __m128i _mm_set_epi64x(long long e1, long long e0) { return (__m128i){e0, e1}; }
+static inline __m128i _mm_set_epi32(int e3, int e2, int e1, int e0) { return (__m128i)(__v4si){e0, e1, e2, e3}; }
+static inline __m128i _mm_setr_epi32(int e0, int e1, int e2, int e3) { return (__m128i)(__v4si){e0, e1, e2, e3}; }
+
+static inline __m128i _mm_loadu_si128(const __m128i *p) { return *p; }
+static inline void _mm_storeu_si128(__m128i *p, __m128i a) { *p = a; }
+#define _mm_load_si128   _mm_loadu_si128
+#define _mm_store_si128  _mm_storeu_si128
+
+static inline __m128i _mm_add_epi8(__m128i a, __m128i b) { return (__m128i)((__v16qi)a + (__v16qi)b); }
+static inline __m128i _mm_add_epi16(__m128i a, __m128i b) { return (__m128i)((__v8hi)a + (__v8hi)b); }
+static inline __m128i _mm_add_epi32(__m128i a, __m128i b) { return (__m128i)((__v4si)a + (__v4si)b); }
+static inline __m128i _mm_add_epi64(__m128i a, __m128i b) { return a + b; }
+static inline __m128i _mm_sub_epi8(__m128i a, __m128i b) { return (__m128i)((__v16qi)a - (__v16qi)b); }
+static inline __m128i _mm_sub_epi16(__m128i a, __m128i b) { return (__m128i)((__v8hi)a - (__v8hi)b); }
+static inline __m128i _mm_sub_epi32(__m128i a, __m128i b) { return (__m128i)((__v4si)a - (__v4si)b); }
+static inline __m128i _mm_sub_epi64(__m128i a, __m128i b) { return a - b; }
+static inline __m128i _mm_mullo_epi16(__m128i a, __m128i b) { return (__m128i)((__v8hi)a * (__v8hi)b); }
+
+static inline __m128i _mm_and_si128(__m128i a, __m128i b) { return a & b; }
+static inline __m128i _mm_or_si128(__m128i a, __m128i b) { return a | b; }
+static inline __m128i _mm_xor_si128(__m128i a, __m128i b) { return a ^ b; }
+static inline __m128i _mm_andnot_si128(__m128i a, __m128i b) { return (a ^ (__m128i){-1, -1}) & b; }
+
+static inline int _mm_cvtsi128_si32(__m128i a) { return ((__v4si)a)[0]; }
+static inline __m128i _mm_cvtsi32_si128(int a) { return (__m128i)(__v4si){a, 0, 0, 0}; }
+
+static inline __m128i _mm_shuffle_epi32(__m128i a, int imm) {
+  __v4si v = (__v4si)a;
+  return (__m128i)(__v4si){v[imm & 3], v[(imm >> 2) & 3], v[(imm >> 4) & 3], v[(imm >> 6) & 3]};
+}
+
+static inline __m128d _mm_setzero_pd(void) { return (__m128d){0, 0}; }
+static inline __m128d _mm_set1_pd(double a) { return (__m128d){a, a}; }
+static inline __m128d _mm_set_pd(double e1, double e0) { return (__m128d){e0, e1}; }
+static inline __m128d _mm_loadu_pd(const double *p) { return *(const __m128d*)p; }
+static inline void _mm_storeu_pd(double *p, __m128d a) { *(__m128d*)p = a; }
+#define _mm_load_pd   _mm_loadu_pd
+#define _mm_store_pd  _mm_storeu_pd
+
+static inline __m128d _mm_add_pd(__m128d a, __m128d b) { return a + b; }
+static inline __m128d _mm_sub_pd(__m128d a, __m128d b) { return a - b; }
+static inline __m128d _mm_mul_pd(__m128d a, __m128d b) { return a * b; }
+static inline __m128d _mm_div_pd(__m128d a, __m128d b) { return a / b; }
+static inline double _mm_cvtsd_f64(__m128d a) { return a[0]; }
+
+#endif
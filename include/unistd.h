@@ -48,6 +48,9 @@ int pipe2(int *pipefd, int flag);
 int isatty(int fd);
 int chdir(const char *path);
 
+ssize_t pwrite(int fd, const void *buf, size_t count, off_t offset);
+int ftruncate(int fd, off_t length);
+
 pid_t fork(void);
 long clone3(struct clone_args *cl_args, size_t size);
 int execvp(const char *, char *const[]);
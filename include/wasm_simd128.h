@@ -0,0 +1,57 @@
+#pragma once
+
+#if defined(__GNUC__) && !defined(__XCC)
+
+#include_next <wasm_simd128.h>
+
+#else
+
+// WebAssembly SIMD128 intrinsics on top of the generic vector extension.
+
+#include <stdint.h>
+
+typedef int32_t v128_t __attribute__((vector_size(16)));
+
+typedef int8_t __i8x16 __attribute__((vector_size(16)));
+typedef int16_t __i16x8 __attribute__((vector_size(16)));
+typedef int64_t __i64x2 __attribute__((vector_size(16)));
+typedef float __f32x4 __attribute__((vector_size(16)));
+typedef double __f64x2 __attribute__((vector_size(16)));
+
+static inline v128_t wasm_v128_load(const void *p) { return *(const v128_t*)p; }
+static inline void wasm_v128_store(void *p, v128_t a) { *(v128_t*)p = a; }
+
+static inline v128_t wasm_v128_and(v128_t a, v128_t b) { return a & b; }
+static inline v128_t wasm_v128_or(v128_t a, v128_t b) { return a | b; }
+static inline v128_t wasm_v128_xor(v128_t a, v128_t b) { return a ^ b; }
+
+static inline v128_t wasm_i8x16_add(v128_t a, v128_t b) { return (v128_t)((__i8x16)a + (__i8x16)b); }
+static inline v128_t wasm_i8x16_sub(v128_t a, v128_t b) { return (v128_t)((__i8x16)a - (__i8x16)b); }
+static inline v128_t wasm_i16x8_add(v128_t a, v128_t b) { return (v128_t)((__i16x8)a + (__i16x8)b); }
+static inline v128_t wasm_i16x8_sub(v128_t a, v128_t b) { return (v128_t)((__i16x8)a - (__i16x8)b); }
+static inline v128_t wasm_i16x8_mul(v128_t a, v128_t b) { return (v128_t)((__i16x8)a * (__i16x8)b); }
+static inline v128_t wasm_i32x4_add(v128_t a, v128_t b) { return a + b; }
+static inline v128_t wasm_i32x4_sub(v128_t a, v128_t b) { return a - b; }
+static inline v128_t wasm_i32x4_mul(v128_t a, v128_t b) { return a * b; }
+static inline v128_t wasm_i64x2_add(v128_t a, v128_t b) { return (v128_t)((__i64x2)a + (__i64x2)b); }
+static inline v128_t wasm_i64x2_sub(v128_t a, v128_t b) { return (v128_t)((__i64x2)a - (__i64x2)b); }
+
+static inline v128_t wasm_i32x4_splat(int32_t a) { return (v128_t){a, a, a, a}; }
+static inline v128_t wasm_i32x4_make(int32_t c0, int32_t c1, int32_t c2, int32_t c3) { return (v128_t){c0, c1, c2, c3}; }
+static inline int32_t wasm_i32x4_extract_lane(v128_t a, int i) { return a[i]; }
+static inline v128_t wasm_i32x4_replace_lane(v128_t a, int i, int32_t x) { a[i] = x; return a; }
+
+#ifndef __NO_FLONUM
+static inline v128_t wasm_f32x4_add(v128_t a, v128_t b) { return (v128_t)((__f32x4)a + (__f32x4)b); }
+static inline v128_t wasm_f32x4_sub(v128_t a, v128_t b) { return (v128_t)((__f32x4)a - (__f32x4)b); }
+static inline v128_t wasm_f32x4_mul(v128_t a, v128_t b) { return (v128_t)((__f32x4)a * (__f32x4)b); }
+static inline v128_t wasm_f32x4_div(v128_t a, v128_t b) { return (v128_t)((__f32x4)a / (__f32x4)b); }
+static inline v128_t wasm_f64x2_add(v128_t a, v128_t b) { return (v128_t)((__f64x2)a + (__f64x2)b); }
+static inline v128_t wasm_f64x2_sub(v128_t a, v128_t b) { return (v128_t)((__f64x2)a - (__f64x2)b); }
+static inline v128_t wasm_f64x2_mul(v128_t a, v128_t b) { return (v128_t)((__f64x2)a * (__f64x2)b); }
+static inline v128_t wasm_f64x2_div(v128_t a, v128_t b) { return (v128_t)((__f64x2)a / (__f64x2)b); }
+static inline v128_t wasm_f32x4_splat(float a) { return (v128_t)(__f32x4){a, a, a, a}; }
+static inline float wasm_f32x4_extract_lane(v128_t a, int i) { return ((__f32x4)a)[i]; }
+#endif
+
+#endif
@@ -0,0 +1,38 @@
+#pragma once
+
+#if defined(__GNUC__) && !defined(__XCC)
+
+#include_next <xmmintrin.h>
+
+#else
+
+// SSE intrinsics on top of the generic vector extension.
+
+typedef float __m128 __attribute__((vector_size(16)));
+
+static inline __m128 _mm_setzero_ps(void) { return (__m128){0, 0, 0, 0}; }
+static inline __m128 _mm_set1_ps(float a) { return (__m128){a, a, a, a}; }
+static inline __m128 _mm_set_ps(float e3, float e2, float e1, float e0) { return (__m128){e0, e1, e2, e3}; }
+static inline __m128 _mm_setr_ps(float e0, float e1, float e2, float e3) { return (__m128){e0, e1, e2, e3}; }
+
+// Vector load/store doesn't assume the alignment.
+static inline __m128 _mm_loadu_ps(const float *p) { return *(const __m128*)p; }
+static inline void _mm_storeu_ps(float *p, __m128 a) { *(__m128*)p = a; }
+#define _mm_load_ps   _mm_loadu_ps
+#define _mm_store_ps  _mm_storeu_ps
+
+static inline __m128 _mm_add_ps(__m128 a, __m128 b) { return a + b; }
+static inline __m128 _mm_sub_ps(__m128 a, __m128 b) { return a - b; }
+static inline __m128 _mm_mul_ps(__m128 a, __m128 b) { return a * b; }
+static inline __m128 _mm_div_ps(__m128 a, __m128 b) { return a / b; }
+
+static inline float _mm_cvtss_f32(__m128 a) { return a[0]; }
+
+#define _MM_SHUFFLE(z, y, x, w)  (((z) << 6) | ((y) << 4) | ((x) << 2) | (w))
+
+// Lanes 0-1 from a, lanes 2-3 from b.
+static inline __m128 _mm_shuffle_ps(__m128 a, __m128 b, int imm) {
+  return (__m128){a[imm & 3], a[(imm >> 2) & 3], b[(imm >> 4) & 3], b[(imm >> 6) & 3]};
+}
+
+#endif
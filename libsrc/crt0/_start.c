@@ -43,7 +43,7 @@ void _start(void) {
   __asm("mov (%rsp), %rdi\n"
         "lea 8(%rsp), %rsi\n"
         "lea 8(%rsi, %rdi, 8), %rdx\n"
-        "jmp start2");
+        "call start2");  // Keep the stack aligned to 16 bytes as a function entry.
 #elif defined(__aarch64__)
   __asm("ldr x0, [sp]\n"
         "add x1, sp, #8\n"
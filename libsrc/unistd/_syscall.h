@@ -24,8 +24,11 @@
 #define __NR_fstat   5
 #define __NR_lstat   6
 #define __NR_lseek   8
+#define __NR_mmap    9
+#define __NR_munmap  11
 #define __NR_brk     12
 #define __NR_ioctl   16
+#define __NR_pwrite64  18
 #define __NR_pipe    22
 #define __NR_dup     32
 #define __NR_fork    57
@@ -33,6 +36,7 @@
 #define __NR_exit    60
 #define __NR_wait4   61
 #define __NR_kill    62
+#define __NR_ftruncate  77
 #define __NR_getcwd  79
 #define __NR_chdir   80
 #define __NR_mkdir   83
@@ -64,7 +68,11 @@
 #define __NR_close   57
 #define __NR_fstat   80
 #define __NR_lseek   62
+#define __NR_ftruncate  46
+#define __NR_pwrite64  68
 #define __NR_brk     214
+#define __NR_munmap  215
+#define __NR_mmap    222
 //#define __NR_ioctl   16
 #define __NR_pipe2    59
 #define __NR_dup     23
@@ -104,9 +112,13 @@
 #define __NR_lseek     62
 #define __NR_read      63
 #define __NR_write     64
+#define __NR_ftruncate 46
+#define __NR_pwrite64  68
 #define __NR_exit      93
 #define __NR_kill      129
 #define __NR_brk       214
+#define __NR_munmap    215
+#define __NR_mmap      222
 #define __NR_execve    221
 #define __NR_wait4     260
 #define __NR_fstat     80
@@ -0,0 +1,19 @@
+#include "unistd.h"
+#include "errno.h"
+#include "_syscall.h"
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#if defined(__NR_ftruncate)
+int ftruncate(int fd, off_t length) {
+  int ret;
+  SYSCALL_RET(__NR_ftruncate, ret);
+  if (ret < 0) {
+    errno = -ret;
+    ret = -1;
+  }
+  return ret;
+}
+#endif
@@ -0,0 +1,22 @@
+#include "sys/mman.h"
+#include "errno.h"
+#include "_syscall.h"
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#if defined(__NR_mmap)
+void *mmap(void *addr, size_t length, int prot, int flags, int fd, off_t offset) {
+  long ret;
+#if defined(__x86_64__)
+  SYSCALL_ARGCOUNT(4);
+#endif
+  SYSCALL_RET(__NR_mmap, ret);
+  if ((unsigned long)ret >= -4095UL) {  // -4095~-1: error
+    errno = -ret;
+    return MAP_FAILED;
+  }
+  return (void*)ret;
+}
+#endif
@@ -0,0 +1,22 @@
+#include "unistd.h"
+#include "errno.h"
+#include "_syscall.h"
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#if defined(__NR_pwrite64)
+ssize_t pwrite(int fd, const void *buf, size_t count, off_t offset) {
+  ssize_t ret;
+#if defined(__x86_64__)
+  SYSCALL_ARGCOUNT(4);
+#endif
+  SYSCALL_RET(__NR_pwrite64, ret);
+  if (ret < 0) {
+    errno = -ret;
+    ret = -1;
+  }
+  return ret;
+}
+#endif
@@ -41,7 +41,7 @@ static void dump_vvreg(FILE *fp, VReg *vreg) {
 static void dump_vreg(FILE *fp, VReg *vreg) {
   assert(vreg != NULL);
   assert(!(vreg->flag & VRF_SPILLED));
-  static const char *kSize[] = {"b", "w", "d", ""};
+  static const char *kSize[] = {"b", "w", "d", "", "x"};
   if (vreg->flag & VRF_CONST) {
     fprintf(fp, "(%" PRId64 ")", vreg->fixnum);
   } else if (vreg->phys >= 0) {
@@ -74,11 +74,26 @@ static void dump_vregs(FILE *fp, const char *title, Vector *regs, bool newline)
     fprintf(fp, "]");
 }
 
+static void dump_mem_operand(FILE *fp, IR *ir, VReg *base) {
+  fprintf(fp, "[");
+  dump_vreg(fp, base);
+  if (ir->mem.index != NULL) {
+    fprintf(fp, " + ");
+    dump_vreg(fp, ir->mem.index);
+    if (ir->mem.scale > 0)
+      fprintf(fp, " << %d", ir->mem.scale);
+  }
+  int64_t offset = ir->mem.offset;
+  if (offset != 0)
+    fprintf(fp, " %c %" PRId64, offset >= 0 ? '+' : '-', offset > 0 ? offset : -offset);
+  fprintf(fp, "]");
+}
+
 static void dump_ir(FILE *fp, IR *ir) {
   static char *kOps[] = {
-    "BOFS", "IOFS", "SOFS", "LOAD", "LOAD_S", "STORE", "STORE_S",
-    "ADD", "SUB", "MUL", "DIV", "MOD", "BITAND", "BITOR", "BITXOR", "LSHIFT", "RSHIFT",
-    "NEG", "BITNOT", "COND", "JMP", "TJMP",
+    "BOFS", "IOFS", "SOFS", "LOAD", "LOAD_S", "STORE", "STORE_S", "VOP",
+    "ADD", "SUB", "MUL", "DIV", "MOD", "BITAND", "BITOR", "BITXOR", "LSHIFT", "RSHIFT", "MULHI",
+    "NEG", "BITNOT", "POPCNT", "CLZ", "CTZ", "BSWAP", "COND", "SELECT", "JMP", "TJMP",
     "PRECALL", "PUSHARG", "CALL", "RESULT", "SUBSP",
     "CAST", "MOV", "KEEP", "PHI", "ASM",
   };
@@ -86,6 +101,7 @@ static void dump_ir(FILE *fp, IR *ir) {
   static char *kCond2[] = {NULL, "MP", "==", "!=", "<", "<=", ">=", ">", NULL, "MP", "==", "!=", "<", "<=", ">=", ">"};
 
   switch (ir->kind) {
+  case IR_MULHI:
   case IR_DIV:
   case IR_MOD:
     fprintf(fp, "%s%s\t", kOps[ir->kind], ir->flag & IRF_UNSIGNED ? "U" : "");
@@ -103,13 +119,15 @@ static void dump_ir(FILE *fp, IR *ir) {
   case IR_BOFS:   { int64_t offset = ir->bofs.frameinfo->offset + ir->bofs.offset; dump_vreg(fp, ir->dst); fprintf(fp, " = &[rbp %c %" PRId64 "]\n", offset >= 0 ? '+' : '-', offset > 0 ? offset : -offset); } break;
   case IR_IOFS:   dump_vreg(fp, ir->dst); fprintf(fp, " = &%.*s", NAMES(ir->iofs.label)); if (ir->iofs.offset != 0) { int64_t offset = ir->iofs.offset; fprintf(fp, " %c %" PRId64, offset >= 0 ? '+' : '-', offset > 0 ? offset : -offset); } fprintf(fp, "\n"); break;
   case IR_SOFS:   dump_vreg(fp, ir->dst); fprintf(fp, " = &[rsp %c %" PRId64 "]\n", ir->opr1->fixnum >= 0 ? '+' : '-', ir->opr1->fixnum > 0 ? ir->opr1->fixnum : -ir->opr1->fixnum); break;
-  case IR_LOAD:   dump_vreg(fp, ir->dst); fprintf(fp, " = ["); dump_vreg(fp, ir->opr1); fprintf(fp, "]\n"); break;
+  case IR_LOAD:   dump_vreg(fp, ir->dst); fprintf(fp, " = "); dump_mem_operand(fp, ir, ir->opr1); fprintf(fp, "\n"); break;
   case IR_LOAD_S: dump_vreg(fp, ir->dst); fprintf(fp, " = [v%d]\n", ir->opr1->virt); break;
-  case IR_STORE:  fprintf(fp, "["); dump_vreg(fp, ir->opr2); fprintf(fp, "] = "); dump_vreg(fp, ir->opr1); fprintf(fp, "\n"); break;
+  case IR_STORE:  dump_mem_operand(fp, ir, ir->opr2); fprintf(fp, " = "); dump_vreg(fp, ir->opr1); fprintf(fp, "\n"); break;
   case IR_STORE_S:fprintf(fp, "[v%d] = ", ir->opr2->virt); dump_vreg(fp, ir->opr1); fprintf(fp, "\n"); break;
+  case IR_VOP:    dump_vreg(fp, ir->dst); fprintf(fp, " = "); dump_vreg(fp, ir->opr1); fprintf(fp, " %s ", kOps[ir->vop.kind]); dump_vreg(fp, ir->opr2); fprintf(fp, "  (%s%d)\n", ir->vop.vflag & VRF_FLONUM ? "f" : "i", 8 << ir->vop.elem); break;
   case IR_ADD:    dump_vreg(fp, ir->dst); fprintf(fp, " = "); dump_vreg(fp, ir->opr1); fprintf(fp, " + "); dump_vreg(fp, ir->opr2); fprintf(fp, "\n"); break;
   case IR_SUB:    dump_vreg(fp, ir->dst); fprintf(fp, " = "); dump_vreg(fp, ir->opr1); fprintf(fp, " - "); dump_vreg(fp, ir->opr2); fprintf(fp, "\n"); break;
   case IR_MUL:    dump_vreg(fp, ir->dst); fprintf(fp, " = "); dump_vreg(fp, ir->opr1); fprintf(fp, " * "); dump_vreg(fp, ir->opr2); fprintf(fp, "\n"); break;
+  case IR_MULHI:  dump_vreg(fp, ir->dst); fprintf(fp, " = "); dump_vreg(fp, ir->opr1); fprintf(fp, " *^ "); dump_vreg(fp, ir->opr2); fprintf(fp, "\n"); break;
   case IR_DIV:    dump_vreg(fp, ir->dst); fprintf(fp, " = "); dump_vreg(fp, ir->opr1); fprintf(fp, " / "); dump_vreg(fp, ir->opr2); fprintf(fp, "\n"); break;
   case IR_MOD:    dump_vreg(fp, ir->dst); fprintf(fp, " = "); dump_vreg(fp, ir->opr1); fprintf(fp, " %% "); dump_vreg(fp, ir->opr2); fprintf(fp, "\n"); break;
   case IR_BITAND: dump_vreg(fp, ir->dst); fprintf(fp, " = "); dump_vreg(fp, ir->opr1); fprintf(fp, " & "); dump_vreg(fp, ir->opr2); fprintf(fp, "\n"); break;
@@ -119,7 +137,10 @@ static void dump_ir(FILE *fp, IR *ir) {
   case IR_RSHIFT: dump_vreg(fp, ir->dst); fprintf(fp, " = "); dump_vreg(fp, ir->opr1); fprintf(fp, " >> "); dump_vreg(fp, ir->opr2); fprintf(fp, "\n"); break;
   case IR_NEG:    dump_vreg(fp, ir->dst); fprintf(fp, " = -"); dump_vreg(fp, ir->opr1); fprintf(fp, "\n"); break;
   case IR_BITNOT: dump_vreg(fp, ir->dst); fprintf(fp, " = ~"); dump_vreg(fp, ir->opr1); fprintf(fp, "\n"); break;
+  case IR_POPCNT: case IR_CLZ: case IR_CTZ: case IR_BSWAP:
+    dump_vreg(fp, ir->dst); fprintf(fp, " = "); dump_vreg(fp, ir->opr1); fprintf(fp, "\n"); break;
   case IR_COND:   dump_vreg(fp, ir->dst); fprintf(fp, " = "); if (ir->cond.kind != COND_ANY && ir->cond.kind != COND_NONE) {dump_vreg(fp, ir->opr1); fprintf(fp, " %s ", kCond2[ir->cond.kind & (COND_MASK | COND_UNSIGNED)]); dump_vreg(fp, ir->opr2);} fprintf(fp, "\n"); break;
+  case IR_SELECT: dump_vreg(fp, ir->dst); fprintf(fp, " = "); dump_vreg(fp, ir->opr1); fprintf(fp, " %s ", kCond2[ir->select.cond & (COND_MASK | COND_UNSIGNED)]); dump_vreg(fp, ir->opr2); fprintf(fp, " ? "); dump_vreg(fp, ir->select.tval); fprintf(fp, " : "); dump_vreg(fp, ir->select.fval); fprintf(fp, "\n"); break;
   case IR_JMP:    if (ir->jmp.cond != COND_ANY && ir->jmp.cond != COND_NONE) {dump_vreg(fp, ir->opr1); fprintf(fp, ", "); dump_vreg(fp, ir->opr2); fprintf(fp, ", ");} fprintf(fp, "%.*s\n", NAMES(ir->jmp.bb->label)); break;
   case IR_TJMP:
     dump_vreg(fp, ir->opr1);
@@ -139,7 +160,7 @@ static void dump_ir(FILE *fp, IR *ir) {
       fprintf(fp, "*"); dump_vreg(fp, ir->opr1); fprintf(fp, "(args=#%d)\n", ir->call.reg_arg_count);
     }
     break;
-  case IR_RESULT: if (ir->dst != NULL) { dump_vreg(fp, ir->dst); fprintf(fp, " = "); } dump_vreg(fp, ir->opr1); fprintf(fp, "\n"); break;
+  case IR_RESULT: if (ir->dst != NULL) { dump_vreg(fp, ir->dst); fprintf(fp, " = "); } else if (ir->result.index > 0) { fprintf(fp, "[%d] ", ir->result.index); } dump_vreg(fp, ir->opr1); fprintf(fp, "\n"); break;
   case IR_SUBSP:  dump_vreg(fp, ir->opr1); fprintf(fp, "\n"); break;
   case IR_CAST:   dump_vreg(fp, ir->dst); fprintf(fp, " = "); dump_vreg(fp, ir->opr1); fprintf(fp, "\n"); break;
   case IR_MOV:    dump_vreg(fp, ir->dst); fprintf(fp, " = "); dump_vreg(fp, ir->opr1); fprintf(fp, "\n"); break;
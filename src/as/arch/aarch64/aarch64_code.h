@@ -18,6 +18,8 @@
 #define W_SUB_E(sz, rd, rn, rm, option, ov)        MAKE_CODE32(inst, code, 0x4b200000U | ((sz) << 31) | ((rm) << 16) | ((option) << 13) | ((ov) << 10) | ((rn) << 5) | (rd))
 #define W_MADD(sz, rd, rn, rm, ra)                 MAKE_CODE32(inst, code, 0x1b000000U | ((sz) << 31) | ((rm) << 16) | ((ra) << 10) | ((rn) << 5) | (rd))
 #define W_MSUB(sz, rd, rn, rm, ra)                 MAKE_CODE32(inst, code, 0x1b008000U | ((sz) << 31) | ((rm) << 16) | ((ra) << 10) | ((rn) << 5) | (rd))
+#define W_SMULH(rd, rn, rm)                        MAKE_CODE32(inst, code, 0x9b407c00U | ((rm) << 16) | ((rn) << 5) | (rd))
+#define W_UMULH(rd, rn, rm)                        MAKE_CODE32(inst, code, 0x9bc07c00U | ((rm) << 16) | ((rn) << 5) | (rd))
 #define W_SDIV(sz, rd, rn, rm)                     MAKE_CODE32(inst, code, 0x1ac00c00U | ((sz) << 31) | ((rm) << 16) | ((rn) << 5) | (rd))
 #define W_UDIV(sz, rd, rn, rm)                     MAKE_CODE32(inst, code, 0x1ac00800U | ((sz) << 31) | ((rm) << 16) | ((rn) << 5) | (rd))
 #define W_AND_S(sz, rd, rn, rm, imm)               MAKE_CODE32(inst, code, 0x0a000000U | ((sz) << 31) | ((rm) << 16) | (((imm) & ((1U << 6) - 1)) << 10) | ((rn) << 5) | (rd))
@@ -46,8 +48,14 @@
 
 #define W_ADRP(rd, imm)                            MAKE_CODE32(inst, code, 0x90000000U | (IMM(imm, 31, 30) << 29) | (IMM(imm, 29, 12) << 5) | (rd))
 
+#define W_CSEL(sz, rd, rn, rm, cond)               MAKE_CODE32(inst, code, 0x1a800000U | ((sz) << 31) | ((rm) << 16) | ((cond) << 12) | ((rn) << 5) | (rd))
 #define W_CSINC(sz, rd, rn, rm, cond)              MAKE_CODE32(inst, code, 0x1a800400U | ((sz) << 31) | ((rm) << 16) | ((cond) << 12) | ((rn) << 5) | (rd))
 
+#define W_DP1(sz, opc, rd, rn)                     MAKE_CODE32(inst, code, 0x5ac00000U | ((sz) << 31) | ((opc) << 10) | ((rn) << 5) | (rd))
+#define W_RBIT(sz, rd, rn)                         W_DP1(sz, 0, rd, rn)
+#define W_REV(sz, rd, rn)                          W_DP1(sz, 2 | (sz), rd, rn)
+#define W_CLZ(sz, rd, rn)                          W_DP1(sz, 4, rd, rn)
+
 #define W_B()                                      MAKE_CODE32(inst, code, 0x14000000U)
 #define W_BR(rn)                                   MAKE_CODE32(inst, code, 0xd61f0000U | ((rn) << 5))
 #define W_BCC(cond)                                MAKE_CODE32(inst, code, 0x54000000U | (cond))
@@ -80,8 +88,13 @@
 #define F_LDP(b, rt, ru, base, ofs, prepost)       MAKE_CODE32(inst, code, 0x2c400000U | ((b) << 30) | ((prepost) << 23) | ((((ofs) & ((1U << 10) - (1 << 3)))) << (15 - 3)) | ((ru) << 10) | ((base) << 5) | (rt))
 #define F_STP(b, rt, ru, base, ofs, prepost)       MAKE_CODE32(inst, code, 0x2c000000U | ((b) << 30) | ((prepost) << 23) | ((((ofs) & ((1U << 10) - (1 << 3)))) << (15 - 3)) | ((ru) << 10) | ((base) << 5) | (rt))
 
-#define F_LDR_R(sz, rt, base, rm, s, s2, option)   MAKE_CODE32(inst, code, 0xbc700800U | ((sz) << 30) | ((s) << 23) | ((rm) << 16) | ((option) << 13) | ((s2) << 12) | ((base) << 5) | (rt))
-#define F_STR_R(sz, rt, base, rm, s2, option)      MAKE_CODE32(inst, code, 0xbc300800U | ((sz) << 30) | ((rm) << 16) | ((option) << 13) | ((s2) << 12) | ((base) << 5) | (rt))
+#define Q_LDR_UIMM(rt, ofs, base)                  MAKE_CODE32(inst, code, 0x3dc00000U | ((((ofs) & ((1U << 12) - 1))) << 10) | ((base) << 5) | (rt))
+#define Q_LDUR(rt, ofs, base)                      MAKE_CODE32(inst, code, 0x3cc00000U | ((((ofs) & ((1U << 9) - 1))) << 12) | ((base) << 5) | (rt))
+#define Q_STR_UIMM(rt, ofs, base)                  MAKE_CODE32(inst, code, 0x3d800000U | ((((ofs) & ((1U << 12) - 1))) << 10) | ((base) << 5) | (rt))
+#define Q_STUR(rt, ofs, base)                      MAKE_CODE32(inst, code, 0x3c800000U | ((((ofs) & ((1U << 9) - 1))) << 12) | ((base) << 5) | (rt))
+
+#define F_LDR_R(sz, rt, base, rm, s, s2, option)   MAKE_CODE32(inst, code, 0xbc600800U | ((sz) << 30) | ((s) << 23) | ((rm) << 16) | ((option) << 13) | ((s2) << 12) | ((base) << 5) | (rt))
+#define F_STR_R(sz, rt, base, rm, s2, option)      MAKE_CODE32(inst, code, 0xbc200800U | ((sz) << 30) | ((rm) << 16) | ((option) << 13) | ((s2) << 12) | ((base) << 5) | (rt))
 
 #define FMOV(sz, rd, rn)                           MAKE_CODE32(inst, code, 0x1e204000U | ((sz) << 22) | ((rn) << 5) | (rd))
 #define FADD(sz, rd, rn, rm)                       MAKE_CODE32(inst, code, 0x1e202800U | ((sz) << 22) | ((rm) << 16) | ((rn) << 5) | (rd))
@@ -97,3 +110,15 @@
 #define FCVT(dsz, rt, rn)                          MAKE_CODE32(inst, code, 0x1e224000 | ((1 - (dsz)) << 22) | ((dsz) << 15) | ((rn) << 5) | (rt))
 #define FCVTZS(dsz, rt, ssz, rn)                   MAKE_CODE32(inst, code, 0x1e380000 | ((dsz) << 31) | ((ssz) << 22) | ((rn) << 5) | (rt))
 #define FCVTZU(dsz, rt, ssz, rn)                   MAKE_CODE32(inst, code, 0x1e390000 | ((dsz) << 31) | ((ssz) << 22) | ((rn) << 5) | (rt))
+
+// SIMD (128bit)
+#define V_ADD(sz, rd, rn, rm)                      MAKE_CODE32(inst, code, 0x4e208400U | ((sz) << 22) | ((rm) << 16) | ((rn) << 5) | (rd))
+#define V_SUB(sz, rd, rn, rm)                      MAKE_CODE32(inst, code, 0x6e208400U | ((sz) << 22) | ((rm) << 16) | ((rn) << 5) | (rd))
+#define V_MUL(sz, rd, rn, rm)                      MAKE_CODE32(inst, code, 0x4e209c00U | ((sz) << 22) | ((rm) << 16) | ((rn) << 5) | (rd))
+#define V_AND(rd, rn, rm)                          MAKE_CODE32(inst, code, 0x4e201c00U | ((rm) << 16) | ((rn) << 5) | (rd))
+#define V_ORR(rd, rn, rm)                          MAKE_CODE32(inst, code, 0x4ea01c00U | ((rm) << 16) | ((rn) << 5) | (rd))
+#define V_EOR(rd, rn, rm)                          MAKE_CODE32(inst, code, 0x6e201c00U | ((rm) << 16) | ((rn) << 5) | (rd))
+#define V_FADD(sz, rd, rn, rm)                     MAKE_CODE32(inst, code, 0x4e20d400U | ((sz) << 22) | ((rm) << 16) | ((rn) << 5) | (rd))
+#define V_FSUB(sz, rd, rn, rm)                     MAKE_CODE32(inst, code, 0x4ea0d400U | ((sz) << 22) | ((rm) << 16) | ((rn) << 5) | (rd))
+#define V_FMUL(sz, rd, rn, rm)                     MAKE_CODE32(inst, code, 0x6e20dc00U | ((sz) << 22) | ((rm) << 16) | ((rn) << 5) | (rd))
+#define V_FDIV(sz, rd, rn, rm)                     MAKE_CODE32(inst, code, 0x6e20fc00U | ((sz) << 22) | ((rm) << 16) | ((rn) << 5) | (rd))
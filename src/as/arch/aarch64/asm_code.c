@@ -127,6 +127,8 @@ static unsigned char *asm_3r(Inst *inst, Code *code) {
     }
     break;
   case MUL:  P_MUL(sz, opr1->reg.no, opr2->reg.no, opr3->reg.no); break;
+  case SMULH: W_SMULH(opr1->reg.no, opr2->reg.no, opr3->reg.no); break;
+  case UMULH: W_UMULH(opr1->reg.no, opr2->reg.no, opr3->reg.no); break;
   case SDIV: W_SDIV(sz, opr1->reg.no, opr2->reg.no, opr3->reg.no); break;
   case UDIV: W_UDIV(sz, opr1->reg.no, opr2->reg.no, opr3->reg.no); break;
   case AND:  W_AND_S(sz, opr1->reg.no, opr2->reg.no, opr3->reg.no, 0); break;
@@ -199,6 +201,9 @@ static unsigned char *asm_2r(Inst *inst, Code *code) {
   case UXTW:
     P_MOV(0, opr1->reg.no, opr2->reg.no);
     break;
+  case CLZ:   W_CLZ(sz, opr1->reg.no, opr2->reg.no); break;
+  case RBIT:  W_RBIT(sz, opr1->reg.no, opr2->reg.no); break;
+  case REV:   W_REV(sz, opr1->reg.no, opr2->reg.no); break;
   default: assert(false); return NULL;
   }
   return code->buf;
@@ -241,6 +246,15 @@ static unsigned char *asm_4r(Inst *inst, Code *code) {
   return code->buf;
 }
 
+static bool is_im9(int64_t offset) {
+  return offset < (1 << 8) && offset >= -(1 << 8);
+}
+
+// Unsigned offset, scaled by access size.
+static bool is_uimm12_offset(int64_t offset, int pow) {
+  return offset >= 0 && (offset & ((1 << pow) - 1)) == 0 && (offset >> pow) < (1 << 12);
+}
+
 static unsigned char *asm_ldrstr(Inst *inst, Code *code) {
   Operand *opr1 = &inst->opr[0];
   uint32_t sz = opr1->reg.size == REG64 ? 1 : 0;
@@ -250,7 +264,6 @@ static unsigned char *asm_ldrstr(Inst *inst, Code *code) {
     // assert(opr2->indirect.offset == NULL || opr2->indirect.offset->kind == EX_FIXNUM);
     ExprWithFlag *offset_expr = &opr2->indirect.offset;
     int64_t offset = offset_expr->expr != NULL && offset_expr->expr->kind == EX_FIXNUM ? offset_expr->expr->fixnum : 0;
-    assert(offset < (1 << (6 + 3)) && offset >= -(1 << (6 + 3)));
     uint32_t base = opr2->indirect.reg.no;
     uint32_t prepost = kPrePost[opr2->indirect.prepost];
     switch (inst->op) {
@@ -264,23 +277,32 @@ static unsigned char *asm_ldrstr(Inst *inst, Code *code) {
         }
         b |= sz;
         if (opr2->indirect.prepost == 0) {
-          if (offset >= 0)
-            W_LDR_UIMM(b, s, opr1->reg.no, offset >> (2 + sz), base);
-          else
+          if (is_uimm12_offset(offset, b))
+            W_LDR_UIMM(b, s, opr1->reg.no, offset >> b, base);
+          else if (is_im9(offset))
             W_LDUR(b, s, opr1->reg.no, offset, base);
+          else
+            return NULL;
         } else {
+          assert(is_im9(offset));
           W_LDR(b, s, opr1->reg.no, offset, base, prepost);
         }
       }
       break;
     case STRB: case STRH: case STR:
-      if (opr2->indirect.prepost == 0) {
-        if (offset >= 0)
-          W_STR_UIMM((inst->op - STRB) | sz, opr1->reg.no, offset >> (2 + sz), base);
-        else
-          W_STUR((inst->op - STRB) | sz, opr1->reg.no, offset, base);
-      } else {
-        W_STR((inst->op - STRB) | sz, opr1->reg.no, offset, base, prepost);
+      {
+        uint32_t b = (inst->op - STRB) | sz;
+        if (opr2->indirect.prepost == 0) {
+          if (is_uimm12_offset(offset, b))
+            W_STR_UIMM(b, opr1->reg.no, offset >> b, base);
+          else if (is_im9(offset))
+            W_STUR(b, opr1->reg.no, offset, base);
+          else
+            return NULL;
+        } else {
+          assert(is_im9(offset));
+          W_STR(b, opr1->reg.no, offset, base, prepost);
+        }
       }
       break;
     default: assert(false); break;
@@ -379,6 +401,16 @@ static unsigned char *asm_cset(Inst *inst, Code *code) {
   return code->buf;
 }
 
+static unsigned char *asm_csel(Inst *inst, Code *code) {
+  Operand *opr1 = &inst->opr[0];
+  Operand *opr2 = &inst->opr[1];
+  Operand *opr3 = &inst->opr[2];
+  Operand *opr4 = &inst->opr[3];
+  uint32_t sz = opr1->reg.size == REG64 ? 1 : 0;
+  W_CSEL(sz, opr1->reg.no, opr2->reg.no, opr3->reg.no, opr4->cond);
+  return code->buf;
+}
+
 static unsigned char *asm_b(Inst *inst, Code *code) {
   W_B();
   return code->buf;
@@ -426,25 +458,56 @@ static unsigned char *asm_svc(Inst *inst, Code *code) {
 
 // FP instructions.
 
+static unsigned char *asm_q_ldrstr(Inst *inst, Code *code) {
+  Operand *opr1 = &inst->opr[0];
+  Operand *opr2 = &inst->opr[1];
+  if (opr2->type != INDIRECT || opr2->indirect.prepost != 0)
+    return NULL;
+  ExprWithFlag *offset_expr = &opr2->indirect.offset;
+  int64_t offset = offset_expr->expr != NULL && offset_expr->expr->kind == EX_FIXNUM ? offset_expr->expr->fixnum : 0;
+  uint32_t base = opr2->indirect.reg.no;
+  if (is_uimm12_offset(offset, 4)) {
+    if (inst->op == F_LDR)
+      Q_LDR_UIMM(opr1->reg.no, offset >> 4, base);
+    else
+      Q_STR_UIMM(opr1->reg.no, offset >> 4, base);
+  } else if (is_im9(offset)) {
+    if (inst->op == F_LDR)
+      Q_LDUR(opr1->reg.no, offset, base);
+    else
+      Q_STUR(opr1->reg.no, offset, base);
+  } else {
+    return NULL;
+  }
+  return code->buf;
+}
+
 static unsigned char *asm_f_ldrstr(Inst *inst, Code *code) {
   Operand *opr1 = &inst->opr[0];
   Operand *opr2 = &inst->opr[1];
+  if (opr1->reg.size == REG128)
+    return asm_q_ldrstr(inst, code);
   uint32_t sz = opr1->reg.size == REG64 ? 1 : 0;
   if (opr2->type == INDIRECT) {
     assert(opr2->indirect.reg.size == REG64);
     // assert(opr2->indirect.offset == NULL || opr2->indirect.offset->kind == EX_FIXNUM);
     ExprWithFlag *offset_expr = &opr2->indirect.offset;
     int64_t offset = offset_expr->expr != NULL && offset_expr->expr->kind == EX_FIXNUM ? offset_expr->expr->fixnum : 0;
-    assert(offset < (1 << (6 + 3)) && offset >= -(1 << (6 + 3)));
     uint32_t base = opr2->indirect.reg.no;
     uint32_t prepost = kPrePost[opr2->indirect.prepost];
+    if (opr2->indirect.prepost == 0) {
+      if (!is_uimm12_offset(offset, 2 + sz) && !is_im9(offset))
+        return NULL;
+    } else {
+      assert(is_im9(offset));
+    }
 
     switch (inst->op) {
     case F_LDR:
       {
         uint32_t s = 0;
         if (opr2->indirect.prepost == 0) {
-          if (offset >= 0)
+          if (is_uimm12_offset(offset, 2 + sz))
             F_LDR_UIMM(sz, s, opr1->reg.no, offset >> (2 + sz), base);
           else
             F_LDUR(sz, s, opr1->reg.no, offset, base);
@@ -455,12 +518,12 @@ static unsigned char *asm_f_ldrstr(Inst *inst, Code *code) {
       break;
     case F_STR:
       if (opr2->indirect.prepost == 0) {
-        if (offset >= 0)
-          F_STR_UIMM((inst->op - STRB) | sz, opr1->reg.no, 0, base);
+        if (is_uimm12_offset(offset, 2 + sz))
+          F_STR_UIMM(sz, opr1->reg.no, offset >> (2 + sz), base);
         else
-          F_STUR((inst->op - STRB) | sz, opr1->reg.no, offset, base);
+          F_STUR(sz, opr1->reg.no, offset, base);
       } else {
-        F_STR((inst->op - STRB) | sz, opr1->reg.no, offset, base, prepost);
+        F_STR(sz, opr1->reg.no, offset, base, prepost);
       }
       break;
     default: assert(false); break;
@@ -539,6 +602,52 @@ static unsigned char *asm_f_2r(Inst *inst, Code *code) {
   return code->buf;
 }
 
+// SIMD instructions.
+
+static unsigned char *asm_v_3r(Inst *inst, Code *code) {
+  Operand *opr1 = &inst->opr[0];
+  Operand *opr2 = &inst->opr[1];
+  Operand *opr3 = &inst->opr[2];
+  uint32_t sz = opr1->reg.size;  // VRegArrangement
+  if (opr2->reg.size != opr1->reg.size || opr3->reg.size != opr1->reg.size)
+    return NULL;
+  uint32_t rd = opr1->reg.no, rn = opr2->reg.no, rm = opr3->reg.no;
+
+  switch (inst->op) {
+  case V_ADD:  V_ADD(sz, rd, rn, rm); break;
+  case V_SUB:  V_SUB(sz, rd, rn, rm); break;
+  case V_MUL:
+    if (sz == VA_2D)
+      return NULL;
+    V_MUL(sz, rd, rn, rm);
+    break;
+  case V_AND: case V_ORR: case V_EOR:
+    if (sz != VA_16B)
+      return NULL;
+    switch (inst->op) {
+    case V_AND:  V_AND(rd, rn, rm); break;
+    case V_ORR:  V_ORR(rd, rn, rm); break;
+    case V_EOR:  V_EOR(rd, rn, rm); break;
+    default: assert(false); break;
+    }
+    break;
+  case V_FADD: case V_FSUB: case V_FMUL: case V_FDIV:
+    if (sz != VA_4S && sz != VA_2D)
+      return NULL;
+    sz = sz == VA_2D ? 1 : 0;
+    switch (inst->op) {
+    case V_FADD:  V_FADD(sz, rd, rn, rm); break;
+    case V_FSUB:  V_FSUB(sz, rd, rn, rm); break;
+    case V_FMUL:  V_FMUL(sz, rd, rn, rm); break;
+    case V_FDIV:  V_FDIV(sz, rd, rn, rm); break;
+    default: assert(false); break;
+    }
+    break;
+  default: assert(false); break;
+  }
+  return code->buf;
+}
+
 ////////////////////////////////////////////////
 
 typedef unsigned char *(*AsmInstFunc)(Inst *inst, Code *code);
@@ -548,7 +657,7 @@ static const AsmInstFunc table[] = {
   [MOV] = asm_mov, [MOVK] = asm_movk,
   [ADD_R] = asm_3r, [ADD_I] = asm_2ri,
   [SUB_R] = asm_3r, [SUB_I] = asm_2ri,
-  [MUL] = asm_3r, [SDIV] = asm_3r, [UDIV] = asm_3r,
+  [MUL] = asm_3r, [SMULH] = asm_3r, [UMULH] = asm_3r, [SDIV] = asm_3r, [UDIV] = asm_3r,
   [MADD] = asm_4r, [MSUB] = asm_4r,
   [AND] = asm_3r, [ORR] = asm_3r, [EOR] = asm_3r, [EON] = asm_3r,
   [CMP_R] = asm_2r, [CMP_I] = asm_ri,
@@ -558,6 +667,7 @@ static const AsmInstFunc table[] = {
   [ASR_R] = asm_3r, [ASR_I] = asm_2ri,
   [SXTB] = asm_2r, [SXTH] = asm_2r,  [SXTW] = asm_2r,
   [UXTB] = asm_2r, [UXTH] = asm_2r,  [UXTW] = asm_2r,
+  [CLZ] = asm_2r,  [RBIT] = asm_2r,  [REV] = asm_2r,
   [LDRB] = asm_ldrstr, [LDRSB] = asm_ldrstr, [LDR] = asm_ldrstr,
   [LDRH] = asm_ldrstr, [LDRSH] = asm_ldrstr, [LDRSW] = asm_ldrstr,
   [STRB] = asm_ldrstr, [STRH] = asm_ldrstr,  [STR] = asm_ldrstr,
@@ -565,6 +675,7 @@ static const AsmInstFunc table[] = {
   [STP] = asm_ldpstp,
   [ADRP] = asm_adrp,
   [CSET] = asm_cset,
+  [CSEL] = asm_csel,
   [B] = asm_b,
   [BR] = asm_br,
   [BEQ] = asm_bcc,  [BNE] = asm_bcc,  [BHS] = asm_bcc,  [BLO] = asm_bcc,
@@ -586,6 +697,10 @@ static const AsmInstFunc table[] = {
   [FSQRT] = asm_f_2r,
   [SCVTF] = asm_f_2r, [UCVTF] = asm_f_2r,
   [FCVT] = asm_f_2r, [FCVTZS] = asm_f_2r, [FCVTZU] = asm_f_2r,
+
+  [V_ADD] = asm_v_3r, [V_SUB] = asm_v_3r, [V_MUL] = asm_v_3r,
+  [V_AND] = asm_v_3r, [V_ORR] = asm_v_3r, [V_EOR] = asm_v_3r,
+  [V_FADD] = asm_v_3r, [V_FSUB] = asm_v_3r, [V_FMUL] = asm_v_3r, [V_FDIV] = asm_v_3r,
 };
 
 void assemble_inst(Inst *inst, ParseInfo *info, Code *code) {
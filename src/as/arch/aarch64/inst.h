@@ -10,7 +10,7 @@ enum Opcode {
   NOOP,
   MOV, MOVK,
   ADD_R, ADD_I, SUB_R, SUB_I,
-  MUL, SDIV, UDIV,
+  MUL, SMULH, UMULH, SDIV, UDIV,
   MADD, MSUB,
   AND, ORR, EOR, EON,
   CMP_R, CMP_I, CMN_R, CMN_I,
@@ -19,11 +19,12 @@ enum Opcode {
   ASR_R, ASR_I,
   SXTB, SXTH, SXTW,
   UXTB, UXTH, UXTW,
+  CLZ, RBIT, REV,
   LDRB, LDRH, LDR, LDRSB, LDRSH, LDRSW,
   STRB, STRH, STR,
   LDP, STP,
   ADRP,
-  CSET,
+  CSET, CSEL,
   B, BR,
   BEQ, BNE, BHS, BLO, BMI, BPL, BVS, BVC,
   BHI, BLS, BGE, BLT, BGT, BLE, BAL, BNV,
@@ -39,15 +40,28 @@ enum Opcode {
   FSQRT,
   SCVTF, UCVTF,
   FCVT, FCVTZS, FCVTZU,
+
+  V_ADD, V_SUB, V_MUL,
+  V_AND, V_ORR, V_EOR,
+  V_FADD, V_FSUB, V_FMUL, V_FDIV,
 };
 
 enum RegSize {
   REG32,
   REG64,
+  REG128,
+};
+
+// Arrangement of vector register: 16b, 8h, 4s, 2d.
+enum VRegArrangement {
+  VA_16B,
+  VA_8H,
+  VA_4S,
+  VA_2D,
 };
 
 typedef struct {
-  char size;  // RegSize
+  char size;  // RegSize, or VRegArrangement for VREG
   char no;    // 0~31
   char sp;
 } Reg;
@@ -71,6 +85,7 @@ enum OperandType {
   SHIFT,
   EXTEND,
   FREG,       // freg
+  VREG,       // vN.4s
 };
 
 #define LF_PAGE     (1 << 0)
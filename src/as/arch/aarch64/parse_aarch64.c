@@ -12,18 +12,19 @@ enum RawOpcode {
   R_NOOP,
   R_MOV, R_MOVK,
   R_ADD, R_SUB,
-  R_MUL, R_SDIV, R_UDIV,
+  R_MUL, R_SMULH, R_UMULH, R_SDIV, R_UDIV,
   R_MADD, R_MSUB,
   R_AND, R_ORR, R_EOR, R_EON,
   R_CMP, R_CMN,
   R_LSL, R_LSR, R_ASR,
   R_SXTB, R_SXTH, R_SXTW,
   R_UXTB, R_UXTH, R_UXTW,
+  R_CLZ, R_RBIT, R_REV,
   R_LDRB, R_LDRH, R_LDR, R_LDRSB, R_LDRSH, R_LDRSW,
   R_STRB, R_STRH, R_STR,
   R_LDP, R_STP,
   R_ADRP,
-  R_CSET,
+  R_CSET, R_CSEL,
   R_B, R_BR,
   R_BEQ, R_BNE, R_BHS, R_BLO, R_BMI, R_BPL, R_BVS, R_BVC,
   R_BHI, R_BLS, R_BGE, R_BLT, R_BGT, R_BLE, R_BAL, R_BNV,
@@ -41,18 +42,19 @@ enum RawOpcode {
 
 const char *kRawOpTable[] = {
   "mov", "movk",
-  "add", "sub", "mul", "sdiv", "udiv",
+  "add", "sub", "mul", "smulh", "umulh", "sdiv", "udiv",
   "madd", "msub",
   "and", "orr", "eor", "eon",
   "cmp", "cmn",
   "lsl", "lsr", "asr",
   "sxtb", "sxth", "sxtw",
   "uxtb", "uxth", "uxtw",
+  "clz", "rbit", "rev",
   "ldrb", "ldrh", "ldr", "ldrsb", "ldrsh", "ldrsw",
   "strb", "strh", "str",
   "ldp", "stp",
   "adrp",
-  "cset",
+  "cset", "csel",
   "b", "br",
   "beq", "bne", "bhs", "blo", "bmi", "bpl", "bvs", "bvc",
   "bhi", "bls", "bge", "blt", "bgt", "ble", "bal", "bnv",
@@ -88,6 +90,10 @@ enum RegType {
   // FP64bit
     D0,  D1,  D2,  D3,  D4,  D5,  D6,  D7,  D8,  D9, D10, D11, D12, D13, D14, D15,
    D16, D17, D18, D19, D20, D21, D22, D23, D24, D25, D26, D27, D28, D29, D30, D31,
+
+  // FP128bit
+    Q0,  Q1,  Q2,  Q3,  Q4,  Q5,  Q6,  Q7,  Q8,  Q9, Q10, Q11, Q12, Q13, Q14, Q15,
+   Q16, Q17, Q18, Q19, Q20, Q21, Q22, Q23, Q24, Q25, Q26, Q27, Q28, Q29, Q30, Q31,
 };
 
 typedef struct {
@@ -146,6 +152,17 @@ static const RegisterTable kFRegisters64[] = {
   {"d28", D28},  {"d29", D29},  {"d30", D30},  {"d31", D31},
 };
 
+static const RegisterTable kFRegisters128[] = {
+  {"q0", Q0},    {"q1", Q1},    {"q2", Q2},    {"q3", Q3},
+  {"q4", Q4},    {"q5", Q5},    {"q6", Q6},    {"q7", Q7},
+  {"q8", Q8},    {"q9", Q9},    {"q10", Q10},  {"q11", Q11},
+  {"q12", Q12},  {"q13", Q13},  {"q14", Q14},  {"q15", Q15},
+  {"q16", Q16},  {"q17", Q17},  {"q18", Q18},  {"q19", Q19},
+  {"q20", Q20},  {"q21", Q21},  {"q22", Q22},  {"q23", Q23},
+  {"q24", Q24},  {"q25", Q25},  {"q26", Q26},  {"q27", Q27},
+  {"q28", Q28},  {"q29", Q29},  {"q30", Q30},  {"q31", Q31},
+};
+
 static const char kCondTable[][3] = {
   "eq", "ne", "hs", "lo", "mi", "pl", "vs", "vc",
   "hi", "ls", "ge", "lt", "gt", "le", "al", "nv",
@@ -167,6 +184,10 @@ inline bool is_freg64(enum RegType reg) {
   return reg >= D0 && reg <= D31;
 }
 
+inline bool is_freg128(enum RegType reg) {
+  return reg >= Q0 && reg <= Q31;
+}
+
 #define R32  (1 << 0)
 #define R64  (1 << 1)
 #define F32  (1 << 2)
@@ -180,13 +201,16 @@ inline bool is_freg64(enum RegType reg) {
 #define CND  (1 << 10)
 #define SFT  (1 << 11)  // lsl #nn
 #define EXT  (1 << 12)  // UXTB, UXTH, UXTW, UXTX, SXTB, SXTH, SXTW, SXTX, LSL, LSR, ASR
+#define F128  (1 << 13)
+#define VEC  (1 << 14)  // v0.4s
 
 static enum RegType find_register(const char **pp, unsigned int flag) {
   const char *p = *pp;
-  static const RegisterTable *kRegisters[] = { kRegisters32, kRegisters64, kFRegisters32, kFRegisters64 };
-  static const int kRegistersCount[] = { ARRAY_SIZE(kRegisters32), ARRAY_SIZE(kRegisters64), ARRAY_SIZE(kFRegisters32), ARRAY_SIZE(kFRegisters64) };
+  static const RegisterTable *kRegisters[] = { kRegisters32, kRegisters64, kFRegisters32, kFRegisters64, kFRegisters128 };
+  static const int kRegistersCount[] = { ARRAY_SIZE(kRegisters32), ARRAY_SIZE(kRegisters64), ARRAY_SIZE(kFRegisters32), ARRAY_SIZE(kFRegisters64), ARRAY_SIZE(kFRegisters128) };
+  static const unsigned int kRegistersFlag[] = { R32, R64, F32, F64, F128 };
   for (int i = 0; i < (int)ARRAY_SIZE(kRegisters); ++i) {
-    if ((flag & (R32 << i)) == 0)
+    if ((flag & kRegistersFlag[i]) == 0)
       continue;
 
     const RegisterTable *regs = kRegisters[i];
@@ -202,6 +226,32 @@ static enum RegType find_register(const char **pp, unsigned int flag) {
   return NOREG;
 }
 
+// vN.16b, vN.8h, vN.4s, vN.2d
+static bool find_vector_register(const char **pp, Reg *reg) {
+  static const char kArrangements[][4] = {"16b", "8h", "4s", "2d"};
+  const char *p = *pp;
+  if (tolower(*p) != 'v' || !isdigit(p[1]))
+    return false;
+  int no = 0;
+  for (++p; isdigit(*p); ++p)
+    no = no * 10 + (*p - '0');
+  if (no >= 32 || *p != '.')
+    return false;
+  ++p;
+  for (int i = 0; i < (int)ARRAY_SIZE(kArrangements); ++i) {
+    const char *name = kArrangements[i];
+    size_t n = strlen(name);
+    if (strncasecmp(p, name, n) == 0 && !is_label_chr(p[n])) {
+      *pp = p + n;
+      reg->size = i;
+      reg->no = no;
+      reg->sp = false;
+      return true;
+    }
+  }
+  return false;
+}
+
 static enum CondType find_cond(const char **pp) {
   const char *p = *pp;
   for (int i = 0; i < (int)ARRAY_SIZE(kCondTable); ++i) {
@@ -463,7 +513,7 @@ unsigned int parse_operand(ParseInfo *info, unsigned int opr_flag, Operand *oper
     }
   }
 
-  if (opr_flag & (R32 | R64 | F32 | F64)) {
+  if (opr_flag & (R32 | R64 | F32 | F64 | F128)) {
     enum RegType reg = find_register(&info->p, opr_flag);
     if (reg != NOREG) {
       enum RegSize size;
@@ -489,12 +539,16 @@ unsigned int parse_operand(ParseInfo *info, unsigned int opr_flag, Operand *oper
         size = REG64;
         no = reg - D0;
         result = F64;
+      } else if (is_freg128(reg)) {
+        size = REG128;
+        no = reg - Q0;
+        result = F128;
       } else {
         assert(false);
         return 0;
       }
 
-      operand->type = (result & (F32 | F64)) != 0 ? FREG : REG;
+      operand->type = (result & (F32 | F64 | F128)) != 0 ? FREG : REG;
       operand->reg.size = size;
       operand->reg.no = no;
       operand->reg.sp = reg == SP;
@@ -502,6 +556,13 @@ unsigned int parse_operand(ParseInfo *info, unsigned int opr_flag, Operand *oper
     }
   }
 
+  if (opr_flag & VEC) {
+    if (find_vector_register(&info->p, &operand->reg)) {
+      operand->type = VREG;
+      return VEC;
+    }
+  }
+
   if (opr_flag & CND) {
     enum CondType cond = find_cond(&info->p);
     if (cond != NOCOND) {
@@ -552,7 +613,7 @@ const ParseInstTable kParseInstTable[] = {
   [R_MOVK] = { 1, (const ParseOpArray*[]){
     &(ParseOpArray){MOVK, {R32 | R64, IMM, SFT}},
   } },
-  [R_ADD] = { 9, (const ParseOpArray*[]){
+  [R_ADD] = { 10, (const ParseOpArray*[]){
     &(ParseOpArray){ADD_R, {R32, R32, R32}},
     &(ParseOpArray){ADD_R, {R32, R32, R32, EXT}},
     &(ParseOpArray){ADD_I, {R32, R32, IMM}},
@@ -562,8 +623,9 @@ const ParseInstTable kParseInstTable[] = {
     &(ParseOpArray){ADD_R, {R64 | RSP, R64 | RSP, R64}},
     &(ParseOpArray){ADD_I, {R64 | RSP, R64 | RSP, IMM}},
     &(ParseOpArray){ADD_I, {R64 | RSP, R64 | RSP, EXP}},
+    &(ParseOpArray){V_ADD, {VEC, VEC, VEC}},
   } },
-  [R_SUB] = { 9, (const ParseOpArray*[]){
+  [R_SUB] = { 10, (const ParseOpArray*[]){
     &(ParseOpArray){SUB_R, {R32, R32, R32}},
     &(ParseOpArray){SUB_R, {R32, R32, R32, EXT}},
     &(ParseOpArray){SUB_I, {R32, R32, IMM}},
@@ -573,15 +635,18 @@ const ParseInstTable kParseInstTable[] = {
     &(ParseOpArray){SUB_R, {R64 | RSP, R64 | RSP, R64}},
     &(ParseOpArray){SUB_I, {R64 | RSP, R64 | RSP, IMM}},
     &(ParseOpArray){SUB_I, {R64 | RSP, R64 | RSP, EXP}},
+    &(ParseOpArray){V_SUB, {VEC, VEC, VEC}},
   } },
-  [R_MUL] = { 2, (const ParseOpArray*[]){ &(ParseOpArray){MUL, {R32, R32, R32}}, &(ParseOpArray){MUL, {R64, R64, R64}} } },
+  [R_MUL] = { 3, (const ParseOpArray*[]){ &(ParseOpArray){MUL, {R32, R32, R32}}, &(ParseOpArray){MUL, {R64, R64, R64}}, &(ParseOpArray){V_MUL, {VEC, VEC, VEC}} } },
+  [R_SMULH] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){SMULH, {R64, R64, R64}} } },
+  [R_UMULH] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){UMULH, {R64, R64, R64}} } },
   [R_SDIV] = { 2, (const ParseOpArray*[]){ &(ParseOpArray){SDIV, {R32, R32, R32}}, &(ParseOpArray){SDIV, {R64, R64, R64}} } },
   [R_UDIV] = { 2, (const ParseOpArray*[]){ &(ParseOpArray){UDIV, {R32, R32, R32}}, &(ParseOpArray){UDIV, {R64, R64, R64}} } },
   [R_MADD] = { 2, (const ParseOpArray*[]){ &(ParseOpArray){MADD, {R32, R32, R32, R32}}, &(ParseOpArray){MADD, {R64, R64, R64, R64}} } },
   [R_MSUB] = { 2, (const ParseOpArray*[]){ &(ParseOpArray){MSUB, {R32, R32, R32, R32}}, &(ParseOpArray){MSUB, {R64, R64, R64, R64}} } },
-  [R_AND] = { 2, (const ParseOpArray*[]){ &(ParseOpArray){AND, {R32, R32, R32}}, &(ParseOpArray){AND, {R64, R64, R64}} } },
-  [R_ORR] = { 2, (const ParseOpArray*[]){ &(ParseOpArray){ORR, {R32, R32, R32}}, &(ParseOpArray){ORR, {R64, R64, R64}} } },
-  [R_EOR] = { 2, (const ParseOpArray*[]){ &(ParseOpArray){EOR, {R32, R32, R32}}, &(ParseOpArray){EOR, {R64, R64, R64}} } },
+  [R_AND] = { 3, (const ParseOpArray*[]){ &(ParseOpArray){AND, {R32, R32, R32}}, &(ParseOpArray){AND, {R64, R64, R64}}, &(ParseOpArray){V_AND, {VEC, VEC, VEC}} } },
+  [R_ORR] = { 3, (const ParseOpArray*[]){ &(ParseOpArray){ORR, {R32, R32, R32}}, &(ParseOpArray){ORR, {R64, R64, R64}}, &(ParseOpArray){V_ORR, {VEC, VEC, VEC}} } },
+  [R_EOR] = { 3, (const ParseOpArray*[]){ &(ParseOpArray){EOR, {R32, R32, R32}}, &(ParseOpArray){EOR, {R64, R64, R64}}, &(ParseOpArray){V_EOR, {VEC, VEC, VEC}} } },
   [R_EON] = { 2, (const ParseOpArray*[]){ &(ParseOpArray){EON, {R32, R32, R32}}, &(ParseOpArray){EON, {R64, R64, R64}} } },
   [R_CMP] = { 3, (const ParseOpArray*[]){
     &(ParseOpArray){CMP_R, {R32, R32}},
@@ -617,11 +682,14 @@ const ParseInstTable kParseInstTable[] = {
   [R_UXTB] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){UXTB, {R32 | R64, R32}} } },
   [R_UXTH] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){UXTH, {R32 | R64, R32}} } },
   [R_UXTW] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){UXTW, {R64, R32}} } },
+  [R_CLZ] = { 2, (const ParseOpArray*[]){ &(ParseOpArray){CLZ, {R32, R32}}, &(ParseOpArray){CLZ, {R64, R64}} } },
+  [R_RBIT] = { 2, (const ParseOpArray*[]){ &(ParseOpArray){RBIT, {R32, R32}}, &(ParseOpArray){RBIT, {R64, R64}} } },
+  [R_REV] = { 2, (const ParseOpArray*[]){ &(ParseOpArray){REV, {R32, R32}}, &(ParseOpArray){REV, {R64, R64}} } },
   [R_LDRB] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){LDRB, {R32 | R64, IND | ROI}} } },
   [R_LDRH] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){LDRH, {R32 | R64, IND | ROI}} } },
   [R_LDR] = { 2, (const ParseOpArray*[]){
     &(ParseOpArray){LDR, {R32 | R64, IND | ROI}},
-    &(ParseOpArray){F_LDR, {F32 | F64, IND | ROI}},
+    &(ParseOpArray){F_LDR, {F32 | F64 | F128, IND | ROI}},
   } },
   [R_LDRSB] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){LDRSB, {R32 | R64, IND | ROI}} } },
   [R_LDRSH] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){LDRSH, {R32 | R64, IND | ROI}} } },
@@ -629,7 +697,7 @@ const ParseInstTable kParseInstTable[] = {
   [R_STRH] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){STRH, {R32, IND | ROI}} } },
   [R_STR] = { 2, (const ParseOpArray*[]){
     &(ParseOpArray){STR, {R32 | R64, IND | ROI}},
-    &(ParseOpArray){F_STR, {F32 | F64, IND | ROI}},
+    &(ParseOpArray){F_STR, {F32 | F64 | F128, IND | ROI}},
   } },
   [R_LDP] = { 4, (const ParseOpArray*[]){
     &(ParseOpArray){LDP, {R32, R32, IND}},
@@ -645,6 +713,7 @@ const ParseInstTable kParseInstTable[] = {
   } },
   [R_ADRP] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){ADRP, {R64, EXP}} } },
   [R_CSET] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){CSET, {R32 | R64, CND}} } },
+  [R_CSEL] = { 2, (const ParseOpArray*[]){ &(ParseOpArray){CSEL, {R32, R32, R32, CND}}, &(ParseOpArray){CSEL, {R64, R64, R64, CND}} } },
   [R_B] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){B, {EXP}} } },
   [R_BR] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){BR, {R64}} } },
   [R_BEQ] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){BEQ, {EXP}} } },
@@ -672,21 +741,25 @@ const ParseInstTable kParseInstTable[] = {
     &(ParseOpArray){FMOV, {F32, F32}},
     &(ParseOpArray){FMOV, {F64, F64}},
   } },
-  [R_FADD] = { 2, (const ParseOpArray*[]){
+  [R_FADD] = { 3, (const ParseOpArray*[]){
     &(ParseOpArray){FADD, {F32, F32, F32}},
     &(ParseOpArray){FADD, {F64, F64, F64}},
+    &(ParseOpArray){V_FADD, {VEC, VEC, VEC}},
   } },
-  [R_FSUB] = { 2, (const ParseOpArray*[]){
+  [R_FSUB] = { 3, (const ParseOpArray*[]){
     &(ParseOpArray){FSUB, {F32, F32, F32}},
     &(ParseOpArray){FSUB, {F64, F64, F64}},
+    &(ParseOpArray){V_FSUB, {VEC, VEC, VEC}},
   } },
-  [R_FMUL] = { 2, (const ParseOpArray*[]){
+  [R_FMUL] = { 3, (const ParseOpArray*[]){
     &(ParseOpArray){FMUL, {F32, F32, F32}},
     &(ParseOpArray){FMUL, {F64, F64, F64}},
+    &(ParseOpArray){V_FMUL, {VEC, VEC, VEC}},
   } },
-  [R_FDIV] = { 2, (const ParseOpArray*[]){
+  [R_FDIV] = { 3, (const ParseOpArray*[]){
     &(ParseOpArray){FDIV, {F32, F32, F32}},
     &(ParseOpArray){FDIV, {F64, F64, F64}},
+    &(ParseOpArray){V_FDIV, {VEC, VEC, VEC}},
   } },
   [R_FCMP] = { 2, (const ParseOpArray*[]){
     &(ParseOpArray){FCMP, {F32, F32}},
@@ -88,6 +88,8 @@ static unsigned char *asm_3r(Inst *inst, Code *code) {
   case SUBW:   W_SUBW(rd, rs1, rs2); break;
   case MUL:    W_MUL(rd, rs1, rs2); break;
   case MULW:   W_MULW(rd, rs1, rs2); break;
+  case MULH:   W_MULH(rd, rs1, rs2); break;
+  case MULHU:  W_MULHU(rd, rs1, rs2); break;
   case DIV:    W_DIV(rd, rs1, rs2); break;
   case DIVW:   W_DIVW(rd, rs1, rs2); break;
   case DIVU:   W_DIVU(rd, rs1, rs2); break;
@@ -609,7 +611,7 @@ static const AsmInstFunc table[] = {
   [ADD] = asm_3r, [ADDW] = asm_3r,
   [ADDI] = asm_2ri, [ADDIW] = asm_2ri,
   [SUB] = asm_3r, [SUBW] = asm_3r,
-  [MUL] = asm_3r, [MULW] = asm_3r,
+  [MUL] = asm_3r, [MULW] = asm_3r, [MULH] = asm_3r, [MULHU] = asm_3r,
   [DIV] = asm_3r, [DIVU] = asm_3r, [DIVW] = asm_3r, [DIVUW] = asm_3r,
   [REM] = asm_3r, [REMU] = asm_3r, [REMW] = asm_3r, [REMUW] = asm_3r,
   [AND] = asm_3r, [ANDI] = asm_2ri,
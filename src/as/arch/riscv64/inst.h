@@ -15,7 +15,7 @@ enum Opcode {
   ADD, ADDW,
   ADDI, ADDIW,
   SUB, SUBW,
-  MUL, MULW,
+  MUL, MULW, MULH, MULHU,
   DIV, DIVU, DIVW, DIVUW,
   REM, REMU, REMW, REMUW,
   AND, ANDI,
@@ -364,7 +364,10 @@ bool resolve_relative_address(Vector *sections, Table *label_table, Vector *unre
       case IR_EXPR_QUAD:
         {
           Value value = calc_expr(label_table, ir->expr.expr);
-          assert(value.label != NULL);
+          ir->expr.addend = value.offset;
+          ir->expr.resolved = value.label == NULL;
+          if (ir->expr.resolved)
+            break;  // Difference of labels in the same section.
           UnresolvedInfo *info = malloc_or_die(sizeof(*info));
           info->kind = UNRES_ABS64;  // TODO:
           info->label = value.label;
@@ -421,9 +424,9 @@ void emit_irs(Vector *sections) {
       case IR_EXPR_LONG:
       case IR_EXPR_QUAD:
         {
-          int64_t zero = 0;
+          int64_t value = ir->expr.resolved ? ir->expr.addend : 0;
           int size = 1 << (ir->kind - IR_EXPR_BYTE);
-          sec_add_data(section, &zero, size);  // TODO: Target endian
+          sec_add_data(section, &value, size);  // TODO: Target endian
         }
         break;
       }
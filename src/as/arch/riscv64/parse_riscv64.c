@@ -17,7 +17,7 @@ enum RawOpcode {
   R_ADD, R_ADDW,
   R_ADDI, R_ADDIW,
   R_SUB, R_SUBW,
-  R_MUL, R_MULW,
+  R_MUL, R_MULW, R_MULH, R_MULHU,
   R_DIV, R_DIVU, R_DIVW, R_DIVUW,
   R_REM, R_REMU, R_REMW, R_REMUW,
   R_AND, R_ANDI,
@@ -69,7 +69,7 @@ const char *kRawOpTable[] = {
   "add", "addw",
   "addi", "addiw",
   "sub", "subw",
-  "mul", "mulw",
+  "mul", "mulw", "mulh", "mulhu",
   "div", "divu", "divw", "divuw",
   "rem", "remu", "remw", "remuw",
   "and", "andi",
@@ -383,6 +383,8 @@ const ParseInstTable kParseInstTable[] = {
   [R_SUBW] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){SUBW, {R64, R64, R64}} } },
   [R_MUL] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){MUL, {R64, R64, R64}} } },
   [R_MULW] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){MULW, {R64, R64, R64}} } },
+  [R_MULH] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){MULH, {R64, R64, R64}} } },
+  [R_MULHU] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){MULHU, {R64, R64, R64}} } },
   [R_DIV] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){DIV, {R64, R64, R64}} } },
   [R_DIVW] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){DIVW, {R64, R64, R64}} } },
   [R_DIVU] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){DIVU, {R64, R64, R64}} } },
@@ -25,6 +25,8 @@
 #define W_SUBW(rd, rs1, rs2)      MAKE_CODE32(inst, code, RTYPE(0x20, rs2, rs1, 0x00, rd, 0x3b))
 #define W_MUL(rd, rs1, rs2)       MAKE_CODE32(inst, code, RTYPE(0x01, rs2, rs1, 0x00, rd, 0x33))
 #define W_MULW(rd, rs1, rs2)      MAKE_CODE32(inst, code, RTYPE(0x01, rs2, rs1, 0x00, rd, 0x3b))
+#define W_MULH(rd, rs1, rs2)      MAKE_CODE32(inst, code, RTYPE(0x01, rs2, rs1, 0x01, rd, 0x33))
+#define W_MULHU(rd, rs1, rs2)     MAKE_CODE32(inst, code, RTYPE(0x01, rs2, rs1, 0x03, rd, 0x33))
 #define W_DIV(rd, rs1, rs2)       MAKE_CODE32(inst, code, RTYPE(0x01, rs2, rs1, 0x04, rd, 0x33))
 #define W_DIVU(rd, rs1, rs2)      MAKE_CODE32(inst, code, RTYPE(0x01, rs2, rs1, 0x05, rd, 0x33))
 #define W_DIVW(rd, rs1, rs2)      MAKE_CODE32(inst, code, RTYPE(0x01, rs2, rs1, 0x04, rd, 0x3b))
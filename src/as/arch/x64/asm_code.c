@@ -202,44 +202,59 @@ static unsigned char *asm_mov_ri(Inst *inst, Code *code) {
   return NULL;
 }
 
+// Put `[prefix] [REX] op0 [op1] ModR/M SIB [disp]` for `offset(%base, %index, scale)` operand.
+// `reg` is the register number for ModR/M reg field, and `size` determines REX.W and 0x66.
+static unsigned char *put_indirect_with_index(unsigned char *p, const Operand *opr, enum RegSize size,
+                                              int reg, short prefix, short op0, short op1) {
+  Expr *offset_expr = opr->indirect_with_index.offset;
+  Expr *scale_expr = opr->indirect_with_index.scale;
+  if ((offset_expr != NULL && offset_expr->kind != EX_FIXNUM) ||
+      (scale_expr != NULL && scale_expr->kind != EX_FIXNUM))
+    return NULL;
+  long offset = offset_expr != NULL ? offset_expr->fixnum : 0;
+  long scale = scale_expr != NULL ? scale_expr->fixnum : 1;
+  if (!is_im32(offset) || !(1 <= scale && scale <= 8 && IS_POWER_OF_2(scale)))
+    return NULL;
+
+  assert(opr->indirect_with_index.base_reg.no != RIP);
+  int bno = opr_regno(&opr->indirect_with_index.base_reg);
+  int ino = opr_regno(&opr->indirect_with_index.index_reg);
+  assert(ino != RSP - RAX);  // %rsp cannot be an index.
+  bool noofs = offset == 0 && (bno & 7) != RBP - RAX;  // %rbp and %r13 require offset.
+  int pow = most_significant_bit(scale);
+  short buf[] = {
+    size == REG16 ? 0x66 : -1,
+    prefix,
+    (size == REG64 || reg >= 8 || ino >= 8 || bno >= 8)
+        ? 0x40 | (size == REG64 ? 0x08 : 0) | ((reg & 8) >> 1) | ((ino & 8) >> 2) | ((bno & 8) >> 3)
+        : -1,
+    op0,
+    op1,
+    (noofs ? 0x00 : is_im8(offset) ? 0x40 : 0x80) | ((reg & 7) << 3) | 0x04,
+    (pow << 6) | ((ino & 7) << 3) | (bno & 7),
+  };
+  p = put_code_filtered(p, buf, ARRAY_SIZE(buf));
+  if (noofs) {
+    ;
+  } else if (is_im8(offset)) {
+    *p++ = IM8(offset);
+  } else {
+    PUT_CODE(p, IM32(offset));
+    p += 4;
+  }
+  return p;
+}
+
 static unsigned char *asm_mov_iir(Inst *inst, Code *code) {
-  if (inst->opr[0].indirect_with_index.offset->kind == EX_FIXNUM) {
-    long offset = inst->opr[0].indirect_with_index.offset->fixnum;
-    assert(is_im32(offset));
-    short offset_bit = offset == 0 ? 0x04 : is_im8(offset) ? 0x44 : 0x84;
-    enum RegSize size = inst->opr[1].reg.size;
-    assert(inst->opr[0].indirect_with_index.base_reg.no != RIP);
-    int bno = opr_regno(&inst->opr[0].indirect_with_index.base_reg);
-    int ino = opr_regno(&inst->opr[0].indirect_with_index.index_reg);
-    int dno = opr_regno(&inst->opr[1].reg);
-    Expr *scale_expr = inst->opr[0].indirect_with_index.scale;
-    char scale_bit = 0;
-    if (scale_expr != NULL) {
-      scale_bit = most_significant_bit(scale_expr->fixnum);
-      assert(IS_POWER_OF_2(scale_expr->fixnum) && scale_bit < 4);
-    }
-    short x = ((bno & 8) >> 3) | ((ino & 8) >> 2) | ((dno & 8) >> 1);
-    short prefix = size == REG16 ? 0x66 : size == REG64 || x != 0 ? 0x48 | x : -1;
-    short buf[] = {
-      prefix,
-      size == REG8 ? 0x8a : 0x8b,
-      ((dno & 7) << 3) | offset_bit,
-      (scale_bit << 6) | ((ino & 7) << 3) | (bno & 7),
-    };
-    unsigned char *p = code->buf;
-    p = put_code_filtered(p, buf, ARRAY_SIZE(buf));
+  enum RegSize size = inst->opr[1].reg.size;
+  return put_indirect_with_index(code->buf, &inst->opr[0], size, opr_regno(&inst->opr[1].reg), -1,
+                                 size == REG8 ? 0x8a : 0x8b, -1);
+}
 
-    if (offset != 0) {
-      if (is_im8(offset)) {
-        *p++ = IM8(offset);
-      } else {
-        PUT_CODE(p, IM32(offset));
-        p += 4;
-      }
-    }
-    return p;
-  }
-  return NULL;
+static unsigned char *asm_mov_rii(Inst *inst, Code *code) {
+  enum RegSize size = inst->opr[0].reg.size;
+  return put_indirect_with_index(code->buf, &inst->opr[1], size, opr_regno(&inst->opr[0].reg), -1,
+                                 size == REG8 ? 0x88 : 0x89, -1);
 }
 
 static unsigned char *asm_mov_dr(Inst *inst, Code *code) {
@@ -333,6 +348,27 @@ static unsigned char *asm_movbwlq_imi(Inst *inst, Code *code) {
   return p;
 }
 
+static unsigned char *asm_movbwlq_imii(Inst *inst, Code *code) {
+  static const enum RegSize kSizes[] = {REG8, REG16, REG32, REG64};
+  int pow = inst->op - MOVB_IMII;
+  assert(0 <= pow && pow < 4);
+  unsigned char *p = put_indirect_with_index(code->buf, &inst->opr[1], kSizes[pow], 0, -1,
+                                             pow == 0 ? 0xc6 : 0xc7, -1);
+  if (p == NULL)
+    return NULL;
+
+  long value = inst->opr[0].immediate;
+  switch (pow) {
+  case 0: *p++ = IM8(value); break;
+  case 1: PUT_CODE(p, IM16(value)); p += 2; break;
+  default:
+    PUT_CODE(p, IM32(value));
+    p += 4;
+    break;
+  }
+  return p;
+}
+
 static unsigned char *asm_movbwlq_imd(Inst *inst, Code *code) {
   assert(inst->opr[1].direct.expr->kind == EX_FIXNUM);
   int64_t dst = inst->opr[1].direct.expr->fixnum;
@@ -449,12 +485,13 @@ static unsigned char *asm_movsds_xx(Inst *inst, Code *code, bool single) {
 static unsigned char *asm_movsd_xx(Inst *inst, Code *code) { return asm_movsds_xx(inst, code, false); }
 static unsigned char *asm_movss_xx(Inst *inst, Code *code) { return asm_movsds_xx(inst, code, true); }
 
-static unsigned char *asm_movsds_ix(Inst *inst, Code *code, bool single) {
+// SSE load: `op xmm, [reg + offset]`.
+static unsigned char *assemble_sse_ix(Inst *inst, Code *code, unsigned char prefix,
+                                      unsigned char opc) {
   long offset;
   if (inst->opr[0].indirect.offset.expr->kind == EX_FIXNUM &&
       (offset = inst->opr[0].indirect.offset.expr->fixnum, is_im32(offset))) {
     if (inst->opr[0].indirect.reg.no != RIP) {
-      unsigned char prefix = single ? 0xf3 : 0xf2;
       unsigned char sno = opr_regno(&inst->opr[0].indirect.reg);
       unsigned char dno = inst->opr[1].regxmm - XMM0;
       int d = dno & 7;
@@ -467,7 +504,7 @@ static unsigned char *asm_movsds_ix(Inst *inst, Code *code, bool single) {
         prefix,
         sno >= 8 || dno >= 8 ? (unsigned char)0x40 | ((sno & 8) >> 3) | ((dno & 8) >> 1) : -1,
         0x0f,
-        0x10,
+        opc,
         op | s | (d << 3),
         s == RSP - RAX ? 0x24 : -1,
       };
@@ -487,15 +524,39 @@ static unsigned char *asm_movsds_ix(Inst *inst, Code *code, bool single) {
   }
   return NULL;
 }
-static unsigned char *asm_movsd_ix(Inst *inst, Code *code) { return asm_movsds_ix(inst, code, false); }
-static unsigned char *asm_movss_ix(Inst *inst, Code *code) { return asm_movsds_ix(inst, code, true); }
+static unsigned char *asm_movsd_ix(Inst *inst, Code *code) { return assemble_sse_ix(inst, code, 0xf2, 0x10); }
+static unsigned char *asm_movss_ix(Inst *inst, Code *code) { return assemble_sse_ix(inst, code, 0xf3, 0x10); }
+static unsigned char *asm_movdqu_ix(Inst *inst, Code *code) { return assemble_sse_ix(inst, code, 0xf3, 0x6f); }
+
+static unsigned char *asm_movsds_iix(Inst *inst, Code *code, bool single) {
+  return put_indirect_with_index(code->buf, &inst->opr[0], REG32, inst->opr[1].regxmm - XMM0,
+                                 single ? 0xf3 : 0xf2, 0x0f, 0x10);
+}
+static unsigned char *asm_movsd_iix(Inst *inst, Code *code) { return asm_movsds_iix(inst, code, false); }
+static unsigned char *asm_movss_iix(Inst *inst, Code *code) { return asm_movsds_iix(inst, code, true); }
+static unsigned char *asm_movdqu_iix(Inst *inst, Code *code) {
+  return put_indirect_with_index(code->buf, &inst->opr[0], REG32, inst->opr[1].regxmm - XMM0,
+                                 0xf3, 0x0f, 0x6f);
+}
+
+static unsigned char *asm_movsds_xii(Inst *inst, Code *code, bool single) {
+  return put_indirect_with_index(code->buf, &inst->opr[1], REG32, inst->opr[0].regxmm - XMM0,
+                                 single ? 0xf3 : 0xf2, 0x0f, 0x11);
+}
+static unsigned char *asm_movsd_xii(Inst *inst, Code *code) { return asm_movsds_xii(inst, code, false); }
+static unsigned char *asm_movss_xii(Inst *inst, Code *code) { return asm_movsds_xii(inst, code, true); }
+static unsigned char *asm_movdqu_xii(Inst *inst, Code *code) {
+  return put_indirect_with_index(code->buf, &inst->opr[1], REG32, inst->opr[0].regxmm - XMM0,
+                                 0xf3, 0x0f, 0x7f);
+}
 
-static unsigned char *asm_movsds_xi(Inst *inst, Code *code, bool single) {
+// SSE store: `op [reg + offset], xmm`.
+static unsigned char *assemble_sse_xi(Inst *inst, Code *code, unsigned char prefix,
+                                      unsigned char opc) {
   long offset;
   if (inst->opr[1].indirect.offset.expr->kind == EX_FIXNUM &&
       (offset = inst->opr[1].indirect.offset.expr->fixnum, is_im32(offset))) {
     if (inst->opr[1].indirect.reg.no != RIP) {
-      unsigned char prefix = single ? 0xf3 : 0xf2;
       unsigned char sno = inst->opr[0].regxmm - XMM0;
       unsigned char dno = opr_regno(&inst->opr[1].indirect.reg);
       int d = dno & 7;
@@ -508,7 +569,7 @@ static unsigned char *asm_movsds_xi(Inst *inst, Code *code, bool single) {
         prefix,
         sno >= 8 || dno >= 8 ? (unsigned char)0x40 | ((dno & 8) >> 3) | ((sno & 8) >> 1) : -1,
         0x0f,
-        0x11,
+        opc,
         op | d | (s << 3),
         d == RSP - RAX ? 0x24 : -1,
       };
@@ -528,8 +589,9 @@ static unsigned char *asm_movsds_xi(Inst *inst, Code *code, bool single) {
   }
   return NULL;
 }
-static unsigned char *asm_movsd_xi(Inst *inst, Code *code) { return asm_movsds_xi(inst, code, false); }
-static unsigned char *asm_movss_xi(Inst *inst, Code *code) { return asm_movsds_xi(inst, code, true); }
+static unsigned char *asm_movsd_xi(Inst *inst, Code *code) { return assemble_sse_xi(inst, code, 0xf2, 0x11); }
+static unsigned char *asm_movss_xi(Inst *inst, Code *code) { return assemble_sse_xi(inst, code, 0xf3, 0x11); }
+static unsigned char *asm_movdqu_xi(Inst *inst, Code *code) { return assemble_sse_xi(inst, code, 0xf3, 0x7f); }
 
 static unsigned char *assemble_bop_sd(Inst *inst, Code *code, bool single, unsigned char op) {
   unsigned char *p = code->buf;
@@ -562,16 +624,17 @@ static unsigned char *asm_mulss_xx(Inst *inst, Code *code) { return assemble_bop
 static unsigned char *asm_divsd_xx(Inst *inst, Code *code) { return assemble_bop_sd(inst, code, false, 0x5e); }
 static unsigned char *asm_divss_xx(Inst *inst, Code *code) { return assemble_bop_sd(inst, code, true, 0x5e); }
 
-static unsigned char *assemble_xorpd_xx(Inst *inst, Code *code, bool single) {
+// Packed operation between xmm registers: `[prefix] 0f op /r`, prefix is omitted if -1.
+static unsigned char *assemble_packed_xx(Inst *inst, Code *code, short prefix, unsigned char op) {
   unsigned char *p = code->buf;
   if (inst->opr[0].type == REG_XMM && inst->opr[1].type == REG_XMM) {
     unsigned char sno = inst->opr[0].regxmm - XMM0;
     unsigned char dno = inst->opr[1].regxmm - XMM0;
     short buf[] = {
-      single ? -1 : 0x66,
+      prefix,
       sno >= 8 || dno >= 8 ? (unsigned char)0x40 | ((sno & 8) >> 3) | ((dno & 8) >> 1) : -1,
       0x0f,
-      0x57,
+      op,
       (unsigned char)0xc0 | ((dno & 7) << 3) | (sno & 7),
     };
     p = put_code_filtered(p, buf, ARRAY_SIZE(buf));
@@ -579,8 +642,30 @@ static unsigned char *assemble_xorpd_xx(Inst *inst, Code *code, bool single) {
 
   return p;
 }
-static unsigned char *asm_xorpd_xx(Inst *inst, Code *code) { return assemble_xorpd_xx(inst, code, false); }
-static unsigned char *asm_xorps_xx(Inst *inst, Code *code) { return assemble_xorpd_xx(inst, code, true); }
+static unsigned char *asm_xorpd_xx(Inst *inst, Code *code) { return assemble_packed_xx(inst, code, 0x66, 0x57); }
+static unsigned char *asm_xorps_xx(Inst *inst, Code *code) { return assemble_packed_xx(inst, code, -1, 0x57); }
+static unsigned char *asm_movdqu_xx(Inst *inst, Code *code) { return assemble_packed_xx(inst, code, 0xf3, 0x6f); }
+
+static unsigned char *asm_packed_xx(Inst *inst, Code *code) {
+  static const struct {
+    short prefix;
+    unsigned char op;
+  } kPackedOps[] = {
+    [PADDB - PADDB] = {0x66, 0xfc}, [PADDW - PADDB] = {0x66, 0xfd},
+    [PADDD - PADDB] = {0x66, 0xfe}, [PADDQ - PADDB] = {0x66, 0xd4},
+    [PSUBB - PADDB] = {0x66, 0xf8}, [PSUBW - PADDB] = {0x66, 0xf9},
+    [PSUBD - PADDB] = {0x66, 0xfa}, [PSUBQ - PADDB] = {0x66, 0xfb},
+    [PMULLW - PADDB] = {0x66, 0xd5},
+    [PAND - PADDB] = {0x66, 0xdb}, [POR - PADDB] = {0x66, 0xeb}, [PXOR - PADDB] = {0x66, 0xef},
+    [ADDPS - PADDB] = {-1, 0x58}, [ADDPD - PADDB] = {0x66, 0x58},
+    [SUBPS - PADDB] = {-1, 0x5c}, [SUBPD - PADDB] = {0x66, 0x5c},
+    [MULPS - PADDB] = {-1, 0x59}, [MULPD - PADDB] = {0x66, 0x59},
+    [DIVPS - PADDB] = {-1, 0x5e}, [DIVPD - PADDB] = {0x66, 0x5e},
+  };
+  int i = inst->op - PADDB;
+  assert(0 <= i && i < (int)ARRAY_SIZE(kPackedOps));
+  return assemble_packed_xx(inst, code, kPackedOps[i].prefix, kPackedOps[i].op);
+}
 
 static unsigned char *assemble_ucomisd(Inst *inst, Code *code, unsigned char opc, bool single) {
   unsigned char *p = code->buf;
@@ -723,41 +808,8 @@ static unsigned char *asm_lea_ir(Inst *inst, Code *code) {
 }
 
 static unsigned char *asm_lea_iir(Inst *inst, Code *code) {
-  Expr *offset_expr = inst->opr[0].indirect_with_index.offset;
-  Expr *scale_expr = inst->opr[0].indirect_with_index.scale;
-  if ((offset_expr == NULL || offset_expr->kind == EX_FIXNUM) &&
-      (scale_expr == NULL || scale_expr->kind == EX_FIXNUM)) {
-    long offset = offset_expr != NULL ? offset_expr->fixnum : 0;
-    long scale = scale_expr != NULL ? scale_expr->fixnum : 1;
-    if (is_im32(offset) && 1 <= scale && scale <= 8 && IS_POWER_OF_2(scale)) {
-      int breg = opr_regno(&inst->opr[0].indirect_with_index.base_reg);
-      int ireg = opr_regno(&inst->opr[0].indirect_with_index.index_reg);
-      int dreg = opr_regno(&inst->opr[1].reg);
-      bool noofs = offset == 0 && breg != RBP - RAX;
-      int pow = most_significant_bit(scale);
-      assert(IS_POWER_OF_2(scale) && pow < 4);
-      short buf[] = {
-        0x48 | ((breg & 8) >> 3) | ((ireg & 8) >> 2) | ((dreg & 8) >> 1),
-        0x8d,
-        (noofs ? 0x00 : is_im8(offset) ? 0x40 : 0x80) | ((dreg & 7) << 3) | 0x04,
-        (breg & 7) | ((ireg & 7) << 3) | (pow << 6),
-        breg == RSP - RAX ? 0x24 : -1,
-      };
-
-      unsigned char *p = code->buf;
-      p = put_code_filtered(p, buf, ARRAY_SIZE(buf));
-      if (noofs) {
-        ;
-      } else if (is_im8(offset)) {
-        *p++ = IM8(offset);
-      } else if (is_im32(offset)) {
-        PUT_CODE(p, IM32(offset));
-        p += 4;
-      }
-      return p;
-    }
-  }
-  return NULL;
+  return put_indirect_with_index(code->buf, &inst->opr[0], REG64, opr_regno(&inst->opr[1].reg), -1,
+                                 0x8d, -1);
 }
 
 static unsigned char *asm_add_rr(Inst *inst, Code *code) {
@@ -1009,6 +1061,54 @@ static unsigned char *asm_mul_r(Inst *inst, Code *code) {
   return p;
 }
 
+static unsigned char *asm_imul_r(Inst *inst, Code *code) {
+  enum RegSize size = inst->opr[0].reg.size;
+  unsigned char *p = code->buf;
+  short buf[] = {
+    MAKE_REX0(
+        size, 0, opr_regno(&inst->opr[0].reg),
+        0xf6 | (size == REG8 ? 0 : 1)),
+    0xe8 | inst->opr[0].reg.no,
+  };
+  p = put_code_filtered(p, buf, ARRAY_SIZE(buf));
+  return p;
+}
+
+static unsigned char *asm_imul_rr(Inst *inst, Code *code) {
+  enum RegSize size = inst->opr[1].reg.size;
+  int s = opr_regno(&inst->opr[0].reg);
+  int d = opr_regno(&inst->opr[1].reg);
+  unsigned char *p = code->buf;
+  short buf[] = {
+    MAKE_REX0(size, d, s, 0x0f),
+    0xaf,
+    0xc0 | ((d & 7) << 3) | (s & 7),
+  };
+  p = put_code_filtered(p, buf, ARRAY_SIZE(buf));
+  return p;
+}
+
+static unsigned char *asm_imul_imrr(Inst *inst, Code *code) {
+  long value = inst->opr[0].immediate;
+  if (!is_im32(value))
+    return NULL;
+  enum RegSize size = inst->opr[2].reg.size;
+  bool im8 = is_im8(value);
+  unsigned char *p = code->buf;
+  p = put_rex2(p, size, opr_regno(&inst->opr[2].reg), opr_regno(&inst->opr[1].reg),
+               im8 ? 0x6b : 0x69);
+  if (im8) {
+    *p++ = IM8(value);
+  } else if (size == REG16) {
+    PUT_CODE(p, IM16(value));
+    p += 2;
+  } else {
+    PUT_CODE(p, IM32(value));
+    p += 4;
+  }
+  return p;
+}
+
 static unsigned char *asm_div_r(Inst *inst, Code *code) {
   enum RegSize size = inst->opr[0].reg.size;
   unsigned char *p = code->buf;
@@ -1364,6 +1464,50 @@ static unsigned char *asm_set_r(Inst *inst, Code *code) {
   return p;
 }
 
+static unsigned char *asm_cmov_rr(Inst *inst, Code *code) {
+  enum RegSize size = inst->opr[1].reg.size;
+  int s = opr_regno(&inst->opr[0].reg);
+  int d = opr_regno(&inst->opr[1].reg);
+  unsigned char *p = code->buf;
+  short buf[] = {
+    MAKE_REX0(size, d, s, 0x0f),
+    0x40 | (inst->op - CMOVO),
+    0xc0 | ((d & 7) << 3) | (s & 7),
+  };
+  p = put_code_filtered(p, buf, ARRAY_SIZE(buf));
+  return p;
+}
+
+static unsigned char *asm_bitscan_rr(Inst *inst, Code *code) {
+  enum RegSize size = inst->opr[1].reg.size;
+  int s = opr_regno(&inst->opr[0].reg);
+  int d = opr_regno(&inst->opr[1].reg);
+  bool rep = inst->op != BSR;  // popcnt and tzcnt have `rep` prefix.
+  unsigned char op = inst->op == POPCNT ? 0xb8 : inst->op == TZCNT ? 0xbc : 0xbd;
+  unsigned char *p = code->buf;
+  short buf[] = {
+    size == REG16 ? 0x66 : -1,
+    rep ? 0xf3 : -1,
+    MAKE_REX0(size == REG16 ? REG32 : size, d, s, 0x0f),
+    op,
+    0xc0 | ((d & 7) << 3) | (s & 7),
+  };
+  p = put_code_filtered(p, buf, ARRAY_SIZE(buf));
+  return p;
+}
+
+static unsigned char *asm_bswap_r(Inst *inst, Code *code) {
+  enum RegSize size = inst->opr[0].reg.size;
+  int r = opr_regno(&inst->opr[0].reg);
+  unsigned char *p = code->buf;
+  short buf[] = {
+    MAKE_REX0(size, 0, r, 0x0f),
+    0xc8 | (r & 7),
+  };
+  p = put_code_filtered(p, buf, ARRAY_SIZE(buf));
+  return p;
+}
+
 static unsigned char *asm_push_r(Inst *inst, Code *code) {
   unsigned char *p = code->buf;
   short buf[] = {
@@ -1528,6 +1672,7 @@ static const AsmInstFunc table[] = {
   [MOV_IR] = asm_mov_ir,
   [MOV_RI] = asm_mov_ri,
   [MOV_IIR] = asm_mov_iir,
+  [MOV_RII] = asm_mov_rii,
   [MOV_DR] = asm_mov_dr,
   [MOV_RD] = asm_mov_rd,
   [MOV_SR] = asm_mov_sr,
@@ -1535,6 +1680,10 @@ static const AsmInstFunc table[] = {
   [MOVW_IMI] = asm_movbwlq_imi,
   [MOVL_IMI] = asm_movbwlq_imi,
   [MOVQ_IMI] = asm_movbwlq_imi,
+  [MOVB_IMII] = asm_movbwlq_imii,
+  [MOVW_IMII] = asm_movbwlq_imii,
+  [MOVL_IMII] = asm_movbwlq_imii,
+  [MOVQ_IMII] = asm_movbwlq_imii,
   [MOVB_IMD] = asm_movbwlq_imd,
   [MOVW_IMD] = asm_movbwlq_imd,
   [MOVL_IMD] = asm_movbwlq_imd,
@@ -1553,6 +1702,9 @@ static const AsmInstFunc table[] = {
   [SUB_IIR] = asm_sub_iir,
   [SUBQ] = asm_subq_imi,
   [MUL] = asm_mul_r,
+  [IMUL] = asm_imul_r,
+  [IMUL_RR] = asm_imul_rr,
+  [IMUL_IMRR] = asm_imul_imrr,
   [DIV] = asm_div_r,
   [IDIV] = asm_idiv_r,
   [NEG] = asm_neg_r,
@@ -1583,6 +1735,14 @@ static const AsmInstFunc table[] = {
   [SETE] = asm_set_r,  [SETNE] = asm_set_r,  [SETBE] = asm_set_r,  [SETA] = asm_set_r,
   [SETS] = asm_set_r,  [SETNS] = asm_set_r,  [SETP] = asm_set_r,  [SETNP] = asm_set_r,
   [SETL] = asm_set_r,  [SETGE] = asm_set_r,  [SETLE] = asm_set_r,  [SETG] = asm_set_r,
+  [CMOVO] = asm_cmov_rr,  [CMOVNO] = asm_cmov_rr,  [CMOVB] = asm_cmov_rr,
+  [CMOVAE] = asm_cmov_rr, [CMOVE] = asm_cmov_rr,   [CMOVNE] = asm_cmov_rr,
+  [CMOVBE] = asm_cmov_rr, [CMOVA] = asm_cmov_rr,   [CMOVS] = asm_cmov_rr,
+  [CMOVNS] = asm_cmov_rr, [CMOVP] = asm_cmov_rr,   [CMOVNP] = asm_cmov_rr,
+  [CMOVL] = asm_cmov_rr,  [CMOVGE] = asm_cmov_rr,  [CMOVLE] = asm_cmov_rr,
+  [CMOVG] = asm_cmov_rr,
+  [POPCNT] = asm_bitscan_rr, [TZCNT] = asm_bitscan_rr, [BSR] = asm_bitscan_rr,
+  [BSWAP] = asm_bswap_r,
   [JMP_D] = asm_jmp_d,
   [JMP_DER] = asm_jmp_der,
   [JMP_DEI] = asm_jmp_dei,
@@ -1603,9 +1763,13 @@ static const AsmInstFunc table[] = {
   [MOVSD_XX] = asm_movsd_xx,
   [MOVSD_IX] = asm_movsd_ix,
   [MOVSD_XI] = asm_movsd_xi,
+  [MOVSD_IIX] = asm_movsd_iix,
+  [MOVSD_XII] = asm_movsd_xii,
   [MOVSS_XX] = asm_movss_xx,
   [MOVSS_IX] = asm_movss_ix,
   [MOVSS_XI] = asm_movss_xi,
+  [MOVSS_IIX] = asm_movss_iix,
+  [MOVSS_XII] = asm_movss_xii,
   [ADDSD] = asm_addsd_xx, [ADDSS] = asm_addss_xx,
   [SUBSD] = asm_subsd_xx, [SUBSS] = asm_subss_xx,
   [MULSD] = asm_mulsd_xx, [MULSS] = asm_mulss_xx,
@@ -1620,6 +1784,17 @@ static const AsmInstFunc table[] = {
   [CVTSD2SS] = asm_cvtsd2ss_xx,
   [CVTSS2SD] = asm_cvtss2sd_xx,
   [SQRTSD] = asm_sqrtsd_xx,
+  [MOVDQU_XX] = asm_movdqu_xx,
+  [MOVDQU_IX] = asm_movdqu_ix,
+  [MOVDQU_XI] = asm_movdqu_xi,
+  [MOVDQU_IIX] = asm_movdqu_iix,
+  [MOVDQU_XII] = asm_movdqu_xii,
+  [PADDB] = asm_packed_xx, [PADDW] = asm_packed_xx, [PADDD] = asm_packed_xx, [PADDQ] = asm_packed_xx,
+  [PSUBB] = asm_packed_xx, [PSUBW] = asm_packed_xx, [PSUBD] = asm_packed_xx, [PSUBQ] = asm_packed_xx,
+  [PMULLW] = asm_packed_xx,
+  [PAND] = asm_packed_xx, [POR] = asm_packed_xx, [PXOR] = asm_packed_xx,
+  [ADDPS] = asm_packed_xx, [ADDPD] = asm_packed_xx, [SUBPS] = asm_packed_xx, [SUBPD] = asm_packed_xx,
+  [MULPS] = asm_packed_xx, [MULPD] = asm_packed_xx, [DIVPS] = asm_packed_xx, [DIVPD] = asm_packed_xx,
   [ENDBR64] = asm_endbr64,
 };
 
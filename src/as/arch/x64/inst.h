@@ -9,8 +9,9 @@ typedef struct Name Name;
 
 enum Opcode {
   NOOP,
-  MOV_RR, MOV_IMR, MOV_IR, MOV_RI, MOV_IIR, MOV_DR, MOV_RD, MOV_SR,
+  MOV_RR, MOV_IMR, MOV_IR, MOV_RI, MOV_IIR, MOV_RII, MOV_DR, MOV_RD, MOV_SR,
   MOVB_IMI, MOVW_IMI, MOVL_IMI, MOVQ_IMI,
+  MOVB_IMII, MOVW_IMII, MOVL_IMII, MOVQ_IMII,
   MOVB_IMD, MOVW_IMD, MOVL_IMD, MOVQ_IMD,
   MOVSX, MOVZX,
   LEA_IR, LEA_IIR,
@@ -19,7 +20,7 @@ enum Opcode {
   ADDQ,
   SUB_RR, SUB_IMR, SUB_IR, SUB_IIR,
   SUBQ,
-  MUL,
+  MUL, IMUL, IMUL_RR, IMUL_IMRR,
   DIV, IDIV,
   NEG,
   NOT,
@@ -38,6 +39,11 @@ enum Opcode {
   SETO, SETNO, SETB, SETAE, SETE, SETNE, SETBE, SETA,
   SETS, SETNS, SETP, SETNP, SETL, SETGE, SETLE, SETG,
 
+  CMOVO, CMOVNO, CMOVB, CMOVAE, CMOVE, CMOVNE, CMOVBE, CMOVA,
+  CMOVS, CMOVNS, CMOVP, CMOVNP, CMOVL, CMOVGE, CMOVLE, CMOVG,
+
+  POPCNT, TZCNT, BSR, BSWAP,
+
   JMP_D, JMP_DER, JMP_DEI, JMP_DEII,
   JO,  JNO,  JB,  JAE,  JE,  JNE,  JBE,  JA,
   JS,  JNS,  JP,  JNP,  JL,  JGE,  JLE,  JG,
@@ -46,18 +52,23 @@ enum Opcode {
 
   INT, SYSCALL,
 
-  MOVSD_XX, MOVSD_IX, MOVSD_XI,
+  MOVSD_XX, MOVSD_IX, MOVSD_XI, MOVSD_IIX, MOVSD_XII,
   ADDSD, SUBSD, MULSD, DIVSD, XORPD,
   COMISD, UCOMISD,
   CVTSI2SD, CVTTSD2SI,
   SQRTSD,
 
-  MOVSS_XX, MOVSS_IX, MOVSS_XI,
+  MOVSS_XX, MOVSS_IX, MOVSS_XI, MOVSS_IIX, MOVSS_XII,
   ADDSS, SUBSS, MULSS, DIVSS, XORPS,
   COMISS, UCOMISS,
   CVTSI2SS, CVTTSS2SI,
   CVTSD2SS, CVTSS2SD,
 
+  MOVDQU_XX, MOVDQU_IX, MOVDQU_XI, MOVDQU_IIX, MOVDQU_XII,
+  PADDB, PADDW, PADDD, PADDQ, PSUBB, PSUBW, PSUBD, PSUBQ, PMULLW,
+  PAND, POR, PXOR,
+  ADDPS, ADDPD, SUBPS, SUBPD, MULPS, MULPD, DIVPS, DIVPD,
+
   ENDBR64,
 };
 
@@ -163,5 +174,5 @@ typedef struct {
 
 typedef struct Inst {
   enum Opcode op;
-  Operand opr[2];  // src, dst
+  Operand opr[3];  // src, dst (imul: imm, src, dst)
 } Inst;
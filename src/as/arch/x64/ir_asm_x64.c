@@ -181,7 +181,7 @@ bool resolve_relative_address(Vector *sections, Table *label_table, Vector *unre
               Value value = calc_expr(label_table, inst->opr[0].direct.expr);
               if (value.label != NULL) {
                 LabelInfo *label_info = table_get(label_table, value.label);
-                if (label_info == NULL) {
+                if (label_info == NULL || label_info->section != section) {
                   // Make unresolved label jmp to long.
                   size_upgraded |= make_jmp_long(ir);
 
@@ -243,14 +243,16 @@ bool resolve_relative_address(Vector *sections, Table *label_table, Vector *unre
       case IR_EXPR_QUAD:
         {
           Value value = calc_expr(label_table, ir->expr.expr);
-          assert(value.label != NULL);
+          ir->expr.addend = value.offset;
+          ir->expr.resolved = value.label == NULL;
+          if (ir->expr.resolved)
+            break;  // Difference of labels in the same section.
           UnresolvedInfo *info = malloc_or_die(sizeof(*info));
           info->kind = UNRES_ABS64;  // TODO:
           info->label = value.label;
           info->src_section = section;
           info->offset = address - start_address;
           info->add = value.offset;
-          ir->expr.addend = value.offset;
           vec_push(unresolved, info);
         }
         break;
@@ -304,7 +306,7 @@ void emit_irs(Vector *sections) {
 #if XCC_TARGET_PLATFORM == XCC_PLATFORM_APPLE
           int64_t value = ir->expr.addend;
 #else
-          int64_t value = 0;
+          int64_t value = ir->expr.resolved ? ir->expr.addend : 0;
 #endif
           int size = 1 << (ir->kind - IR_EXPR_BYTE);
           sec_add_data(section, &value, size);  // TODO: Target endian
@@ -18,7 +18,7 @@ enum RawOpcode {
 
   R_ADD, R_ADDQ,
   R_SUB, R_SUBQ,
-  R_MUL,
+  R_MUL, R_IMUL,
   R_DIV, R_IDIV,
   R_NEG,
   R_NOT,
@@ -33,6 +33,11 @@ enum RawOpcode {
   R_SETO, R_SETNO, R_SETB, R_SETAE, R_SETE, R_SETNE, R_SETBE, R_SETA,
   R_SETS, R_SETNS, R_SETP, R_SETNP, R_SETL, R_SETGE, R_SETLE, R_SETG,
 
+  R_CMOVO, R_CMOVNO, R_CMOVB, R_CMOVAE, R_CMOVE, R_CMOVNE, R_CMOVBE, R_CMOVA,
+  R_CMOVS, R_CMOVNS, R_CMOVP, R_CMOVNP, R_CMOVL, R_CMOVGE, R_CMOVLE, R_CMOVG,
+
+  R_POPCNT, R_TZCNT, R_BSR, R_BSWAP,
+
   R_JMP,
   R_JO, R_JNO, R_JB, R_JAE, R_JE, R_JNE, R_JBE, R_JA,
   R_JS, R_JNS, R_JP, R_JNP, R_JL, R_JGE, R_JLE, R_JG,
@@ -51,6 +56,11 @@ enum RawOpcode {
   R_CVTSI2SS, R_CVTTSS2SI,
   R_CVTSD2SS, R_CVTSS2SD,
 
+  R_MOVDQU,
+  R_PADDB, R_PADDW, R_PADDD, R_PADDQ, R_PSUBB, R_PSUBW, R_PSUBD, R_PSUBQ, R_PMULLW,
+  R_PAND, R_POR, R_PXOR,
+  R_ADDPS, R_ADDPD, R_SUBPS, R_SUBPD, R_MULPS, R_MULPD, R_DIVPS, R_DIVPD,
+
   R_ENDBR64,
 };
 
@@ -62,7 +72,7 @@ const char *kRawOpTable[] = {
 
   "add",  "addq",
   "sub",  "subq",
-  "mul",
+  "mul",  "imul",
   "div",  "idiv",
   "neg",
   "not",
@@ -77,6 +87,11 @@ const char *kRawOpTable[] = {
   "seto",  "setno",  "setb",  "setae",  "sete",  "setne",  "setbe",  "seta",
   "sets",  "setns",  "setp",  "setnp",  "setl",  "setge",  "setle",  "setg",
 
+  "cmovo",  "cmovno",  "cmovb",  "cmovae",  "cmove",  "cmovne",  "cmovbe",  "cmova",
+  "cmovs",  "cmovns",  "cmovp",  "cmovnp",  "cmovl",  "cmovge",  "cmovle",  "cmovg",
+
+  "popcnt", "tzcnt", "bsr", "bswap",
+
   "jmp",
   "jo",  "jno",  "jb",  "jae",  "je",  "jne",  "jbe",  "ja",
   "js",  "jns",  "jp",  "jnp",  "jl",  "jge",  "jle",  "jg",
@@ -95,6 +110,11 @@ const char *kRawOpTable[] = {
   "cvtsi2ss",  "cvttss2si",
   "cvtsd2ss",  "cvtss2sd",
 
+  "movdqu",
+  "paddb", "paddw", "paddd", "paddq", "psubb", "psubw", "psubd", "psubq", "pmullw",
+  "pand", "por", "pxor",
+  "addps", "addpd", "subps", "subpd", "mulps", "mulpd", "divps", "divpd",
+
   "endbr64",
   NULL,
 };
@@ -489,31 +509,36 @@ unsigned int parse_operand(ParseInfo *info, unsigned int opr_flag, Operand *oper
 }
 
 const ParseInstTable kParseInstTable[] = {
-  [R_MOV] = { 11, (const ParseOpArray*[]){
+  [R_MOV] = { 12, (const ParseOpArray*[]){
     &(ParseOpArray){MOV_RR, {R8, R8}},     &(ParseOpArray){MOV_RR, {R16, R16}},
     &(ParseOpArray){MOV_RR, {R32, R32}},   &(ParseOpArray){MOV_RR, {R64, R64}},
     &(ParseOpArray){MOV_IMR, {IMM, R8 | R16 | R32 | R64}},
     &(ParseOpArray){MOV_IR, {IND, R8 | R16 | R32 | R64}},
     &(ParseOpArray){MOV_RI, {R8 | R16 | R32 | R64, IND}},
     &(ParseOpArray){MOV_IIR, {IIND, R8 | R16 | R32 | R64}},
+    &(ParseOpArray){MOV_RII, {R8 | R16 | R32 | R64, IIND}},
     &(ParseOpArray){MOV_DR, {EXP, R8 | R16 | R32 | R64}},
     &(ParseOpArray){MOV_RD, {R8 | R16 | R32 | R64, EXP}},
     &(ParseOpArray){MOV_SR, {SEG, R64}},
   } },
-  [R_MOVB] = { 2, (const ParseOpArray*[]){
+  [R_MOVB] = { 3, (const ParseOpArray*[]){
     &(ParseOpArray){MOVB_IMI, {IMM, IND}},
+    &(ParseOpArray){MOVB_IMII, {IMM, IIND}},
     &(ParseOpArray){MOVB_IMD, {IMM, EXP}},
   } },
-  [R_MOVW] = { 2, (const ParseOpArray*[]){
+  [R_MOVW] = { 3, (const ParseOpArray*[]){
     &(ParseOpArray){MOVW_IMI, {IMM, IND}},
+    &(ParseOpArray){MOVW_IMII, {IMM, IIND}},
     &(ParseOpArray){MOVW_IMD, {IMM, EXP}},
   } },
-  [R_MOVL] = { 2, (const ParseOpArray*[]){
+  [R_MOVL] = { 3, (const ParseOpArray*[]){
     &(ParseOpArray){MOVL_IMI, {IMM, IND}},
+    &(ParseOpArray){MOVL_IMII, {IMM, IIND}},
     &(ParseOpArray){MOVL_IMD, {IMM, EXP}},
   } },
-  [R_MOVQ] = { 2, (const ParseOpArray*[]){
+  [R_MOVQ] = { 3, (const ParseOpArray*[]){
     &(ParseOpArray){MOVQ_IMI, {IMM, IND}},
+    &(ParseOpArray){MOVQ_IMII, {IMM, IIND}},
     &(ParseOpArray){MOVQ_IMD, {IMM, EXP}},
   } },
   [R_MOVSX] = { 6, (const ParseOpArray*[]){
@@ -553,6 +578,13 @@ const ParseInstTable kParseInstTable[] = {
   } },
   [R_SUBQ] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){SUBQ, {IMM, IND}} } },
   [R_MUL] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){MUL, {R8 | R16 | R32 | R64}} } },
+  [R_IMUL] = { 7, (const ParseOpArray*[]){
+    &(ParseOpArray){IMUL, {R8 | R16 | R32 | R64}},
+    &(ParseOpArray){IMUL_RR, {R16, R16}},  &(ParseOpArray){IMUL_RR, {R32, R32}},
+    &(ParseOpArray){IMUL_RR, {R64, R64}},
+    &(ParseOpArray){IMUL_IMRR, {IMM, R16, R16}},  &(ParseOpArray){IMUL_IMRR, {IMM, R32, R32}},
+    &(ParseOpArray){IMUL_IMRR, {IMM, R64, R64}},
+  } },
   [R_DIV] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){DIV, {R8 | R16 | R32 | R64}} } },
   [R_IDIV] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){IDIV, {R8 | R16 | R32 | R64}} } },
   [R_NEG] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){NEG, {R8 | R16 | R32 | R64}} } },
@@ -622,6 +654,85 @@ const ParseInstTable kParseInstTable[] = {
   [R_SETGE] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){SETGE, {R8}} } },
   [R_SETLE] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){SETLE, {R8}} } },
   [R_SETG]  = { 1, (const ParseOpArray*[]){ &(ParseOpArray){SETG,  {R8}} } },
+  [R_CMOVO]  = { 3, (const ParseOpArray*[]){
+    &(ParseOpArray){CMOVO, {R16, R16}},  &(ParseOpArray){CMOVO, {R32, R32}},
+    &(ParseOpArray){CMOVO, {R64, R64}},
+  } },
+  [R_CMOVNO] = { 3, (const ParseOpArray*[]){
+    &(ParseOpArray){CMOVNO, {R16, R16}},  &(ParseOpArray){CMOVNO, {R32, R32}},
+    &(ParseOpArray){CMOVNO, {R64, R64}},
+  } },
+  [R_CMOVB]  = { 3, (const ParseOpArray*[]){
+    &(ParseOpArray){CMOVB, {R16, R16}},  &(ParseOpArray){CMOVB, {R32, R32}},
+    &(ParseOpArray){CMOVB, {R64, R64}},
+  } },
+  [R_CMOVAE] = { 3, (const ParseOpArray*[]){
+    &(ParseOpArray){CMOVAE, {R16, R16}},  &(ParseOpArray){CMOVAE, {R32, R32}},
+    &(ParseOpArray){CMOVAE, {R64, R64}},
+  } },
+  [R_CMOVE]  = { 3, (const ParseOpArray*[]){
+    &(ParseOpArray){CMOVE, {R16, R16}},  &(ParseOpArray){CMOVE, {R32, R32}},
+    &(ParseOpArray){CMOVE, {R64, R64}},
+  } },
+  [R_CMOVNE] = { 3, (const ParseOpArray*[]){
+    &(ParseOpArray){CMOVNE, {R16, R16}},  &(ParseOpArray){CMOVNE, {R32, R32}},
+    &(ParseOpArray){CMOVNE, {R64, R64}},
+  } },
+  [R_CMOVBE] = { 3, (const ParseOpArray*[]){
+    &(ParseOpArray){CMOVBE, {R16, R16}},  &(ParseOpArray){CMOVBE, {R32, R32}},
+    &(ParseOpArray){CMOVBE, {R64, R64}},
+  } },
+  [R_CMOVA]  = { 3, (const ParseOpArray*[]){
+    &(ParseOpArray){CMOVA, {R16, R16}},  &(ParseOpArray){CMOVA, {R32, R32}},
+    &(ParseOpArray){CMOVA, {R64, R64}},
+  } },
+  [R_CMOVS]  = { 3, (const ParseOpArray*[]){
+    &(ParseOpArray){CMOVS, {R16, R16}},  &(ParseOpArray){CMOVS, {R32, R32}},
+    &(ParseOpArray){CMOVS, {R64, R64}},
+  } },
+  [R_CMOVNS] = { 3, (const ParseOpArray*[]){
+    &(ParseOpArray){CMOVNS, {R16, R16}},  &(ParseOpArray){CMOVNS, {R32, R32}},
+    &(ParseOpArray){CMOVNS, {R64, R64}},
+  } },
+  [R_CMOVP]  = { 3, (const ParseOpArray*[]){
+    &(ParseOpArray){CMOVP, {R16, R16}},  &(ParseOpArray){CMOVP, {R32, R32}},
+    &(ParseOpArray){CMOVP, {R64, R64}},
+  } },
+  [R_CMOVNP] = { 3, (const ParseOpArray*[]){
+    &(ParseOpArray){CMOVNP, {R16, R16}},  &(ParseOpArray){CMOVNP, {R32, R32}},
+    &(ParseOpArray){CMOVNP, {R64, R64}},
+  } },
+  [R_CMOVL]  = { 3, (const ParseOpArray*[]){
+    &(ParseOpArray){CMOVL, {R16, R16}},  &(ParseOpArray){CMOVL, {R32, R32}},
+    &(ParseOpArray){CMOVL, {R64, R64}},
+  } },
+  [R_CMOVGE] = { 3, (const ParseOpArray*[]){
+    &(ParseOpArray){CMOVGE, {R16, R16}},  &(ParseOpArray){CMOVGE, {R32, R32}},
+    &(ParseOpArray){CMOVGE, {R64, R64}},
+  } },
+  [R_CMOVLE] = { 3, (const ParseOpArray*[]){
+    &(ParseOpArray){CMOVLE, {R16, R16}},  &(ParseOpArray){CMOVLE, {R32, R32}},
+    &(ParseOpArray){CMOVLE, {R64, R64}},
+  } },
+  [R_CMOVG]  = { 3, (const ParseOpArray*[]){
+    &(ParseOpArray){CMOVG, {R16, R16}},  &(ParseOpArray){CMOVG, {R32, R32}},
+    &(ParseOpArray){CMOVG, {R64, R64}},
+  } },
+  [R_POPCNT] = { 3, (const ParseOpArray*[]){
+    &(ParseOpArray){POPCNT, {R16, R16}},  &(ParseOpArray){POPCNT, {R32, R32}},
+    &(ParseOpArray){POPCNT, {R64, R64}},
+  } },
+  [R_TZCNT] = { 3, (const ParseOpArray*[]){
+    &(ParseOpArray){TZCNT, {R16, R16}},  &(ParseOpArray){TZCNT, {R32, R32}},
+    &(ParseOpArray){TZCNT, {R64, R64}},
+  } },
+  [R_BSR] = { 3, (const ParseOpArray*[]){
+    &(ParseOpArray){BSR, {R16, R16}},  &(ParseOpArray){BSR, {R32, R32}},
+    &(ParseOpArray){BSR, {R64, R64}},
+  } },
+  [R_BSWAP] = { 2, (const ParseOpArray*[]){
+    &(ParseOpArray){BSWAP, {R32}},  &(ParseOpArray){BSWAP, {R64}},
+  } },
   [R_JMP] = { 4, (const ParseOpArray*[]){
     &(ParseOpArray){JMP_D, {EXP}},
     &(ParseOpArray){JMP_DER, {DER}},
@@ -657,15 +768,19 @@ const ParseInstTable kParseInstTable[] = {
   [R_INT] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){INT, {IMM}} } },
   [R_SYSCALL] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){SYSCALL} } },
 
-  [R_MOVSD] = { 3, (const ParseOpArray*[]){
+  [R_MOVSD] = { 5, (const ParseOpArray*[]){
     &(ParseOpArray){MOVSD_XX, {XMM, XMM}},
     &(ParseOpArray){MOVSD_IX, {IND, XMM}},
     &(ParseOpArray){MOVSD_XI, {XMM, IND}},
+    &(ParseOpArray){MOVSD_IIX, {IIND, XMM}},
+    &(ParseOpArray){MOVSD_XII, {XMM, IIND}},
   } },
-  [R_MOVSS] = { 3, (const ParseOpArray*[]){
+  [R_MOVSS] = { 5, (const ParseOpArray*[]){
     &(ParseOpArray){MOVSS_XX, {XMM, XMM}},
     &(ParseOpArray){MOVSS_IX, {IND, XMM}},
     &(ParseOpArray){MOVSS_XI, {XMM, IND}},
+    &(ParseOpArray){MOVSS_IIX, {IIND, XMM}},
+    &(ParseOpArray){MOVSS_XII, {XMM, IIND}},
   } },
   [R_ADDSD] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){ADDSD, {XMM, XMM}}, } },
   [R_ADDSS] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){ADDSS, {XMM, XMM}}, } },
@@ -689,5 +804,33 @@ const ParseInstTable kParseInstTable[] = {
   [R_CVTSS2SD] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){CVTSS2SD, {XMM, XMM}}, } },
   [R_SQRTSD] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){SQRTSD, {XMM, XMM}}, } },
 
+  [R_MOVDQU] = { 5, (const ParseOpArray*[]){
+    &(ParseOpArray){MOVDQU_XX, {XMM, XMM}},
+    &(ParseOpArray){MOVDQU_IX, {IND, XMM}},
+    &(ParseOpArray){MOVDQU_XI, {XMM, IND}},
+    &(ParseOpArray){MOVDQU_IIX, {IIND, XMM}},
+    &(ParseOpArray){MOVDQU_XII, {XMM, IIND}},
+  } },
+  [R_PADDB] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){PADDB, {XMM, XMM}}, } },
+  [R_PADDW] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){PADDW, {XMM, XMM}}, } },
+  [R_PADDD] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){PADDD, {XMM, XMM}}, } },
+  [R_PADDQ] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){PADDQ, {XMM, XMM}}, } },
+  [R_PSUBB] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){PSUBB, {XMM, XMM}}, } },
+  [R_PSUBW] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){PSUBW, {XMM, XMM}}, } },
+  [R_PSUBD] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){PSUBD, {XMM, XMM}}, } },
+  [R_PSUBQ] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){PSUBQ, {XMM, XMM}}, } },
+  [R_PMULLW] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){PMULLW, {XMM, XMM}}, } },
+  [R_PAND] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){PAND, {XMM, XMM}}, } },
+  [R_POR] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){POR, {XMM, XMM}}, } },
+  [R_PXOR] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){PXOR, {XMM, XMM}}, } },
+  [R_ADDPS] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){ADDPS, {XMM, XMM}}, } },
+  [R_ADDPD] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){ADDPD, {XMM, XMM}}, } },
+  [R_SUBPS] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){SUBPS, {XMM, XMM}}, } },
+  [R_SUBPD] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){SUBPD, {XMM, XMM}}, } },
+  [R_MULPS] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){MULPS, {XMM, XMM}}, } },
+  [R_MULPD] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){MULPD, {XMM, XMM}}, } },
+  [R_DIVPS] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){DIVPS, {XMM, XMM}}, } },
+  [R_DIVPD] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){DIVPD, {XMM, XMM}}, } },
+
   [R_ENDBR64] = { 1, (const ParseOpArray*[]){ &(ParseOpArray){ENDBR64}, } },
 };
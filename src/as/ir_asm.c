@@ -51,5 +51,6 @@ IR *new_ir_expr(enum IrKind kind, const Expr *expr) {
   ir->kind = kind;
   ir->expr.expr = expr;
   ir->expr.addend = 0;
+  ir->expr.resolved = false;
   return ir;
 }
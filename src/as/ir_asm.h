@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <stddef.h>  // size_t
 #include <stdint.h>  // uint64_t
 
@@ -72,6 +73,7 @@ typedef struct {
     struct {
       const Expr *expr;
       int64_t addend;  // Calculated in `resolve_relative_address`
+      bool resolved;   // No relocation: `addend` is the value.
     } expr;
     size_t bss;
     size_t zero;
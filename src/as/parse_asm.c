@@ -818,6 +818,24 @@ static uint32_t parse_section_flag(ParseInfo *info) {
   }
   return flag;
 }
+
+static uint32_t parse_section_type(ParseInfo *info) {
+  const char *p = skip_whitespaces(info->p);
+  if (*p != '@' && *p != '%') {
+    parse_error(info, ".section: section type expected");
+    return 0;
+  }
+  info->p = p + 1;
+  const Name *type = parse_section_name(info);
+  if (type != NULL) {
+    if (equal_name(type, alloc_name("progbits", NULL, false)))
+      return 0;
+    if (equal_name(type, alloc_name("nobits", NULL, false)))
+      return SF_BSS;
+  }
+  parse_error(info, ".section: illegal section type");
+  return 0;
+}
 #endif
 
 void handle_directive(ParseInfo *info, enum DirectiveType dir) {
@@ -1063,6 +1081,11 @@ void handle_directive(ParseInfo *info, enum DirectiveType dir) {
       if (*p == ',') {
         info->p = p + 1;
         flag = parse_section_flag(info);
+        p = skip_whitespaces(info->p);
+        if (*p == ',') {
+          info->p = p + 1;
+          flag |= parse_section_type(info);
+        }
       }
 
       char *sectname = strndup(name->chars, name->bytes);
@@ -214,6 +214,8 @@
 #define ADD(o1, o2, o3)       EMIT_ASM("add", o1, o2, o3)
 #define SUB(o1, o2, o3)       EMIT_ASM("sub", o1, o2, o3)
 #define MUL(o1, o2, o3)       EMIT_ASM("mul", o1, o2, o3)
+#define SMULH(o1, o2, o3)     EMIT_ASM("smulh", o1, o2, o3)
+#define UMULH(o1, o2, o3)     EMIT_ASM("umulh", o1, o2, o3)
 #define SDIV(o1, o2, o3)      EMIT_ASM("sdiv", o1, o2, o3)
 #define UDIV(o1, o2, o3)      EMIT_ASM("udiv", o1, o2, o3)
 #define MSUB(o1, o2, o3, o4)  EMIT_ASM("msub", o1, o2, o3, o4)
@@ -233,6 +235,10 @@
 #define BLR(o1)               EMIT_ASM("blr", o1)
 #define RET()                 EMIT_ASM("ret")
 #define CSET(o1, c)           EMIT_ASM("cset", o1, c)
+#define CSEL(o1, o2, o3, c)   EMIT_ASM("csel", o1, o2, o3, c)
+#define CLZ(o1, o2)           EMIT_ASM("clz", o1, o2)
+#define RBIT(o1, o2)          EMIT_ASM("rbit", o1, o2)
+#define REV(o1, o2)           EMIT_ASM("rev", o1, o2)
 
 #define ADRP(o1, o2)          EMIT_ASM("adrp", o1, o2)
 
@@ -10,4 +10,13 @@
 #define PHYSICAL_FREG_TEMPORARY  (8)
 #define PHYSICAL_FREG_MAX        (PHYSICAL_FREG_TEMPORARY + 24)
 
+// Bit operations: clz, rbit + clz, rev  (population count requires SIMD registers)
+#define ARCH_HAS_CLZ     1
+#define ARCH_HAS_CTZ     1
+#define ARCH_HAS_BSWAP   1
+
+// 128bit vector (NEON): integer multiplication for 8, 16 and 32bit lanes, bit of VRegSize.
+#define ARCH_HAS_VECTOR  1
+#define ARCH_VECTOR_IMUL_SIZES  ((1 << 0) | (1 << 1) | (1 << 2))
+
 #define GET_FPREG_INDEX()  21
@@ -125,6 +125,16 @@ static void move_params_to_assigned(Function *func) {
   for (int i = 0; i < fparam_count; ++i) {
     RegParamInfo *p = &fparams[i];
     VReg *vreg = p->vreg;
+    if (vreg->vsize == VRegSize16) {  // Short vector.
+      if (vreg->flag & VRF_SPILLED) {
+        assert(vreg->frame.offset != 0);
+        STR(fmt("q%d", p->index), IMMEDIATE_OFFSET(FP, vreg->frame.offset));
+      } else if (p->index != vreg->phys) {
+        const char *src = fmt("v%d.16b", p->index);
+        ORR(fmt("v%d.16b", vreg->phys), src, src);
+      }
+      continue;
+    }
     const char *src = (p->type->flonum.kind >= FL_DOUBLE ? kFRegParam64s : kFRegParam32s)[p->index];
     if (vreg->flag & VRF_SPILLED) {
       int offset = vreg->frame.offset;
@@ -185,7 +195,7 @@ void emit_defun(Function *func) {
       _GLOBL(label);
     else
       _LOCAL(label);
-    EMIT_ALIGN(2);
+    EMIT_ALIGN(MAX(2, varinfo != NULL ? varinfo->global.align : 0));
 #if XCC_TARGET_PLATFORM != XCC_PLATFORM_APPLE
     EMIT_ASM(".type", quote_label(fmt_name(func->name)), "@function");
 #endif
@@ -245,7 +255,7 @@ void emit_defun(Function *func) {
     move_params_to_assigned(func);
   }
 
-  emit_bb_irs(fnbe->bbcon);
+  int cold_start = emit_bb_irs(fnbe->bbcon, 0);
 
   if (!function_not_returned(fnbe)) {
     // Epilogue
@@ -262,5 +272,8 @@ void emit_defun(Function *func) {
     RET();
   }
 
+  // Unlikely BBs are placed after the epilogue.
+  emit_bb_irs(fnbe->bbcon, cold_start);
+
   // Static variables are emitted through global variables.
 }
@@ -44,6 +44,7 @@ static const int kCalleeSaveRegs[] = {11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21
 static const int kCallerSaveRegs[] = {22, 23, 24, 25, 26, 27};
 
 const int ArchRegParamMapping[] = {0, 1, 2, 3, 4, 5, 6, 7};
+const int ArchRegResultMapping[] = {0, 1};
 
 const char **kRegSizeTable[] = {kReg32s, kReg32s, kReg32s, kReg64s};
 static const char *kZeroRegTable[] = {WZR, WZR, WZR, XZR};
@@ -53,6 +54,7 @@ static const char *kTmpRegTable[] = {W17, W17, W17, X17};
 
 #define SZ_FLOAT   VRegSize4
 #define SZ_DOUBLE  VRegSize8
+#define SZ_VECTOR  VRegSize16
 const char *kFReg32s[PHYSICAL_FREG_MAX] = {
    S0,  S1,  S2,  S3,  S4,  S5,  S6,  S7,
    S8,  S9, S10, S11, S12, S13, S14, S15,
@@ -95,11 +97,15 @@ static unsigned long detect_extra_occupied(RegAlloc *ra, IR *ir) {
 const RegAllocSettings kArchRegAllocSettings = {
   .detect_extra_occupied = detect_extra_occupied,
   .reg_param_mapping = ArchRegParamMapping,
+  .reg_result_mapping = ArchRegResultMapping,
   .phys_max = PHYSICAL_REG_MAX,
   .phys_temporary_count = PHYSICAL_REG_TEMPORARY,
+  .caller_save_bits = REG_BIT_RANGE(22, 28),  // kCallerSaveRegs
 #ifndef __NO_FLONUM
   .fphys_max = PHYSICAL_FREG_MAX,
   .fphys_temporary_count = PHYSICAL_FREG_TEMPORARY,
+  .fcaller_save_bits = REG_BIT_RANGE(16, 32),  // kCallerSaveFRegs
+  .vector_fregs = REG_BIT_RANGE(0, PHYSICAL_FREG_MAX),  // v0-31
 #endif
 };
 
@@ -198,22 +204,45 @@ static void ei_sofs(IR *ir) {
   }
 }
 
+static const char *mem_operand(IR *ir, VReg *base) {
+  assert(!(base->flag & (VRF_CONST | VRF_SPILLED)));
+  VReg *index = ir->mem.index;
+  if (index == NULL)
+    return IMMEDIATE_OFFSET(kReg64s[base->phys], ir->mem.offset);
+  assert(!(index->flag & (VRF_CONST | VRF_SPILLED)) && ir->mem.offset == 0);
+  return REG_OFFSET(kReg64s[base->phys], kReg64s[index->phys],
+                    ir->mem.scale > 0 ? fmt("lsl #%d", ir->mem.scale) : NULL);
+}
+
+// Move whole 128bit register for short vector.
+static void mov_vector(int dst, int src) {
+  const char *vsrc = fmt("v%d.16b", src);
+  ORR(fmt("v%d.16b", dst), vsrc, vsrc);
+}
+
+// Frame slot of the spilled register, accessed in `pow` size.
+static const char *spilled_operand(VReg *vreg, int pow) {
+  int64_t offset = vreg->frame.offset;
+  if (is_im9(offset))
+    return IMMEDIATE_OFFSET(FP, offset);
+  const char *tmp = kTmpRegTable[3];
+  mov_immediate(tmp, offset, true, false);
+  if (pow < SZ_VECTOR)
+    return REG_OFFSET(FP, tmp, NULL);
+  // No register offset for 128bit register.
+  ADD(tmp, FP, tmp);
+  return IMMEDIATE_OFFSET(tmp, 0);
+}
+
 #define ei_load_s  ei_load
 static void ei_load(IR *ir) {
   assert(!(ir->opr1->flag & VRF_CONST));
   const char *src;
   if (ir->kind == IR_LOAD) {
-    assert(!(ir->opr1->flag & VRF_SPILLED));
-    src = IMMEDIATE_OFFSET0(kReg64s[ir->opr1->phys]);
+    src = mem_operand(ir, ir->opr1);
   } else {
     assert(ir->opr1->flag & VRF_SPILLED);
-    if (is_im9(ir->opr1->frame.offset)) {
-      src = IMMEDIATE_OFFSET(FP, ir->opr1->frame.offset);
-    } else {
-      const char *tmp = kTmpRegTable[3];
-      mov_immediate(tmp, ir->opr1->frame.offset, true, false);
-      src = REG_OFFSET(FP, tmp, NULL);
-    }
+    src = spilled_operand(ir->opr1, ir->opr1->vsize);
   }
 
   const char *dst;
@@ -221,6 +250,7 @@ static void ei_load(IR *ir) {
     switch (ir->dst->vsize) {
     case SZ_FLOAT:   dst = kFReg32s[ir->dst->phys]; break;
     case SZ_DOUBLE:  dst = kFReg64s[ir->dst->phys]; break;
+    case SZ_VECTOR:  dst = fmt("q%d", ir->dst->phys); break;
     default: assert(false); break;
     }
     LDR(dst, src);
@@ -252,17 +282,10 @@ static void ei_store(IR *ir) {
   int pow = ir->opr1->vsize;
   const char *target;
   if (ir->kind == IR_STORE) {
-    assert(!(ir->opr2->flag & VRF_SPILLED));
-    target = IMMEDIATE_OFFSET0(kReg64s[ir->opr2->phys]);
+    target = mem_operand(ir, ir->opr2);
   } else {
     assert(ir->opr2->flag & VRF_SPILLED);
-    if (is_im9(ir->opr2->frame.offset)) {
-      target = IMMEDIATE_OFFSET(FP, ir->opr2->frame.offset);
-    } else {
-      const char *tmp = kTmpRegTable[3];
-      mov_immediate(tmp, ir->opr2->frame.offset, true, false);
-      target = REG_OFFSET(FP, tmp, NULL);
-    }
+    target = spilled_operand(ir->opr2, pow);
   }
   const char *src;
   if (ir->opr1->flag & VRF_FLONUM) {
@@ -270,6 +293,7 @@ static void ei_store(IR *ir) {
     default: assert(false); // Fallthrough
     case SZ_FLOAT:   src = kFReg32s[ir->opr1->phys]; break;
     case SZ_DOUBLE:  src = kFReg64s[ir->opr1->phys]; break;
+    case SZ_VECTOR:  src = fmt("q%d", ir->opr1->phys); break;
     }
   } else if (ir->opr1->flag & VRF_CONST) {
     if (ir->opr1->fixnum == 0)
@@ -283,7 +307,9 @@ static void ei_store(IR *ir) {
   switch (pow) {
   case 0:          STRB(src, target); break;
   case 1:          STRH(src, target); break;
-  case 2: case 3:  STR(src, target); break;
+  case 2: case 3: case 4:
+    STR(src, target);
+    break;
   default: assert(false); break;
   }
 }
@@ -352,6 +378,16 @@ static void ei_mul(IR *ir) {
   }
 }
 
+static void ei_mulhi(IR *ir) {
+  assert(!(ir->opr1->flag & VRF_CONST) && !(ir->opr2->flag & VRF_CONST));
+  assert(ir->dst->vsize == VRegSize8);
+  const char **regs = kReg64s;
+  if (ir->flag & IRF_UNSIGNED)
+    UMULH(regs[ir->dst->phys], regs[ir->opr1->phys], regs[ir->opr2->phys]);
+  else
+    SMULH(regs[ir->dst->phys], regs[ir->opr1->phys], regs[ir->opr2->phys]);
+}
+
 static void ei_div(IR *ir) {
   if (ir->dst->flag & VRF_FLONUM) {
     const char **regs;
@@ -439,20 +475,23 @@ static void ei_rshift(IR *ir) {
 
 static void ei_result(IR *ir) {
   if (ir->opr1->flag & VRF_FLONUM) {
-    int dstphys = ir->dst != NULL ? ir->dst->phys : GET_D0_INDEX();
+    int dstphys = ir->dst != NULL ? ir->dst->phys : GET_D0_INDEX() + ir->result.index;
     if (ir->opr1->phys != dstphys) {  // Source is not return register.
       const char **regs;
       switch (ir->opr1->vsize) {
       default: assert(false);  // Fallthroguh
       case SZ_FLOAT:  regs = kFReg32s; break;
       case SZ_DOUBLE: regs = kFReg64s; break;
+      case SZ_VECTOR:
+        mov_vector(dstphys, ir->opr1->phys);
+        return;
       }
       FMOV(regs[dstphys], regs[ir->opr1->phys]);
     }
   } else {
     int pow = ir->opr1->vsize;
     assert(0 <= pow && pow < 4);
-    int dstphys = ir->dst != NULL ? ir->dst->phys : GET_X0_INDEX();
+    int dstphys = ir->dst != NULL ? ir->dst->phys : ArchRegResultMapping[ir->result.index];
     const char *dst = kRegSizeTable[pow][dstphys];
     if (ir->opr1->flag & VRF_CONST) {
       mov_immediate(dst, ir->opr1->fixnum, pow >= 3, ir->flag & IRF_UNSIGNED);
@@ -484,6 +523,9 @@ static void ei_mov(IR *ir) {
       default: assert(false); // Fallthrough
       case SZ_FLOAT:   dst = kFReg32s[ir->dst->phys]; src = kFReg32s[ir->opr1->phys]; break;
       case SZ_DOUBLE:  dst = kFReg64s[ir->dst->phys]; src = kFReg64s[ir->opr1->phys]; break;
+      case SZ_VECTOR:
+        mov_vector(ir->dst->phys, ir->opr1->phys);
+        return;
       }
       FMOV(dst, src);
     }
@@ -560,6 +602,31 @@ static void ei_bitnot(IR *ir) {
   EON(regs[ir->dst->phys], regs[ir->opr1->phys], kZeroRegTable[pow]);
 }
 
+static void ei_clz(IR *ir) {
+  assert(!(ir->opr1->flag & VRF_CONST));
+  int pow = ir->dst->vsize;
+  assert(0 <= pow && pow < 4);
+  const char **regs = kRegSizeTable[pow];
+  CLZ(regs[ir->dst->phys], regs[ir->opr1->phys]);
+}
+
+static void ei_ctz(IR *ir) {
+  assert(!(ir->opr1->flag & VRF_CONST));
+  int pow = ir->dst->vsize;
+  assert(0 <= pow && pow < 4);
+  const char **regs = kRegSizeTable[pow];
+  RBIT(regs[ir->dst->phys], regs[ir->opr1->phys]);
+  CLZ(regs[ir->dst->phys], regs[ir->dst->phys]);
+}
+
+static void ei_bswap(IR *ir) {
+  assert(!(ir->opr1->flag & VRF_CONST));
+  int pow = ir->dst->vsize;
+  assert(2 <= pow && pow < 4);
+  const char **regs = kRegSizeTable[pow];
+  REV(regs[ir->dst->phys], regs[ir->opr1->phys]);
+}
+
 static void ei_cond(IR *ir) {
   cmp_vregs(ir->opr1, ir->opr2);
 
@@ -596,6 +663,39 @@ static void ei_cond(IR *ir) {
   }
 }
 
+static void ei_select(IR *ir) {
+  assert(!(ir->select.cond & COND_FLONUM));
+  cmp_vregs(ir->opr1, ir->opr2);
+
+  int pow = ir->dst->vsize;
+  assert(0 <= pow && pow < 4);
+  const char **regs = kRegSizeTable[pow];
+  VReg *tval = ir->select.tval, *fval = ir->select.fval;
+  const char *dst = regs[ir->dst->phys];
+  const char *t = tval->flag & VRF_CONST ? kZeroRegTable[pow] : regs[tval->phys];
+  const char *f = fval->flag & VRF_CONST ? kZeroRegTable[pow] : regs[fval->phys];
+
+  int cond = ir->select.cond;
+  switch (cond) {
+  case COND_EQ | COND_UNSIGNED:  // Fallthrough
+  case COND_EQ:  CSEL(dst, t, f, CEQ); break;
+
+  case COND_NE | COND_UNSIGNED:  // Fallthrough
+  case COND_NE:  CSEL(dst, t, f, CNE); break;
+
+  case COND_LT:  CSEL(dst, t, f, CLT); break;
+  case COND_GT:  CSEL(dst, t, f, CGT); break;
+  case COND_LE:  CSEL(dst, t, f, CLE); break;
+  case COND_GE:  CSEL(dst, t, f, CGE); break;
+
+  case COND_LT | COND_UNSIGNED:  CSEL(dst, t, f, CLO); break;
+  case COND_GT | COND_UNSIGNED:  CSEL(dst, t, f, CHI); break;
+  case COND_LE | COND_UNSIGNED:  CSEL(dst, t, f, CLS); break;
+  case COND_GE | COND_UNSIGNED:  CSEL(dst, t, f, CHS); break;
+  default: assert(false); break;
+  }
+}
+
 static void ei_jmp(IR *ir) {
   const char *label = fmt_name(ir->jmp.bb->label);
   int cond = ir->jmp.cond;
@@ -686,6 +786,7 @@ static void ei_pusharg(IR *ir) {
       switch (ir->opr1->vsize) {
       case SZ_FLOAT:  FMOV(kFReg32s[ir->pusharg.index], kFReg32s[ir->opr1->phys]); break;
       case SZ_DOUBLE:  FMOV(kFReg64s[ir->pusharg.index], kFReg64s[ir->opr1->phys]); break;
+      case SZ_VECTOR:  mov_vector(ir->pusharg.index, ir->opr1->phys); break;
       default: assert(false); break;
       }
     }
@@ -716,6 +817,42 @@ static void ei_call(IR *ir) {
   // Resore caller save registers.
   pop_caller_save_regs(precall->precall.caller_saves);
 
+  if (ir->call.result_frame != NULL) {
+    // Store the aggregate result into the frame: the destination is padded to 8 bytes.
+    int iindex = 0, findex = 0;
+    for (int i = 0; i < ir->call.result_part_count; ++i) {
+      const AggregatePart *part = &ir->call.result_parts[i];
+      int64_t offset = ir->call.result_frame->offset + part->offset;
+      const char *dst;
+      if (is_im9(offset)) {
+        dst = IMMEDIATE_OFFSET(FP, offset);
+      } else {
+        const char *tmp = kTmpRegTable[3];
+        mov_immediate(tmp, offset, true, false);
+        if (part->size < 16) {
+          dst = REG_OFFSET(FP, tmp, NULL);
+        } else {
+          ADD(tmp, FP, tmp);
+          dst = IMMEDIATE_OFFSET(tmp, 0);
+        }
+      }
+      if (part->is_flo) {
+        int index = GET_D0_INDEX() + findex++;
+        STR(part->size == 4 ? kFReg32s[index] : part->size == 8 ? kFReg64s[index]
+                                                                : fmt("q%d", index), dst);
+      } else {
+        int pow = part->size <= 1 ? 0 : most_significant_bit(part->size - 1) + 1;
+        const char *src = kRegSizeTable[pow][ArchRegResultMapping[iindex++]];
+        switch (pow) {
+        case 0:          STRB(src, dst); break;
+        case 1:          STRH(src, dst); break;
+        case 2: case 3:  STR(src, dst); break;
+        default: assert(false); break;
+        }
+      }
+    }
+  }
+
   if (ir->dst != NULL) {
     if (ir->dst->flag & VRF_FLONUM) {
       if (ir->dst->phys != GET_D0_INDEX()) {
@@ -828,6 +965,33 @@ static void ei_asm(IR *ir) {
   }
 }
 
+static void ei_vop(IR *ir) {
+  static const char *kIntOps[] = {
+    [IR_ADD] = "add", [IR_SUB] = "sub", [IR_MUL] = "mul",
+    [IR_BITAND] = "and", [IR_BITOR] = "orr", [IR_BITXOR] = "eor",
+  };
+  static const char *kFloatOps[] = {
+    [IR_ADD] = "fadd", [IR_SUB] = "fsub", [IR_MUL] = "fmul", [IR_DIV] = "fdiv",
+  };
+  static const char kArrangements[][4] = {"16b", "8h", "4s", "2d"};
+  const char *op;
+  const char *arrangement;
+  if (ir->vop.vflag & VRF_FLONUM) {
+    assert(ir->vop.kind < (int)ARRAY_SIZE(kFloatOps));
+    op = kFloatOps[ir->vop.kind];
+    arrangement = kArrangements[ir->vop.elem];
+  } else {
+    assert(ir->vop.kind < (int)ARRAY_SIZE(kIntOps));
+    op = kIntOps[ir->vop.kind];
+    // Bitwise operations are independent from the lane size.
+    bool bitwise = ir->vop.kind == IR_BITAND || ir->vop.kind == IR_BITOR || ir->vop.kind == IR_BITXOR;
+    arrangement = kArrangements[bitwise ? 0 : ir->vop.elem];
+  }
+  assert(op != NULL);
+  EMIT_ASM(op, fmt("v%d.%s", ir->dst->phys, arrangement), fmt("v%d.%s", ir->opr1->phys, arrangement),
+           fmt("v%d.%s", ir->opr2->phys, arrangement));
+}
+
 //
 
 static int enum_callee_save_regs(unsigned long bit, int n, const int *indices, const char **regs,
@@ -958,33 +1122,26 @@ static void pop_caller_save_regs(Vector *saves) {
   }
 }
 
-void emit_bb_irs(BBContainer *bbcon) {
+int emit_bb_irs(BBContainer *bbcon, int start) {
   typedef void (*EmitIrFunc)(IR *);
   static const EmitIrFunc table[] = {
     [IR_BOFS] = ei_bofs, [IR_IOFS] = ei_iofs, [IR_SOFS] = ei_sofs,
     [IR_LOAD] = ei_load, [IR_LOAD_S] = ei_load_s, [IR_STORE] = ei_store, [IR_STORE_S] = ei_store_s,
-    [IR_ADD] = ei_add, [IR_SUB] = ei_sub, [IR_MUL] = ei_mul, [IR_DIV] = ei_div,
-    [IR_MOD] = ei_mod, [IR_BITAND] = ei_bitand, [IR_BITOR] = ei_bitor,
+    [IR_ADD] = ei_add, [IR_SUB] = ei_sub, [IR_MUL] = ei_mul, [IR_MULHI] = ei_mulhi,
+    [IR_DIV] = ei_div, [IR_MOD] = ei_mod, [IR_BITAND] = ei_bitand, [IR_BITOR] = ei_bitor,
     [IR_BITXOR] = ei_bitxor, [IR_LSHIFT] = ei_lshift, [IR_RSHIFT] = ei_rshift,
     [IR_NEG] = ei_neg, [IR_BITNOT] = ei_bitnot,
-    [IR_COND] = ei_cond, [IR_JMP] = ei_jmp, [IR_TJMP] = ei_tjmp,
+    [IR_CLZ] = ei_clz, [IR_CTZ] = ei_ctz, [IR_BSWAP] = ei_bswap,
+    [IR_COND] = ei_cond, [IR_SELECT] = ei_select, [IR_JMP] = ei_jmp, [IR_TJMP] = ei_tjmp,
     [IR_PRECALL] = ei_precall, [IR_PUSHARG] = ei_pusharg, [IR_CALL] = ei_call,
     [IR_RESULT] = ei_result, [IR_SUBSP] = ei_subsp, [IR_CAST] = ei_cast,
-    [IR_MOV] = ei_mov, [IR_KEEP] = ei_keep, [IR_ASM] = ei_asm,
+    [IR_MOV] = ei_mov, [IR_KEEP] = ei_keep, [IR_ASM] = ei_asm, [IR_VOP] = ei_vop,
   };
 
-  for (int i = 0; i < bbcon->len; ++i) {
+  for (int i = start; i < bbcon->len; ++i) {
     BB *bb = bbcon->data[i];
-#ifndef NDEBUG
-    // Check BB connection.
-    if (i < bbcon->len - 1) {
-      BB *nbb = bbcon->data[i + 1];
-      UNUSED(nbb);
-      assert(bb->next == nbb);
-    } else {
-      assert(bb->next == NULL);
-    }
-#endif
+    // Check BB connection: the chain ends at the return BB, and cold BBs follow it.
+    assert(bb->next == NULL || (i < bbcon->len - 1 && bb->next == bbcon->data[i + 1]));
 
     if (is_fall_path_only(bbcon, i))
       emit_comment(NULL);
@@ -996,7 +1153,10 @@ void emit_bb_irs(BBContainer *bbcon) {
       assert(table[ir->kind] != NULL);
       (*table[ir->kind])(ir);
     }
+    if (bb->next == NULL)
+      return i + 1;
   }
+  return bbcon->len;
 }
 
 //
@@ -1015,6 +1175,16 @@ static void insert_const_mov(VReg **pvreg, RegAlloc *ra, Vector *irs, int i) {
   *pvreg = tmp;
 }
 
+bool is_legal_mem_operand(IR *ir, bool indexed, int scale, int64_t offset) {
+  // Access size in log2.
+  int pow = ir->kind == IR_LOAD ? ir->dst->vsize : ir->opr1->vsize;
+  if (indexed)  // [xN, xM, lsl #pow], not for 128bit register.
+    return offset == 0 && (scale == 0 || scale == pow) && pow < SZ_VECTOR;
+  // Unscaled signed, or scaled unsigned immediate.
+  return is_im9(offset) ||
+      (offset >= 0 && (offset & ((1 << pow) - 1)) == 0 && (offset >> pow) < (1 << 12));
+}
+
 void tweak_irs(FuncBackend *fnbe) {
   BBContainer *bbcon = fnbe->bbcon;
   RegAlloc *ra = fnbe->ra;
@@ -1072,6 +1242,7 @@ void tweak_irs(FuncBackend *fnbe) {
         }
         break;
       case IR_MUL:
+      case IR_MULHI:
       case IR_DIV:
       case IR_MOD:
       case IR_BITAND:
@@ -1089,11 +1260,18 @@ void tweak_irs(FuncBackend *fnbe) {
         if (ir->opr1->flag & VRF_CONST)
           insert_const_mov(&ir->opr1, ra, irs, j++);
         break;
-      case IR_COND: case IR_JMP:
+      case IR_COND: case IR_JMP: case IR_SELECT:
         if (ir->opr2 != NULL &&
             (ir->opr2->flag & VRF_CONST) &&
             (ir->opr2->fixnum > 0x0fff || ir->opr2->fixnum < -0x0fff))
           insert_const_mov(&ir->opr2, ra, irs, j++);
+        if (ir->kind == IR_SELECT) {
+          // csel takes registers, except zero register for constant 0.
+          if (ir->select.tval->flag & VRF_CONST && ir->select.tval->fixnum != 0)
+            insert_const_mov(&ir->select.tval, ra, irs, j++);
+          if (ir->select.fval->flag & VRF_CONST && ir->select.fval->fixnum != 0)
+            insert_const_mov(&ir->select.fval, ra, irs, j++);
+        }
         break;
       case IR_TJMP:
         {
@@ -1107,6 +1285,9 @@ void tweak_irs(FuncBackend *fnbe) {
           ir->opr2 = tmp;
         }
         break;
+      case IR_CLZ:
+      case IR_CTZ:
+      case IR_BSWAP:
       case IR_PUSHARG:
         if (ir->opr1->flag & VRF_CONST)
           insert_const_mov(&ir->opr1, ra, irs, j++);
@@ -142,7 +142,7 @@ void emit_defun(Function *func) {
       _GLOBL(label);
     else
       _LOCAL(label);
-    EMIT_ALIGN(2);
+    EMIT_ALIGN(MAX(2, varinfo != NULL ? varinfo->global.align : 0));
 #if XCC_TARGET_PLATFORM != XCC_PLATFORM_APPLE
     EMIT_ASM(".type", quote_label(fmt_name(func->name)), "@function");
 #endif
@@ -205,7 +205,7 @@ void emit_defun(Function *func) {
     move_params_to_assigned(func);
   }
 
-  emit_bb_irs(fnbe->bbcon);
+  int cold_start = emit_bb_irs(fnbe->bbcon, 0);
 
   if (!function_not_returned(fnbe)) {
     // Epilogue
@@ -227,5 +227,8 @@ void emit_defun(Function *func) {
     RET();
   }
 
+  // Unlikely BBs are placed after the epilogue.
+  emit_bb_irs(fnbe->bbcon, cold_start);
+
   // Static variables are emitted through global variables.
 }
@@ -33,6 +33,7 @@ static const int kCalleeSaveRegs[] = {8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18};
 static const int kCallerSaveRegs[] = {19, 20, 21, 22, 23, 24, 25};
 
 const int ArchRegParamMapping[] = {0, 1, 2, 3, 4, 5, 6, 7};
+const int ArchRegResultMapping[] = {0, 1};
 
 // Break s1 in store, mod and tjmp
 static const char *kTmpReg = S1;
@@ -65,11 +66,14 @@ static unsigned long detect_extra_occupied(RegAlloc *ra, IR *ir) {
 const RegAllocSettings kArchRegAllocSettings = {
   .detect_extra_occupied = detect_extra_occupied,
   .reg_param_mapping = ArchRegParamMapping,
+  .reg_result_mapping = ArchRegResultMapping,
   .phys_max = PHYSICAL_REG_MAX,
   .phys_temporary_count = PHYSICAL_REG_TEMPORARY,
+  .caller_save_bits = REG_BIT_RANGE(19, 26),  // kCallerSaveRegs
 #ifndef __NO_FLONUM
   .fphys_max = PHYSICAL_FREG_MAX,
   .fphys_temporary_count = PHYSICAL_FREG_TEMPORARY,
+  .fcaller_save_bits = REG_BIT_RANGE(20, 32),  // kCallerSaveFRegs
 #endif
 };
 
@@ -128,8 +132,8 @@ static void ei_load(IR *ir) {
   assert(!(ir->opr1->flag & VRF_CONST));
   const char *src;
   if (ir->kind == IR_LOAD) {
-    assert(!(ir->opr1->flag & VRF_SPILLED));
-    src = IMMEDIATE_OFFSET0(kReg64s[ir->opr1->phys]);
+    assert(!(ir->opr1->flag & VRF_SPILLED) && ir->mem.index == NULL);
+    src = IMMEDIATE_OFFSET(ir->mem.offset, kReg64s[ir->opr1->phys]);
   } else {
     assert(ir->opr1->flag & VRF_SPILLED);
     if (is_im12(ir->opr1->frame.offset)) {
@@ -178,8 +182,8 @@ static void ei_store(IR *ir) {
   assert(!(ir->opr2->flag & VRF_CONST));
   const char *target;
   if (ir->kind == IR_STORE) {
-    assert(!(ir->opr2->flag & VRF_SPILLED));
-    target = IMMEDIATE_OFFSET0(kReg64s[ir->opr2->phys]);
+    assert(!(ir->opr2->flag & VRF_SPILLED) && ir->mem.index == NULL);
+    target = IMMEDIATE_OFFSET(ir->mem.offset, kReg64s[ir->opr2->phys]);
   } else {
     assert(ir->opr2->flag & VRF_SPILLED);
     if (is_im12(ir->opr2->frame.offset)) {
@@ -284,6 +288,15 @@ static void ei_mul(IR *ir) {
   }
 }
 
+static void ei_mulhi(IR *ir) {
+  assert(!(ir->opr1->flag & VRF_CONST) && !(ir->opr2->flag & VRF_CONST));
+  assert(ir->dst->vsize == VRegSize8);
+  if (ir->flag & IRF_UNSIGNED)
+    MULHU(kReg64s[ir->dst->phys], kReg64s[ir->opr1->phys], kReg64s[ir->opr2->phys]);
+  else
+    MULH(kReg64s[ir->dst->phys], kReg64s[ir->opr1->phys], kReg64s[ir->opr2->phys]);
+}
+
 static void ei_div(IR *ir) {
   if (ir->dst->flag & VRF_FLONUM) {
     switch (ir->dst->vsize) {
@@ -372,7 +385,7 @@ static void ei_rshift(IR *ir) {
 
 static void ei_result(IR *ir) {
   if (ir->opr1->flag & VRF_FLONUM) {
-    int dstphys = ir->dst != NULL ? ir->dst->phys : GET_FA0_INDEX();
+    int dstphys = ir->dst != NULL ? ir->dst->phys : GET_FA0_INDEX() + ir->result.index;
     if (ir->opr1->phys != dstphys) {  // Source is not return register.
       const char **regs;
       switch (ir->opr1->vsize) {
@@ -383,7 +396,7 @@ static void ei_result(IR *ir) {
       FMV_D(regs[dstphys], regs[ir->opr1->phys]);
     }
   } else {
-    int dstphys = ir->dst != NULL ? ir->dst->phys : GET_A0_INDEX();
+    int dstphys = ir->dst != NULL ? ir->dst->phys : ArchRegResultMapping[ir->result.index];
     const char *dst = kReg64s[dstphys];
     if (ir->opr1->flag & VRF_CONST) {
       LI(dst, IM(ir->opr1->fixnum));
@@ -701,6 +714,40 @@ static void ei_call(IR *ir) {
   // Resore caller save registers.
   pop_caller_save_regs(precall->precall.caller_saves);
 
+  if (ir->call.result_frame != NULL) {
+    // Store the aggregate result into the frame: the destination is padded to 8 bytes.
+    int iindex = 0, findex = 0;
+    for (int i = 0; i < ir->call.result_part_count; ++i) {
+      const AggregatePart *part = &ir->call.result_parts[i];
+      int64_t offset = ir->call.result_frame->offset + part->offset;
+      const char *dst;
+      if (is_im12(offset)) {
+        dst = IMMEDIATE_OFFSET(offset, FP);
+      } else {
+        LI(kTmpReg, IM(offset));
+        ADD(kTmpReg, kTmpReg, FP);
+        dst = IMMEDIATE_OFFSET0(kTmpReg);
+      }
+      if (part->is_flo) {
+        int index = GET_FA0_INDEX() + findex++;
+        if (part->size == 4)
+          FSW(kFReg32s[index], dst);
+        else
+          FSD(kFReg64s[index], dst);
+      } else {
+        int pow = part->size <= 1 ? 0 : most_significant_bit(part->size - 1) + 1;
+        const char *src = kReg64s[ArchRegResultMapping[iindex++]];
+        switch (pow) {
+        case 0:  SB(src, dst); break;
+        case 1:  SH(src, dst); break;
+        case 2:  SW(src, dst); break;
+        case 3:  SD(src, dst); break;
+        default: assert(false); break;
+        }
+      }
+    }
+  }
+
   if (ir->dst != NULL) {
     if (ir->dst->flag & VRF_FLONUM) {
       if (ir->dst->phys != GET_FA0_INDEX()) {
@@ -942,13 +989,13 @@ static void pop_caller_save_regs(Vector *saves) {
     ADDI(SP, SP, IM(space));
 }
 
-void emit_bb_irs(BBContainer *bbcon) {
+int emit_bb_irs(BBContainer *bbcon, int start) {
   typedef void (*EmitIrFunc)(IR *);
   static const EmitIrFunc table[] = {
     [IR_BOFS] = ei_bofs, [IR_IOFS] = ei_iofs, [IR_SOFS] = ei_sofs,
     [IR_LOAD] = ei_load, [IR_LOAD_S] = ei_load_s, [IR_STORE] = ei_store, [IR_STORE_S] = ei_store_s,
-    [IR_ADD] = ei_add, [IR_SUB] = ei_sub, [IR_MUL] = ei_mul, [IR_DIV] = ei_div,
-    [IR_MOD] = ei_mod, [IR_BITAND] = ei_bitand, [IR_BITOR] = ei_bitor,
+    [IR_ADD] = ei_add, [IR_SUB] = ei_sub, [IR_MUL] = ei_mul, [IR_MULHI] = ei_mulhi,
+    [IR_DIV] = ei_div, [IR_MOD] = ei_mod, [IR_BITAND] = ei_bitand, [IR_BITOR] = ei_bitor,
     [IR_BITXOR] = ei_bitxor, [IR_LSHIFT] = ei_lshift, [IR_RSHIFT] = ei_rshift,
     [IR_NEG] = ei_neg, [IR_BITNOT] = ei_bitnot,
     [IR_COND] = ei_cond, [IR_JMP] = ei_jmp, [IR_TJMP] = ei_tjmp,
@@ -957,18 +1004,10 @@ void emit_bb_irs(BBContainer *bbcon) {
     [IR_MOV] = ei_mov, [IR_KEEP] = ei_keep, [IR_ASM] = ei_asm,
   };
 
-  for (int i = 0; i < bbcon->len; ++i) {
+  for (int i = start; i < bbcon->len; ++i) {
     BB *bb = bbcon->data[i];
-#ifndef NDEBUG
-    // Check BB connection.
-    if (i < bbcon->len - 1) {
-      BB *nbb = bbcon->data[i + 1];
-      UNUSED(nbb);
-      assert(bb->next == nbb);
-    } else {
-      assert(bb->next == NULL);
-    }
-#endif
+    // Check BB connection: the chain ends at the return BB, and cold BBs follow it.
+    assert(bb->next == NULL || (i < bbcon->len - 1 && bb->next == bbcon->data[i + 1]));
 
     if (is_fall_path_only(bbcon, i))
       emit_comment(NULL);
@@ -980,7 +1019,10 @@ void emit_bb_irs(BBContainer *bbcon) {
       assert(table[ir->kind] != NULL);
       (*table[ir->kind])(ir);
     }
+    if (bb->next == NULL)
+      return i + 1;
   }
+  return bbcon->len;
 }
 
 //
@@ -1001,6 +1043,12 @@ static void insert_const_mov(VReg **pvreg, RegAlloc *ra, Vector *irs, int i) {
 
 #define insert_tmp_mov  insert_const_mov
 
+bool is_legal_mem_operand(IR *ir, bool indexed, int scale, int64_t offset) {
+  UNUSED(ir);
+  UNUSED(scale);
+  return !indexed && is_im12(offset);
+}
+
 void tweak_irs(FuncBackend *fnbe) {
   BBContainer *bbcon = fnbe->bbcon;
   RegAlloc *ra = fnbe->ra;
@@ -1044,6 +1092,7 @@ void tweak_irs(FuncBackend *fnbe) {
           insert_const_mov(&ir->opr2, ra, irs, j++);
         break;
       case IR_MUL:
+      case IR_MULHI:
       case IR_DIV:
       case IR_MOD:
         assert(!(ir->opr1->flag & VRF_CONST) || !(ir->opr2->flag & VRF_CONST));
@@ -1130,6 +1179,53 @@ void tweak_irs(FuncBackend *fnbe) {
           insert_const_mov(&ir->opr2, ra, irs, j++);
         }
         break;
+      case IR_SELECT:
+        {
+          // No conditional move (Zicond) in the base ISA, so use mask instead:
+          //   c = opr1 @@ opr2; m = -c; dst = fval ^ ((tval ^ fval) & m)
+          VReg *dst = ir->dst, *tval = ir->select.tval, *fval = ir->select.fval;
+          int c_kind = ir->select.cond;
+          if ((c_kind & COND_MASK) == COND_LE || (c_kind & COND_MASK) == COND_GE) {
+            // `slt` computes `<` and `>` directly, so swap the values instead of negating.
+            c_kind = invert_cond(c_kind);
+            VReg *tmp = tval;
+            tval = fval;
+            fval = tmp;
+          }
+          int flag = ir->flag;
+          enum VRegSize vsize = dst->vsize;
+          int vflag = dst->flag & VRF_MASK;
+          VReg *c = reg_alloc_spawn(ra, vsize, vflag);
+          IR *cond = new_ir_bop_raw(IR_COND, c, ir->opr1, ir->opr2, flag);
+          cond->cond.kind = c_kind;
+          VReg *m = reg_alloc_spawn(ra, vsize, vflag);
+          IR *neg = new_ir_bop_raw(IR_NEG, m, c, NULL, flag);
+
+          VReg *x;
+          IR *diff = NULL;
+          if (tval->flag & fval->flag & VRF_CONST) {
+            x = reg_alloc_spawn_const(ra, tval->fixnum ^ fval->fixnum, vsize);
+          } else {
+            x = reg_alloc_spawn(ra, vsize, vflag);
+            diff = tval->flag & VRF_CONST ? new_ir_bop_raw(IR_BITXOR, x, fval, tval, flag)
+                                          : new_ir_bop_raw(IR_BITXOR, x, tval, fval, flag);
+          }
+          VReg *y = reg_alloc_spawn(ra, vsize, vflag);
+          IR *mask = x->flag & VRF_CONST ? new_ir_bop_raw(IR_BITAND, y, m, x, flag)
+                                         : new_ir_bop_raw(IR_BITAND, y, x, m, flag);
+          IR *merge = fval->flag & VRF_CONST ? new_ir_bop_raw(IR_BITXOR, dst, y, fval, flag)
+                                             : new_ir_bop_raw(IR_BITXOR, dst, fval, y, flag);
+
+          vec_remove_at(irs, j);
+          IR *seq[] = {cond, neg, diff, mask, merge};
+          int k = j;
+          for (int l = 0; l < (int)ARRAY_SIZE(seq); ++l) {
+            if (seq[l] != NULL)
+              vec_insert(irs, k++, seq[l]);
+          }
+          --j;  // Tweak inserted IRs again.
+        }
+        break;
       case IR_TJMP:
         {
           // Make sure opr1 can be broken.
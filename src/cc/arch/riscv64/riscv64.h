@@ -97,6 +97,8 @@
 #define SUBW(o1, o2, o3)      EMIT_ASM("subw", o1, o2, o3)
 #define MUL(o1, o2, o3)       EMIT_ASM("mul", o1, o2, o3)
 #define MULW(o1, o2, o3)      EMIT_ASM("mulw", o1, o2, o3)
+#define MULH(o1, o2, o3)      EMIT_ASM("mulh", o1, o2, o3)
+#define MULHU(o1, o2, o3)     EMIT_ASM("mulhu", o1, o2, o3)
 #define DIV(o1, o2, o3)       EMIT_ASM("div", o1, o2, o3)
 #define DIVU(o1, o2, o3)      EMIT_ASM("divu", o1, o2, o3)
 #define DIVW(o1, o2, o3)      EMIT_ASM("divw", o1, o2, o3)
@@ -9,3 +9,13 @@
 #define PHYSICAL_REG_MAX         (PHYSICAL_REG_TEMPORARY + 8)
 #define PHYSICAL_FREG_TEMPORARY  (8)
 #define PHYSICAL_FREG_MAX        (PHYSICAL_FREG_TEMPORARY + 8)
+
+// Bit operations: bsr, tzcnt, bswap
+// popcnt is not in the x86-64 baseline (it came with SSE4.2), so population count is computed.
+#define ARCH_HAS_CLZ     1
+#define ARCH_HAS_CTZ     1
+#define ARCH_HAS_BSWAP   1
+
+// 128bit vector (SSE2): integer multiplication only for 16bit lanes (pmullw), bit of VRegSize.
+#define ARCH_HAS_VECTOR  1
+#define ARCH_VECTOR_IMUL_SIZES  (1 << 1)
@@ -10,6 +10,7 @@
 #include "ast.h"
 #include "cc_misc.h"
 #include "codegen.h"
+#include "fe_misc.h"  // cc_flags
 #include "ir.h"
 #include "lexer.h"
 #include "regalloc.h"
@@ -19,6 +20,8 @@
 #include "var.h"
 #include "x64.h"
 
+#define RED_ZONE_SIZE  (128)
+
 int count_callee_save_regs(unsigned long used, unsigned long fused);
 
 char *im(int64_t x) {
@@ -63,6 +66,21 @@ char *gotpcrel(char *label) {
   return fmt("%s@GOTPCREL", label);
 }
 
+// Without frame pointer, the frame base is virtually placed where %rbp would be pushed,
+// so frame offsets (negative for locals, positive for stack parameters) are kept as is.
+bool frame_pointer_omitted;
+int rsp_frame_offset;
+
+char *frame_indirect(int offset) {
+  if (!frame_pointer_omitted)
+    return OFFSET_INDIRECT(offset, RBP, NULL, 1);
+  return OFFSET_INDIRECT(offset + rsp_frame_offset, RSP, NULL, 1);
+}
+
+bool can_omit_frame_pointer(Function *func) {
+  return !func->type->func.vaargs && !(func->flag & FUNCF_STACK_MODIFIED);
+}
+
 ////////////////////////////////////////////////
 
 static bool is_asm(Stmt *stmt) {
@@ -95,7 +113,7 @@ static void move_params_to_assigned(Function *func) {
     if (vreg->flag & VRF_SPILLED) {
       int offset = vreg->frame.offset;
       assert(offset != 0);
-      MOV(src, OFFSET_INDIRECT(offset, RBP, NULL, 1));
+      MOV(src, frame_indirect(offset));
     } else if (ArchRegParamMapping[p->index] != vreg->phys) {
       const char *dst = kRegSizeTable[pow][vreg->phys];
       MOV(src, dst);
@@ -105,26 +123,25 @@ static void move_params_to_assigned(Function *func) {
     RegParamInfo *p = &fparams[i];
     VReg *vreg = p->vreg;
     const char *src = kFRegParam64s[p->index];
+    const char *dst;
     if (vreg->flag & VRF_SPILLED) {
       int offset = vreg->frame.offset;
       assert(offset != 0);
-      const char *dst = OFFSET_INDIRECT(offset, RBP, NULL, 1);
-      switch (p->type->flonum.kind) {
-      case FL_FLOAT:   MOVSS(src, dst); break;
-      case FL_DOUBLE: case FL_LDOUBLE:
-        MOVSD(src, dst);
-        break;
-      }
+      dst = frame_indirect(offset);
     } else {
-      if (p->index != vreg->phys) {
-        const char *dst = kFReg64s[vreg->phys];
-        switch (p->type->flonum.kind) {
-        case FL_FLOAT:   MOVSS(src, dst); break;
-        case FL_DOUBLE: case FL_LDOUBLE:
-          MOVSD(src, dst);
-          break;
-        }
-      }
+      if (p->index == vreg->phys)
+        continue;
+      dst = kFReg64s[vreg->phys];
+    }
+    if (vreg->vsize == VRegSize16) {  // Short vector.
+      MOVDQU(src, dst);
+      continue;
+    }
+    switch (p->type->flonum.kind) {
+    case FL_FLOAT:   MOVSS(src, dst); break;
+    case FL_DOUBLE: case FL_LDOUBLE:
+      MOVSD(src, dst);
+      break;
     }
   }
 
@@ -169,7 +186,7 @@ void emit_defun(Function *func) {
       _GLOBL(label);
     else
       _LOCAL(label);
-    EMIT_ALIGN(2);
+    EMIT_ALIGN(MAX(2, varinfo != NULL ? varinfo->global.align : 0));
 #if XCC_TARGET_PLATFORM != XCC_PLATFORM_APPLE
     EMIT_ASM(".type", quote_label(fmt_name(func->name)), "@function");
 #endif
@@ -205,28 +222,45 @@ void emit_defun(Function *func) {
     // so default offset is 8.
     size_t frame_offset = 8;
 
+    size_t callee_saved_size = callee_saved_count * TARGET_POINTER_SIZE;
+    frame_pointer_omitted = false;
     if (fnbe->frame_size > 0 || fnbe->ra->flag & RAF_STACK_FRAME) {
-      PUSH(RBP);
-      MOV(RSP, RBP);
-      rbp_saved = true;
-      // RBP is pushed so the 16-bytes-align offset becomes 0.
-      frame_offset = 0;
+      if (can_omit_frame_pointer(func) && !(func->flag & FUNCF_HAS_FUNCALL) &&
+          fnbe->frame_size + TARGET_POINTER_SIZE <= RED_ZONE_SIZE) {
+        // Leaf function: put the frame into the red zone, without touching %rsp.
+        frame_pointer_omitted = true;
+        rsp_frame_offset = -TARGET_POINTER_SIZE;
+      } else if (cc_flags.omit_frame_pointer && can_omit_frame_pointer(func)) {
+        frame_pointer_omitted = true;
+        frame_size = fnbe->frame_size + TARGET_POINTER_SIZE;
+        if (func->flag & FUNCF_HAS_FUNCALL)
+          frame_size += -(frame_size + callee_saved_size + frame_offset) & 15;
+        rsp_frame_offset = frame_size - TARGET_POINTER_SIZE;
+        SUB(IM(frame_size), RSP);
+      } else {
+        PUSH(RBP);
+        MOV(RSP, RBP);
+        rbp_saved = true;
+        // RBP is pushed so the 16-bytes-align offset becomes 0.
+        frame_offset = 0;
+      }
     }
 
-    size_t callee_saved_size = callee_saved_count * TARGET_POINTER_SIZE;
-    frame_size = fnbe->frame_size;
-    if (func->flag & (FUNCF_HAS_FUNCALL | FUNCF_STACK_MODIFIED)) {
-      // Align frame size to 16 only it contains funcall.
-      frame_size += -(fnbe->frame_size + callee_saved_size + frame_offset) & 15;
-    }
-    if (frame_size > 0) {
-      SUB(IM(frame_size), RSP);
+    if (!frame_pointer_omitted) {
+      frame_size = fnbe->frame_size;
+      if (func->flag & (FUNCF_HAS_FUNCALL | FUNCF_STACK_MODIFIED)) {
+        // Align frame size to 16 only it contains funcall.
+        frame_size += -(fnbe->frame_size + callee_saved_size + frame_offset) & 15;
+      }
+      if (frame_size > 0) {
+        SUB(IM(frame_size), RSP);
+      }
     }
 
     move_params_to_assigned(func);
   }
 
-  emit_bb_irs(fnbe->bbcon);
+  int cold_start = emit_bb_irs(fnbe->bbcon, 0);
 
   if (!function_not_returned(fnbe)) {
     // Epilogue
@@ -244,5 +278,8 @@ void emit_defun(Function *func) {
     RET();
   }
 
+  // Unlikely BBs are placed after the epilogue.
+  emit_bb_irs(fnbe->bbcon, cold_start);
+
   // Static variables are emitted through global variables.
 }
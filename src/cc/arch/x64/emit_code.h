@@ -2,8 +2,10 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>  // int64_t
 
+typedef struct Function Function;
 typedef struct Vector Vector;
 
 char *im(int64_t x);  // $x
@@ -11,3 +13,9 @@ char *indirect(const char *base, const char *index, int scale);
 char *offset_indirect(int offset, const char *base, const char *index, int scale);
 char *label_indirect(const char *label, int64_t offset, const char *reg);
 char *gotpcrel(char *label);
+
+// Local variables are addressed relative to %rbp, or to %rsp if the frame pointer is omitted.
+extern bool frame_pointer_omitted;
+extern int rsp_frame_offset;  // Distance from %rsp to the frame base, changes around calls.
+char *frame_indirect(int offset);
+bool can_omit_frame_pointer(Function *func);
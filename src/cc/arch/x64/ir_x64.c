@@ -8,6 +8,7 @@
 
 #include "ast.h"
 #include "emit_code.h"
+#include "fe_misc.h"  // cc_flags, curfunc
 #include "regalloc.h"
 #include "table.h"
 #include "util.h"
@@ -39,6 +40,7 @@ static const int kCalleeSaveRegs[] = {7, 8, 9, 10, 11, 12};
 static const int kCallerSaveRegs[] = {13, 14};
 
 const int ArchRegParamMapping[] = {1, 2, 3, 4, 5, 6};
+const int ArchRegResultMapping[] = {GET_AREG_INDEX(), GET_DREG_INDEX()};
 
 #define kReg8s   (kRegSizeTable[0])
 #define kReg32s  (kRegSizeTable[2])
@@ -46,6 +48,7 @@ const int ArchRegParamMapping[] = {1, 2, 3, 4, 5, 6};
 
 #define SZ_FLOAT   VRegSize4
 #define SZ_DOUBLE  VRegSize8
+#define SZ_VECTOR  VRegSize16
 const char *kFReg64s[PHYSICAL_FREG_MAX] = {
   XMM0, XMM1, XMM2, XMM3, XMM4, XMM5, XMM6, XMM7,
   XMM8, XMM9, XMM10, XMM11, XMM12, XMM13, XMM14, XMM15};
@@ -58,7 +61,7 @@ static const int kCallerSaveFRegs[] = {8, 9, 10, 11, 12, 13, 14, 15};
 static unsigned long detect_extra_occupied(RegAlloc *ra, IR *ir) {
   unsigned long ioccupy = 0;
   switch (ir->kind) {
-  case IR_MUL: case IR_DIV: case IR_MOD:
+  case IR_MULHI: case IR_DIV: case IR_MOD:
     if (!(ir->dst->flag & VRF_FLONUM))
       ioccupy = (1UL << GET_DREG_INDEX()) | (1UL << GET_AREG_INDEX());
     break;
@@ -74,7 +77,8 @@ static unsigned long detect_extra_occupied(RegAlloc *ra, IR *ir) {
     break;
   default: break;
   }
-  if (ra->flag & RAF_STACK_FRAME)
+  if ((ra->flag & RAF_STACK_FRAME) &&
+      !(cc_flags.omit_frame_pointer && can_omit_frame_pointer(curfunc)))
     ioccupy |= 1UL << GET_BPREG_INDEX();
   return ioccupy;
 }
@@ -82,11 +86,15 @@ static unsigned long detect_extra_occupied(RegAlloc *ra, IR *ir) {
 const RegAllocSettings kArchRegAllocSettings = {
   .detect_extra_occupied = detect_extra_occupied,
   .reg_param_mapping = ArchRegParamMapping,
+  .reg_result_mapping = ArchRegResultMapping,
   .phys_max = PHYSICAL_REG_MAX,
   .phys_temporary_count = PHYSICAL_REG_TEMPORARY,
+  .caller_save_bits = REG_BIT_RANGE(13, 15),  // kCallerSaveRegs
 #ifndef __NO_FLONUM
   .fphys_max = PHYSICAL_FREG_MAX,
   .fphys_temporary_count = PHYSICAL_FREG_TEMPORARY,
+  .fcaller_save_bits = REG_BIT_RANGE(8, 16),  // kCallerSaveFRegs
+  .vector_fregs = REG_BIT_RANGE(0, PHYSICAL_FREG_MAX),  // xmm0-15
 #endif
 };
 
@@ -104,7 +112,7 @@ static bool is_got(const Name *name) {
 
 static void ei_bofs(IR *ir) {
   int64_t offset = ir->bofs.frameinfo->offset + ir->bofs.offset;
-  LEA(OFFSET_INDIRECT(offset, RBP, NULL, 1), kReg64s[ir->dst->phys]);
+  LEA(frame_indirect(offset), kReg64s[ir->dst->phys]);
 }
 
 static void ei_iofs(IR *ir) {
@@ -124,26 +132,35 @@ static void ei_sofs(IR *ir) {
   LEA(OFFSET_INDIRECT(ir->opr1->fixnum, RSP, NULL, 1), kReg64s[ir->dst->phys]);
 }
 
+static const char *mem_operand(IR *ir, VReg *base) {
+  assert(!(base->flag & VRF_SPILLED));
+  VReg *index = ir->mem.index;
+  assert(index == NULL || !(index->flag & (VRF_CONST | VRF_SPILLED)));
+  return OFFSET_INDIRECT(ir->mem.offset, kReg64s[base->phys],
+                         index != NULL ? kReg64s[index->phys] : NULL, 1 << ir->mem.scale);
+}
+
 #define ei_load_s  ei_load
 static void ei_load(IR *ir) {
   const char *src;
   if (ir->kind == IR_LOAD) {
     if (ir->opr1->flag & VRF_CONST) {
-      src = fmt("0x%x", ir->opr1->fixnum);
+      assert(ir->mem.index == NULL);
+      src = fmt("0x%x", ir->opr1->fixnum + ir->mem.offset);
     } else {
-      assert(!(ir->opr1->flag & VRF_SPILLED));
-      src = INDIRECT(kReg64s[ir->opr1->phys], NULL, 1);
+      src = mem_operand(ir, ir->opr1);
     }
   } else {
     assert(!(ir->opr1->flag & VRF_CONST));
     assert(ir->opr1->flag & VRF_SPILLED);
-    src = OFFSET_INDIRECT(ir->opr1->frame.offset, RBP, NULL, 1);
+    src = frame_indirect(ir->opr1->frame.offset);
   }
 
   if (ir->dst->flag & VRF_FLONUM) {
     switch (ir->dst->vsize) {
     case SZ_FLOAT:  MOVSS(src, kFReg64s[ir->dst->phys]); break;
     case SZ_DOUBLE: MOVSD(src, kFReg64s[ir->dst->phys]); break;
+    case SZ_VECTOR: MOVDQU(src, kFReg64s[ir->dst->phys]); break;
     default: assert(false); break;
     }
   } else {
@@ -159,21 +176,22 @@ static void ei_store(IR *ir) {
   const char *target;
   if (ir->kind == IR_STORE) {
     if (ir->opr2->flag & VRF_CONST) {
-      target = fmt("0x%x", ir->opr2->fixnum);
+      assert(ir->mem.index == NULL);
+      target = fmt("0x%x", ir->opr2->fixnum + ir->mem.offset);
     } else {
-      assert(!(ir->opr2->flag & VRF_SPILLED));
-      target = INDIRECT(kReg64s[ir->opr2->phys], NULL, 1);
+      target = mem_operand(ir, ir->opr2);
     }
   } else {
     assert(!(ir->opr2->flag & VRF_CONST));
     assert(ir->opr2->flag & VRF_SPILLED);
-    target = OFFSET_INDIRECT(ir->opr2->frame.offset, RBP, NULL, 1);
+    target = frame_indirect(ir->opr2->frame.offset);
   }
 
   if (ir->opr1->flag & VRF_FLONUM) {
     switch (ir->opr1->vsize) {
     case SZ_FLOAT:  MOVSS(kFReg64s[ir->opr1->phys], target); break;
     case SZ_DOUBLE: MOVSD(kFReg64s[ir->opr1->phys], target); break;
+    case SZ_VECTOR: MOVDQU(kFReg64s[ir->opr1->phys], target); break;
     default: assert(false); break;
     }
   } else {
@@ -255,8 +273,9 @@ static void ei_sub(IR *ir) {
 }
 
 static void ei_mul(IR *ir) {
-  assert(!(ir->opr1->flag & VRF_CONST) && !(ir->opr2->flag & VRF_CONST));
+  assert(!(ir->opr1->flag & VRF_CONST));
   if (ir->dst->flag & VRF_FLONUM) {
+    assert(!(ir->opr2->flag & VRF_CONST));
     assert(ir->dst->phys == ir->opr1->phys);
     const char **regs = kFReg64s;
     switch (ir->dst->vsize) {
@@ -265,21 +284,53 @@ static void ei_mul(IR *ir) {
     default: assert(false); break;
     }
   } else {
-    // Break %rax, %rdx
-    assert(ir->dst->phys == ir->opr1->phys);
-    assert(ir->opr2->phys != GET_AREG_INDEX());
+    // Lower bits of the product are same for signed and unsigned,
+    // and 8bit imul doesn't have two or three operand form: use 32bit instead.
     int pow = ir->dst->vsize;
     assert(0 <= pow && pow < 4);
+    if (pow < VRegSize4)
+      pow = VRegSize4;
     const char **regs = kRegSizeTable[pow];
-    const char *a = regs[GET_AREG_INDEX()];
-    if (ir->opr1->phys != GET_AREG_INDEX())
-      MOV(regs[ir->opr1->phys], a);
-    MUL(regs[ir->opr2->phys]);
-    if (ir->dst->phys != GET_AREG_INDEX())
-      MOV(a, regs[ir->dst->phys]);
+    if (ir->opr2->flag & VRF_CONST) {
+      // x * {3, 5, 9} << k => lea (x, x, {2, 4, 8}), dst; shl k, dst
+      int64_t value = ir->opr2->fixnum;
+      int shift = 0;
+      if (value > 0) {
+        for (; (value & 1) == 0; value >>= 1)
+          ++shift;
+      }
+      if (value == 3 || value == 5 || value == 9) {
+        const char *src = kReg64s[ir->opr1->phys];
+        LEA(INDIRECT(src, src, value - 1), kReg64s[ir->dst->phys]);
+        if (shift > 0)
+          SHL(IM(shift), regs[ir->dst->phys]);
+      } else {
+        IMUL3(IM(ir->opr2->fixnum), regs[ir->opr1->phys], regs[ir->dst->phys]);
+      }
+    } else {
+      assert(ir->dst->phys == ir->opr1->phys);
+      IMUL2(regs[ir->opr2->phys], regs[ir->dst->phys]);
+    }
   }
 }
 
+static void ei_mulhi(IR *ir) {
+  assert(!(ir->opr1->flag & VRF_CONST) && !(ir->opr2->flag & VRF_CONST));
+  assert(ir->dst->vsize == VRegSize8);
+  assert(ir->dst->phys == ir->opr1->phys);
+  assert(ir->opr2->phys != GET_AREG_INDEX());
+  // Break %rax, %rdx
+  const char **regs = kReg64s;
+  if (ir->opr1->phys != GET_AREG_INDEX())
+    MOV(regs[ir->opr1->phys], RAX);
+  if (ir->flag & IRF_UNSIGNED)
+    MUL(regs[ir->opr2->phys]);
+  else
+    IMUL(regs[ir->opr2->phys]);
+  if (ir->dst->phys != GET_DREG_INDEX())
+    MOV(RDX, regs[ir->dst->phys]);
+}
+
 static void ei_div(IR *ir) {
   assert(!(ir->opr1->flag & VRF_CONST) && !(ir->opr2->flag & VRF_CONST));
   if (ir->dst->flag & VRF_FLONUM) {
@@ -549,6 +600,31 @@ static void ei_bitnot(IR *ir) {
   NOT(regs[ir->dst->phys]);
 }
 
+static void ei_clz(IR *ir) {
+  assert(!(ir->opr1->flag & VRF_CONST));
+  int pow = ir->dst->vsize;
+  assert(2 <= pow && pow < 4);
+  const char **regs = kRegSizeTable[pow];
+  // lzcnt is not available on all CPUs, so use bsr instead: undefined for 0 anyway.
+  BSR(regs[ir->opr1->phys], regs[ir->dst->phys]);
+  XOR(IM((8 << pow) - 1), regs[ir->dst->phys]);
+}
+
+static void ei_ctz(IR *ir) {
+  assert(!(ir->opr1->flag & VRF_CONST));
+  int pow = ir->dst->vsize;
+  assert(2 <= pow && pow < 4);
+  const char **regs = kRegSizeTable[pow];
+  TZCNT(regs[ir->opr1->phys], regs[ir->dst->phys]);
+}
+
+static void ei_bswap(IR *ir) {
+  assert(ir->dst->phys == ir->opr1->phys);
+  int pow = ir->dst->vsize;
+  assert(2 <= pow && pow < 4);
+  BSWAP(kRegSizeTable[pow][ir->dst->phys]);
+}
+
 static void ei_cond(IR *ir) {
   VReg *opr1 = ir->opr1, *opr2 = ir->opr2;
 
@@ -611,6 +687,47 @@ static void ei_cond(IR *ir) {
   MOVSX(dst, kReg32s[ir->dst->phys]);  // Assume bool is 4 byte.
 }
 
+static void ei_select(IR *ir) {
+  assert(!(ir->select.cond & COND_FLONUM));
+  assert(!(ir->select.tval->flag & VRF_CONST) && !(ir->select.fval->flag & VRF_CONST));
+  cmp_vregs(ir->opr1, ir->opr2, ir->select.cond);
+
+  // cmov doesn't support 8-bit registers, so use 32-bit one instead.
+  int pow = ir->dst->vsize;
+  assert(0 <= pow && pow < 4);
+  const char **regs = kRegSizeTable[pow < 2 ? 2 : pow];
+  int cond = ir->select.cond;
+  const char *src;
+  if (ir->dst->phys == ir->select.tval->phys) {
+    cond = invert_cond(cond);
+    src = regs[ir->select.fval->phys];
+  } else {
+    if (ir->dst->phys != ir->select.fval->phys)
+      MOV(regs[ir->select.fval->phys], regs[ir->dst->phys]);  // mov doesn't change flags.
+    src = regs[ir->select.tval->phys];
+  }
+  const char *dst = regs[ir->dst->phys];
+
+  switch (cond) {
+  case COND_EQ | COND_UNSIGNED:  // Fallthrough
+  case COND_EQ:  CMOVE(src, dst); break;
+
+  case COND_NE | COND_UNSIGNED:  // Fallthrough
+  case COND_NE:  CMOVNE(src, dst); break;
+
+  case COND_LT:  CMOVL(src, dst); break;
+  case COND_GT:  CMOVG(src, dst); break;
+  case COND_LE:  CMOVLE(src, dst); break;
+  case COND_GE:  CMOVGE(src, dst); break;
+
+  case COND_LT | COND_UNSIGNED:  CMOVB(src, dst); break;
+  case COND_GT | COND_UNSIGNED:  CMOVA(src, dst); break;
+  case COND_LE | COND_UNSIGNED:  CMOVBE(src, dst); break;
+  case COND_GE | COND_UNSIGNED:  CMOVAE(src, dst); break;
+  default: assert(false); break;
+  }
+}
+
 static void ei_jmp(IR *ir) {
   int cond = ir->jmp.cond;
   assert(cond != COND_NONE);
@@ -696,18 +813,20 @@ static void ei_tjmp(IR *ir) {
   assert(ir->opr2 != NULL);
   const char *opr2 = kReg64s[ir->opr2->phys];
 
+  // Table entries are 32-bit offsets from the table, which is put into the text section.
   const Name *table_label = alloc_label();
   LEA(LABEL_INDIRECT(fmt_name(table_label), 0, RIP), opr2);
-  JMP(fmt("*%s", OFFSET_INDIRECT(0, opr2, kReg64s[phys], 8)));
+  MOV(OFFSET_INDIRECT(0, opr2, kReg64s[phys], 4), kReg32s[phys]);
+  MOVSX(kReg32s[phys], kReg64s[phys]);
+  ADD(kReg64s[phys], opr2);
+  JMP(fmt("*%s", opr2));
 
-  _RODATA();  // gcc warns, should be put into .data section?
-  EMIT_ALIGN(8);
+  EMIT_ALIGN(4);
   EMIT_LABEL(fmt_name(table_label));
   for (size_t i = 0, len = ir->tjmp.len; i < len; ++i) {
     BB *bb = ir->tjmp.bbs[i];
-    _QUAD(fmt("%.*s", NAMES(bb->label)));
+    _LONG(fmt("%.*s-%.*s", NAMES(bb->label), NAMES(table_label)));
   }
-  _TEXT();
 }
 
 static void ei_precall(IR *ir) {
@@ -722,6 +841,7 @@ static void ei_precall(IR *ir) {
   if (total > 0) {
     SUB(IM(total), RSP);
   }
+  rsp_frame_offset += ir->precall.caller_saves->len * TARGET_POINTER_SIZE + total;
 }
 
 static void ei_pusharg(IR *ir) {
@@ -731,6 +851,7 @@ static void ei_pusharg(IR *ir) {
       switch (ir->opr1->vsize) {
       case SZ_FLOAT: MOVSS(kFReg64s[ir->opr1->phys], kFReg64s[ir->pusharg.index]); break;
       case SZ_DOUBLE: MOVSD(kFReg64s[ir->opr1->phys], kFReg64s[ir->pusharg.index]); break;
+      case SZ_VECTOR: MOVDQU(kFReg64s[ir->opr1->phys], kFReg64s[ir->pusharg.index]); break;
       default: assert(false); break;
       }
     }
@@ -782,6 +903,28 @@ static void ei_call(IR *ir) {
 
   // Resore caller save registers.
   pop_caller_save_regs(precall->precall.caller_saves);
+  rsp_frame_offset -= precall->precall.caller_saves->len * TARGET_POINTER_SIZE + total;
+
+  if (ir->call.result_frame != NULL) {
+    // Store the aggregate result into the frame: the destination is padded to 8 bytes.
+    int iindex = 0, findex = 0;
+    for (int i = 0; i < ir->call.result_part_count; ++i) {
+      const AggregatePart *part = &ir->call.result_parts[i];
+      const char *dst = frame_indirect(ir->call.result_frame->offset + part->offset);
+      if (part->is_flo) {
+        const char *src = kFReg64s[GET_XMM0_INDEX() + findex++];
+        switch (part->size) {
+        case 4:   MOVSS(src, dst); break;
+        case 8:   MOVSD(src, dst); break;
+        case 16:  MOVDQU(src, dst); break;
+        default: assert(false); break;
+        }
+      } else {
+        int pow = part->size <= 1 ? 0 : most_significant_bit(part->size - 1) + 1;
+        MOV(kRegSizeTable[pow][ArchRegResultMapping[iindex++]], dst);
+      }
+    }
+  }
 
   if (ir->dst != NULL) {
     if (ir->dst->flag & VRF_FLONUM) {
@@ -805,12 +948,13 @@ static void ei_call(IR *ir) {
 
 static void ei_result(IR *ir) {
   if (ir->opr1->flag & VRF_FLONUM) {
-    int dstphys = ir->dst != NULL ? ir->dst->phys : GET_XMM0_INDEX();
+    int dstphys = ir->dst != NULL ? ir->dst->phys : GET_XMM0_INDEX() + ir->result.index;
     if (ir->opr1->phys != dstphys) {
       const char *dst = kFReg64s[dstphys];
       switch (ir->opr1->vsize) {
       case SZ_FLOAT: MOVSS(kFReg64s[ir->opr1->phys], dst); break;
       case SZ_DOUBLE: MOVSD(kFReg64s[ir->opr1->phys], dst); break;
+      case SZ_VECTOR: MOVDQU(kFReg64s[ir->opr1->phys], dst); break;
       default: assert(false); break;
       }
     }
@@ -818,7 +962,7 @@ static void ei_result(IR *ir) {
     int pow = ir->opr1->vsize;
     assert(0 <= pow && pow < 4);
     const char **regs = kRegSizeTable[pow];
-    int dstphys = ir->dst != NULL ? ir->dst->phys : GET_AREG_INDEX();
+    int dstphys = ir->dst != NULL ? ir->dst->phys : ArchRegResultMapping[ir->result.index];
     const char *dst = regs[dstphys];
     if (ir->opr1->flag & VRF_CONST)
       MOV(IM(ir->opr1->fixnum), dst);
@@ -948,6 +1092,7 @@ static void ei_mov(IR *ir) {
       switch (ir->dst->vsize) {
       case SZ_FLOAT: MOVSS(kFReg64s[ir->opr1->phys], kFReg64s[ir->dst->phys]); break;
       case SZ_DOUBLE: MOVSD(kFReg64s[ir->opr1->phys], kFReg64s[ir->dst->phys]); break;
+      case SZ_VECTOR: MOVDQU(kFReg64s[ir->opr1->phys], kFReg64s[ir->dst->phys]); break;
       default: assert(false); break;
       }
     }
@@ -1087,33 +1232,55 @@ static void pop_caller_save_regs(Vector *saves) {
   }
 }
 
-void emit_bb_irs(BBContainer *bbcon) {
+static void ei_vop(IR *ir) {
+  assert(ir->opr1->phys == ir->dst->phys);
+  // Instructions for each lane size: byte, word, dword, qword.
+  static const char *kIntOps[][4] = {
+    [IR_ADD] = {"paddb", "paddw", "paddd", "paddq"},
+    [IR_SUB] = {"psubb", "psubw", "psubd", "psubq"},
+    [IR_MUL] = {NULL, "pmullw", NULL, NULL},
+    [IR_BITAND] = {"pand", "pand", "pand", "pand"},
+    [IR_BITOR] = {"por", "por", "por", "por"},
+    [IR_BITXOR] = {"pxor", "pxor", "pxor", "pxor"},
+  };
+  static const char *kFloatOps[][2] = {  // single, double
+    [IR_ADD] = {"addps", "addpd"},
+    [IR_SUB] = {"subps", "subpd"},
+    [IR_MUL] = {"mulps", "mulpd"},
+    [IR_DIV] = {"divps", "divpd"},
+  };
+  const char *op;
+  if (ir->vop.vflag & VRF_FLONUM) {
+    assert(ir->vop.kind < (int)ARRAY_SIZE(kFloatOps));
+    op = kFloatOps[ir->vop.kind][ir->vop.elem == SZ_DOUBLE];
+  } else {
+    assert(ir->vop.kind < (int)ARRAY_SIZE(kIntOps));
+    op = kIntOps[ir->vop.kind][ir->vop.elem];
+  }
+  assert(op != NULL);
+  EMIT_ASM(op, kFReg64s[ir->opr2->phys], kFReg64s[ir->dst->phys]);
+}
+
+int emit_bb_irs(BBContainer *bbcon, int start) {
   typedef void (*EmitIrFunc)(IR *);
   static const EmitIrFunc table[] = {
     [IR_BOFS] = ei_bofs, [IR_IOFS] = ei_iofs, [IR_SOFS] = ei_sofs,
     [IR_LOAD] = ei_load, [IR_LOAD_S] = ei_load_s, [IR_STORE] = ei_store, [IR_STORE_S] = ei_store_s,
-    [IR_ADD] = ei_add, [IR_SUB] = ei_sub, [IR_MUL] = ei_mul, [IR_DIV] = ei_div,
-    [IR_MOD] = ei_mod, [IR_BITAND] = ei_bitand, [IR_BITOR] = ei_bitor,
+    [IR_ADD] = ei_add, [IR_SUB] = ei_sub, [IR_MUL] = ei_mul, [IR_MULHI] = ei_mulhi,
+    [IR_DIV] = ei_div, [IR_MOD] = ei_mod, [IR_BITAND] = ei_bitand, [IR_BITOR] = ei_bitor,
     [IR_BITXOR] = ei_bitxor, [IR_LSHIFT] = ei_lshift, [IR_RSHIFT] = ei_rshift,
     [IR_NEG] = ei_neg, [IR_BITNOT] = ei_bitnot,
-    [IR_COND] = ei_cond, [IR_JMP] = ei_jmp, [IR_TJMP] = ei_tjmp,
+    [IR_CLZ] = ei_clz, [IR_CTZ] = ei_ctz, [IR_BSWAP] = ei_bswap,
+    [IR_COND] = ei_cond, [IR_SELECT] = ei_select, [IR_JMP] = ei_jmp, [IR_TJMP] = ei_tjmp,
     [IR_PRECALL] = ei_precall, [IR_PUSHARG] = ei_pusharg, [IR_CALL] = ei_call,
     [IR_RESULT] = ei_result, [IR_SUBSP] = ei_subsp, [IR_CAST] = ei_cast,
-    [IR_MOV] = ei_mov, [IR_KEEP] = ei_keep, [IR_ASM] = ei_asm,
+    [IR_MOV] = ei_mov, [IR_KEEP] = ei_keep, [IR_ASM] = ei_asm, [IR_VOP] = ei_vop,
   };
 
-  for (int i = 0; i < bbcon->len; ++i) {
+  for (int i = start; i < bbcon->len; ++i) {
     BB *bb = bbcon->data[i];
-#ifndef NDEBUG
-    // Check BB connection.
-    if (i < bbcon->len - 1) {
-      BB *nbb = bbcon->data[i + 1];
-      UNUSED(nbb);
-      assert(bb->next == nbb);
-    } else {
-      assert(bb->next == NULL);
-    }
-#endif
+    // Check BB connection: the chain ends at the return BB, and cold BBs follow it.
+    assert(bb->next == NULL || (i < bbcon->len - 1 && bb->next == bbcon->data[i + 1]));
 
     if (is_fall_path_only(bbcon, i))
       emit_comment(NULL);
@@ -1125,7 +1292,10 @@ void emit_bb_irs(BBContainer *bbcon) {
       assert(table[ir->kind] != NULL);
       (*table[ir->kind])(ir);
     }
+    if (bb->next == NULL)
+      return i + 1;
   }
+  return bbcon->len;
 }
 
 static void insert_const_mov(VReg **pvreg, RegAlloc *ra, Vector *irs, int i) {
@@ -1158,9 +1328,15 @@ static void convert_3to2(FuncBackend *fnbe) {
           break;
         }
         // Fallthrough
+      case IR_MUL:
+        // Constant multiplication uses three operand form (imul or lea).
+        if (ir->kind == IR_MUL && !(ir->dst->flag & VRF_FLONUM) && ir->opr2->flag & VRF_CONST &&
+            is_im32(ir->opr2->fixnum))
+          break;
+        // Fallthrough
       case IR_ADD:  // binops
       case IR_SUB:
-      case IR_MUL:
+      case IR_MULHI:
       case IR_DIV:
       case IR_MOD:
       case IR_BITAND:
@@ -1169,6 +1345,8 @@ static void convert_3to2(FuncBackend *fnbe) {
       case IR_LSHIFT:
       case IR_RSHIFT:
       case IR_BITNOT:
+      case IR_BSWAP:
+      case IR_VOP:
         {
           assert(!(ir->dst->flag & VRF_CONST));
           IR *mov = new_ir_mov(ir->dst, ir->opr1, ir->flag);
@@ -1183,6 +1361,12 @@ static void convert_3to2(FuncBackend *fnbe) {
   }
 }
 
+bool is_legal_mem_operand(IR *ir, bool indexed, int scale, int64_t offset) {
+  UNUSED(ir);
+  UNUSED(indexed);
+  return scale >= 0 && scale <= 3 && is_im32(offset);
+}
+
 void tweak_irs(FuncBackend *fnbe) {
   convert_3to2(fnbe);
 
@@ -1204,7 +1388,7 @@ void tweak_irs(FuncBackend *fnbe) {
       }
 
       switch (ir->kind) {
-      case IR_MUL:
+      case IR_MULHI:
       case IR_DIV:
       case IR_MOD:
         assert(!(ir->opr1->flag & VRF_CONST));
@@ -1214,6 +1398,9 @@ void tweak_irs(FuncBackend *fnbe) {
 
       case IR_TJMP:
         {
+          // Make sure opr1 can be broken.
+          insert_tmp_mov(&ir->opr1, ra, irs, j++);
+
           // Allocate temporary register to use calculation.
           VReg *tmp = reg_alloc_spawn(ra, VRegSize8, 0);
           IR *keep = new_ir_keep(tmp, NULL, NULL);  // Notify the register begins to be used.
@@ -1229,7 +1416,18 @@ void tweak_irs(FuncBackend *fnbe) {
           insert_const_mov(&ir->opr1, ra, irs, j++);
         }
         break;
-
+      case IR_CLZ:
+      case IR_CTZ:
+        if (ir->opr1->flag & VRF_CONST)
+          insert_const_mov(&ir->opr1, ra, irs, j++);
+        break;
+      case IR_SELECT:
+        // cmov takes register operands only.
+        if (ir->select.tval->flag & VRF_CONST)
+          insert_const_mov(&ir->select.tval, ra, irs, j++);
+        if (ir->select.fval->flag & VRF_CONST)
+          insert_const_mov(&ir->select.fval, ra, irs, j++);
+        break;
       default: break;
       }
     }
@@ -122,6 +122,9 @@
 #define SUB(o1, o2)    EMIT_ASM("sub", o1, o2)
 #define SUBQ(o1, o2)   EMIT_ASM("subq", o1, o2)
 #define MUL(o1)        EMIT_ASM("mul", o1)
+#define IMUL(o1)       EMIT_ASM("imul", o1)
+#define IMUL2(o1, o2)  EMIT_ASM("imul", o1, o2)
+#define IMUL3(o1, o2, o3)  EMIT_ASM("imul", o1, o2, o3)
 #define DIV(o1)        EMIT_ASM("div", o1)
 #define IDIV(o1)       EMIT_ASM("idiv", o1)
 #define CMP(o1, o2)    EMIT_ASM("cmp", o1, o2)
@@ -174,6 +177,19 @@
 #define SETAE(o1)      EMIT_ASM("setae", o1)
 #define SETP(o1)       EMIT_ASM("setp", o1)
 #define SETNP(o1)      EMIT_ASM("setnp", o1)
+#define CMOVE(o1, o2)  EMIT_ASM("cmove", o1, o2)
+#define CMOVNE(o1, o2) EMIT_ASM("cmovne", o1, o2)
+#define CMOVL(o1, o2)  EMIT_ASM("cmovl", o1, o2)
+#define CMOVG(o1, o2)  EMIT_ASM("cmovg", o1, o2)
+#define CMOVLE(o1, o2) EMIT_ASM("cmovle", o1, o2)
+#define CMOVGE(o1, o2) EMIT_ASM("cmovge", o1, o2)
+#define CMOVB(o1, o2)  EMIT_ASM("cmovb", o1, o2)
+#define CMOVA(o1, o2)  EMIT_ASM("cmova", o1, o2)
+#define CMOVBE(o1, o2) EMIT_ASM("cmovbe", o1, o2)
+#define CMOVAE(o1, o2) EMIT_ASM("cmovae", o1, o2)
+#define TZCNT(o1, o2)   EMIT_ASM("tzcnt", o1, o2)
+#define BSR(o1, o2)     EMIT_ASM("bsr", o1, o2)
+#define BSWAP(o)        EMIT_ASM("bswap", o)
 #define CWTL()         EMIT_ASM("cwtl")
 #define CLTD()         EMIT_ASM("cltd")
 #define CQTO()         EMIT_ASM("cqto")
@@ -203,5 +219,7 @@
 #define CVTSI2SS(o1, o2)   EMIT_ASM("cvtsi2ss", o1, o2)
 #define CVTTSS2SI(o1, o2)  EMIT_ASM("cvttss2si", o1, o2)
 
+#define MOVDQU(o1, o2)     EMIT_ASM("movdqu", o1, o2)
+
 #define CVTSD2SS(o1, o2)   EMIT_ASM("cvtsd2ss", o1, o2)  // double->single
 #define CVTSS2SD(o1, o2)   EMIT_ASM("cvtss2sd", o1, o2)  // single->double
@@ -5,13 +5,17 @@
 #include <inttypes.h>
 #include <limits.h>  // CHAR_BIT
 #include <stdbool.h>
-#include <stdlib.h>  // qsort
+#include <stdio.h>
+#include <stdlib.h>  // free
 #include <string.h>
 
 #include "arch_config.h"
 #include "ast.h"
+#include "cc_misc.h"  // cluster_switch_cases
+#include "emit_util.h"  // is_weak_attr
 #include "fe_misc.h"  // curfunc, curscope
 #include "ir.h"
+#include "loop.h"
 #include "optimize.h"
 #include "regalloc.h"
 #include "table.h"
@@ -73,39 +77,46 @@ static VarInfo *prepare_retvar(Function *func) {
   return varinfo;
 }
 
-static void alloc_variable_registers(Function *func) {
-  assert(func->type->kind == TY_FUNC);
+static void alloc_scope_variable_registers(Scope *scope) {
+  if (scope->vars == NULL)
+    return;
 
-  for (int i = 0; i < func->scopes->len; ++i) {
-    Scope *scope = func->scopes->data[i];
-    if (scope->vars == NULL)
+  for (int j = 0; j < scope->vars->len; ++j) {
+    VarInfo *varinfo = scope->vars->data[j];
+    if (!is_local_storage(varinfo)) {
+      // Static entity is allocated in global, not on stack.
+      // Extern doesn't have its entity.
+      // Enum members are replaced to constant value.
       continue;
+    }
 
-    for (int j = 0; j < scope->vars->len; ++j) {
-      VarInfo *varinfo = scope->vars->data[j];
-      if (!is_local_storage(varinfo)) {
-        // Static entity is allocated in global, not on stack.
-        // Extern doesn't have its entity.
-        // Enum members are replaced to constant value.
-        continue;
-      }
-
-      varinfo->local.vreg = NULL;
-      varinfo->local.frameinfo = NULL;
-      if (!is_prim_type(varinfo->type)) {
-        FrameInfo *fi = malloc_or_die(sizeof(*fi));
-        fi->offset = 0;
-        varinfo->local.frameinfo = fi;
-        continue;
-      }
-
-      VReg *vreg = add_new_vreg(varinfo->type);
-      if (varinfo->storage & VS_REF_TAKEN)
-        vreg->flag |= VRF_REF;
-      varinfo->local.vreg = vreg;
-      varinfo->local.frameinfo = &vreg->frame;
+    varinfo->local.vreg = NULL;
+    varinfo->local.frameinfo = NULL;
+    bool is_volatile = (varinfo->type->qualifier & TQ_VOLATILE) != 0;
+    if (!is_prim_type(varinfo->type)) {
+      FrameInfo *fi = malloc_or_die(sizeof(*fi));
+      fi->offset = 0;
+      fi->flag = is_volatile || (varinfo->storage & VS_PARAM) ? 0 : FIF_PROMOTABLE;
+      varinfo->local.frameinfo = fi;
+      continue;
     }
+
+    VReg *vreg = add_new_vreg(varinfo->type);
+    if (varinfo->storage & VS_REF_TAKEN)
+      vreg->flag |= VRF_REF;
+    if (!is_volatile)
+      vreg->frame.flag = FIF_PROMOTABLE;
+    varinfo->local.vreg = vreg;
+    varinfo->local.frameinfo = &vreg->frame;
   }
+}
+
+static void alloc_variable_registers(Function *func) {
+  assert(func->type->kind == TY_FUNC);
+  FuncBackend *fnbe = func->extra;
+
+  for (int i = 0; i < func->scopes->len; ++i)
+    alloc_scope_variable_registers(func->scopes->data[i]);
 
   struct RegSet {
     int index;
@@ -117,7 +128,8 @@ static void alloc_variable_registers(Function *func) {
   enum RegKind { IREG = 0, FREG = 1 };
 
   // Handle if return value is on the stack.
-  if (is_stack_param(func->type->func.ret)) {
+  AggregatePart parts[MAX_AGGREGATE_PARTS];
+  if (is_stack_param(func->type->func.ret) && classify_aggregate(func->type->func.ret, parts) == 0) {
     prepare_retvar(func);
     ++regparams[IREG].index;
   }
@@ -130,24 +142,70 @@ static void alloc_variable_registers(Function *func) {
       VReg *vreg = varinfo->local.vreg;
       if (vreg != NULL) {
         vreg->flag |= VRF_PARAM;
+        if (varinfo->type->qualifier & TQ_RESTRICT)
+          vreg->flag |= VRF_RESTRICT;
         enum RegKind k = (vreg->flag & VRF_FLONUM) ? FREG : IREG;
         struct RegSet *p = &regparams[k];
         if (p->index < p->max)
           vreg->reg_param_index = p->index++;
         else
           vreg->flag |= VRF_STACK_PARAM;
+      } else {
+        // Aggregate is passed through registers if all of its parts fit, otherwise on the stack.
+        int n = classify_aggregate(varinfo->type, parts);
+        int counts[2] = {0, 0};
+        for (int j = 0; j < n; ++j)
+          ++counts[parts[j].is_flo ? FREG : IREG];
+        if (n <= 0 || regparams[IREG].index + counts[IREG] > regparams[IREG].max ||
+            regparams[FREG].index + counts[FREG] > regparams[FREG].max)
+          continue;
+
+        FrameInfo *fi = varinfo->local.frameinfo;
+        fi->flag |= FIF_REG_PARAM;
+        if (!(varinfo->type->qualifier & TQ_VOLATILE))
+          fi->flag |= FIF_PROMOTABLE;
+        for (int j = 0; j < n; ++j) {
+          const AggregatePart *part = &parts[j];
+          VReg *vreg = part->is_flo ? reg_alloc_spawn(curra, most_significant_bit(part->size),
+                                                      VRF_FLONUM)
+                                    : reg_alloc_spawn(curra, VRegSize8, 0);
+          vreg->flag |= VRF_PARAM;
+          vreg->reg_param_index = regparams[part->is_flo ? FREG : IREG].index++;
+          vec_push(fnbe->param_parts, vreg);
+        }
       }
     }
   }
 }
 
+// Aggregate parameters through registers are stored into their frames at the entry.
+static void store_aggregate_params(Function *func) {
+  FuncBackend *fnbe = func->extra;
+  const Vector *params = func->params;
+  if (params == NULL)
+    return;
+  int ipart = 0;
+  for (int i = 0; i < params->len; ++i) {
+    VarInfo *varinfo = params->data[i];
+    FrameInfo *fi = varinfo->local.frameinfo;
+    if (varinfo->local.vreg != NULL || !(fi->flag & FIF_REG_PARAM))
+      continue;
+    AggregatePart parts[MAX_AGGREGATE_PARTS];
+    int n = classify_aggregate(varinfo->type, parts);
+    VReg *addr = new_ir_bofs(fi);
+    for (int j = 0; j < n; ++j)
+      gen_store_part(addr, &parts[j], fnbe->param_parts->data[ipart++]);
+  }
+}
+
 void enumerate_register_params(
     Function *func, RegParamInfo iargs[], int max_ireg, RegParamInfo fargs[], int max_freg,
     int *piarg_count, int *pfarg_count) {
   int iarg_count = 0;
   int farg_count = 0;
 
-  VReg *retval = ((FuncBackend*)func->extra)->retval;
+  FuncBackend *fnbe = func->extra;
+  VReg *retval = fnbe->retval;
   if (retval != NULL) {
     RegParamInfo *p = &iargs[iarg_count++];
     p->type = &tyVoidPtr;
@@ -157,26 +215,41 @@ void enumerate_register_params(
 
   const Vector *params = func->params;
   if (params != NULL) {
-    for (int i = 0, len = params->len; i < len; ++i) {
+    for (int i = 0, ipart = 0, len = params->len; i < len; ++i) {
       const VarInfo *varinfo = params->data[i];
       const Type *type = varinfo->type;
-      if (is_stack_param(type))
-        continue;
-      VReg *vreg = varinfo->local.vreg;
-      assert(vreg != NULL);
-      RegParamInfo *p = NULL;
-      int index = 0;
-      if (is_flonum(type)) {
-        if (farg_count < max_freg)
-          p = &fargs[index = farg_count++];
-      } else {
-        if (iarg_count < max_ireg)
-          p = &iargs[index = iarg_count++];
+      AggregatePart parts[MAX_AGGREGATE_PARTS];
+      int n = 1;
+      if (is_stack_param(type)) {
+        if (!(varinfo->local.frameinfo->flag & FIF_REG_PARAM))
+          continue;
+        n = classify_aggregate(type, parts);
       }
-      if (p != NULL) {
-        p->type = type;
-        p->vreg = vreg;
-        p->index = index;
+      for (int j = 0; j < n; ++j) {
+        VReg *vreg = varinfo->local.vreg;
+        bool flo = is_flonum(type);
+        if (vreg == NULL) {
+          // Each part of the aggregate: short vector is kept as its own type.
+          vreg = fnbe->param_parts->data[ipart++];
+          flo = parts[j].is_flo;
+          type = !flo ? &tySize : parts[j].size == 4 ? &tyFloat : parts[j].size == 8 ? &tyDouble
+                                                                                    : varinfo->type;
+        }
+        assert(vreg != NULL);
+        RegParamInfo *p = NULL;
+        int index = 0;
+        if (flo) {
+          if (farg_count < max_freg)
+            p = &fargs[index = farg_count++];
+        } else {
+          if (iarg_count < max_ireg)
+            p = &iargs[index = iarg_count++];
+        }
+        if (p != NULL) {
+          p->type = type;
+          p->vreg = vreg;
+          p->index = index;
+        }
       }
     }
   }
@@ -203,37 +276,256 @@ static enum VRegSize get_elem_vtype(const Type *type) {
   return most_significant_bit(s);
 }
 
-void gen_memcpy(const Type *type, VReg *dst, VReg *src) {
+// Register class to move the element at `offset` of the aggregate: floating-point if the member
+// there is a floating-point number of the element size, so it matches accesses to the member.
+static int get_elem_vflag(const Type *type, size_t offset, size_t size) {
+  for (;;) {
+    switch (type->kind) {
+    case TY_FLONUM:
+      return offset == 0 && type_size(type) == size ? VRF_FLONUM : 0;
+    case TY_ARRAY:
+      {
+        size_t elem_size = type_size(type->pa.ptrof);
+        if (elem_size == 0)
+          return 0;
+        type = type->pa.ptrof;
+        offset %= elem_size;
+      }
+      break;
+    case TY_STRUCT:
+      {
+        const StructInfo *sinfo = type->struct_.info;
+        if (sinfo->is_union)
+          return 0;
+        const MemberInfo *minfo = NULL;
+        for (int i = 0; i < sinfo->member_count; ++i) {
+          const MemberInfo *m = &sinfo->members[i];
+          if (m->offset <= offset && offset + size <= m->offset + type_size(m->type)) {
+            minfo = m;
+            break;
+          }
+        }
+        if (minfo == NULL)
+          return 0;
+        type = minfo->type;
+        offset -= minfo->offset;
+      }
+      break;
+    default:
+      return 0;
+    }
+  }
+}
+
+// Aggregates up to this number of elements are copied/cleared with straight-line moves.
+#define MAX_UNROLL_MOVES  (8)
+// Aggregates from this size are handed to libc memcpy/memset.
+#define MIN_LIBC_MOVE_SIZE  (256)
+// Bytes copied by a 128bit move through a floating-point register.
+#define VECTOR_MOVE_SIZE  (16)
+
+// Elements moved per iteration in the copy/clear loop: more than one when unrolling is enabled.
+#define MOVE_LOOP_UNROLL  (4)
+
+static VReg *offset_ptr(VReg *ptr, size_t offset) {
+  if (offset == 0)
+    return ptr;
+  return new_ir_bop(IR_ADD, ptr, new_const_vreg(offset, ptr->vsize), ptr->vsize, IRF_UNSIGNED);
+}
+
+static void gen_libc_call(const char *name, VReg *args[], int arg_count) {
+  IR *precall = new_ir_precall(arg_count, 0);
+  for (int i = arg_count; --i >= 0; )
+    new_ir_pusharg(args[i], i);
+  VReg **arg_vregs = calloc_or_die(arg_count * sizeof(*arg_vregs));
+  memcpy(arg_vregs, args, arg_count * sizeof(*arg_vregs));
+  new_ir_call(alloc_name(name, NULL, false), true, NULL, arg_count, arg_count, -1, 0, precall,
+              arg_vregs, -1);
+}
+
+// `allow_call` must be false while function arguments are being set up:
+// a nested call would break argument registers already assigned.
+static void gen_memcpy_sub(const Type *type, VReg *dst, VReg *src, bool allow_call) {
   size_t size = type_size(type);
   if (size == 0)
     return;
+#if ARCH_HAS_VECTOR
+  if (is_vector(type) && size == VECTOR_MOVE_SIZE) {
+    // As a whole, so that the vector can be kept in a register.
+    VReg *tmp = new_ir_load(src, VRegSize16, VRF_FLONUM, 0);
+    new_ir_store(dst, tmp, 0);
+    return;
+  }
+#endif
   enum VRegSize elem_vsize = get_elem_vtype(type);
   size_t count = size >> elem_vsize;
   assert(count > 0);
-  if (count == 1) {
-    VReg *tmp = new_ir_load(src, elem_vsize, to_vflag(type), 0);
-    new_ir_store(dst, tmp, 0);
+  if (count <= MAX_UNROLL_MOVES) {
+    for (size_t i = 0; i < count; ++i) {
+      size_t offset = i << elem_vsize;
+      int vflag = get_elem_vflag(type, offset, 1 << elem_vsize);
+      VReg *tmp = new_ir_load(offset_ptr(src, offset), elem_vsize, vflag, 0);
+      new_ir_store(offset_ptr(dst, offset), tmp, 0);
+    }
+  } else if (allow_call && size >= MIN_LIBC_MOVE_SIZE) {
+    VReg *args[] = {dst, src, new_const_vreg(size, to_vsize(&tySize))};
+    gen_libc_call("memcpy", args, ARRAY_SIZE(args));
+#if ARCH_HAS_VECTOR
+  } else if (size >= VECTOR_MOVE_SIZE && size < MIN_LIBC_MOVE_SIZE) {
+    // 128bit moves: the last one overlaps the previous, unless the size is a multiple.
+    for (size_t offset = 0; offset < size; offset += VECTOR_MOVE_SIZE) {
+      size_t ofs = MIN(offset, size - VECTOR_MOVE_SIZE);
+      VReg *tmp = new_ir_load(offset_ptr(src, ofs), VRegSize16, VRF_FLONUM, 0);
+      new_ir_store(offset_ptr(dst, ofs), tmp, 0);
+    }
+#endif
   } else {
     VReg *srcp = add_new_vreg(&tyVoidPtr);
     new_ir_mov(srcp, src, IRF_UNSIGNED);
     VReg *dstp = add_new_vreg(&tyVoidPtr);
     new_ir_mov(dstp, dst, IRF_UNSIGNED);
 
+    size_t unroll = loop_unroll_budget() > 0 ? MOVE_LOOP_UNROLL : 1;
     enum VRegSize vsSize = to_vsize(&tySize);
     VReg *vcount = add_new_vreg(&tySize);
-    new_ir_mov(vcount, new_const_vreg(count, vsSize), IRF_UNSIGNED);
-    VReg *vadd = new_const_vreg(1 << elem_vsize, vsSize);
+    new_ir_mov(vcount, new_const_vreg(count / unroll, vsSize), IRF_UNSIGNED);
+    VReg *vadd = new_const_vreg(unroll << elem_vsize, vsSize);
 
     BB *loop_bb = new_bb();
     set_curbb(loop_bb);
-    VReg *tmp = new_ir_load(srcp, elem_vsize, to_vflag(type), 0);
-    new_ir_mov(srcp, new_ir_bop(IR_ADD, srcp, vadd, srcp->vsize, IRF_UNSIGNED), IRF_UNSIGNED);  // srcp += elem_size
-    new_ir_store(dstp, tmp, 0);
-    new_ir_mov(dstp, new_ir_bop(IR_ADD, dstp, vadd, dstp->vsize, IRF_UNSIGNED), IRF_UNSIGNED);  // dstp += elem_size
+    for (size_t i = 0; i < unroll; ++i) {
+      size_t offset = i << elem_vsize;
+      VReg *tmp = new_ir_load(offset_ptr(srcp, offset), elem_vsize, to_vflag(type), 0);
+      new_ir_store(offset_ptr(dstp, offset), tmp, 0);
+    }
+    new_ir_mov(srcp, new_ir_bop(IR_ADD, srcp, vadd, srcp->vsize, IRF_UNSIGNED), IRF_UNSIGNED);  // srcp += elem_size * unroll
+    new_ir_mov(dstp, new_ir_bop(IR_ADD, dstp, vadd, dstp->vsize, IRF_UNSIGNED), IRF_UNSIGNED);  // dstp += elem_size * unroll
     new_ir_mov(vcount, new_ir_bop(IR_SUB, vcount, new_const_vreg(1, vsSize),
                                   vcount->vsize, IRF_UNSIGNED), IRF_UNSIGNED);  // vcount -= 1
     new_ir_cjmp(vcount, new_const_vreg(0, vcount->vsize), COND_NE, loop_bb);
     set_curbb(new_bb());
+
+    // Rest of the elements.
+    for (size_t i = 0; i < count % unroll; ++i) {
+      size_t offset = i << elem_vsize;
+      VReg *tmp = new_ir_load(offset_ptr(srcp, offset), elem_vsize, to_vflag(type), 0);
+      new_ir_store(offset_ptr(dstp, offset), tmp, 0);
+    }
+  }
+}
+
+void gen_memcpy(const Type *type, VReg *dst, VReg *src) {
+  gen_memcpy_sub(type, dst, src, true);
+}
+
+void gen_memcpy_inline(const Type *type, VReg *dst, VReg *src) {
+  gen_memcpy_sub(type, dst, src, false);
+}
+
+// Load a part of the aggregate into a register: integer of odd size is composed of smaller ones.
+VReg *gen_load_part(VReg *addr, const AggregatePart *part) {
+  VReg *src = offset_ptr(addr, part->offset);
+  if (part->is_flo)
+    return new_ir_load(src, most_significant_bit(part->size), VRF_FLONUM, 0);
+  if (IS_POWER_OF_2(part->size)) {
+    // 32bit value is kept sign-extended as `int` in 64bit register.
+    int flag = part->size == 4 ? 0 : IRF_UNSIGNED;
+    return new_ir_load(src, most_significant_bit(part->size), 0, flag);
+  }
+
+  VReg *result = NULL;
+  for (int offset = 0; offset < part->size; ) {
+    enum VRegSize vsize = most_significant_bit(part->size - offset);
+    IR *cast = new_ir_cast(new_ir_load(offset_ptr(src, offset), vsize, 0, IRF_UNSIGNED),
+                           VRegSize8, 0);
+    cast->flag = IRF_UNSIGNED;
+    VReg *value = cast->dst;
+    if (offset > 0)
+      value = new_ir_bop(IR_LSHIFT, value, new_const_vreg(offset * CHAR_BIT, VRegSize8),
+                         VRegSize8, IRF_UNSIGNED);
+    result = result == NULL ? value : new_ir_bop(IR_BITOR, result, value, VRegSize8, IRF_UNSIGNED);
+    offset += 1 << vsize;
+  }
+  return result;
+}
+
+// Store a part of the aggregate from a register, reverse of `gen_load_part`.
+void gen_store_part(VReg *addr, const AggregatePart *part, VReg *vreg) {
+  VReg *dst = offset_ptr(addr, part->offset);
+  if (part->is_flo) {
+    new_ir_store(dst, vreg, 0);
+    return;
+  }
+
+  for (int offset = 0; offset < part->size; ) {
+    enum VRegSize vsize = most_significant_bit(part->size - offset);
+    VReg *value = vreg;
+    if (offset > 0)
+      value = new_ir_bop(IR_RSHIFT, value, new_const_vreg(offset * CHAR_BIT, value->vsize),
+                         value->vsize, IRF_UNSIGNED);
+    if (vsize < value->vsize)
+      value = new_ir_cast(value, vsize, 0)->dst;
+    new_ir_store(offset_ptr(dst, offset), value, 0);
+    offset += 1 << vsize;
+  }
+}
+
+#if ARCH_HAS_VECTOR
+#ifndef ARCH_VECTOR_IMUL_SIZES
+#define ARCH_VECTOR_IMUL_SIZES  (0)
+#endif
+
+// Whether the element-wise operation is done with a single 128bit SIMD instruction.
+static bool is_simd_vector_op(enum IrKind kind, const Type *type, const Type *elem_type) {
+  if (type_size(type) != 16)
+    return false;
+  switch (kind) {
+  case IR_ADD: case IR_SUB: case IR_BITAND: case IR_BITOR: case IR_BITXOR:
+    return true;
+  case IR_MUL:
+    return is_flonum(elem_type) || (ARCH_VECTOR_IMUL_SIZES & (1 << to_vsize(elem_type))) != 0;
+  case IR_DIV:
+    return is_flonum(elem_type);
+  default:
+    return false;
+  }
+}
+#endif
+
+// [dst] = [lhs] @@ [rhs] for each lane of the vector.
+void gen_vector_op(enum IrKind kind, const Type *type, VReg *dst, VReg *lhs, VReg *rhs) {
+  const StructInfo *sinfo = type->struct_.info;
+  assert(sinfo->is_vector);
+  const Type *elem_type = sinfo->members[0].type;
+  enum VRegSize elem_vsize = to_vsize(elem_type);
+  int vflag = to_vflag(elem_type);
+#if ARCH_HAS_VECTOR
+  if (is_simd_vector_op(kind, type, elem_type)) {
+    VReg *l = new_ir_load(lhs, VRegSize16, VRF_FLONUM, 0);
+    VReg *r = new_ir_load(rhs, VRegSize16, VRF_FLONUM, 0);
+    new_ir_store(dst, new_ir_vop(kind, l, r, elem_vsize, vflag), 0);
+    return;
+  }
+#endif
+
+  // Operate lane by lane, small integers are calculated in int as C does.
+  int flag = is_unsigned(elem_type) ? IRF_UNSIGNED : 0;
+  enum VRegSize calc_vsize = vflag == 0 && elem_vsize < VRegSize4 ? VRegSize4 : elem_vsize;
+  for (int i = 0; i < sinfo->member_count; ++i) {
+    size_t offset = sinfo->members[i].offset;
+    VReg *l = new_ir_load(offset_ptr(lhs, offset), elem_vsize, vflag, flag);
+    VReg *r = new_ir_load(offset_ptr(rhs, offset), elem_vsize, vflag, flag);
+    if (calc_vsize != elem_vsize) {
+      IR *lcast = new_ir_cast(l, calc_vsize, vflag);
+      IR *rcast = new_ir_cast(r, calc_vsize, vflag);
+      lcast->flag = rcast->flag = flag;
+      l = lcast->dst;
+      r = rcast->dst;
+    }
+    VReg *value = new_ir_bop(kind, l, r, calc_vsize, flag);
+    if (calc_vsize != elem_vsize)
+      value = new_ir_cast(value, elem_vsize, vflag)->dst;
+    new_ir_store(offset_ptr(dst, offset), value, flag);
   }
 }
 
@@ -245,25 +537,36 @@ static void gen_clear(const Type *type, VReg *dst) {
   size_t count = size >> elem_vtype;
   assert(count > 0);
   VReg *vzero = new_const_vreg(0, elem_vtype);
-  if (count == 1) {
-    new_ir_store(dst, vzero, 0);
+  if (count <= MAX_UNROLL_MOVES) {
+    for (size_t i = 0; i < count; ++i)
+      new_ir_store(offset_ptr(dst, i << elem_vtype), vzero, 0);
+  } else if (size >= MIN_LIBC_MOVE_SIZE) {
+    enum VRegSize vsSize = to_vsize(&tySize);
+    VReg *args[] = {dst, new_const_vreg(0, to_vsize(&tyInt)), new_const_vreg(size, vsSize)};
+    gen_libc_call("memset", args, ARRAY_SIZE(args));
   } else {
     VReg *dstp = add_new_vreg(&tyVoidPtr);
     new_ir_mov(dstp, dst, IRF_UNSIGNED);
 
+    size_t unroll = loop_unroll_budget() > 0 ? MOVE_LOOP_UNROLL : 1;
     enum VRegSize vsSize = to_vsize(&tySize);
     VReg *vcount = add_new_vreg(&tySize);
-    new_ir_mov(vcount, new_const_vreg(count, vsSize), IRF_UNSIGNED);
-    VReg *vadd = new_const_vreg(1 << elem_vtype, vsSize);
+    new_ir_mov(vcount, new_const_vreg(count / unroll, vsSize), IRF_UNSIGNED);
+    VReg *vadd = new_const_vreg(unroll << elem_vtype, vsSize);
 
     BB *loop_bb = new_bb();
     set_curbb(loop_bb);
-    new_ir_store(dstp, vzero, 0);
-    new_ir_mov(dstp, new_ir_bop(IR_ADD, dstp, vadd, dstp->vsize, IRF_UNSIGNED), IRF_UNSIGNED);  // dstp += elem_size
+    for (size_t i = 0; i < unroll; ++i)
+      new_ir_store(offset_ptr(dstp, i << elem_vtype), vzero, 0);
+    new_ir_mov(dstp, new_ir_bop(IR_ADD, dstp, vadd, dstp->vsize, IRF_UNSIGNED), IRF_UNSIGNED);  // dstp += elem_size * unroll
     new_ir_mov(vcount, new_ir_bop(IR_SUB, vcount, new_const_vreg(1, vsSize),
                                   vcount->vsize, IRF_UNSIGNED), IRF_UNSIGNED);  // vcount -= 1
     new_ir_cjmp(vcount, new_const_vreg(0, vcount->vsize), COND_NE, loop_bb);
     set_curbb(new_bb());
+
+    // Rest of the elements.
+    for (size_t i = 0; i < count % unroll; ++i)
+      new_ir_store(offset_ptr(dstp, i << elem_vtype), vzero, 0);
   }
 }
 
@@ -347,10 +650,20 @@ extern inline void gen_return(Stmt *stmt) {
       if (retval != NULL) {
         gen_memcpy(val->type, retval, vreg);
         new_ir_result(fnbe->result_dst, retval, IRF_UNSIGNED);  // Pointer is unsigned.
-      } else {
+      } else if (fnbe->result_dst != NULL) {
         // Embedding inline function: lval (struct pointer) is returned.
-        assert(fnbe->result_dst != NULL);
         new_ir_mov(fnbe->result_dst, vreg, IRF_UNSIGNED);
+      } else {
+        // Returned through registers: load all parts before setting any of them.
+        AggregatePart parts[MAX_AGGREGATE_PARTS];
+        VReg *values[MAX_AGGREGATE_PARTS];
+        int n = classify_aggregate(val->type, parts);
+        assert(n > 0);
+        for (int i = 0; i < n; ++i)
+          values[i] = gen_load_part(vreg, &parts[i]);
+        int counts[2] = {0, 0};
+        for (int i = 0; i < n; ++i)
+          new_ir_result(NULL, values[i], 0)->result.index = counts[parts[i].is_flo]++;
       }
     }
   }
@@ -358,9 +671,55 @@ extern inline void gen_return(Stmt *stmt) {
   set_curbb(bb);
 }
 
+// Returns the expected result of the condition given by `__builtin_expect`: 1 or 0,
+// or -1 if unknown. The condition is replaced with the one without the call if possible.
+static int get_expected_cond(Expr **pcond) {
+  static const Name *expect_name;
+  if (expect_name == NULL)
+    expect_name = alloc_name("__builtin_expect", NULL, false);
+
+  Expr *cond = *pcond;
+  if ((cond->kind != EX_EQ && cond->kind != EX_NE) || cond->bop.rhs->kind != EX_FIXNUM)
+    return -1;
+  Expr *call = strip_cast(cond->bop.lhs);
+  if (call->kind != EX_FUNCALL)
+    return -1;
+  Expr *func = call->funcall.func;
+  Vector *args = call->funcall.args;
+  if (func->kind != EX_VAR || !is_global_scope(func->var.scope) ||
+      !equal_name(func->var.name, expect_name) || args->len != 2)
+    return -1;
+  Expr *expected = strip_cast(args->data[1]);
+  if (expected->kind != EX_FIXNUM)
+    return -1;
+
+  if (cond->kind == EX_NE && cond->bop.rhs->fixnum == 0 && call == cond->bop.lhs) {
+    // `__builtin_expect(x, c) != 0` => `x != 0`: Skip widening to long.
+    Expr *value = args->data[0];
+    if (value->kind == EX_CAST && is_fixnum(value->unary.sub->type->kind) &&
+        type_size(value->unary.sub->type) <= type_size(value->type))
+      value = value->unary.sub;
+    *pcond = make_cond(value);
+  }
+
+  bool eq = expected->fixnum == cond->bop.rhs->fixnum;
+  return eq == (cond->kind == EX_EQ);
+}
+
 extern inline void gen_if(Stmt *stmt) {
   BB *tbb = new_bb();
   BB *fbb = new_bb();
+  switch (get_expected_cond(&stmt->if_.cond)) {
+  case 0:
+    tbb->cold = true;
+    break;
+  case 1:
+    // Without else block, `fbb` is the following code, so don't mark it.
+    if (stmt->if_.fblock != NULL)
+      fbb->cold = true;
+    break;
+  default: break;
+  }
   gen_cond_jmp(stmt->if_.cond, tbb, fbb);
   set_curbb(tbb);
   gen_stmt(stmt->if_.tblock);
@@ -375,77 +734,113 @@ extern inline void gen_if(Stmt *stmt) {
   }
 }
 
-static int compare_cases(const void *pa, const void *pb) {
-  Stmt *ca = *(Stmt**)pa;
-  Stmt *cb = *(Stmt**)pb;
-  if (ca->case_.value == NULL)
-    return 1;
-  if (cb->case_.value == NULL)
-    return -1;
-  Fixnum d = ca->case_.value->fixnum - cb->case_.value->fixnum;
-  return d > 0 ? 1 : d < 0 ? -1 : 0;
-}
-
-static void gen_switch_cond_table_jump(Stmt *swtch, VReg *vreg, Stmt **cases, int len, int cond_flag) {
-  Fixnum min = (cases[0])->case_.value->fixnum;
-  Fixnum max = (cases[len - 1])->case_.value->fixnum;
-  Fixnum range = max - min + 1;
-
-  BB **table = malloc_or_die(sizeof(*table) * range);
+static BB *switch_default_bb(Stmt *swtch) {
   Stmt *def = swtch->switch_.default_;
-  BB *skip_bb = def != NULL ? def->case_.bb : swtch->switch_.break_bb;
-  for (Fixnum i = 0; i < range; ++i)
-    table[i] = skip_bb;
-  for (int i = 0; i < len; ++i) {
-    Stmt *c = cases[i];
-    table[c->case_.value->fixnum - min] = c->case_.bb;
-  }
+  return def != NULL ? def->case_.bb : swtch->switch_.break_bb;
+}
 
-  BB *nextbb = new_bb();
+// Subtract the minimum value, and jump to `miss_bb` if the value is out of range.
+static VReg *gen_switch_range_check(VReg *vreg, Fixnum min, Fixnum max, int cond_flag,
+                                    BB *miss_bb) {
   VReg *val = vreg;
   if (min != 0) {
     int flag = (cond_flag & COND_UNSIGNED) ? IRF_UNSIGNED : 0;
     val = new_ir_bop(IR_SUB, vreg, new_const_vreg(min, vreg->vsize), vreg->vsize, flag);
   }
-  new_ir_cjmp(val, new_const_vreg(max - min, val->vsize), COND_GT | COND_UNSIGNED, skip_bb);
+  BB *nextbb = new_bb();
+  new_ir_cjmp(val, new_const_vreg(max - min, val->vsize), COND_GT | COND_UNSIGNED, miss_bb);
   set_curbb(nextbb);
+  return val;
+}
+
+static void gen_switch_table_jump(Stmt *swtch, VReg *vreg, const SwitchCase *cases, int len,
+                                  int cond_flag, BB *miss_bb) {
+  Fixnum min = cases[0].value;
+  Fixnum max = cases[len - 1].value;
+  Fixnum range = max - min + 1;
+
+  BB **table = malloc_or_die(sizeof(*table) * range);
+  BB *default_bb = switch_default_bb(swtch);
+  for (Fixnum i = 0; i < range; ++i)
+    table[i] = default_bb;
+  for (int i = 0; i < len; ++i)
+    table[cases[i].value - min] = cases[i].stmt->case_.bb;
+
+  VReg *val = gen_switch_range_check(vreg, min, max, cond_flag, miss_bb);
   new_ir_tjmp(val, table, range);
 }
 
-static void gen_switch_cond_recur(Stmt *swtch, VReg *vreg, Stmt **cases, int len, int cond_flag) {
-  if (len <= 2) {
-    for (int i = 0; i < len; ++i) {
+static void gen_switch_bit_test(Stmt *swtch, VReg *vreg, const SwitchCase *cases, int len,
+                                int cond_flag, BB *miss_bb) {
+  Fixnum min = cases[0].value;
+  Fixnum max = cases[len - 1].value;
+  VReg *val = gen_switch_range_check(vreg, min, max, cond_flag, miss_bb);
+  // Offset is in range, so test bits in a pointer-size word.
+  const enum VRegSize vsize = VRegSize8;
+  if (val->vsize != vsize) {
+    IR *cast = new_ir_cast(val, vsize, 0);
+    cast->flag |= IRF_UNSIGNED;
+    val = cast->dst;
+  }
+  VReg *bit = new_ir_bop(IR_LSHIFT, new_const_vreg(1, vsize), val, vsize, IRF_UNSIGNED);
+  // Test the mask for each target, in order of appearance.
+  for (int i = 0; i < len; ++i) {
+    Stmt *target = cases[i].target;
+    int j;
+    for (j = 0; j < i; ++j) {
+      if (cases[j].target == target)
+        break;
+    }
+    if (j < i)
+      continue;  // Already tested.
+
+    UFixnum mask = 0;
+    for (j = i; j < len; ++j) {
+      if (cases[j].target == target)
+        mask |= (UFixnum)1 << (cases[j].value - min);
+    }
+    VReg *masked = new_ir_bop(IR_BITAND, bit, new_const_vreg(mask, vsize), vsize, IRF_UNSIGNED);
+    BB *nextbb = new_bb();
+    new_ir_cjmp(masked, new_const_vreg(0, vsize), COND_NE, cases[i].stmt->case_.bb);
+    set_curbb(nextbb);
+  }
+  new_ir_jmp(switch_default_bb(swtch));
+}
+
+// Binary search over clusters, and compare in sequence at the leaves.
+static void gen_switch_clusters(Stmt *swtch, VReg *vreg, const SwitchCase *cases,
+                                const SwitchCluster *clusters, int n, int cond_flag) {
+  if (n <= 3) {
+    for (int i = 0; i < n; ++i) {
+      const SwitchCluster *cluster = &clusters[i];
+      const SwitchCase *p = &cases[cluster->start];
       BB *nextbb = new_bb();
-      Stmt *c = cases[i];
-      VReg *num = new_const_vreg(c->case_.value->fixnum, vreg->vsize);
-      new_ir_cjmp(vreg, num, COND_EQ | cond_flag, c->case_.bb);
+      BB *miss_bb = i < n - 1 ? nextbb : switch_default_bb(swtch);
+      switch (cluster->kind) {
+      case SC_CASE:
+        new_ir_cjmp(vreg, new_const_vreg(p->value, vreg->vsize), COND_EQ | cond_flag,
+                    p->stmt->case_.bb);
+        break;
+      case SC_JUMP_TABLE:
+        gen_switch_table_jump(swtch, vreg, p, cluster->count, cond_flag, miss_bb);
+        break;
+      case SC_BIT_TEST:
+        gen_switch_bit_test(swtch, vreg, p, cluster->count, cond_flag, miss_bb);
+        break;
+      }
       set_curbb(nextbb);
     }
-    Stmt *def = swtch->switch_.default_;
-    new_ir_jmp(def != NULL ? def->case_.bb : swtch->switch_.break_bb);
+    new_ir_jmp(switch_default_bb(swtch));
   } else {
-    Stmt *min = cases[0];
-    Stmt *max = cases[len - 1];
-    Fixnum range = max->case_.value->fixnum - min->case_.value->fixnum + 1;
-    if (range >= 4 && len > (range >> 1)) {
-      gen_switch_cond_table_jump(swtch, vreg, cases, len, cond_flag);
-      return;
-    }
-
-    BB *bbne = new_bb();
-    int m = len >> 1;
-    Stmt *c = cases[m];
-    VReg *num = new_const_vreg(c->case_.value->fixnum, vreg->vsize);
-    new_ir_cjmp(vreg, num, COND_EQ | cond_flag, c->case_.bb);
-    set_curbb(bbne);
-
+    int m = n >> 1;
     BB *bblt = new_bb();
-    BB *bbgt = new_bb();
-    new_ir_cjmp(vreg, num, COND_GT | cond_flag, bbgt);
+    BB *bbge = new_bb();
+    VReg *num = new_const_vreg(cases[clusters[m].start].value, vreg->vsize);
+    new_ir_cjmp(vreg, num, COND_GE | cond_flag, bbge);
     set_curbb(bblt);
-    gen_switch_cond_recur(swtch, vreg, cases, m, cond_flag);
-    set_curbb(bbgt);
-    gen_switch_cond_recur(swtch, vreg, cases + (m + 1), len - (m + 1), cond_flag);
+    gen_switch_clusters(swtch, vreg, cases, clusters, m, cond_flag);
+    set_curbb(bbge);
+    gen_switch_clusters(swtch, vreg, cases, clusters + m, n - m, cond_flag);
   }
 }
 
@@ -453,13 +848,11 @@ static void gen_switch_cond(Stmt *stmt) {
   Expr *value = stmt->switch_.value;
   VReg *vreg = gen_expr(value);
 
-  Vector *cases = stmt->switch_.cases;
-  int len = cases->len;
-
   if (vreg->flag & VRF_CONST) {
+    Vector *cases = stmt->switch_.cases;
     Fixnum value = vreg->fixnum;
     Stmt *target = stmt->switch_.default_;
-    for (int i = 0; i < len; ++i) {
+    for (int i = 0; i < cases->len; ++i) {
       Stmt *c = cases->data[i];
       if (c->case_.value != NULL && c->case_.value->fixnum == value) {
         target = c;
@@ -471,18 +864,18 @@ static void gen_switch_cond(Stmt *stmt) {
     new_ir_jmp(target != NULL ? target->case_.bb : stmt->switch_.break_bb);
     set_curbb(nextbb);
   } else {
+    int len;
+    SwitchCase *cases = sort_switch_cases(stmt, is_unsigned(value->type), &len);
     if (len > 0) {
-      // Sort cases in increasing order.
-      qsort(cases->data, len, sizeof(void*), compare_cases);
-
-      if (stmt->switch_.default_ != NULL)
-        --len;  // Ignore default.
+      SwitchCluster *clusters = malloc_or_die(sizeof(*clusters) * len);
+      int n = cluster_switch_cases(cases, len, TARGET_POINTER_SIZE * TARGET_CHAR_BIT, clusters);
       int cond_flag = is_unsigned(value->type) ? COND_UNSIGNED : 0;
-      gen_switch_cond_recur(stmt, vreg, (Stmt**)cases->data, len, cond_flag);
+      gen_switch_clusters(stmt, vreg, cases, clusters, n, cond_flag);
+      free(clusters);
     } else {
-      Stmt *def = stmt->switch_.default_;
-      new_ir_jmp(def != NULL ? def->case_.bb : stmt->switch_.break_bb);
+      new_ir_jmp(switch_default_bb(stmt));
     }
+    free(cases);
   }
   set_curbb(new_bb());
 }
@@ -550,7 +943,27 @@ static void gen_do_while(Stmt *stmt) {
   pop_break_bb(save_break);
 }
 
+#if ARCH_HAS_VECTOR
+static bool is_vectorizable_op(enum ExprKind kind, const Type *type) {
+  return is_simd_vector_op(kind + (IR_ADD - EX_ADD), type, type->struct_.info->members[0].type);
+}
+#endif
+
 static void gen_for(Stmt *stmt) {
+#if ARCH_HAS_VECTOR
+  Stmt *vectorized = vectorize_loop(stmt, is_vectorizable_op);
+  if (vectorized != NULL) {
+    alloc_scope_variable_registers(vectorized->block.scope);
+    gen_stmt(vectorized);
+    return;
+  }
+#endif
+  Stmt *unrolled = unroll_loop(stmt);
+  if (unrolled != NULL) {
+    gen_stmt(unrolled);
+    return;
+  }
+
   BB *save_break, *save_cont;
   BB *loop_bb = new_bb();
   BB *continue_bb = push_continue_bb(&save_cont);
@@ -671,7 +1084,8 @@ void prepare_register_allocation(Function *func) {
         assert(!is_prim_type(varinfo->type));
         // Whether it is a parameter or local variable defined in a function,
         // it is needed to access relative to base pointer.
-        require_stack_frame = true;
+        if (!(varinfo->local.frameinfo->flag & FIF_PROMOTED))
+          require_stack_frame = true;
         continue;
       }
 
@@ -741,9 +1155,10 @@ void detect_living_registers(RegAlloc *ra, BBContainer *bbcon) {
       // Store living vregs to IR_CALL.
       IR *ir = bb->irs->data[j];
       if (ir->kind == IR_CALL) {
-        // Store it into corresponding precall.
+        // Store it into corresponding precall: only registers broken by the callee need saving.
         IR *ir_precall = ir->call.precall;
-        ir_precall->precall.living_pregs = living_pregs;
+        ir_precall->precall.living_pregs = living_pregs &
+            (ir->call.clobbered_regs | (ir->call.clobbered_fregs << floreg_offset));
       }
 
       // Add activated registers.
@@ -766,6 +1181,38 @@ void detect_living_registers(RegAlloc *ra, BBContainer *bbcon) {
 #undef VREGFOR
 }
 
+bool dump_frame_size;
+
+static size_t local_var_size(VarInfo *varinfo) {
+  Type *type = varinfo->type;
+  size_t size = type_size(type);
+  if (type->kind == TY_STRUCT && type->struct_.info->is_flexible) {
+    Initializer *init = varinfo->local.init;
+    if (init != NULL) {
+      int m = type->struct_.info->member_count;
+      assert(init->kind == IK_MULTI);
+      assert(init->multi->len == m);
+      Initializer *e = init->multi->data[m - 1];
+      if (e != NULL) {
+        assert(e->kind == IK_MULTI);
+        MemberInfo *me = &type->struct_.info->members[m - 1];
+        assert(me->type->kind == TY_ARRAY);
+        size += type_size(me->type->pa.ptrof) * e->multi->len;
+      }
+    }
+  }
+  if (size < 1)
+    size = 1;
+  return size;
+}
+
+// Spill slot which can be shared by vregs whose live intervals are disjoint.
+typedef struct {
+  int size;
+  int offset;
+  int end;  // Live interval end of the last occupant.
+} SpillSlot;
+
 void alloc_stack_variables_onto_stack_frame(Function *func) {
   FuncBackend *fnbe = func->extra;
   assert(fnbe->frame_size == 0);
@@ -782,72 +1229,105 @@ void alloc_stack_variables_onto_stack_frame(Function *func) {
   }
 
   bool require_stack_frame = false;
+  size_t unshared_size = frame_size;  // For statistics.
 
   // Allocate stack variables onto stack frame.
-  for (int i = 0; i < func->scopes->len; ++i) {
+  // Variables in a scope are placed below those of its ancestors,
+  // so sibling scopes (whose lifetimes are disjoint) share the same storage.
+  // Parent scopes come before their children in `func->scopes`.
+  int scope_count = func->scopes->len;
+  size_t *scope_bottoms = ALLOCA(sizeof(*scope_bottoms) * scope_count);
+  size_t base_size = frame_size;
+
+  // A statement expression or an inlined function returning an aggregate gives the address of
+  // its storage, so such scopes (and their descendants) are allocated with the enclosing scope.
+  int *owners = ALLOCA(sizeof(*owners) * scope_count);
+  for (int i = 0; i < scope_count; ++i) {
     Scope *scope = func->scopes->data[i];
-    if (scope->vars == NULL)
-      continue;
+    owners[i] = i;
+    for (int k = i; --k >= 0; ) {
+      if (func->scopes->data[k] == scope->parent) {
+        if (owners[k] != k || vec_contains(fnbe->escaping_scopes, scope))
+          owners[i] = owners[k];
+        break;
+      }
+    }
+  }
 
-    for (int j = 0; j < scope->vars->len; ++j) {
-      VarInfo *varinfo = scope->vars->data[j];
-      if (!is_local_storage(varinfo))
-        continue;
+  for (int i = 0; i < scope_count; ++i) {
+    if (owners[i] != i) {
+      scope_bottoms[i] = scope_bottoms[owners[i]];
+      continue;
+    }
 
-      if (varinfo->storage & VS_PARAM) {
-        assert(is_stack_param(varinfo->type) || varinfo->local.vreg != NULL);
-        if (is_stack_param(varinfo->type)) {
-          FrameInfo *fi = varinfo->local.frameinfo;
-          fi->offset = param_offset = ALIGN(param_offset, align_size(varinfo->type));
-          param_offset += ALIGN(type_size(varinfo->type), TARGET_POINTER_SIZE);
-          require_stack_frame = true;
-          continue;
-        } else if (varinfo->local.vreg->flag & VRF_STACK_PARAM) {
-          FrameInfo *fi = varinfo->local.frameinfo;
-          fi->offset = param_offset = ALIGN(param_offset, TARGET_POINTER_SIZE);
-          param_offset += TARGET_POINTER_SIZE;
-          require_stack_frame = true;
-          continue;
-        }
+    Scope *scope = func->scopes->data[i];
+    size_t bottom = base_size;
+    for (int k = i; --k >= 0; ) {
+      if (func->scopes->data[k] == scope->parent) {
+        bottom = scope_bottoms[k];
+        break;
       }
+    }
 
-      if (is_prim_type(varinfo->type)) {
-        // Primitive type variables are handled according to RegAlloc results in below.
+    for (int s = i; s < scope_count; ++s) {
+      if (owners[s] != i)
         continue;
-      }
+      scope = func->scopes->data[s];
+      if (scope->vars == NULL)
+        continue;
+      for (int j = 0; j < scope->vars->len; ++j) {
+        VarInfo *varinfo = scope->vars->data[j];
+        if (!is_local_storage(varinfo))
+          continue;
 
-      assert(varinfo->local.vreg == NULL);
-      FrameInfo *fi = varinfo->local.frameinfo;
-      assert(fi != NULL);
-
-      Type *type = varinfo->type;
-      size_t size = type_size(type);
-      if (type->kind == TY_STRUCT && type->struct_.info->is_flexible) {
-        Initializer *init = varinfo->local.init;
-        if (init != NULL) {
-          int m = type->struct_.info->member_count;
-          assert(init->kind == IK_MULTI);
-          assert(init->multi->len == m);
-          Initializer *e = init->multi->data[m - 1];
-          if (e != NULL) {
-            assert(e->kind == IK_MULTI);
-            MemberInfo *me = &type->struct_.info->members[m - 1];
-            assert(me->type->kind == TY_ARRAY);
-            size += type_size(me->type->pa.ptrof) * e->multi->len;
+        if (varinfo->storage & VS_PARAM) {
+          assert(is_stack_param(varinfo->type) || varinfo->local.vreg != NULL);
+          if (is_stack_param(varinfo->type) &&
+              !(varinfo->local.frameinfo->flag & FIF_REG_PARAM)) {
+            FrameInfo *fi = varinfo->local.frameinfo;
+            fi->offset = param_offset = ALIGN(param_offset, align_size(varinfo->type));
+            param_offset += ALIGN(type_size(varinfo->type), TARGET_POINTER_SIZE);
+            require_stack_frame = true;
+            continue;
+          } else if (varinfo->local.vreg != NULL && varinfo->local.vreg->flag & VRF_STACK_PARAM) {
+            FrameInfo *fi = varinfo->local.frameinfo;
+            fi->offset = param_offset = ALIGN(param_offset, TARGET_POINTER_SIZE);
+            param_offset += TARGET_POINTER_SIZE;
+            require_stack_frame = true;
+            continue;
           }
         }
-      }
-      if (size < 1)
-        size = 1;
-      size_t align = align_size(type);
 
-      frame_size = ALIGN(frame_size + size, align);
-      fi->offset = -(int)frame_size;
+        if (is_prim_type(varinfo->type)) {
+          // Primitive type variables are handled according to RegAlloc results in below.
+          continue;
+        }
+
+        assert(varinfo->local.vreg == NULL);
+        FrameInfo *fi = varinfo->local.frameinfo;
+        assert(fi != NULL);
+        if (fi->flag & FIF_PROMOTED)
+          continue;  // Replaced with registers.
+
+        size_t size = local_var_size(varinfo);
+        size_t align = align_size(varinfo->type);
+        if (fi->flag & FIF_REG_PARAM)
+          align = MAX(align, TARGET_POINTER_SIZE);  // Parts are stored by the register size.
+        bottom = ALIGN(bottom + size, align);
+        fi->offset = -(int)bottom;
+        unshared_size = ALIGN(unshared_size + size, align);
+      }
     }
+    scope_bottoms[i] = bottom;
+    if (bottom > frame_size)
+      frame_size = bottom;
   }
 
   // Allocate spilled variables onto stack frame.
+  // Address-taken variables are accessed outside of their live intervals,
+  // so only registers spilled by the register allocator share slots.
   RegAlloc *ra = fnbe->ra;
+  Vector *slots = new_vector();
   for (int i = 0; i < ra->vregs->len; ++i) {
     LiveInterval *li = ra->sorted_intervals[i];
     if (li->state != LI_SPILL)
@@ -859,10 +1339,42 @@ void alloc_stack_variables_onto_stack_frame(Function *func) {
 
     int size, align;
     size = align = 1 << vreg->vsize;
+    unshared_size = ALIGN(unshared_size + size, align);
+
+    if (!(vreg->flag & VRF_REF)) {
+      SpillSlot *slot = NULL;
+      for (int j = 0; j < slots->len; ++j) {
+        SpillSlot *p = slots->data[j];
+        if (p->size == size && p->end < li->start) {
+          slot = p;
+          break;
+        }
+      }
+      if (slot != NULL) {
+        slot->end = li->end;
+        vreg->frame.offset = slot->offset;
+        continue;
+      }
+    }
 
     frame_size = ALIGN(frame_size + size, align);
     vreg->frame.offset = -(int)frame_size;
+
+    if (!(vreg->flag & VRF_REF)) {
+      SpillSlot *slot = malloc_or_die(sizeof(*slot));
+      slot->size = size;
+      slot->offset = vreg->frame.offset;
+      slot->end = li->end;
+      vec_push(slots, slot);
+    }
   }
+  for (int i = 0; i < slots->len; ++i)
+    free(slots->data[i]);
+  free_vector(slots);
+
+  if (dump_frame_size)
+    fprintf(stderr, "%.*s: frame size %zu (unshared %zu)\n", NAMES(func->name), frame_size,
+            unshared_size);
 
   fnbe->frame_size = frame_size;
   assert(!(require_stack_frame || frame_size > 0) || (fnbe->ra->flag & RAF_STACK_FRAME));
@@ -888,6 +1400,11 @@ bool gen_defun(Function *func) {
   fnbe->result_dst = NULL;
   fnbe->frame_size = 0;
   fnbe->vaarg_frame_info.offset = 0;  // Calculated in later.
+  fnbe->clobbered_regs = ~0UL;  // Calculated after register allocation.
+  fnbe->clobbered_fregs = ~0UL;
+  fnbe->ra_ordered = false;
+  fnbe->escaping_scopes = new_vector();
+  fnbe->param_parts = new_vector();
 
   fnbe->bbcon = new_func_blocks();
   set_curbb(new_bb());
@@ -904,6 +1421,7 @@ bool gen_defun(Function *func) {
   }
 
   alloc_variable_registers(func);
+  store_aggregate_params(func);
 
   fnbe->ret_bb = new_bb();
 
@@ -919,6 +1437,220 @@ bool gen_defun(Function *func) {
   return true;
 }
 
+// Constant data of globals
+
+typedef struct {
+  unsigned char *data;
+  unsigned char *relocated;  // Non-zero where the value is decided by the linker.
+  size_t pos;
+} ConstImage;
+
+static Table const_images;    // <ConstImage*>
+static Table folded_globals;  // <VarInfo*>
+
+static void const_image_align(void *ud, int align) {
+  ConstImage *image = ud;
+  image->pos = ALIGN(image->pos, (size_t)align);
+}
+
+static void const_image_number(void *ud, const Type *type, Expr *var, int64_t offset) {
+  ConstImage *image = ud;
+  size_t size = type_size(type);
+  // Every target is little endian.
+  for (size_t i = 0; i < size; ++i) {
+    image->data[image->pos + i] = (UFixnum)offset >> (i * CHAR_BIT);
+    image->relocated[image->pos + i] = var != NULL;
+  }
+  image->pos += size;
+}
+
+static void const_image_string(void *ud, Expr *str, size_t size) {
+  ConstImage *image = ud;
+  size_t src_size = str->str.len * type_size(str->type->pa.ptrof);
+  memcpy(&image->data[image->pos], str->str.buf, MIN(src_size, size));
+  image->pos += size;
+}
+
+// Reads `size` bytes at `offset` from a global which is never modified.
+bool read_const_global(const Name *label, int64_t offset, int size, int64_t *pvalue) {
+  static const ConstructInitialValueVTable kVtable = {
+    .emit_align = const_image_align,
+    .emit_number = const_image_number,
+    .emit_string = const_image_string,
+  };
+
+  VarInfo *varinfo = scope_find(global_scope, label, NULL);
+  if (varinfo == NULL || (varinfo->storage & (VS_EXTERN | VS_ENUM_MEMBER | VS_TYPEDEF)) ||
+      varinfo->type->kind == TY_FUNC || varinfo->global.init == NULL ||
+      (varinfo->type->qualifier & (TQ_CONST | TQ_VOLATILE)) != TQ_CONST)
+    return false;
+  size_t var_size = type_size(varinfo->type);
+  if (offset < 0 || (size_t)offset + size > var_size)
+    return false;
+
+  ConstImage *image = table_get(&const_images, label);
+  if (image == NULL) {
+    image = malloc_or_die(sizeof(*image));
+    image->data = calloc_or_die(var_size);
+    image->relocated = calloc_or_die(var_size);
+    image->pos = 0;
+    construct_initial_value(varinfo->type, varinfo->global.init, &kVtable, image);
+    table_put(&const_images, label, image);
+  }
+
+  UFixnum value = 0;
+  for (int i = size; --i >= 0; ) {
+    if (image->relocated[offset + i])
+      return false;
+    value = value << CHAR_BIT | image->data[offset + i];
+  }
+  *pvalue = value;
+  table_put(&folded_globals, label, varinfo);
+  return true;
+}
+
+static void refer_initial_value(void *ud, const Type *type, Expr *var, int64_t offset) {
+  UNUSED(type);
+  UNUSED(offset);
+  if (var == NULL)
+    return;
+  Scope *scope;
+  VarInfo *varinfo = scope_find(var->var.scope, var->var.name, &scope);
+  if (varinfo != NULL && !is_global_scope(scope) && (varinfo->storage & VS_STATIC))
+    varinfo = varinfo->static_.gvar;
+  if (varinfo != NULL)
+    table_put(ud, varinfo->name, varinfo);
+}
+
+static void refer_nothing_align(void *ud, int align) {
+  UNUSED(ud);
+  UNUSED(align);
+}
+
+static void refer_nothing_string(void *ud, Expr *str, size_t size) {
+  UNUSED(ud);
+  UNUSED(str);
+  UNUSED(size);
+}
+
+// Static globals whose loads are all folded into constants need not be emitted.
+static void remove_folded_globals(Vector *decls, Vector *funcs) {
+  static const ConstructInitialValueVTable kVtable = {
+    .emit_align = refer_nothing_align,
+    .emit_number = refer_initial_value,
+    .emit_string = refer_nothing_string,
+  };
+
+  if (folded_globals.count == 0)
+    return;
+  for (int i = 0; i < decls->len; ++i) {
+    Declaration *decl = decls->data[i];
+    if (decl != NULL && decl->kind == DCL_ASM)
+      return;  // Might refer to any symbol.
+  }
+
+  Table referred;
+  table_init(&referred);
+  for (int i = 0; i < funcs->len; ++i) {
+    Function *func = funcs->data[i];
+    FuncBackend *fnbe = func->extra;
+    BBContainer *bbcon = fnbe->bbcon;
+    for (int j = 0; j < bbcon->len; ++j) {
+      BB *bb = bbcon->data[j];
+      for (int k = 0; k < bb->irs->len; ++k) {
+        IR *ir = bb->irs->data[k];
+        switch (ir->kind) {
+        case IR_IOFS:
+          table_put(&referred, ir->iofs.label, NULL);
+          break;
+        case IR_CALL:
+          if (ir->call.label != NULL)
+            table_put(&referred, ir->call.label, NULL);
+          break;
+        case IR_ASM:
+          return;
+        default: break;
+        }
+      }
+    }
+  }
+  Vector *gvars = global_scope->vars;
+  for (int i = 0; i < gvars->len; ++i) {
+    VarInfo *varinfo = gvars->data[i];
+    if (!(varinfo->storage & (VS_EXTERN | VS_ENUM_MEMBER | VS_TYPEDEF)) &&
+        varinfo->type->kind != TY_FUNC && varinfo->global.init != NULL)
+      construct_initial_value(varinfo->type, varinfo->global.init, &kVtable, &referred);
+  }
+
+  for (int i = gvars->len; --i >= 0; ) {
+    VarInfo *varinfo = gvars->data[i];
+    if ((varinfo->storage & VS_STATIC) && table_try_get(&folded_globals, varinfo->name, NULL) &&
+        !table_try_get(&referred, varinfo->name, NULL))
+      vec_remove_at(gvars, i);
+  }
+}
+
+// Returns the callee if it is a function in this unit which cannot be replaced at link time,
+// so its register usage is reliable.
+static Function *get_local_callee(IR *ir) {
+  assert(ir->kind == IR_CALL);
+  if (ir->call.label == NULL || ir->call.global)
+    return NULL;
+  VarInfo *varinfo = scope_find(global_scope, ir->call.label, NULL);
+  if (varinfo == NULL || varinfo->type->kind != TY_FUNC || !(varinfo->storage & VS_STATIC))
+    return NULL;
+  Function *func = varinfo->global.func;
+  if (func == NULL || func->extra == NULL || func->type->func.vaargs ||
+      is_weak_attr(func->attributes))
+    return NULL;
+  return func;
+}
+
+// Registers broken by the function, seen from its callers:
+// allocated registers, registers used implicitly and those broken by its callees.
+static void detect_clobbered_registers(Function *func) {
+  FuncBackend *fnbe = func->extra;
+  RegAlloc *ra = fnbe->ra;
+  const RegAllocSettings *settings = ra->settings;
+  const unsigned long iunsaved = REG_BIT_RANGE(0, settings->phys_temporary_count) |
+                                 settings->caller_save_bits;
+  const unsigned long funsaved = REG_BIT_RANGE(0, settings->fphys_temporary_count) |
+                                 settings->fcaller_save_bits;
+  if (func->type->func.vaargs)
+    return;
+
+  // Return value is put into the first register.
+  unsigned long iclobbered = ra->used_reg_bits | 1UL;
+  unsigned long fclobbered = ra->used_freg_bits | 1UL;
+  BBContainer *bbcon = fnbe->bbcon;
+  for (int i = 0; i < bbcon->len; ++i) {
+    BB *bb = bbcon->data[i];
+    for (int j = 0; j < bb->irs->len; ++j) {
+      IR *ir = bb->irs->data[j];
+      switch (ir->kind) {
+      case IR_CALL:
+        iclobbered |= ir->call.clobbered_regs;
+        fclobbered |= ir->call.clobbered_fregs;
+        break;
+      case IR_RESULT:
+        if (ir->dst == NULL) {
+          if (ir->opr1->flag & VRF_FLONUM)
+            fclobbered |= 1UL << ir->result.index;
+          else
+            iclobbered |= 1UL << settings->reg_result_mapping[ir->result.index];
+        }
+        break;
+      case IR_ASM:
+        return;
+      default: break;
+      }
+      iclobbered |= (*settings->detect_extra_occupied)(ra, ir);
+    }
+  }
+  fnbe->clobbered_regs = iclobbered & iunsaved;
+  fnbe->clobbered_fregs = fclobbered & funsaved;
+}
+
 extern inline void gen_defun_after(Function *func) {
   FuncBackend *fnbe = func->extra;
   curfunc = func;
@@ -929,40 +1661,84 @@ extern inline void gen_defun_after(Function *func) {
   tweak_irs(fnbe);
   analyze_reg_flow(fnbe->bbcon);
 
+  // Callees in this unit are already allocated, so calls break only their registers.
+  // Also detect whether the function makes a call at all: builtins and inlined calls
+  // leave no CALL, and the function can stay a leaf.
+  BBContainer *bbcon = fnbe->bbcon;
+  func->flag &= ~FUNCF_HAS_FUNCALL;
+  for (int i = 0; i < bbcon->len; ++i) {
+    BB *bb = bbcon->data[i];
+    for (int j = 0; j < bb->irs->len; ++j) {
+      IR *ir = bb->irs->data[j];
+      Function *callee;
+      if (ir->kind == IR_CALL)
+        func->flag |= FUNCF_HAS_FUNCALL;
+      if (ir->kind == IR_CALL && (callee = get_local_callee(ir)) != NULL) {
+        FuncBackend *callee_fnbe = callee->extra;
+        ir->call.clobbered_regs = callee_fnbe->clobbered_regs;
+        ir->call.clobbered_fregs = callee_fnbe->clobbered_fregs;
+      }
+    }
+  }
+
   alloc_physical_registers(fnbe->ra, fnbe->bbcon);
   map_virtual_to_physical_registers(fnbe->ra);
   detect_living_registers(fnbe->ra, fnbe->bbcon);
+  detect_clobbered_registers(func);
 
   alloc_stack_variables_onto_stack_frame(func);
 
   curfunc = NULL;
 }
 
-static void gen_decl(Declaration *decl) {
-  if (decl == NULL)
+// Allocate registers for callees before their caller (bottom-up on the call graph).
+// Functions in a cycle see each other as unknown callees.
+static void gen_defun_after_callees_first(Function *func) {
+  FuncBackend *fnbe = func->extra;
+  if (fnbe->ra_ordered)
     return;
+  fnbe->ra_ordered = true;
 
-  switch (decl->kind) {
-  case DCL_DEFUN:
-    {
-      Function *func = decl->defun.func;
-      if (gen_defun(func))
-        gen_defun_after(func);
+  BBContainer *bbcon = fnbe->bbcon;
+  for (int i = 0; i < bbcon->len; ++i) {
+    BB *bb = bbcon->data[i];
+    for (int j = 0; j < bb->irs->len; ++j) {
+      IR *ir = bb->irs->data[j];
+      Function *callee;
+      if (ir->kind == IR_CALL && (callee = get_local_callee(ir)) != NULL)
+        gen_defun_after_callees_first(callee);
     }
-    break;
-  case DCL_ASM:
-    break;
   }
+
+  gen_defun_after(func);
 }
 
 void gen(Vector *decls) {
   if (decls == NULL)
     return;
 
+  // Generate IRs for all functions first, to know the call graph.
+  Vector *funcs = new_vector();
   for (int i = 0, len = decls->len; i < len; ++i) {
     Declaration *decl = decls->data[i];
     if (decl == NULL)
       continue;
-    gen_decl(decl);
+
+    switch (decl->kind) {
+    case DCL_DEFUN:
+      {
+        Function *func = decl->defun.func;
+        if (gen_defun(func))
+          vec_push(funcs, func);
+      }
+      break;
+    case DCL_ASM:
+      break;
+    }
   }
+
+  for (int i = 0; i < funcs->len; ++i)
+    gen_defun_after_callees_first(funcs->data[i]);
+  remove_folded_globals(decls, funcs);
+  free_vector(funcs);
 }
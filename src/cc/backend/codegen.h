@@ -4,12 +4,14 @@
 
 #include <stdbool.h>
 #include <stddef.h>  // size_t
+#include <stdint.h>  // int64_t
 
 #include "ir.h"  // enum VRegSize
 
 typedef struct BB BB;
 typedef struct Expr Expr;
 typedef struct Function Function;
+typedef struct Name Name;
 typedef struct RegAlloc RegAlloc;
 typedef struct Stmt Stmt;
 typedef struct StructInfo StructInfo;
@@ -21,6 +23,7 @@ typedef struct Vector Vector;
 // Public
 
 void gen(Vector *decls);
+bool read_const_global(const Name *label, int64_t offset, int size, int64_t *pvalue);
 
 // Private
 
@@ -34,6 +37,7 @@ enum VRegSize to_vsize(const Type *type);
 int to_vflag(const Type *type);
 
 bool is_stack_param(const Type *type);
+int classify_aggregate(const Type *type, AggregatePart parts[MAX_AGGREGATE_PARTS]);
 
 void gen_stmt(struct Stmt *stmt);
 VReg *gen_stmts(Vector *stmts);
@@ -45,6 +49,10 @@ void add_builtin_function(const char *str, Type *type, BuiltinFunctionProc *proc
 
 void gen_clear_local_var(const VarInfo *varinfo);
 void gen_memcpy(const Type *type, VReg *dst, VReg *src);
+void gen_memcpy_inline(const Type *type, VReg *dst, VReg *src);
+void gen_vector_op(enum IrKind kind, const Type *type, VReg *dst, VReg *lhs, VReg *rhs);
+VReg *gen_load_part(VReg *addr, const AggregatePart *part);
+void gen_store_part(VReg *addr, const AggregatePart *part, VReg *vreg);
 
 typedef struct {
   const Type *type;
@@ -60,6 +68,7 @@ bool gen_defun(Function *func);
 void prepare_register_allocation(Function *func);
 void map_virtual_to_physical_registers(RegAlloc *ra);
 void detect_living_registers(RegAlloc *ra, BBContainer *bbcon);
+extern bool dump_frame_size;  // Report frame size of each function to stderr.
 void alloc_stack_variables_onto_stack_frame(Function *func);
 
 int calculate_func_param_bottom(Function *func);
@@ -3,6 +3,7 @@
 
 #include <assert.h>
 #include <stdlib.h>  // malloc
+#include <string.h>  // memcpy
 
 #include "arch_config.h"
 #include "ast.h"
@@ -18,6 +19,131 @@ bool is_stack_param(const Type *type) {
   return type->kind == TY_STRUCT;
 }
 
+typedef struct {
+  const Type *type;
+  size_t offset;
+} ScalarMember;
+
+#define MAX_SCALAR_MEMBERS  (16)
+
+// Collects scalar members of the aggregate in memory order, returns -1 if too many.
+static int flatten_scalar_members(const Type *type, size_t offset, ScalarMember *members, int n,
+                                  bool *has_union) {
+  switch (type->kind) {
+  case TY_ARRAY:
+    {
+      size_t elem_size = type_size(type->pa.ptrof);
+      for (ssize_t i = 0; i < type->pa.length && n >= 0; ++i)
+        n = flatten_scalar_members(type->pa.ptrof, offset + i * elem_size, members, n, has_union);
+    }
+    return n;
+  case TY_STRUCT:
+    {
+      const StructInfo *sinfo = type->struct_.info;
+      if (sinfo->is_union)
+        *has_union = true;
+      for (int i = 0; i < sinfo->member_count && n >= 0; ++i) {
+        const MemberInfo *minfo = &sinfo->members[i];
+        n = flatten_scalar_members(minfo->type, offset + minfo->offset, members, n, has_union);
+      }
+    }
+    return n;
+  default:
+    if (n >= MAX_SCALAR_MEMBERS)
+      return -1;
+    members[n].type = type;
+    members[n].offset = offset;
+    return n + 1;
+  }
+}
+
+// Classifies the aggregate into registers according to the platform ABI,
+// returns the number of registers, or 0 if it is passed through memory.
+int classify_aggregate(const Type *type, AggregatePart parts[MAX_AGGREGATE_PARTS]) {
+  if (type->kind != TY_STRUCT)
+    return 0;
+  const StructInfo *sinfo = type->struct_.info;
+  size_t size = type_size(type);
+  if (size == 0 || size > 16 || sinfo->is_flexible)
+    return 0;
+  if (sinfo->is_vector) {
+#if XCC_TARGET_ARCH == XCC_ARCH_X64 || XCC_TARGET_ARCH == XCC_ARCH_AARCH64
+    // Short vector goes to a single floating-point register as a whole.
+    if (size == 8 || size == 16) {
+      parts[0].offset = 0;
+      parts[0].size = size;
+      parts[0].is_flo = true;
+      return 1;
+    }
+#endif
+    return 0;
+  }
+
+  ScalarMember members[MAX_SCALAR_MEMBERS];
+  bool has_union = false;
+  int n = flatten_scalar_members(type, 0, members, 0, &has_union);
+  if (n <= 0)
+    return 0;
+
+#if XCC_TARGET_ARCH == XCC_ARCH_X64
+  // System V: each eightbyte goes to an SSE register if it consists of floating-point numbers.
+  UNUSED(has_union);
+  int count = (size + 7) / 8;
+  for (int i = 0; i < count; ++i) {
+    size_t start = i * 8;
+    bool flo = true;
+    for (int j = 0; j < n; ++j) {
+      const ScalarMember *m = &members[j];
+      if (m->offset < start + 8 && m->offset + type_size(m->type) > start && !is_flonum(m->type))
+        flo = false;
+    }
+    parts[i].offset = start;
+    parts[i].size = MIN(size - start, 8);
+    parts[i].is_flo = flo;
+  }
+  return count;
+#else
+# if XCC_TARGET_ARCH == XCC_ARCH_AARCH64
+  // AAPCS64: homogeneous floating-point aggregate goes to floating-point registers.
+  if (!has_union && n <= MAX_AGGREGATE_PARTS) {
+    int j;
+    for (j = 0; j < n; ++j) {
+      if (!is_flonum(members[j].type) || type_size(members[j].type) != type_size(members[0].type))
+        break;
+    }
+    if (j >= n) {
+      for (j = 0; j < n; ++j) {
+        parts[j].offset = members[j].offset;
+        parts[j].size = type_size(members[j].type);
+        parts[j].is_flo = true;
+      }
+      return n;
+    }
+  }
+# elif XCC_TARGET_ARCH == XCC_ARCH_RISCV64
+  // LP64D: one or two members including a floating-point number go to each register class.
+  if (!has_union && n <= 2 && (is_flonum(members[0].type) || is_flonum(members[n - 1].type))) {
+    for (int j = 0; j < n; ++j) {
+      parts[j].offset = members[j].offset;
+      parts[j].size = type_size(members[j].type);
+      parts[j].is_flo = is_flonum(members[j].type);
+    }
+    return n;
+  }
+# else
+  UNUSED(has_union);
+# endif
+  // Otherwise integer registers for each 8 bytes.
+  int count = (size + 7) / 8;
+  for (int i = 0; i < count; ++i) {
+    parts[i].offset = i * 8;
+    parts[i].size = MIN(size - i * 8, 8);
+    parts[i].is_flo = false;
+  }
+  return count;
+#endif
+}
+
 enum VRegSize to_vsize(const Type *type) {
   const int MAX_REG_SIZE = 8;
   assert(is_prim_type(type));
@@ -250,6 +376,21 @@ static VReg *gen_lval(Expr *expr) {
   return gen_ref_sub(reduce_refer(expr));
 }
 
+// Access to volatile object must not be removed or reordered by the optimizer.
+static int volatile_flag(const Expr *expr) {
+  for (;;) {
+    if (expr->type->qualifier & TQ_VOLATILE)
+      return IRF_VOLATILE;
+    if (expr->kind != EX_MEMBER)
+      return 0;
+    // Member of volatile struct.
+    const Type *type = expr->member.target->type;
+    if (type->kind == TY_PTR)
+      return type->pa.ptrof->qualifier & TQ_VOLATILE ? IRF_VOLATILE : 0;
+    expr = expr->member.target;
+  }
+}
+
 static VReg *gen_variable(Expr *expr) {
   switch (expr->type->kind) {
   case TY_FIXNUM:
@@ -265,7 +406,7 @@ static VReg *gen_variable(Expr *expr) {
       }
 
       VReg *vreg = gen_lval(expr);
-      int irflag = is_unsigned(expr->type) ? IRF_UNSIGNED : 0;
+      int irflag = (is_unsigned(expr->type) ? IRF_UNSIGNED : 0) | volatile_flag(expr);
       VReg *result = new_ir_load(vreg, to_vsize(expr->type), to_vflag(expr->type), irflag);
       return result;
     }
@@ -308,6 +449,17 @@ static VReg *gen_ternary(Expr *expr) {
   return result;
 }
 
+// Temporary variable on the stack frame, to hold a struct value.
+static VarInfo *add_tmp_frame_var(Type *type) {
+  const Name *name = alloc_label();
+  VarInfo *varinfo = scope_add(curscope, name, type, 0);
+  FrameInfo *fi = malloc_or_die(sizeof(*fi));
+  fi->offset = 0;
+  fi->flag = 0;
+  varinfo->local.frameinfo = fi;
+  return varinfo;
+}
+
 static VReg *gen_funcall(Expr *expr) {
   Expr *func = expr->funcall.func;
   if (func->kind == EX_VAR && is_global_scope(func->var.scope)) {
@@ -319,19 +471,28 @@ static VReg *gen_funcall(Expr *expr) {
   assert(functype != NULL);
 
   VarInfo *ret_varinfo = NULL;  // Return value is on the stack.
+  VarInfo *ret_frame_var = NULL;  // Return value through registers, stored to the frame.
+  AggregatePart ret_parts[MAX_AGGREGATE_PARTS];
+  int ret_part_count = 0;
   if (is_stack_param(expr->type)) {
-    const Name *name = alloc_label();
-    Type *type = expr->type;
-    ret_varinfo = scope_add(curscope, name, type, 0);
-    FrameInfo *fi = malloc_or_die(sizeof(*fi));
-    fi->offset = 0;
-    ret_varinfo->local.frameinfo = fi;
+    ret_part_count = classify_aggregate(expr->type, ret_parts);
+    if (ret_part_count == 0) {
+      ret_varinfo = add_tmp_frame_var(expr->type);
+    } else {
+      // Registers are stored as a whole, so round up the size and align.
+      size_t count = (type_size(expr->type) + TARGET_POINTER_SIZE - 1) / TARGET_POINTER_SIZE;
+      ret_frame_var = add_tmp_frame_var(arrayof(&tySize, count));
+    }
   }
 
   typedef struct {
     int reg_index;
+    int freg_index;  // Start of floating-point registers, for aggregate.
+    int vreg_index;  // Index in `arg_vregs`.
     int offset;
     int size;
+    int part_count;  // Aggregate through registers.
+    AggregatePart parts[MAX_AGGREGATE_PARTS];
     bool stack_arg;
     bool is_flo;
 #if VAARG_FP_AS_GP
@@ -347,6 +508,8 @@ static VReg *gen_funcall(Expr *expr) {
   int offset = 0;
   Vector *args = expr->funcall.args;
   int arg_count = args->len;
+  int total_arg_count = arg_start;
+  int vaarg_start = -1;
   {
     int ireg_index = arg_start;
     int freg_index = 0;
@@ -356,23 +519,54 @@ static VReg *gen_funcall(Expr *expr) {
     for (int i = 0; i < arg_count; ++i) {
       ArgInfo *p = &arg_infos[i];
       p->reg_index = -1;
+      p->freg_index = -1;
       p->offset = -1;
+      p->part_count = 0;
       Expr *arg = args->data[i];
       assert(arg->type->kind != TY_ARRAY);
+      bool vaarg = functype->func.vaargs && functype->func.params != NULL &&
+                   i >= functype->func.params->len;
+      if (vaarg && vaarg_start < 0)
+        vaarg_start = total_arg_count;
       p->size = type_size(arg->type);
       p->is_flo = is_flonum(arg->type);
 #if VAARG_FP_AS_GP
       p->fp_as_gp = false;
-      if (functype->func.vaargs && functype->func.params != NULL && i >= functype->func.params->len) {
+      if (vaarg) {
         p->is_flo = false;
         p->fp_as_gp = true;
       }
 #endif
       p->stack_arg = is_stack_param(arg->type);
 #if VAARG_ON_STACK
-      if (functype->func.vaargs && functype->func.params != NULL && i >= functype->func.params->len)
+      if (vaarg)
         p->stack_arg = true;
 #endif
+      if (p->stack_arg && !vaarg) {
+        // Aggregate is passed through registers if all of its parts fit.
+        int n = classify_aggregate(arg->type, p->parts);
+        int icount = 0, fcount = 0;
+        for (int j = 0; j < n; ++j) {
+          if (p->parts[j].is_flo)
+            ++fcount;
+          else
+            ++icount;
+        }
+        if (n > 0 && ireg_index + icount <= MAX_REG_ARGS && freg_index + fcount <= MAX_FREG_ARGS) {
+          p->stack_arg = false;
+          p->part_count = n;
+          p->reg_index = ireg_index;
+          p->freg_index = freg_index;
+          p->vreg_index = total_arg_count;
+          ireg_index += icount;
+          freg_index += fcount;
+          reg_arg_count += icount;
+          freg_arg_count += fcount;
+          total_arg_count += n;
+          continue;
+        }
+      }
+      p->vreg_index = total_arg_count++;
       if (p->stack_arg || (p->is_flo ? freg_index >= MAX_FREG_ARGS : ireg_index >= MAX_REG_ARGS)) {
         offset = ALIGN(offset, align_size(arg->type));
         p->offset = offset;
@@ -388,32 +582,39 @@ static VReg *gen_funcall(Expr *expr) {
         }
       }
     }
+    if (functype->func.vaargs && functype->func.params != NULL && vaarg_start < 0)
+      vaarg_start = total_arg_count;
   }
 
-  IR *precall = new_ir_precall(arg_count - stack_arg_count, offset);
+  IR *precall = new_ir_precall(reg_arg_count + freg_arg_count, offset);
 
-  int total_arg_count = arg_count + (ret_varinfo != NULL ? 1 : 0);
   VReg **arg_vregs = total_arg_count == 0 ? NULL : calloc_or_die(total_arg_count * sizeof(*arg_vregs));
 
   {
     // Register arguments.
-    int iregarg = 0;
-    int fregarg = 0;
     for (int i = arg_count; --i >= 0; ) {
       Expr *arg = args->data[i];
       VReg *vreg = gen_expr(arg);
       const ArgInfo *p = &arg_infos[i];
+      if (p->part_count > 0) {
+        int iindex = p->reg_index, findex = p->freg_index;
+        for (int j = 0; j < p->part_count; ++j) {
+          const AggregatePart *part = &p->parts[j];
+          VReg *value = gen_load_part(vreg, part);
+          int index = part->is_flo ? findex++ : iindex++;
+          assert(index < (part->is_flo ? MAX_FREG_ARGS : MAX_REG_ARGS));
+          new_ir_pusharg(value, index);
+          arg_vregs[p->vreg_index + j] = value;
+        }
+        continue;
+      }
       if (p->offset < 0) {
         if (p->is_flo) {
-          ++fregarg;
-          int index = freg_arg_count - fregarg;
-          assert(index < MAX_FREG_ARGS);
-          new_ir_pusharg(vreg, index);
+          assert(p->reg_index < MAX_FREG_ARGS);
+          new_ir_pusharg(vreg, p->reg_index);
         } else {
-          ++iregarg;
-          int index = reg_arg_count - iregarg + arg_start;
-          assert(index < MAX_REG_ARGS);
-          IR *ir = new_ir_pusharg(vreg, index);
+          assert(p->reg_index < MAX_REG_ARGS);
+          IR *ir = new_ir_pusharg(vreg, p->reg_index);
 #if !VAARG_FP_AS_GP
           UNUSED(ir);
 #else
@@ -426,13 +627,13 @@ static VReg *gen_funcall(Expr *expr) {
         int ofs = p->offset;
         VReg *dst = new_ir_sofs(new_const_vreg(ofs, offset_type));
         if (is_stack_param(arg->type)) {
-          gen_memcpy(arg->type, dst, vreg);
+          gen_memcpy_inline(arg->type, dst, vreg);
         } else {
           int flag = is_unsigned(arg->type) ? IRF_UNSIGNED : 0;
           new_ir_store(dst, vreg, flag);
         }
       }
-      arg_vregs[i + arg_start] = vreg;
+      arg_vregs[p->vreg_index] = vreg;
     }
   }
   if (ret_varinfo != NULL) {
@@ -453,14 +654,12 @@ static VReg *gen_funcall(Expr *expr) {
 
   VReg *result_reg = NULL;
   {
-    int vaarg_start = !functype->func.vaargs || functype->func.params == NULL ? -1 :
-        functype->func.params->len + (ret_varinfo != NULL ? 1 : 0);
     Type *type = expr->type;
     if (ret_varinfo != NULL)
       type = ptrof(type);
     enum VRegSize ret_vsize = -1;
     int ret_vflag = 0;
-    if (type->kind != TY_VOID) {
+    if (type->kind != TY_VOID && ret_frame_var == NULL) {
       ret_vsize = to_vsize(type);
       ret_vflag = to_vflag(type);
     }
@@ -473,6 +672,44 @@ static VReg *gen_funcall(Expr *expr) {
       result_reg = new_ir_call(NULL, false, freg, total_arg_count, reg_arg_count + freg_arg_count,
                                ret_vsize, ret_vflag, precall, arg_vregs, vaarg_start);
     }
+
+    if (ret_frame_var != NULL) {
+      // The call stores the result registers into the frame.
+      IR *call = curbb->irs->data[curbb->irs->len - 1];
+      assert(call->kind == IR_CALL);
+      AggregatePart *parts = malloc_or_die(sizeof(*parts) * ret_part_count);
+      memcpy(parts, ret_parts, sizeof(*parts) * ret_part_count);
+      call->call.result_frame = ret_frame_var->local.frameinfo;
+      call->call.result_parts = parts;
+      call->call.result_part_count = ret_part_count;
+      result_reg = new_ir_bofs(ret_frame_var->local.frameinfo);
+    }
+  }
+
+  if (func->kind == EX_VAR && is_global_scope(func->var.scope)) {
+    VarInfo *varinfo = scope_find(func->var.scope, func->var.name, NULL);
+    Declaration *decl = varinfo != NULL ? varinfo->global.funcdecl : NULL;
+    int funcflag = decl != NULL ? decl->defun.func->flag : 0;
+    // Calling noreturn or cold function is unlikely, e.g. error handling.
+    if (funcflag & (FUNCF_NORETURN | FUNCF_COLD))
+      curbb->cold = true;
+    if (funcflag & FUNCF_NORETURN) {
+      for (int i = curbb->irs->len; --i >= 0; ) {
+        IR *call = curbb->irs->data[i];
+        if (call->kind == IR_CALL) {
+          call->flag |= IRF_NORETURN;
+          break;
+        }
+      }
+    }
+
+    // Mark the call to allow the optimizer to remove or share it.
+    if (label_call && funcflag & (FUNCF_PURE | FUNCF_CONST) && result_reg != NULL &&
+        ret_varinfo == NULL && ret_frame_var == NULL && stack_arg_count == 0) {
+      IR *call = curbb->irs->data[curbb->irs->len - 1];
+      assert(call->kind == IR_CALL);
+      call->flag |= funcflag & FUNCF_CONST ? IRF_CONST : IRF_PURE;
+    }
   }
 
   return result_reg;
@@ -485,6 +722,11 @@ static VReg *gen_arith(enum ExprKind kind, const Type *type, VReg *lhs, VReg *rh
 }
 
 static VReg *gen_block_expr(Expr *expr) {
+  Scope *scope = expr->block->block.scope;
+  if (scope != NULL && expr->type->kind != TY_VOID && !is_prim_type(expr->type)) {
+    FuncBackend *fnbe = curfunc->extra;
+    vec_push(fnbe->escaping_scopes, scope);
+  }
   return gen_block(expr->block);
 }
 
@@ -528,7 +770,7 @@ static VReg *gen_deref(Expr *expr) {
   VReg *vreg = gen_expr(expr->unary.sub);
   // array, struct and func values are handled as a pointer.
   if (is_prim_type(expr->type)) {
-    int irflag = is_unsigned(expr->type) ? IRF_UNSIGNED : 0;
+    int irflag = (is_unsigned(expr->type) ? IRF_UNSIGNED : 0) | volatile_flag(expr);
     vreg = new_ir_load(vreg, to_vsize(expr->type), to_vflag(expr->type), irflag);
   }
   return vreg;
@@ -549,7 +791,7 @@ static VReg *gen_member(Expr *expr) {
   VReg *vreg = gen_lval(expr);
   VReg *result = vreg;
   if (is_prim_type(expr->type)) {
-    int irflag = is_unsigned(expr->type) ? IRF_UNSIGNED : 0;
+    int irflag = (is_unsigned(expr->type) ? IRF_UNSIGNED : 0) | volatile_flag(expr);
     result = new_ir_load(vreg, to_vsize(expr->type), to_vflag(expr->type), irflag);
   }
   return result;
@@ -583,7 +825,7 @@ static VReg *gen_assign_sub(Expr *lhs, Expr *rhs) {
   case TY_PTR:
   case TY_FLONUM:
     {
-      int flag = is_unsigned(rhs->type) ? IRF_UNSIGNED : 0;
+      int flag = (is_unsigned(rhs->type) ? IRF_UNSIGNED : 0) | volatile_flag(lhs);
       new_ir_store(dst, src, flag);
     }
     break;
@@ -628,7 +870,7 @@ static VReg *gen_expr_incdec(Expr *expr) {
     }
   } else {
     lval = gen_lval(target);
-    val = new_ir_load(lval, vsize, to_vflag(expr->type), flag);
+    val = new_ir_load(lval, vsize, to_vflag(expr->type), flag | volatile_flag(target));
     if (IS_POST(expr))
       before = val;
   }
@@ -640,7 +882,7 @@ static VReg *gen_expr_incdec(Expr *expr) {
       new_const_vreg(expr->type->kind == TY_PTR ? type_size(expr->type->pa.ptrof) : 1, vsize);
   VReg *after = new_ir_bop(kOpAddSub[IS_DEC(expr)], val, addend, vsize, flag);
   if (varinfo != NULL)  new_ir_mov(varinfo->local.vreg, after, flag);
-  else                  new_ir_store(lval, after, flag);
+  else                  new_ir_store(lval, after, flag | volatile_flag(target));
   return before != NULL ? before : after;
 #undef IS_POST
 #undef IS_DEC
@@ -687,7 +929,20 @@ static VReg *gen_expr_logandor(Expr *expr) {
   return result;
 }
 
+static VReg *gen_vector_bop(Expr *expr) {
+  // Vector value is handled as a pointer, as struct: calculate into a temporary on the stack.
+  VReg *lhs = gen_expr(expr->bop.lhs);
+  VReg *rhs = gen_expr(expr->bop.rhs);
+  VarInfo *varinfo = add_tmp_frame_var(expr->type);
+  varinfo->local.frameinfo->flag |= FIF_PROMOTABLE;  // Kept in a register unless it escapes.
+  VReg *dst = new_ir_bofs(varinfo->local.frameinfo);
+  gen_vector_op(expr->kind + (IR_ADD - EX_ADD), expr->type, dst, lhs, rhs);
+  return dst;
+}
+
 static VReg *gen_expr_bop(Expr *expr) {
+  if (is_vector(expr->type))
+    return gen_vector_bop(expr);
   VReg *lhs = gen_expr(expr->bop.lhs);
   VReg *rhs = gen_expr(expr->bop.rhs);
   return gen_arith(expr->kind, expr->type, lhs, rhs);
@@ -742,6 +997,7 @@ static VReg *gen_inlined(Expr *expr) {
     if (!is_prim_type(rettype)) {
       // Receive as its pointer.
       rettype = ptrof(rettype);
+      vec_push(fnbe->escaping_scopes, top_scope);
     }
     fnbe->result_dst = dst = add_new_vreg(rettype);
   }
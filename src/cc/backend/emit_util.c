@@ -2,10 +2,12 @@
 #include "emit_util.h"
 
 #include <assert.h>
+#include <ctype.h>  // isalnum
 #include <inttypes.h>  // PRId64
 #include <stdarg.h>
 #include <stdint.h>  // int64_t
 #include <stdlib.h>  // realloc
+#include <string.h>  // strcmp
 
 #include "ast.h"
 #include "cc_misc.h"
@@ -134,6 +136,43 @@ void emit_align_p2(int align) {
   fprintf(emit_fp, "\t.p2align %d\n", most_significant_bit(align));
 }
 
+// Function being emitted into its own section, with `-ffunction-sections`.
+static const Name *section_funcname;
+// Text section for the function: `.text`, or `.text.hot`/`.text.unlikely` for hot/cold one.
+static const char *section_text = ".text";
+
+// Switch to `<prefix>.<name>` section, unless the name cannot be a section name.
+static bool emit_symbol_section(const char *prefix, const Name *name, const char *flags, const char *type) {
+#if XCC_TARGET_PLATFORM == XCC_PLATFORM_APPLE
+  UNUSED(prefix);
+  UNUSED(name);
+  UNUSED(flags);
+  UNUSED(type);
+  return false;
+#else
+  for (int i = 0; i < (int)name->bytes; ++i) {
+    unsigned char c = name->chars[i];
+    if (!(isalnum(c) || c == '_' || c == '.'))
+      return false;
+  }
+  EMIT_ASM(".section", fmt("%s.%.*s", prefix, NAMES(name)), flags, type);
+  return true;
+#endif
+}
+
+void emit_text_section(void) {
+  if (section_funcname != NULL &&
+      emit_symbol_section(section_text, section_funcname, "\"ax\"", "@progbits"))
+    return;
+#if XCC_TARGET_PLATFORM != XCC_PLATFORM_APPLE
+  if (strcmp(section_text, ".text") != 0) {
+    EMIT_ASM(".section", section_text, "\"ax\"", "@progbits");
+    return;
+  }
+#endif
+  EMIT_ASM(".text");
+}
+
 void emit_comm(const char *label, size_t size, size_t align) {
 #if XCC_TARGET_PLATFORM == XCC_PLATFORM_APPLE
   // p2align on macOS.
@@ -153,7 +192,11 @@ void init_emit(FILE *fp) {
 }
 
 bool function_not_returned(FuncBackend *fnbe) {
-  BB *bb = fnbe->bbcon->data[fnbe->bbcon->len - 1];
+  // The epilogue follows the end of the first fall-through chain, cold BBs are placed after it.
+  BBContainer *bbcon = fnbe->bbcon;
+  BB *bb = bbcon->data[0];
+  for (int i = 1; bb->next != NULL; ++i)
+    bb = bbcon->data[i];
   if (bb->irs->len > 0) {
     IR *ir = bb->irs->data[bb->irs->len - 1];
     if (ir->kind == IR_JMP && ir->jmp.cond == COND_ANY && ir->jmp.bb != NULL) {
@@ -239,14 +282,19 @@ static void emit_varinfo(const VarInfo *varinfo, const Initializer *init) {
   };
 
   const Name *name = varinfo->name;
+  size_t align = MAX(align_size(varinfo->type), varinfo->global.align);
   if (init != NULL) {
-    if (varinfo->type->qualifier & TQ_CONST)
-      _RODATA();
-    else
-      _DATA();
+    if (varinfo->type->qualifier & TQ_CONST) {
+      if (!cc_flags.data_sections || !emit_symbol_section(".rodata", name, "\"a\"", "@progbits"))
+        _RODATA();
+    } else {
+      if (!cc_flags.data_sections || !emit_symbol_section(".data", name, "\"aw\"", "@progbits"))
+        _DATA();
+    }
   } else {
     if (!cc_flags.common) {
-      _BSS();
+      if (!cc_flags.data_sections || !emit_symbol_section(".bss", name, "\"aw\"", "@nobits"))
+        _BSS();
     }
   }
 
@@ -263,7 +311,7 @@ static void emit_varinfo(const VarInfo *varinfo, const Initializer *init) {
 #endif
 
   if (init != NULL) {
-    EMIT_ALIGN(align_size(varinfo->type));
+    EMIT_ALIGN(align);
     EMIT_LABEL(label);
     construct_initial_value(varinfo->type, init, &kVtable, NULL);
   } else {
@@ -271,11 +319,10 @@ static void emit_varinfo(const VarInfo *varinfo, const Initializer *init) {
     if (size < 1)
       size = 1;
 
-    size_t align = align_size(varinfo->type);
     if (cc_flags.common) {
       _COMM(label, size, align);
     } else {
-      EMIT_ALIGN(align_size(varinfo->type));
+      EMIT_ALIGN(align);
       EMIT_LABEL(label);
       _ZERO(num(size));
     }
@@ -383,7 +430,16 @@ void emit_code(Vector *decls) {
 
     switch (decl->kind) {
     case DCL_DEFUN:
-      emit_defun(decl->defun.func);
+      {
+        Function *func = decl->defun.func;
+        section_text = (func->flag & FUNCF_HOT) ? ".text.hot"
+                       : (func->flag & FUNCF_COLD) ? ".text.unlikely" : ".text";
+        if (cc_flags.function_sections)
+          section_funcname = func->name;
+        emit_defun(func);
+        section_funcname = NULL;
+        section_text = ".text";
+      }
       break;
     case DCL_ASM:
       emit_asm(decl->asmstr);
@@ -45,6 +45,7 @@ void emit_asm4(const char *op, const char *a1, const char *a2, const char *a3, c
 void emit_align_p2(int align);
 void emit_comment(const char *comment, ...);
 void emit_comm(const char *label, size_t size, size_t align);
+void emit_text_section(void);
 
 bool function_not_returned(FuncBackend *fnbe);
 
@@ -58,7 +59,7 @@ bool function_not_returned(FuncBackend *fnbe);
 #define _ASCII(x)      EMIT_ASM(".ascii", x)
 #define _STRING(x)     EMIT_ASM(".string", x)
 #define _SECTION(x)    EMIT_ASM(".section", x)
-#define _TEXT()        EMIT_ASM(".text")
+#define _TEXT()        emit_text_section()
 #define _DATA()        EMIT_ASM(".data")
 #define _BSS()         EMIT_ASM(".bss")
 #define _ZERO(x)       EMIT_ASM(".zero", x)
@@ -92,9 +92,9 @@ VReg *new_ir_bop(enum IrKind kind, VReg *opr1, VReg *opr2, enum VRegSize vsize,
           break;
         case IR_MOD:
           if (flag & IRF_UNSIGNED)
-            value = (uint64_t)opr1->fixnum / (uint64_t)opr2->fixnum;
+            value = (uint64_t)opr1->fixnum % (uint64_t)opr2->fixnum;
           else
-            value = opr1->fixnum / opr2->fixnum;
+            value = opr1->fixnum % opr2->fixnum;
           break;
         default: assert(false); break;
         }
@@ -189,6 +189,37 @@ VReg *new_ir_bop(enum IrKind kind, VReg *opr1, VReg *opr2, enum VRegSize vsize,
   return dst;
 }
 
+int64_t calc_bit_op(enum IrKind kind, uint64_t value, enum VRegSize vsize) {
+  int bits = 8 << vsize;
+  if (bits < 64)
+    value &= (1ULL << bits) - 1;
+  int n = 0;
+  switch (kind) {
+  case IR_POPCNT:
+    for (; value != 0; value &= value - 1)
+      ++n;
+    return n;
+  case IR_CLZ:
+    for (n = bits; value != 0; value >>= 1)
+      --n;
+    return n;
+  case IR_CTZ:
+    if (value == 0)
+      return bits;
+    for (; !(value & 1); value >>= 1)
+      ++n;
+    return n;
+  case IR_BSWAP:
+    {
+      uint64_t swapped = 0;
+      for (; n < bits; n += 8, value >>= 8)
+        swapped = (swapped << 8) | (value & 0xff);
+      return swapped;
+    }
+  default: assert(false); return 0;
+  }
+}
+
 VReg *new_ir_unary(enum IrKind kind, VReg *opr, enum VRegSize vsize, int flag) {
   assert(kind != IR_LOAD);
   if (opr->flag & VRF_CONST) {
@@ -196,6 +227,9 @@ VReg *new_ir_unary(enum IrKind kind, VReg *opr, enum VRegSize vsize, int flag) {
     switch (kind) {
     case IR_NEG:     value = -opr->fixnum; break;
     case IR_BITNOT:  value = ~opr->fixnum; break;
+    case IR_POPCNT: case IR_CLZ: case IR_CTZ: case IR_BSWAP:
+      value = calc_bit_op(kind, opr->fixnum, vsize);
+      break;
     default: assert(false); break;
     }
     return new_const_vreg(wrap_value(value, 1 << vsize, (flag & IRF_UNSIGNED) != 0), vsize);
@@ -210,6 +244,9 @@ VReg *new_ir_load(VReg *opr, enum VRegSize vsize, int vflag, int irflag) {
   IR *ir = new_ir(IR_LOAD);
   ir->opr1 = opr;
   ir->flag = irflag;
+  ir->mem.index = NULL;
+  ir->mem.offset = 0;
+  ir->mem.scale = 0;
   return ir->dst = reg_alloc_spawn(curra, vsize, vflag);
 }
 
@@ -240,6 +277,20 @@ void new_ir_store(VReg *dst, VReg *src, int flag) {
   ir->opr1 = src;
   ir->opr2 = dst;  // `dst` is used by indirect, so it is not actually `dst`.
   ir->flag = flag;
+  ir->mem.index = NULL;
+  ir->mem.offset = 0;
+  ir->mem.scale = 0;
+}
+
+VReg *new_ir_vop(enum IrKind kind, VReg *opr1, VReg *opr2, enum VRegSize elem, int vflag) {
+  assert(opr1->vsize == VRegSize16 && opr2->vsize == VRegSize16);
+  IR *ir = new_ir(IR_VOP);
+  ir->opr1 = opr1;
+  ir->opr2 = opr2;
+  ir->vop.kind = kind;
+  ir->vop.elem = elem;
+  ir->vop.vflag = vflag;
+  return ir->dst = reg_alloc_spawn(curra, VRegSize16, VRF_FLONUM);
 }
 
 VReg *new_ir_cond(VReg *opr1, VReg *opr2, enum ConditionKind cond) {
@@ -250,6 +301,18 @@ VReg *new_ir_cond(VReg *opr1, VReg *opr2, enum ConditionKind cond) {
   return ir->dst = reg_alloc_spawn(curra, vtBool, 0);
 }
 
+IR *new_ir_select(VReg *dst, VReg *opr1, VReg *opr2, enum ConditionKind cond, VReg *tval,
+                  VReg *fval) {
+  IR *ir = new_ir(IR_SELECT);
+  ir->dst = dst;
+  ir->opr1 = opr1;
+  ir->opr2 = opr2;
+  ir->select.tval = tval;
+  ir->select.fval = fval;
+  ir->select.cond = cond;
+  return ir;
+}
+
 IR *new_ir_jmp(BB *bb) {
   IR *ir = new_ir(IR_JMP);
   ir->jmp.bb = bb;
@@ -308,14 +371,21 @@ VReg *new_ir_call(const Name *label, bool global, VReg *freg, int total_arg_coun
   ir->call.total_arg_count = total_arg_count;
   ir->call.reg_arg_count = reg_arg_count;
   ir->call.vaarg_start = vaarg_start;
+  ir->call.clobbered_regs = ~0UL;
+  ir->call.clobbered_fregs = ~0UL;
+  ir->call.result_frame = NULL;
+  ir->call.result_parts = NULL;
+  ir->call.result_part_count = 0;
   return ir->dst = result_size < 0 ? NULL : reg_alloc_spawn(curra, result_size, result_flag);
 }
 
-void new_ir_result(VReg *dst, VReg *vreg, int flag) {
+IR *new_ir_result(VReg *dst, VReg *vreg, int flag) {
   IR *ir = new_ir(IR_RESULT);
   ir->dst = dst;
   ir->opr1 = vreg;
   ir->flag = flag;
+  ir->result.index = 0;
+  return ir;
 }
 
 void new_ir_subsp(VReg *value, VReg *dst) {
@@ -382,6 +452,7 @@ BB *new_bb(void) {
   bb->out_regs = new_vector();
   bb->assigned_regs = new_vector();
   bb->phis = NULL;
+  bb->cold = false;
   return bb;
 }
 
@@ -499,8 +570,14 @@ void analyze_reg_flow(BBContainer *bbcon) {
     Vector *irs = bb->irs;
     for (int j = 0; j < irs->len; ++j) {
       IR *ir = irs->data[j];
-      VReg *vregs[] = {ir->opr1, ir->opr2};
-      for (int k = 0; k < 2; ++k) {
+      VReg *vregs[] = {ir->opr1, ir->opr2, NULL, NULL};
+      if (ir->kind == IR_LOAD || ir->kind == IR_STORE) {
+        vregs[2] = ir->mem.index;
+      } else if (ir->kind == IR_SELECT) {
+        vregs[2] = ir->select.tval;
+        vregs[3] = ir->select.fval;
+      }
+      for (int k = 0; k < 4; ++k) {
         VReg *vreg = vregs[k];
         if (vreg == NULL || vreg->flag & VRF_CONST)
           continue;
@@ -14,8 +14,22 @@ typedef struct Vector Vector;
 
 typedef struct FrameInfo {
   int offset;
+  int flag;
 } FrameInfo;
 
+#define FIF_PROMOTABLE  (1 << 0)  // Neither volatile nor a stack-passed aggregate: can be registers
+#define FIF_PROMOTED    (1 << 1)  // Replaced with registers, so needs no stack slot
+#define FIF_REG_PARAM   (1 << 2)  // Aggregate parameter passed through registers, kept in the frame
+
+// Aggregate passed or returned through registers (platform ABI): each part occupies a register.
+#define MAX_AGGREGATE_PARTS  (4)
+
+typedef struct {
+  int offset;
+  int size;     // 1~8, might not be a power of 2 for integer, or 16 for a short vector.
+  bool is_flo;  // Floating-point register?
+} AggregatePart;
+
 // Virtual register
 
 enum VRegSize {
@@ -23,6 +37,7 @@ enum VRegSize {
   VRegSize2,
   VRegSize4,
   VRegSize8,
+  VRegSize16,  // Short vector in a floating-point register.
 };
 
 #define VRF_PARAM     (1 << 0)  // Function parameter
@@ -30,6 +45,7 @@ enum VRegSize {
 #define VRF_CONST     (1 << 2)  // Constant
 #define VRF_SPILLED   (1 << 3)  // Spilled
 #define VRF_NO_SPILL  (1 << 4)  // No Spill
+#define VRF_RESTRICT  (1 << 5)  // `restrict` pointer parameter
 #define VRF_FLONUM    (1 << 6)  // Floating-point register?
 #define VRF_UNUSED    (1 << 9)  // Unused
 #define VRF_STACK_PARAM (1 << 10)  // Function parameter, but through stack (spilled by default, so no regalloc needed)
@@ -63,10 +79,11 @@ enum IrKind {
   IR_BOFS,    // dst = [rbp + offset]
   IR_IOFS,    // dst = [rip + label]
   IR_SOFS,    // dst = [rsp + opr1(offset)]
-  IR_LOAD,    // dst = [opr1]
+  IR_LOAD,    // dst = [opr1 + (mem.index << mem.scale) + mem.offset]
   IR_LOAD_S,  // dst = [opr1(spilled)]
-  IR_STORE,   // [opr2] = opr1
+  IR_STORE,   // [opr2 + (mem.index << mem.scale) + mem.offset] = opr1
   IR_STORE_S, // [opr2(spilled)] = opr1
+  IR_VOP,     // dst = opr1 @@ opr2  (128bit vector in floating-point registers, element-wise vop.kind)
   IR_ADD,     // dst = opr1 + opr2
   IR_SUB,
   IR_MUL,
@@ -77,15 +94,21 @@ enum IrKind {
   IR_BITXOR,
   IR_LSHIFT,
   IR_RSHIFT,
+  IR_MULHI,   // dst = upper half of (opr1 * opr2)  (64bit only)
   IR_NEG,
   IR_BITNOT,
+  IR_POPCNT,  // dst = number of 1 bits in opr1
+  IR_CLZ,     // dst = number of leading 0 bits in opr1  (opr1 != 0)
+  IR_CTZ,     // dst = number of trailing 0 bits in opr1  (opr1 != 0)
+  IR_BSWAP,   // dst = opr1 in reversed byte order
   IR_COND,    // dst <- (opr1 @@ opr2) ? 1 : 0
+  IR_SELECT,  // dst <- (opr1 @@ opr2) ? select.tval : select.fval
   IR_JMP,     // Non conditional jump, or conditional jmp (opr1 @@ opr2)
   IR_TJMP,    // Table jump (opr1).  opr2 is NULL, but it might be used to keep temporary vreg.
   IR_PRECALL, // Prepare for call
   IR_PUSHARG,
   IR_CALL,    // Call label or opr1
-  IR_RESULT,  // retval = opr1  (Or mov to dst if set)
+  IR_RESULT,  // retval[result.index] = opr1  (Or mov to dst if set)
   IR_SUBSP,   // RSP -= value
   IR_CAST,    // dst <- opr1
   IR_MOV,     // dst = opr1
@@ -114,7 +137,14 @@ enum {
 enum ConditionKind swap_cond(enum ConditionKind cond);
 enum ConditionKind invert_cond(enum ConditionKind cond);
 
+// Calculate POPCNT, CLZ, CTZ or BSWAP for a constant.
+int64_t calc_bit_op(enum IrKind kind, uint64_t value, enum VRegSize vsize);
+
 #define IRF_UNSIGNED  (1 << 0)
+#define IRF_PURE      (1 << 1)  // CALL: No side effects, result depends on arguments and memory.
+#define IRF_CONST     (1 << 2)  // CALL: No side effects, result depends only on arguments.
+#define IRF_VOLATILE  (1 << 3)  // LOAD, STORE: Access to volatile object, must be kept as is.
+#define IRF_NORETURN  (1 << 4)  // CALL: Never returns.
 
 typedef struct IR {
   enum IrKind kind;
@@ -124,6 +154,11 @@ typedef struct IR {
   VReg *opr2;
 
   union {
+    struct {
+      VReg *index;  // NULL if no index.
+      int64_t offset;
+      int scale;
+    } mem;
     struct {
       FrameInfo *frameinfo;
       int64_t offset;
@@ -136,6 +171,11 @@ typedef struct IR {
     struct {
       enum ConditionKind kind;
     } cond;
+    struct {
+      VReg *tval;
+      VReg *fval;
+      enum ConditionKind cond;
+    } select;
     struct {
       BB *bb;
       enum ConditionKind cond;
@@ -165,10 +205,25 @@ typedef struct IR {
       int reg_arg_count;
       int vaarg_start;
       bool global;
+      // Registers broken by the callee: all caller-save registers unless known.
+      unsigned long clobbered_regs;
+      unsigned long clobbered_fregs;
+      // Aggregate result through registers: stored into `result_frame` right after the call.
+      FrameInfo *result_frame;
+      const AggregatePart *result_parts;
+      int result_part_count;
     } call;
+    struct {
+      int index;  // Index of the result register, counted in each register class.
+    } result;
     struct {
       const char *str;
     } asm_;
+    struct {
+      enum IrKind kind;  // IR_ADD, IR_SUB, IR_MUL, IR_DIV, IR_BITAND, IR_BITOR or IR_BITXOR
+      enum VRegSize elem;
+      int vflag;         // VRF_FLONUM for floating-point lanes.
+    } vop;
   };
 } IR;
 
@@ -189,7 +244,10 @@ VReg *new_ir_bofs(FrameInfo *fi);
 VReg *new_ir_iofs(const Name *label, bool global);
 VReg *new_ir_sofs(VReg *src);
 void new_ir_store(VReg *dst, VReg *src, int flag);
+VReg *new_ir_vop(enum IrKind kind, VReg *opr1, VReg *opr2, enum VRegSize elem, int vflag);
 VReg *new_ir_cond(VReg *opr1, VReg *opr2, enum ConditionKind cond);
+IR *new_ir_select(VReg *dst, VReg *opr1, VReg *opr2, enum ConditionKind cond, VReg *tval,
+                  VReg *fval);
 IR *new_ir_jmp(BB *bb);  // Non-conditional jump
 void new_ir_cjmp(VReg *opr1, VReg *opr2, enum ConditionKind cond, BB *bb);  // Conditional jump
 void new_ir_tjmp(VReg *val, BB **bbs, size_t len);
@@ -198,7 +256,7 @@ IR *new_ir_pusharg(VReg *vreg, int index);
 VReg *new_ir_call(const Name *label, bool global, VReg *freg, int total_arg_count,
                   int reg_arg_count, enum VRegSize result_size, int result_flag, IR *precall,
                   VReg **args, int vaarg_start);
-void new_ir_result(VReg *dst, VReg *vreg, int flag);
+IR *new_ir_result(VReg *dst, VReg *vreg, int flag);
 void new_ir_subsp(VReg *value, VReg *dst);
 IR *new_ir_cast(VReg *vreg, enum VRegSize dstsize, int vflag);
 IR *new_ir_keep(VReg *dst, VReg *opr1, VReg *opr2);
@@ -224,6 +282,7 @@ typedef struct BB {
   Vector *out_regs;  // <VReg*>
   Vector *assigned_regs;  // <VReg*>
   Vector *phis;
+  bool cold;  // Hint: unlikely to be executed.
 } BB;
 
 extern BB *curbb;
@@ -239,7 +298,8 @@ void analyze_reg_flow(BBContainer *bbcon);
 int push_callee_save_regs(unsigned long used, unsigned long fused);
 void pop_callee_save_regs(unsigned long used, unsigned long fused);
 
-void emit_bb_irs(BBContainer *bbcon);
+// Emits BBs from `start` until the fall-through chain ends, and returns the index of the next.
+int emit_bb_irs(BBContainer *bbcon, int start);
 
 // Function info for backend
 
@@ -251,6 +311,12 @@ typedef struct FuncBackend {
   VReg *result_dst;
   size_t frame_size;
   FrameInfo vaarg_frame_info;  // Used for va_start.
+  // Registers which are not preserved by this function, for its callers in the same unit.
+  unsigned long clobbered_regs;
+  unsigned long clobbered_fregs;
+  bool ra_ordered;  // Visited in the callee-first ordering.
+  Vector *escaping_scopes;  // <Scope*>: Scopes whose aggregate value is used after leaving.
+  Vector *param_parts;  // <VReg*>: Registers of aggregate parameters with FIF_REG_PARAM, in order.
 } FuncBackend;
 
 //
@@ -258,3 +324,4 @@ typedef struct FuncBackend {
 extern const RegAllocSettings kArchRegAllocSettings;
 
 void tweak_irs(FuncBackend *fnbe);
+bool is_legal_mem_operand(IR *ir, bool indexed, int scale, int64_t offset);
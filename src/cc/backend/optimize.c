@@ -3,8 +3,10 @@
 
 #include <assert.h>
 #include <limits.h>
+#include <stdint.h>  // intptr_t
 #include <stdlib.h>  // free
 
+#include "codegen.h"  // read_const_global
 #include "ir.h"
 #include "regalloc.h"
 #include "ssa.h"
@@ -129,12 +131,341 @@ static void remove_unnecessary_bb(BBContainer *bbcon) {
   }
 }
 
+// Basic block layout
+
+// Returns the BB which `bb` falls through into, or NULL.
+static BB *fallthrough_bb(BB *bb) {
+  IR *ir = is_last_any_jmp(bb);
+  if (ir != NULL || is_last_jtable(bb) != NULL)
+    return NULL;
+  return bb->next;
+}
+
+static int bb_index(Table *indices, BB *bb) {
+  void *index;
+  if (!table_try_get(indices, bb->label, &index))
+    assert(false);
+  return (int)(intptr_t)index;
+}
+
+// Whether all successors of `bb` are unlikely.
+static bool successors_unlikely(BB *bb, Table *indices, const bool *unlikely) {
+  int count = 0;
+  IR *ir = is_last_jmp(bb);
+  if (ir != NULL) {
+    if (!unlikely[bb_index(indices, ir->jmp.bb)])
+      return false;
+    ++count;
+  }
+  IR *tjmp = is_last_jtable(bb);
+  if (tjmp != NULL) {
+    for (size_t j = 0; j < tjmp->tjmp.len; ++j) {
+      if (!unlikely[bb_index(indices, tjmp->tjmp.bbs[j])])
+        return false;
+      ++count;
+    }
+  }
+  BB *next = fallthrough_bb(bb);
+  if (next != NULL) {
+    if (!unlikely[bb_index(indices, next)])
+      return false;
+    ++count;
+  }
+  return count > 0;
+}
+
+// Whether `bb` is reached only from unlikely BBs.
+static bool predecessors_unlikely(BB *bb, Table *indices, const bool *unlikely) {
+  Vector *from_bbs = bb->from_bbs;
+  if (from_bbs->len == 0)
+    return false;
+  for (int i = 0; i < from_bbs->len; ++i) {
+    if (!unlikely[bb_index(indices, from_bbs->data[i])])
+      return false;
+  }
+  return true;
+}
+
+// Estimate unlikely BBs with static heuristics:
+//   * BBs marked as cold by the code generator (e.g. calling noreturn function),
+//   * BBs which lead only to, or are reached only from, cold BBs,
+//   * early return from within a loop.
+static bool *detect_unlikely_bbs(BBContainer *bbcon, Table *indices) {
+  int count = bbcon->len;
+  bool *unlikely = calloc_or_die(sizeof(*unlikely) * count);
+  for (int i = 0; i < count; ++i) {
+    BB *bb = bbcon->data[i];
+    unlikely[i] = bb->cold;
+  }
+
+  // Entry and return BBs are never moved.
+  for (bool again = true; again; ) {
+    again = false;
+    for (int i = 1; i < count - 1; ++i) {
+      BB *bb = bbcon->data[i];
+      if (!unlikely[i] && (successors_unlikely(bb, indices, unlikely) ||
+                           predecessors_unlikely(bb, indices, unlikely))) {
+        unlikely[i] = again = true;
+      }
+    }
+  }
+
+  // Loop depth: loops are laid out in source order, so a jump backward closes a loop.
+  int *depth = calloc_or_die(sizeof(*depth) * count);
+  for (int i = 0; i < count; ++i) {
+    BB *bb = bbcon->data[i];
+    IR *ir = is_last_jmp(bb);
+    int j;
+    if (ir != NULL && (j = bb_index(indices, ir->jmp.bb)) <= i) {
+      for (int k = j; k <= i; ++k)
+        ++depth[k];
+    }
+  }
+  BB *ret_bb = bbcon->data[count - 1];
+  for (int i = 1; i < count - 1; ++i) {
+    BB *bb = bbcon->data[i];
+    IR *ir = is_last_any_jmp(bb);
+    if (depth[i] > 0 && ir != NULL && ir->jmp.bb == ret_bb)
+      unlikely[i] = true;
+  }
+  free(depth);
+
+  return unlikely;
+}
+
+static bool ends_with_noreturn_call(BB *bb) {
+  for (int i = bb->irs->len; --i >= 0; ) {
+    IR *ir = bb->irs->data[i];
+    if (ir->kind == IR_CALL)
+      return (ir->flag & IRF_NORETURN) != 0;
+  }
+  return false;
+}
+
+// Move unlikely BBs after the return BB, so that likely paths are chained
+// with fall-throughs into the epilogue.
+static void layout_basic_blocks(BBContainer *bbcon) {
+  int count = bbcon->len;
+  if (count <= 2)
+    return;
+
+  detect_from_bbs(bbcon);
+  Table indices;
+  table_init(&indices);
+  for (int i = 0; i < count; ++i) {
+    BB *bb = bbcon->data[i];
+    table_put(&indices, bb->label, (void*)(intptr_t)i);
+  }
+  bool *unlikely = detect_unlikely_bbs(bbcon, &indices);
+
+  // BBs between precall and call must be emitted in order, because the stack pointer is moved.
+  // So group them into a unit with its preceding BB, and move them only as a whole.
+  int *unit_start = malloc_or_die(sizeof(*unit_start) * count);
+  int nest = 0;
+  for (int i = 0; i < count; ++i) {
+    BB *bb = bbcon->data[i];
+    unit_start[i] = nest > 0 ? unit_start[i - 1] : i;
+    for (int j = 0; j < bb->irs->len; ++j) {
+      IR *ir = bb->irs->data[j];
+      if (ir->kind == IR_PRECALL)
+        ++nest;
+      else if (ir->kind == IR_CALL)
+        --nest;
+    }
+  }
+  for (int s = 0, e; s < count; s = e) {
+    bool all = s > 0;
+    for (e = s; e < count && unit_start[e] == s; ++e)
+      all = all && unlikely[e];
+    if (!all || e >= count) {
+      for (int j = s; j < e; ++j)
+        unlikely[j] = false;
+    }
+  }
+
+  Vector *moved = new_vector();
+  BB **fallthroughs = malloc_or_die(sizeof(*fallthroughs) * count);
+  int n = 0;
+  for (int i = 0; i < count; ++i) {
+    BB *bb = bbcon->data[i];
+    fallthroughs[i] = fallthrough_bb(bb);
+    if (unlikely[i])
+      vec_push(moved, bb);
+    else
+      bbcon->data[n++] = bb;
+  }
+
+  if (moved->len > 0) {
+    // The fall-through chain ends at the return BB, and the moved BBs make another one.
+    int ret_index = n - 1;
+    for (int i = 0; i < moved->len; ++i)
+      bbcon->data[n++] = moved->data[i];
+    assert(n == count);
+
+    for (int i = 0; i < count; ++i) {
+      BB *bb = bbcon->data[i];
+      bb->next = i < count - 1 && i != ret_index ? bbcon->data[i + 1] : NULL;
+    }
+
+    // Keep the original fall-through destinations.
+    assert(curbb == NULL);
+    for (int i = 0; i < bbcon->len; ++i) {
+      BB *bb = bbcon->data[i];
+      void *index;
+      BB *dst;
+      if (!table_try_get(&indices, bb->label, &index) ||
+          (dst = fallthroughs[(intptr_t)index]) == NULL || dst == bb->next ||
+          ends_with_noreturn_call(bb))
+        continue;
+      IR *ir = is_last_jmp(bb);
+      if (ir == NULL) {
+        curbb = bb;
+      } else if (ir->jmp.bb == bb->next && !(ir->jmp.cond & COND_FLONUM)) {
+        ir->jmp.cond = invert_cond(ir->jmp.cond);
+        ir->jmp.bb = dst;
+        continue;
+      } else {
+        // JMP must be the last IR, so put another BB to jump.
+        curbb = new_bb();
+        curbb->next = bb->next;
+        bb->next = curbb;
+        vec_insert(bbcon, ++i, curbb);
+      }
+      new_ir_jmp(dst);
+      curbb = NULL;
+    }
+
+    // Remove jmp to next instruction.
+    for (int i = 0; i < bbcon->len - 1; ++i) {
+      BB *bb = bbcon->data[i];
+      IR *ir = is_last_any_jmp(bb);
+      if (ir != NULL && ir->jmp.bb == bb->next)
+        vec_pop(bb->irs);
+    }
+  }
+
+  free(fallthroughs);
+  free_vector(moved);
+  free(unit_start);
+  free(unlikely);
+}
+
 //
 
+// Remove PRECALL, PUSHARGs and CALL of a call at `icall`, keeping argument calculations.
+// Returns the index where the CALL was, or -1 if PRECALL is not in the same BB.
+static int remove_call_sequence(BB *bb, int icall) {
+  Vector *irs = bb->irs;
+  IR *call = irs->data[icall];
+  assert(call->kind == IR_CALL);
+  int iprecall;
+  for (iprecall = icall; --iprecall >= 0; ) {
+    if (irs->data[iprecall] == call->call.precall)
+      break;
+  }
+  if (iprecall < 0)
+    return -1;
+
+  // PUSHARGs for nested calls are surrounded by their PRECALL and CALL.
+  int depth = 0;
+  for (int i = icall; --i > iprecall; ) {
+    IR *ir = irs->data[i];
+    switch (ir->kind) {
+    case IR_CALL:     ++depth; break;
+    case IR_PRECALL:  --depth; break;
+    case IR_PUSHARG:
+      if (depth == 0) {
+        vec_remove_at(irs, i);
+        --icall;
+      }
+      break;
+    default: break;
+    }
+  }
+  vec_remove_at(irs, icall);
+  vec_remove_at(irs, iprecall);
+  return icall - 1;
+}
+
+static bool is_same_call_arg(VReg *a, VReg *b) {
+  if (a == b)
+    return true;
+  return (a->flag & b->flag & VRF_CONST) && a->fixnum == b->fixnum && a->vsize == b->vsize;
+}
+
+static bool may_write_memory(IR *ir) {
+  switch (ir->kind) {
+  case IR_STORE: case IR_STORE_S: case IR_ASM:
+    return true;
+  case IR_CALL:
+    return !(ir->flag & (IRF_PURE | IRF_CONST));
+  default:
+    return false;
+  }
+}
+
+// Share the result of `pure` or `const` function calls with same arguments in a BB.
+static void share_pure_calls(BBContainer *bbcon) {
+  for (int i = 0; i < bbcon->len; ++i) {
+    BB *bb = bbcon->data[i];
+    Vector *irs = bb->irs;
+    for (int j = 0; j < irs->len; ++j) {
+      IR *ir = irs->data[j];
+      if (ir->kind != IR_CALL || !(ir->flag & (IRF_PURE | IRF_CONST)) || ir->dst == NULL)
+        continue;
+
+      VReg **args = ir->call.args;
+      int arg_count = ir->call.total_arg_count;
+      IR *prev = NULL;
+      for (int k = j; --k >= 0; ) {
+        IR *p = irs->data[k];
+        if (p->kind == IR_CALL && p->call.label == ir->call.label &&
+            (p->flag & (IRF_PURE | IRF_CONST)) == (ir->flag & (IRF_PURE | IRF_CONST)) &&
+            p->dst != NULL && p->dst->vsize == ir->dst->vsize &&
+            p->call.total_arg_count == arg_count) {
+          int l;
+          for (l = 0; l < arg_count; ++l) {
+            if (!is_same_call_arg(p->call.args[l], args[l]))
+              break;
+          }
+          if (l >= arg_count) {
+            prev = p;
+            break;
+          }
+        }
+
+        // Stop if an argument is modified, or memory might be changed for `pure`.
+        if (!(ir->flag & IRF_CONST) && may_write_memory(p))
+          break;
+        if (p->dst != NULL) {
+          int l;
+          for (l = 0; l < arg_count; ++l) {
+            if (p->dst == args[l])
+              break;
+          }
+          if (l < arg_count)
+            break;
+        }
+      }
+      if (prev == NULL)
+        continue;
+
+      VReg *dst = ir->dst;
+      int index = remove_call_sequence(bb, j);
+      if (index < 0)
+        continue;
+      IR *mov = new_ir_mov(dst, prev->dst, 0);
+      vec_insert(irs, index, mov);
+      j = index;
+    }
+  }
+}
+
 static void remove_unused_vregs(RegAlloc *ra, BBContainer *bbcon) {
   int vreg_count = ra->vregs->len;
   unsigned char *vreg_read = malloc_or_die(vreg_count);
   for (;;) {
+    bool again = false;
     for (int i = 0; i < vreg_count; ++i) {
       VReg *vreg = ra->vregs->data[i];
       // Must keep function parameter and `&` taken one.
@@ -187,8 +518,14 @@ static void remove_unused_vregs(RegAlloc *ra, BBContainer *bbcon) {
         if (ir->dst == NULL || vreg_read[ir->dst->virt])
           continue;
         if (ir->kind == IR_CALL) {
-          // Function must be CALLed even if the result is unused.
-          ir->dst = NULL;
+          // Function must be CALLed even if the result is unused, unless it has no side effects.
+          int index;
+          if (ir->flag & (IRF_PURE | IRF_CONST) && (index = remove_call_sequence(bb, j)) >= 0) {
+            j = index - 1;
+            again = true;
+          } else {
+            ir->dst = NULL;
+          }
         } else {
           vec_remove_at(bb->irs, j);
           --j;
@@ -197,7 +534,6 @@ static void remove_unused_vregs(RegAlloc *ra, BBContainer *bbcon) {
     }
 
     // Mark unused VRegs.
-    bool again = false;
     for (int i = 0; i < vreg_count; ++i) {
       VReg *vreg;
       if (!vreg_read[i] && (vreg = ra->vregs->data[i]) != NULL) {
@@ -263,6 +599,618 @@ static void peephole(RegAlloc *ra, BB *bb) {
   }
 }
 
+// Scalar replacement
+//   Frame slot whose address is used only for loads and stores at constant offsets
+//   is replaced with registers: address-taken scalar goes back to its own register,
+//   and an aggregate is split into a register per accessed member.
+
+#define MAX_PROMOTED_SLOTS  (8)  // Maximum number of registers which an aggregate is split into.
+
+typedef struct {
+  int64_t offset;
+  VReg *vreg;
+  bool typed;  // False if only zero is stored so far: register class is not fixed yet.
+} FrameSlot;
+
+typedef struct {
+  FrameInfo *frame;
+  VReg *var;  // Address-taken scalar variable, NULL for an aggregate.
+  Vector *slots;  // <FrameSlot*>
+  bool escaped;
+} PromotedFrame;
+
+typedef struct {
+  PromotedFrame *pf;  // NULL if the vreg is not an address of a frame slot.
+  int64_t offset;
+} FrameAddr;
+
+static PromotedFrame *new_promoted_frame(Vector *frames, FrameInfo *frame, VReg *var) {
+  PromotedFrame *pf = calloc_or_die(sizeof(*pf));
+  pf->frame = frame;
+  pf->var = var;
+  pf->slots = new_vector();
+  vec_push(frames, pf);
+  return pf;
+}
+
+static PromotedFrame *find_promoted_frame(Vector *frames, FrameInfo *frame) {
+  for (int i = 0; i < frames->len; ++i) {
+    PromotedFrame *pf = frames->data[i];
+    if (pf->frame == frame)
+      return pf;
+  }
+  if (!(frame->flag & FIF_PROMOTABLE))
+    return NULL;
+  return new_promoted_frame(frames, frame, NULL);
+}
+
+static bool is_zero_store(IR *ir) {
+  return ir->kind == IR_STORE && (ir->opr1->flag & VRF_CONST) && ir->opr1->fixnum == 0;
+}
+
+// Register which holds the accessed part of the frame, or NULL if the frame escapes.
+static VReg *get_frame_slot(RegAlloc *ra, const FrameAddr *addr, IR *ir) {
+  PromotedFrame *pf = addr->pf;
+  if (pf->escaped)
+    return NULL;
+  VReg *value = ir->kind == IR_LOAD ? ir->dst : ir->opr1;
+  enum VRegSize vsize = value->vsize;
+  int vflag = value->flag & VRF_MASK;
+  bool typed = !is_zero_store(ir);
+  int64_t offset = addr->offset + ir->mem.offset;
+  if (pf->var != NULL) {
+    if (offset == 0 && vsize == pf->var->vsize && (!typed || vflag == (pf->var->flag & VRF_MASK)))
+      return pf->var;
+  } else {
+    int size = 1 << vsize;
+    bool conflict = false;
+    for (int i = 0; i < pf->slots->len; ++i) {
+      FrameSlot *slot = pf->slots->data[i];
+      VReg *vreg = slot->vreg;
+      if (slot->offset == offset && vreg->vsize == vsize) {
+        if (typed && !slot->typed) {
+          vreg->flag = (vreg->flag & ~VRF_MASK) | vflag;
+          slot->typed = true;
+        }
+        if (!typed || (vreg->flag & VRF_MASK) == vflag)
+          return vreg;
+        conflict = true;  // Accessed as both integer and floating-point.
+        break;
+      }
+      if (offset < slot->offset + (1 << vreg->vsize) && slot->offset < offset + size) {
+        conflict = true;  // Overlaps with different access.
+        break;
+      }
+    }
+    if (!conflict && offset >= 0 && pf->slots->len < MAX_PROMOTED_SLOTS) {
+      FrameSlot *slot = malloc_or_die(sizeof(*slot));
+      slot->offset = offset;
+      slot->vreg = reg_alloc_spawn(ra, vsize, vflag);
+      slot->typed = typed;
+      vec_push(pf->slots, slot);
+      return slot->vreg;
+    }
+  }
+  pf->escaped = true;
+  return NULL;
+}
+
+// `dst = addr`, `dst = addr + c` or `dst = addr - c`, which defines `dst` only once.
+static bool is_frame_addr_def(IR *ir, const FrameAddr *addrs, const int *def_count) {
+  switch (ir->kind) {
+  case IR_ADD: case IR_SUB:
+    if (!(ir->opr2->flag & VRF_CONST))
+      return false;
+    // Fallthrough
+  case IR_MOV:
+    return !(ir->opr1->flag & VRF_CONST) && addrs[ir->opr1->virt].pf != NULL &&
+           def_count[ir->dst->virt] == 1;
+  default:
+    return false;
+  }
+}
+
+static void promote_frame_slots(RegAlloc *ra, BBContainer *bbcon) {
+  Vector *frames = new_vector();
+  for (int i = 0; i < ra->vregs->len; ++i) {
+    VReg *vreg = ra->vregs->data[i];
+    if (vreg != NULL && (vreg->flag & VRF_REF) && (vreg->frame.flag & FIF_PROMOTABLE))
+      new_promoted_frame(frames, &vreg->frame, vreg);
+  }
+
+  // Addresses must be defined only once: by BOFS, or adding a constant to another address.
+  int vreg_count = ra->vregs->len;
+  int *def_count = calloc_or_die(sizeof(*def_count) * vreg_count);
+  for (int i = 0; i < bbcon->len; ++i) {
+    BB *bb = bbcon->data[i];
+    for (int j = 0; j < bb->irs->len; ++j) {
+      IR *ir = bb->irs->data[j];
+      if (ir->dst != NULL)
+        ++def_count[ir->dst->virt];
+    }
+  }
+  FrameAddr *addrs = calloc_or_die(sizeof(*addrs) * vreg_count);
+  for (int i = 0; i < bbcon->len; ++i) {
+    BB *bb = bbcon->data[i];
+    for (int j = 0; j < bb->irs->len; ++j) {
+      IR *ir = bb->irs->data[j];
+      if (ir->kind == IR_BOFS) {
+        PromotedFrame *pf = find_promoted_frame(frames, ir->bofs.frameinfo);
+        if (pf == NULL)
+          continue;
+        if (def_count[ir->dst->virt] != 1) {
+          pf->escaped = true;
+          continue;
+        }
+        addrs[ir->dst->virt] = (FrameAddr){.pf = pf, .offset = ir->bofs.offset};
+      } else if (is_frame_addr_def(ir, addrs, def_count)) {
+        FrameAddr *addr = &addrs[ir->opr1->virt];
+        int64_t d = ir->kind == IR_MOV ? 0 : ir->kind == IR_ADD ? ir->opr2->fixnum
+                                                                 : -ir->opr2->fixnum;
+        addrs[ir->dst->virt] = (FrameAddr){.pf = addr->pf, .offset = addr->offset + d};
+      }
+    }
+  }
+  free(def_count);
+
+  // Any other use of an address makes the frame escape.
+  for (int i = 0; i < bbcon->len; ++i) {
+    BB *bb = bbcon->data[i];
+    for (int j = 0; j < bb->irs->len; ++j) {
+      IR *ir = bb->irs->data[j];
+      VReg *operands[] = {ir->opr1, ir->opr2};
+      for (int k = 0; k < 2; ++k) {
+        VReg *vreg = operands[k];
+        FrameAddr *addr;
+        if (vreg == NULL || (vreg->flag & VRF_CONST) || (addr = &addrs[vreg->virt])->pf == NULL)
+          continue;
+        if (((ir->kind == IR_LOAD && k == 0) || (ir->kind == IR_STORE && k == 1)) &&
+            ir->mem.index == NULL)
+          get_frame_slot(ra, addr, ir);
+        else if (!(k == 0 && (ir->kind == IR_MOV || ir->kind == IR_ADD || ir->kind == IR_SUB) &&
+                   addrs[ir->dst->virt].pf != NULL))
+          addr->pf->escaped = true;
+      }
+    }
+  }
+
+  // Replace loads and stores with moves.
+  assert(curbb == NULL);
+  RegAlloc *ra_save = curra;
+  curra = ra;
+  for (int i = 0; i < bbcon->len; ++i) {
+    BB *bb = bbcon->data[i];
+    Vector *irs = bb->irs;
+    bb->irs = new_vector();
+    curbb = bb;  // Generated IRs are appended to `bb`.
+    for (int j = 0; j < irs->len; ++j) {
+      IR *ir = irs->data[j];
+      VReg *base = ir->kind == IR_LOAD ? ir->opr1 : ir->kind == IR_STORE ? ir->opr2 : NULL;
+      FrameAddr *addr;
+      if (base == NULL || (base->flag & VRF_CONST) || (addr = &addrs[base->virt])->pf == NULL ||
+          addr->pf->escaped) {
+        vec_push(bb->irs, ir);
+        continue;
+      }
+
+      VReg *slot = get_frame_slot(ra, addr, ir);
+      assert(slot != NULL);
+      if (ir->kind == IR_LOAD) {
+        new_ir_mov(ir->dst, slot, ir->flag);
+      } else if ((slot->flag & VRF_MASK) == (ir->opr1->flag & VRF_MASK)) {
+        new_ir_mov(slot, ir->opr1, ir->flag);
+      } else {
+        // Zero into floating-point register: through integer, as no constant is available.
+        assert(is_zero_store(ir));
+        VReg *tmp = reg_alloc_spawn(ra, slot->vsize, 0);
+        new_ir_mov(tmp, ir->opr1, 0);
+        IR *cast = new_ir_cast(tmp, slot->vsize, slot->flag & VRF_MASK);
+        cast->dst = slot;
+      }
+    }
+    curbb = NULL;
+  }
+  curra = ra_save;
+  free(addrs);
+
+  // Addresses are no longer used, and removed as unused vregs.
+  for (int i = 0; i < frames->len; ++i) {
+    PromotedFrame *pf = frames->data[i];
+    if (!pf->escaped) {
+      if (pf->var != NULL)
+        pf->var->flag &= ~VRF_REF;
+      pf->frame->flag |= FIF_PROMOTED;
+    }
+    for (int j = 0; j < pf->slots->len; ++j)
+      free(pf->slots->data[j]);
+    free_vector(pf->slots);
+    free(pf);
+  }
+  free_vector(frames);
+}
+
+// Memory forwarding
+//   Load from a location whose value is known, stored or loaded before, is replaced with
+//   the value, and store overwritten before being read is removed.
+//   Load from constant data of a global is replaced with the immediate.
+//   Known values are carried into the BB which is reached only from the previous one.
+//   Alias model: distinct frame slots and distinct globals never overlap, and a frame slot
+//   or a `restrict` parameter whose address doesn't escape is accessed only through it.
+
+#define MAX_MEM_ENTRIES  (64)  // Known locations kept at once.
+
+enum MemBaseKind {
+  MB_FRAME,
+  MB_GLOBAL,
+  MB_POINTER,
+};
+
+typedef struct {
+  enum MemBaseKind kind;
+  const void *key;  // FrameInfo*, Name* or root VReg*.
+  bool local;       // Accessed only through the addresses derived from this base.
+} MemBase;
+
+typedef struct {
+  MemBase *base;  // NULL if unknown.
+  int64_t offset;
+  bool offset_known;
+} MemAddr;
+
+typedef struct {
+  MemBase *base;
+  int64_t offset;
+  int size;
+  VReg *value;  // Value at the location.
+  IR *store;    // Store which is not read yet: removed if overwritten.
+} MemEntry;
+
+static MemBase *get_mem_base(Vector *bases, Table *globals, enum MemBaseKind kind,
+                             const void *key) {
+  MemBase *base;
+  if (kind == MB_GLOBAL) {
+    if ((base = table_get(globals, key)) != NULL)
+      return base;
+  } else if (kind == MB_FRAME) {
+    for (int i = 0; i < bases->len; ++i) {
+      base = bases->data[i];
+      if (base->kind == kind && base->key == key)
+        return base;
+    }
+  }
+  base = malloc_or_die(sizeof(*base));
+  base->kind = kind;
+  base->key = key;
+  base->local = kind == MB_FRAME;
+  vec_push(bases, base);
+  if (kind == MB_GLOBAL)
+    table_put(globals, key, base);
+  return base;
+}
+
+static bool may_overlap(const MemEntry *e, const MemAddr *addr, int size) {
+  if (e->base == addr->base)
+    return !addr->offset_known || (e->offset < addr->offset + size &&
+                                   addr->offset < e->offset + e->size);
+  if (e->base->local || (addr->base != NULL && addr->base->local))
+    return false;
+  // Distinct objects don't overlap, but a pointer might point to anything.
+  return addr->base == NULL || e->base->kind == MB_POINTER || addr->base->kind == MB_POINTER;
+}
+
+// Memory at `addr` is accessed: forget the values if written, otherwise stores are read.
+static void access_memory(Vector *entries, const MemAddr *addr, int size, bool write) {
+  for (int i = 0; i < entries->len; ++i) {
+    MemEntry *e = entries->data[i];
+    if (!may_overlap(e, addr, size))
+      continue;
+    if (write) {
+      free(e);
+      vec_remove_at(entries, i--);
+    } else {
+      e->store = NULL;
+    }
+  }
+}
+
+static MemEntry *find_mem_entry(Vector *entries, const MemAddr *addr, int size) {
+  if (addr->base == NULL || !addr->offset_known)
+    return NULL;
+  for (int i = 0; i < entries->len; ++i) {
+    MemEntry *e = entries->data[i];
+    if (e->base == addr->base && e->offset == addr->offset && e->size == size)
+      return e;
+  }
+  return NULL;
+}
+
+static void add_mem_entry(Vector *entries, const MemAddr *addr, int size, VReg *value,
+                          IR *store) {
+  if (addr->base == NULL || !addr->offset_known || (value->flag & VRF_REF))
+    return;
+  if (entries->len >= MAX_MEM_ENTRIES) {
+    free(entries->data[0]);
+    vec_remove_at(entries, 0);
+  }
+  MemEntry *e = malloc_or_die(sizeof(*e));
+  e->base = addr->base;
+  e->offset = addr->offset;
+  e->size = size;
+  e->value = value;
+  e->store = store;
+  vec_push(entries, e);
+}
+
+// `vreg` gets a new value: the entries which depend on it are no longer valid.
+static void redefine_vreg(Vector *entries, VReg *vreg, Vector *bases, Table *globals) {
+  if (vreg->flag & VRF_REF) {
+    // `&` taken variable lives in its frame slot.
+    MemAddr addr = {.base = get_mem_base(bases, globals, MB_FRAME, &vreg->frame)};
+    access_memory(entries, &addr, 0, true);
+  }
+  for (int i = 0; i < entries->len; ++i) {
+    MemEntry *e = entries->data[i];
+    if (e->value == vreg || (e->base->kind == MB_POINTER && e->base->key == vreg)) {
+      free(e);
+      vec_remove_at(entries, i--);
+    }
+  }
+}
+
+static bool is_same_value(VReg *a, VReg *b) {
+  if (a == b)
+    return true;
+  return (a->flag & b->flag & VRF_CONST) && a->fixnum == b->fixnum && a->vsize == b->vsize;
+}
+
+static MemAddr get_mem_addr(const MemAddr *addrs, VReg *vreg) {
+  if (vreg->flag & VRF_CONST)
+    return (MemAddr){.base = NULL};
+  return addrs[vreg->virt];
+}
+
+static MemAddr get_mem_operand(const MemAddr *addrs, IR *ir, VReg *vreg) {
+  MemAddr addr = get_mem_addr(addrs, vreg);
+  addr.offset += ir->mem.offset;
+  if (ir->mem.index != NULL)
+    addr.offset_known = false;
+  return addr;
+}
+
+// Addresses defined only once: frame, global, or derived from another address.
+static MemAddr *analyze_mem_addrs(RegAlloc *ra, BBContainer *bbcon, Vector *bases,
+                                  Table *globals) {
+  int vreg_count = ra->vregs->len;
+  int *def_count = calloc_or_die(sizeof(*def_count) * vreg_count);
+  for (int i = 0; i < bbcon->len; ++i) {
+    BB *bb = bbcon->data[i];
+    for (int j = 0; j < bb->irs->len; ++j) {
+      IR *ir = bb->irs->data[j];
+      if (ir->dst != NULL)
+        ++def_count[ir->dst->virt];
+    }
+  }
+
+  MemAddr *addrs = calloc_or_die(sizeof(*addrs) * vreg_count);
+  for (int i = 0; i < vreg_count; ++i) {
+    VReg *vreg = ra->vregs->data[i];
+    if (vreg != NULL && (vreg->flag & VRF_PARAM) && !(vreg->flag & (VRF_REF | VRF_FLONUM)) &&
+        def_count[i] == 0) {
+      MemBase *base = get_mem_base(bases, globals, MB_POINTER, vreg);
+      base->local = (vreg->flag & VRF_RESTRICT) != 0;
+      addrs[i] = (MemAddr){.base = base, .offset = 0, .offset_known = true};
+    }
+  }
+  for (int i = 0; i < bbcon->len; ++i) {
+    BB *bb = bbcon->data[i];
+    for (int j = 0; j < bb->irs->len; ++j) {
+      IR *ir = bb->irs->data[j];
+      VReg *dst = ir->dst;
+      if (dst == NULL || def_count[dst->virt] != 1 || (dst->flag & (VRF_REF | VRF_FLONUM)))
+        continue;
+      MemAddr *addr = &addrs[dst->virt];
+      switch (ir->kind) {
+      case IR_BOFS:
+        *addr = (MemAddr){.base = get_mem_base(bases, globals, MB_FRAME, ir->bofs.frameinfo),
+                          .offset = ir->bofs.offset, .offset_known = true};
+        continue;
+      case IR_IOFS:
+        *addr = (MemAddr){.base = get_mem_base(bases, globals, MB_GLOBAL, ir->iofs.label),
+                          .offset = ir->iofs.offset, .offset_known = true};
+        continue;
+      case IR_MOV: case IR_ADD: case IR_SUB:
+        if (!(ir->opr1->flag & VRF_CONST) && addrs[ir->opr1->virt].base != NULL) {
+          *addr = addrs[ir->opr1->virt];
+          if (ir->kind != IR_MOV) {
+            if (ir->opr2->flag & VRF_CONST)
+              addr->offset += ir->kind == IR_ADD ? ir->opr2->fixnum : -ir->opr2->fixnum;
+            else
+              addr->offset_known = false;
+          }
+          continue;
+        }
+        break;
+      default: break;
+      }
+      // Unknown pointer: distinguished only by the same root.
+      *addr = (MemAddr){.base = get_mem_base(bases, globals, MB_POINTER, dst), .offset = 0,
+                        .offset_known = true};
+    }
+  }
+  free(def_count);
+
+  // Address used other than for memory access or deriving another one makes its base escape.
+  for (int i = 0; i < bbcon->len; ++i) {
+    BB *bb = bbcon->data[i];
+    for (int j = 0; j < bb->irs->len; ++j) {
+      IR *ir = bb->irs->data[j];
+      VReg *operands[] = {ir->opr1, ir->opr2};
+      for (int k = 0; k < 2; ++k) {
+        VReg *vreg = operands[k];
+        MemBase *base;
+        if (vreg == NULL || (vreg->flag & VRF_CONST) || (base = addrs[vreg->virt].base) == NULL)
+          continue;
+        if ((ir->kind == IR_LOAD && k == 0) || (ir->kind == IR_STORE && k == 1))
+          continue;
+        if (k == 0 && (ir->kind == IR_MOV || ir->kind == IR_ADD || ir->kind == IR_SUB) &&
+            addrs[ir->dst->virt].base == base)
+          continue;
+        base->local = false;
+      }
+    }
+  }
+  return addrs;
+}
+
+static void forward_memory_in_bb(RegAlloc *ra, BB *bb, const MemAddr *addrs, Vector *bases,
+                                 Table *globals, Vector *entries) {
+  static const MemAddr kUnknownAddr = {.base = NULL};
+  Vector *irs = bb->irs;
+  Vector *removed = new_vector();
+  for (int j = 0; j < irs->len; ++j) {
+    IR *ir = irs->data[j];
+
+    VReg *operands[] = {ir->opr1, ir->opr2};
+    for (int k = 0; k < 2; ++k) {
+      VReg *vreg = operands[k];
+      if (vreg != NULL && (vreg->flag & VRF_REF)) {
+        MemAddr addr = {.base = get_mem_base(bases, globals, MB_FRAME, &vreg->frame)};
+        access_memory(entries, &addr, 0, false);
+      }
+    }
+
+    switch (ir->kind) {
+    case IR_LOAD:
+      {
+        MemAddr addr = get_mem_operand(addrs, ir, ir->opr1);
+        VReg *dst = ir->dst;
+        int size = 1 << dst->vsize;
+        bool keep = (ir->flag & IRF_VOLATILE) || (dst->flag & VRF_REF);
+        int64_t value;
+        if (!keep && !(dst->flag & VRF_FLONUM) && addr.base != NULL &&
+            addr.base->kind == MB_GLOBAL && addr.offset_known &&
+            read_const_global(addr.base->key, addr.offset, size, &value)) {
+          // Constant data.
+          ir->kind = IR_MOV;
+          ir->opr1 = reg_alloc_spawn_const(ra, wrap_value(value, size, ir->flag & IRF_UNSIGNED),
+                                           dst->vsize);
+          ir->flag &= IRF_UNSIGNED;
+          redefine_vreg(entries, dst, bases, globals);
+          continue;
+        }
+        MemEntry *e = find_mem_entry(entries, &addr, size);
+        access_memory(entries, &addr, size, false);
+        if (!keep && e != NULL && (e->value->flag & VRF_MASK) == (dst->flag & VRF_MASK)) {
+          ir->kind = IR_MOV;
+          ir->opr1 = e->value;
+          ir->flag &= IRF_UNSIGNED;
+        }
+        redefine_vreg(entries, dst, bases, globals);
+        if (!keep && find_mem_entry(entries, &addr, size) == NULL)
+          add_mem_entry(entries, &addr, size, dst, NULL);
+      }
+      continue;
+    case IR_STORE:
+      {
+        MemAddr addr = get_mem_operand(addrs, ir, ir->opr2);
+        VReg *value = ir->opr1;
+        int size = 1 << value->vsize;
+        if (ir->flag & IRF_VOLATILE) {
+          access_memory(entries, &addr, size, true);
+          break;
+        }
+        MemEntry *e = find_mem_entry(entries, &addr, size);
+        if (e != NULL && is_same_value(e->value, value)) {
+          // The value is already there.
+          vec_push(removed, ir);
+          break;
+        }
+        if (e != NULL && e->store != NULL)
+          vec_push(removed, e->store);  // Overwritten before being read.
+        access_memory(entries, &addr, size, true);
+        add_mem_entry(entries, &addr, size, value, ir);
+      }
+      break;
+    case IR_CALL:
+      // The callee can access the memory reachable from outside.
+      if (!(ir->flag & IRF_CONST))
+        access_memory(entries, &kUnknownAddr, 0, !(ir->flag & IRF_PURE));
+      if (ir->call.result_frame != NULL) {
+        MemAddr addr = {.base = get_mem_base(bases, globals, MB_FRAME, ir->call.result_frame)};
+        access_memory(entries, &addr, 0, true);
+      }
+      break;
+    case IR_ASM:
+      for (int i = 0; i < entries->len; ++i)
+        free(entries->data[i]);
+      vec_clear(entries);
+      break;
+    default: break;
+    }
+
+    if (ir->dst != NULL)
+      redefine_vreg(entries, ir->dst, bases, globals);
+  }
+
+  if (removed->len > 0) {
+    int d = 0;
+    for (int j = 0; j < irs->len; ++j) {
+      IR *ir = irs->data[j];
+      if (!vec_contains(removed, ir))
+        irs->data[d++] = ir;
+    }
+    irs->len = d;
+  }
+  free_vector(removed);
+}
+
+static void forward_memory(RegAlloc *ra, BBContainer *bbcon) {
+  Vector *bases = new_vector();
+  Table globals;
+  table_init(&globals);
+  MemAddr *addrs = analyze_mem_addrs(ra, bbcon, bases, &globals);
+
+  detect_from_bbs(bbcon);
+  Table indices;
+  table_init(&indices);
+  for (int i = 0; i < bbcon->len; ++i) {
+    BB *bb = bbcon->data[i];
+    table_put(&indices, bb->label, (void*)(intptr_t)i);
+  }
+
+  Vector **exits = calloc_or_die(sizeof(*exits) * bbcon->len);
+  for (int i = 0; i < bbcon->len; ++i) {
+    BB *bb = bbcon->data[i];
+    Vector *entries = new_vector();
+    if (bb->from_bbs->len == 1) {
+      int from = bb_index(&indices, bb->from_bbs->data[0]);
+      if (from < i) {
+        Vector *src = exits[from];
+        for (int j = 0; j < src->len; ++j) {
+          MemEntry *e = malloc_or_die(sizeof(*e));
+          *e = *(MemEntry*)src->data[j];
+          e->store = NULL;
+          vec_push(entries, e);
+        }
+      }
+    }
+    forward_memory_in_bb(ra, bb, addrs, bases, &globals, entries);
+    exits[i] = entries;
+  }
+
+  for (int i = 0; i < bbcon->len; ++i) {
+    Vector *entries = exits[i];
+    for (int j = 0; j < entries->len; ++j)
+      free(entries->data[j]);
+    free_vector(entries);
+  }
+  free(exits);
+  for (int i = 0; i < bases->len; ++i)
+    free(bases->data[i]);
+  free_vector(bases);
+  free(addrs);
+}
+
 // Depends on SSA.
 
 static int replace_register(BBContainer *bbcon, VReg *target, VReg *alternation) {
@@ -403,6 +1351,8 @@ static int64_t calc_const_expr(IR *ir) {
   case IR_RSHIFT: value = opr1 >> opr2; break; \
   case IR_NEG: value = -opr1; break; \
   case IR_BITNOT: value = ~opr1; break; \
+  case IR_POPCNT: case IR_CLZ: case IR_CTZ: case IR_BSWAP: \
+    value = calc_bit_op(kind, opr1, ir->dst->vsize); break; \
   default: assert(false); break; \
   }
 
@@ -478,6 +1428,10 @@ static void copy_propagation(RegAlloc *ra, BBContainer *bbcon) {
         case IR_RSHIFT:
         case IR_NEG:
         case IR_BITNOT:
+        case IR_POPCNT:
+        case IR_CLZ:
+        case IR_CTZ:
+        case IR_BSWAP:
           if ((ir->opr1->flag & VRF_CONST) && (ir->opr2 == NULL || ir->opr2->flag & VRF_CONST)) {
             int64_t value = wrap_value(calc_const_expr(ir), 1 << ir->dst->vsize, ir->flag & IRF_UNSIGNED);
             // Replace to MOV.
@@ -528,6 +1482,642 @@ static void copy_propagation(RegAlloc *ra, BBContainer *bbcon) {
   } while (again);
 }
 
+// Multiplication by constant
+
+static VReg *gen_mul_by_const(IR *ir) {
+  VReg *n = ir->opr1;
+  enum VRegSize vsize = ir->dst->vsize;
+  int64_t value = wrap_value(ir->opr2->fixnum, 1 << vsize, (ir->flag & IRF_UNSIGNED) != 0);
+  if (value == 0)
+    return new_const_vreg(0, vsize);
+  if (value == -1)
+    return new_ir_unary(IR_NEG, n, vsize, ir->flag);
+  if (IS_POWER_OF_2(value))
+    return new_ir_bop(IR_LSHIFT, n, new_const_vreg(most_significant_bit(value), vsize), vsize,
+                      ir->flag);
+  return NULL;  // Leave it to the backend.
+}
+
+// Division by constant
+//   Rewrite `DIV`/`MOD` by a constant into multiply-high, shift and fix-up sequences
+//   (Hacker's Delight, chapter 10).
+
+typedef struct {
+  uint64_t m;  // Magic number.
+  int s;       // Post shift.
+  bool add;    // Unsigned: magic number needs `bits + 1` bits.
+} DivMagic;
+
+// Requires 2 <= d < 2^(bits-1)
+static DivMagic signed_div_magic(uint64_t d, int bits) {
+  const uint64_t mask = bits >= 64 ? (uint64_t)-1 : ((uint64_t)1 << bits) - 1;
+  const uint64_t two_n1 = (uint64_t)1 << (bits - 1);
+  uint64_t anc = two_n1 - 1 - two_n1 % d;
+  uint64_t q1 = two_n1 / anc, r1 = two_n1 - q1 * anc;
+  uint64_t q2 = two_n1 / d, r2 = two_n1 - q2 * d;
+  uint64_t delta;
+  int p = bits - 1;
+  do {
+    ++p;
+    q1 = (q1 << 1) & mask;
+    r1 <<= 1;
+    if (r1 >= anc) {
+      ++q1;
+      r1 -= anc;
+    }
+    q2 = (q2 << 1) & mask;
+    r2 <<= 1;
+    if (r2 >= d) {
+      ++q2;
+      r2 -= d;
+    }
+    delta = d - r2;
+  } while (q1 < delta || (q1 == delta && r1 == 0));
+  return (DivMagic){.m = (q2 + 1) & mask, .s = p - bits, .add = false};
+}
+
+// Requires 2 <= d < 2^bits
+static DivMagic unsigned_div_magic(uint64_t d, int bits) {
+  const uint64_t mask = bits >= 64 ? (uint64_t)-1 : ((uint64_t)1 << bits) - 1;
+  const uint64_t two_n1 = (uint64_t)1 << (bits - 1);
+  bool add = false;
+  uint64_t nc = mask - ((-d) & mask) % d;
+  uint64_t q1 = two_n1 / nc, r1 = two_n1 - q1 * nc;
+  uint64_t q2 = (two_n1 - 1) / d, r2 = (two_n1 - 1) - q2 * d;
+  uint64_t delta;
+  int p = bits - 1;
+  do {
+    ++p;
+    if (r1 >= nc - r1) {
+      q1 = 2 * q1 + 1;
+      r1 = 2 * r1 - nc;
+    } else {
+      q1 = 2 * q1;
+      r1 = 2 * r1;
+    }
+    if (r2 + 1 >= d - r2) {
+      if (q2 >= two_n1 - 1)
+        add = true;
+      q2 = 2 * q2 + 1;
+      r2 = 2 * r2 + 1 - d;
+    } else {
+      if (q2 >= two_n1)
+        add = true;
+      q2 = 2 * q2;
+      r2 = 2 * r2 + 1;
+    }
+    q1 &= mask;
+    q2 &= mask;
+    delta = d - 1 - r2;
+  } while (p < bits * 2 && (q1 < delta || (q1 == delta && r1 == 0)));
+  return (DivMagic){.m = (q2 + 1) & mask, .s = p - bits, .add = add};
+}
+
+// (n * m) >> (bits + shift): `n` is extended into 64bit already.
+static VReg *gen_mulhi_const(VReg *n, uint64_t m, int bits, int shift, int flag) {
+  VReg *c = new_const_vreg(m, VRegSize8);
+  VReg *t;
+  if (bits >= 64) {
+    t = new_ir_bop(IR_MULHI, n, c, VRegSize8, flag);
+  } else {
+    // Product fits in 64bit.
+    t = new_ir_bop(IR_MUL, n, c, VRegSize8, flag);
+    shift += bits;
+  }
+  return new_ir_bop(IR_RSHIFT, t, new_const_vreg(shift, VRegSize8), VRegSize8, flag);
+}
+
+// n / (1 << k), truncated toward zero.
+static VReg *gen_div_pow2(VReg *n, int k, int bits, enum VRegSize vsize, int flag, VReg **pbiased) {
+  if (flag & IRF_UNSIGNED)
+    return new_ir_bop(IR_RSHIFT, n, new_const_vreg(k, vsize), vsize, flag);
+
+  // Add (2^k - 1) to negative dividend.
+  VReg *sign = n;
+  if (k > 1)
+    sign = new_ir_bop(IR_RSHIFT, n, new_const_vreg(bits - 1, vsize), vsize, flag);
+  VReg *bias = new_ir_bop(IR_RSHIFT, sign, new_const_vreg(bits - k, vsize), vsize, IRF_UNSIGNED);
+  VReg *biased = new_ir_bop(IR_ADD, n, bias, vsize, flag);
+  if (pbiased != NULL)
+    *pbiased = biased;
+  return new_ir_bop(IR_RSHIFT, biased, new_const_vreg(k, vsize), vsize, flag);
+}
+
+static VReg *gen_div_magic(VReg *n, uint64_t d, int bits, enum VRegSize vsize, int flag) {
+  VReg *x = n;
+  if (vsize != VRegSize8) {
+    IR *cast = new_ir_cast(n, VRegSize8, n->flag & VRF_MASK);
+    cast->flag = flag & IRF_UNSIGNED;
+    x = cast->dst;
+  }
+
+  VReg *q;
+  if (flag & IRF_UNSIGNED) {
+    DivMagic magic = unsigned_div_magic(d, bits);
+    if (!magic.add) {
+      q = gen_mulhi_const(x, magic.m, bits, magic.s, flag);
+    } else {
+      // q = (((n - t) >> 1) + t) >> (s - 1)
+      assert(magic.s > 0);
+      VReg *t = gen_mulhi_const(x, magic.m, bits, 0, flag);
+      VReg *u = new_ir_bop(IR_SUB, x, t, VRegSize8, flag);
+      u = new_ir_bop(IR_RSHIFT, u, new_const_vreg(1, VRegSize8), VRegSize8, flag);
+      u = new_ir_bop(IR_ADD, u, t, VRegSize8, flag);
+      q = new_ir_bop(IR_RSHIFT, u, new_const_vreg(magic.s - 1, VRegSize8), VRegSize8, flag);
+    }
+  } else {
+    DivMagic magic = signed_div_magic(d, bits);
+    VReg *t;
+    if (bits >= 64 && (int64_t)magic.m < 0) {
+      // Magic number is treated as negative: add `n` to compensate.
+      t = gen_mulhi_const(x, magic.m, bits, 0, flag);
+      t = new_ir_bop(IR_ADD, t, x, VRegSize8, flag);
+      t = new_ir_bop(IR_RSHIFT, t, new_const_vreg(magic.s, VRegSize8), VRegSize8, flag);
+    } else {
+      t = gen_mulhi_const(x, magic.m, bits, magic.s, flag);
+    }
+    // Add 1 if negative.
+    VReg *sign = new_ir_bop(IR_RSHIFT, t, new_const_vreg(63, VRegSize8), VRegSize8,
+                            IRF_UNSIGNED);
+    q = new_ir_bop(IR_ADD, t, sign, VRegSize8, flag);
+  }
+
+  if (vsize != VRegSize8)
+    q = new_ir_cast(q, vsize, n->flag & VRF_MASK)->dst;
+  return q;
+}
+
+static VReg *gen_div_by_const(IR *ir) {
+  VReg *n = ir->opr1;
+  VReg *c = ir->opr2;
+  enum VRegSize vsize = ir->dst->vsize;
+  int flag = ir->flag;
+  if (vsize < VRegSize4)
+    return NULL;
+  int bits = 8 << vsize;
+  uint64_t mask = bits >= 64 ? (uint64_t)-1 : ((uint64_t)1 << bits) - 1;
+  bool negative = false;
+  uint64_t d = c->fixnum & mask;
+  if (!(flag & IRF_UNSIGNED)) {
+    int64_t sd = wrap_value(c->fixnum, 1 << vsize, false);
+    if (sd < 0) {
+      if (d == ((uint64_t)1 << (bits - 1)))  // INT_MIN
+        return NULL;
+      negative = true;
+      sd = -sd;
+    }
+    d = sd;
+  }
+
+  if (d == 0)
+    return NULL;
+  if (d == 1) {
+    if (ir->kind == IR_MOD)
+      return new_const_vreg(0, vsize);
+    return negative ? new_ir_unary(IR_NEG, n, vsize, flag) : n;
+  }
+
+  VReg *q;
+  if (IS_POWER_OF_2(d)) {
+    int k = most_significant_bit(d);
+    if (ir->kind == IR_MOD) {
+      if (flag & IRF_UNSIGNED)
+        return new_ir_bop(IR_BITAND, n, new_const_vreg(d - 1, vsize), vsize, flag);
+      // n - ((n + bias) & -d)
+      VReg *biased;
+      gen_div_pow2(n, k, bits, vsize, flag, &biased);
+      VReg *r = new_ir_bop(IR_BITAND, biased, new_const_vreg(-d, vsize), vsize, flag);
+      return new_ir_bop(IR_SUB, n, r, vsize, flag);
+    }
+    q = gen_div_pow2(n, k, bits, vsize, flag, NULL);
+  } else {
+    q = gen_div_magic(n, d, bits, vsize, flag);
+  }
+
+  if (ir->kind == IR_MOD) {
+    VReg *prod = new_ir_bop(IR_MUL, q, new_const_vreg(d, vsize), vsize, flag);
+    return new_ir_bop(IR_SUB, n, prod, vsize, flag);
+  }
+  if (negative)
+    q = new_ir_unary(IR_NEG, q, vsize, flag);
+  return q;
+}
+
+// Rewrite arithmetic by constant into cheaper operations.
+static void lower_const_arith(RegAlloc *ra, BBContainer *bbcon) {
+  assert(curbb == NULL);
+  RegAlloc *ra_save = curra;
+  curra = ra;
+  for (int i = 0; i < bbcon->len; ++i) {
+    BB *bb = bbcon->data[i];
+    Vector *irs = bb->irs;
+    bb->irs = new_vector();
+    curbb = bb;  // Generated IRs are appended to `bb`.
+    for (int j = 0; j < irs->len; ++j) {
+      IR *ir = irs->data[j];
+      VReg *result = NULL;
+      int start = bb->irs->len;
+      if ((ir->kind == IR_MUL || ir->kind == IR_DIV || ir->kind == IR_MOD) &&
+          !(ir->dst->flag & VRF_FLONUM) &&
+          !(ir->opr1->flag & VRF_CONST) && ir->opr2->flag & VRF_CONST)
+        result = ir->kind == IR_MUL ? gen_mul_by_const(ir) : gen_div_by_const(ir);
+      if (result == NULL) {
+        vec_push(bb->irs, ir);
+        continue;
+      }
+
+      // Store the result into the original destination.
+      IR *last = bb->irs->len > start ? bb->irs->data[bb->irs->len - 1] : NULL;
+      if (last != NULL && last->dst == result)
+        last->dst = ir->dst;
+      else
+        new_ir_mov(ir->dst, result, ir->flag);
+    }
+    curbb = NULL;
+  }
+  curra = ra_save;
+}
+
+// Addressing mode
+
+// Returns the IR which defines `vreg` in current BB, if the IR can be folded into its only user.
+static IR *foldable_def(VReg *vreg, Vector *irs, const int *def_pos, const int *use_count) {
+  if (vreg == NULL || (vreg->flag & (VRF_CONST | VRF_PARAM | VRF_REF | VRF_SPILLED | VRF_FLONUM)) ||
+      use_count[vreg->virt] != 1)
+    return NULL;
+  int pos = def_pos[vreg->virt];
+  if (pos < 0)
+    return NULL;
+  IR *ir = irs->data[pos];
+  // Operands must not be modified between the definition and the user.
+  VReg *operands[] = {ir->opr1, ir->opr2};
+  for (int k = 0; k < 2; ++k) {
+    VReg *opr = operands[k];
+    if (opr != NULL && !(opr->flag & VRF_CONST) &&
+        (opr->vsize != vreg->vsize || def_pos[opr->virt] >= pos))
+      return NULL;
+  }
+  return ir;
+}
+
+static void fold_mem_operand(IR *ir, Vector *irs, const int *def_pos, int *use_count,
+                             Vector *removed) {
+  VReg **pbase = ir->kind == IR_LOAD ? &ir->opr1 : &ir->opr2;
+  for (;;) {
+    VReg *base = *pbase;
+    IR *def = foldable_def(base, irs, def_pos, use_count);
+    if (def == NULL)
+      break;
+
+    VReg *nbase = NULL, *index = ir->mem.index;
+    int scale = ir->mem.scale;
+    int64_t offset = ir->mem.offset;
+    IR *folded[3] = {def, NULL, NULL};
+    if (def->kind == IR_ADD || def->kind == IR_SUB) {
+      if (def->opr2->flag & VRF_CONST) {
+        nbase = def->opr1;
+        offset += def->kind == IR_ADD ? def->opr2->fixnum : -def->opr2->fixnum;
+      } else if (def->kind == IR_ADD && def->opr1->flag & VRF_CONST) {
+        nbase = def->opr2;
+        offset += def->opr1->fixnum;
+      } else if (def->kind == IR_ADD && index == NULL) {
+        // Choose scaled one as index.
+        nbase = def->opr1;
+        index = def->opr2;
+        for (int k = 0; k < 2; ++k) {
+          VReg *idx = k == 0 ? def->opr2 : def->opr1;
+          IR *s = foldable_def(idx, irs, def_pos, use_count);
+          if (s != NULL && s->kind == IR_LSHIFT && s->opr2->flag & VRF_CONST &&
+              !(s->opr1->flag & VRF_CONST) &&
+              is_legal_mem_operand(ir, true, s->opr2->fixnum, offset)) {
+            folded[1] = s;
+            nbase = k == 0 ? def->opr1 : def->opr2;
+            index = s->opr1;
+            scale = s->opr2->fixnum;
+            break;
+          }
+        }
+
+        // Move constant part of index into offset: (i + c) << scale
+        IR *c = foldable_def(index, irs, def_pos, use_count);
+        if (c != NULL && (c->kind == IR_ADD || c->kind == IR_SUB) && c->opr2->flag & VRF_CONST &&
+            !(c->opr1->flag & VRF_CONST)) {
+          int64_t d = c->opr2->fixnum * ((int64_t)1 << scale);
+          if (is_legal_mem_operand(ir, true, scale, offset + (c->kind == IR_ADD ? d : -d))) {
+            folded[2] = c;
+            index = c->opr1;
+            offset += c->kind == IR_ADD ? d : -d;
+          }
+        }
+      }
+    }
+    if (nbase == NULL || (nbase->flag & VRF_CONST) ||
+        !is_legal_mem_operand(ir, index != NULL, scale, offset))
+      break;
+
+    *pbase = nbase;
+    ir->mem.index = index;
+    ir->mem.scale = scale;
+    ir->mem.offset = offset;
+    for (int k = 0; k < 3; ++k) {
+      IR *f = folded[k];
+      if (f != NULL) {
+        use_count[f->dst->virt] = 0;
+        vec_push(removed, f);
+      }
+    }
+  }
+}
+
+// Fold address calculation into the memory operand of load/store:
+//   [base + (index << scale) + offset]
+static void fold_mem_operands(RegAlloc *ra, BBContainer *bbcon) {
+  int vreg_count = ra->vregs->len;
+  int *use_count = calloc_or_die(sizeof(*use_count) * vreg_count);
+  int *def_pos = malloc_or_die(sizeof(*def_pos) * vreg_count);
+  for (int i = 0; i < vreg_count; ++i)
+    def_pos[i] = -1;
+
+  for (int i = 0; i < bbcon->len; ++i) {
+    BB *bb = bbcon->data[i];
+    Vector *phis = bb->phis;
+    if (phis != NULL) {
+      for (int j = 0; j < phis->len; ++j) {
+        Phi *phi = phis->data[j];
+        for (int k = 0; k < phi->params->len; ++k) {
+          VReg *vreg = phi->params->data[k];
+          if (!(vreg->flag & VRF_CONST))
+            ++use_count[vreg->virt];
+        }
+      }
+    }
+    for (int j = 0; j < bb->irs->len; ++j) {
+      IR *ir = bb->irs->data[j];
+      VReg *operands[] = {ir->opr1, ir->opr2};
+      for (int k = 0; k < 2; ++k) {
+        VReg *vreg = operands[k];
+        if (vreg != NULL && !(vreg->flag & VRF_CONST))
+          ++use_count[vreg->virt];
+      }
+    }
+  }
+
+  Vector *removed = new_vector();
+  for (int i = 0; i < bbcon->len; ++i) {
+    BB *bb = bbcon->data[i];
+    Vector *irs = bb->irs;
+    for (int j = 0; j < irs->len; ++j) {
+      IR *ir = irs->data[j];
+      if (ir->kind == IR_LOAD || ir->kind == IR_STORE)
+        fold_mem_operand(ir, irs, def_pos, use_count, removed);
+      if (ir->dst != NULL)
+        def_pos[ir->dst->virt] = j;
+    }
+
+    for (int j = 0; j < irs->len; ++j) {
+      IR *ir = irs->data[j];
+      if (ir->dst != NULL)
+        def_pos[ir->dst->virt] = -1;
+      if (removed->len > 0 && vec_contains(removed, ir))
+        vec_remove_at(irs, j--);
+    }
+    vec_clear(removed);
+  }
+
+  free(def_pos);
+  free(use_count);
+}
+
+// If-conversion
+
+#define MAX_SELECT_ARM_IRS  (3)  // Maximum number of IRs in each arm of a branch.
+#define MAX_SELECTS         (2)  // Maximum number of selects generated from a branch.
+
+// Whether `ir` can be executed even if its BB is not taken: no side effect, and never traps.
+static bool is_speculatable_ir(IR *ir) {
+  switch (ir->kind) {
+  case IR_BOFS: case IR_IOFS: case IR_MOV: case IR_CAST: case IR_COND:
+  case IR_ADD: case IR_SUB: case IR_MUL: case IR_BITAND: case IR_BITOR: case IR_BITXOR:
+  case IR_LSHIFT: case IR_RSHIFT: case IR_NEG: case IR_BITNOT:
+  case IR_POPCNT: case IR_CLZ: case IR_CTZ: case IR_BSWAP:
+    break;
+  default:
+    return false;
+  }
+  if (ir->dst->flag & VRF_STACK_PARAM)
+    return false;
+  VReg *vregs[] = {ir->dst, ir->opr1, ir->opr2};
+  for (int k = 0; k < 3; ++k) {
+    VReg *vreg = vregs[k];
+    if (vreg != NULL && vreg->flag & VRF_FLONUM)
+      return false;
+  }
+  return true;
+}
+
+// Returns the destination of `bb` if it is an arm of a branch from `from`,
+// which consists of a few speculatable IRs.
+static BB *get_select_arm_dest(BB *bb, BB *from) {
+  if (bb->from_bbs->len != 1 || bb->from_bbs->data[0] != from)
+    return NULL;
+  Vector *irs = bb->irs;
+  int len = irs->len;
+  IR *jmp = is_last_jmp(bb);
+  if (jmp != NULL) {
+    if (jmp->jmp.cond != COND_ANY)
+      return NULL;
+    --len;
+  }
+  if (len > MAX_SELECT_ARM_IRS)
+    return NULL;
+  for (int i = 0; i < len; ++i) {
+    if (!is_speculatable_ir(irs->data[i]))
+      return NULL;
+  }
+  return jmp != NULL ? jmp->jmp.bb : bb->next;
+}
+
+static bool is_aliasable_mov(IR *ir) {
+  return ir->kind == IR_MOV && ir->opr1->vsize == ir->dst->vsize;
+}
+
+// Convert small branches (diamond or triangle shaped) into selects:
+//   if (opr1 @@ opr2) {x = a;} else {x = b;}  =>  x = (opr1 @@ opr2) ? a : b
+// IRs in arms are executed unconditionally, with their destinations renamed.
+static bool convert_branches_to_selects(RegAlloc *ra, BBContainer *bbcon) {
+  detect_from_bbs(bbcon);
+
+  int vreg_count = ra->vregs->len;
+  int *read_count = calloc_or_die(sizeof(*read_count) * vreg_count);
+  for (int i = 0; i < bbcon->len; ++i) {
+    BB *bb = bbcon->data[i];
+    for (int j = 0; j < bb->irs->len; ++j) {
+      IR *ir = bb->irs->data[j];
+      VReg *vregs[] = {ir->opr1, ir->opr2, NULL};
+      if (ir->kind == IR_LOAD || ir->kind == IR_STORE)
+        vregs[2] = ir->mem.index;
+      for (int k = 0; k < 3; ++k) {
+        VReg *vreg = vregs[k];
+        if (vreg != NULL && !(vreg->flag & VRF_CONST))
+          ++read_count[vreg->virt];
+      }
+    }
+  }
+
+  // Values of vregs at the end of each arm: [0] for true, [1] for false.
+  VReg **maps[2];
+  for (int a = 0; a < 2; ++a)
+    maps[a] = calloc_or_die(sizeof(*maps[a]) * vreg_count);
+  int *inner_read_count = calloc_or_die(sizeof(*inner_read_count) * vreg_count);
+  Vector *defs = new_vector();  // <VReg*>: Vregs assigned in arms.
+
+  bool changed = false;
+  for (int i = 0; i < bbcon->len; ++i) {
+    BB *bb = bbcon->data[i];
+    IR *jmp = is_last_jmp(bb);
+    if (jmp == NULL || jmp->jmp.cond == COND_ANY || jmp->jmp.cond & COND_FLONUM)
+      continue;
+    BB *tbb = jmp->jmp.bb, *fbb = bb->next;
+    if (fbb == NULL || tbb == fbb)
+      continue;
+    BB *tdst = get_select_arm_dest(tbb, bb);
+    BB *fdst = get_select_arm_dest(fbb, bb);
+    BB *arms[2] = {tbb, fbb};
+    BB *join;
+    if (tdst != NULL && tdst == fdst) {
+      join = tdst;
+    } else if (fdst == tbb) {
+      arms[0] = NULL;
+      join = tbb;
+    } else if (tdst == fbb) {
+      arms[1] = NULL;
+      join = fbb;
+    } else {
+      continue;
+    }
+
+    // Check: vregs which need select, and their order.
+    bool ok = true;
+    for (int a = 0; a < 2 && ok; ++a) {
+      BB *arm = arms[a];
+      if (arm == NULL)
+        continue;
+      VReg **map = maps[a];
+      for (int j = 0; j < arm->irs->len && ok; ++j) {
+        IR *ir = arm->irs->data[j];
+        if (ir->kind == IR_JMP)
+          break;
+        VReg *oprs[] = {ir->opr1, ir->opr2};
+        for (int k = 0; k < 2; ++k) {
+          VReg *vreg = oprs[k];
+          if (vreg != NULL && !(vreg->flag & VRF_CONST) && vreg->virt < vreg_count &&
+              map[vreg->virt] != NULL)
+            ++inner_read_count[vreg->virt];
+        }
+        VReg *dst = ir->dst;
+        if (dst->virt >= vreg_count) {
+          ok = false;
+          break;
+        }
+        if (!vec_contains(defs, dst))
+          vec_push(defs, dst);
+        // Aliased value, or temporary (marked with itself).
+        VReg *src = ir->opr1;
+        if (is_aliasable_mov(ir) && !(src->flag & VRF_CONST) && src->virt < vreg_count &&
+            map[src->virt] != NULL)
+          src = map[src->virt];
+        map[dst->virt] = is_aliasable_mov(ir) ? src : dst;
+      }
+    }
+    int nsel = 0;
+    for (int j = 0; j < defs->len && ok; ++j) {
+      VReg *dst = defs->data[j];
+      if (read_count[dst->virt] <= inner_read_count[dst->virt])
+        continue;
+      // Selects are executed in order, so operands must not be overwritten by previous ones.
+      for (int k = 0; k < j; ++k) {
+        VReg *prev = defs->data[k];
+        if (read_count[prev->virt] > inner_read_count[prev->virt] &&
+            (prev == jmp->opr1 || prev == jmp->opr2 || prev == maps[0][dst->virt] ||
+             prev == maps[1][dst->virt]))
+          ok = false;
+      }
+      ++nsel;
+    }
+    ok = ok && nsel <= MAX_SELECTS;
+
+    if (ok) {
+      // Execute IRs in arms unconditionally.
+      vec_pop(bb->irs);
+      for (int a = 0; a < 2; ++a) {
+        BB *arm = arms[a];
+        if (arm == NULL)
+          continue;
+        VReg **map = maps[a];
+        for (int j = 0; j < defs->len; ++j)
+          map[((VReg*)defs->data[j])->virt] = NULL;
+        for (int j = 0; j < arm->irs->len; ++j) {
+          IR *ir = arm->irs->data[j];
+          if (ir->kind == IR_JMP)
+            break;
+          VReg **oprs[] = {&ir->opr1, &ir->opr2};
+          for (int k = 0; k < 2; ++k) {
+            VReg *vreg = *oprs[k];
+            if (vreg != NULL && !(vreg->flag & VRF_CONST) && vreg->virt < vreg_count &&
+                map[vreg->virt] != NULL)
+              *oprs[k] = map[vreg->virt];
+          }
+          VReg *dst = ir->dst;
+          if (is_aliasable_mov(ir)) {
+            map[dst->virt] = ir->opr1;
+          } else {
+            VReg *tmp = reg_alloc_spawn(ra, dst->vsize, dst->flag & VRF_MASK);
+            map[dst->virt] = ir->dst = tmp;
+            vec_push(bb->irs, ir);
+          }
+        }
+        vec_clear(arm->irs);
+      }
+
+      assert(curbb == NULL);
+      curbb = bb;
+      for (int j = 0; j < defs->len; ++j) {
+        VReg *dst = defs->data[j];
+        if (read_count[dst->virt] <= inner_read_count[dst->virt])
+          continue;
+        VReg *tval = maps[0][dst->virt] != NULL ? maps[0][dst->virt] : dst;
+        VReg *fval = maps[1][dst->virt] != NULL ? maps[1][dst->virt] : dst;
+        if (tval == fval)
+          new_ir_mov(dst, tval, 0);
+        else
+          new_ir_select(dst, jmp->opr1, jmp->opr2, jmp->jmp.cond, tval, fval);
+        VReg *vals[] = {tval, fval};
+        for (int k = 0; k < 2; ++k) {
+          if (!(vals[k]->flag & VRF_CONST) && vals[k]->virt < vreg_count)
+            ++read_count[vals[k]->virt];
+        }
+      }
+      new_ir_jmp(join);
+      curbb = NULL;
+      changed = true;
+    }
+
+    for (int j = 0; j < defs->len; ++j) {
+      int virt = ((VReg*)defs->data[j])->virt;
+      maps[0][virt] = maps[1][virt] = NULL;
+      inner_read_count[virt] = 0;
+    }
+    vec_clear(defs);
+  }
+
+  free_vector(defs);
+  free(inner_read_count);
+  for (int a = 0; a < 2; ++a)
+    free(maps[a]);
+  free(read_count);
+  return changed;
+}
+
 //
 
 void optimize(RegAlloc *ra, BBContainer *bbcon) {
@@ -543,18 +2133,30 @@ void optimize(RegAlloc *ra, BBContainer *bbcon) {
     BB *bb = bbcon->data[i];
     peephole(ra, bb);
   }
+  promote_frame_slots(ra, bbcon);
+  forward_memory(ra, bbcon);
 
   if (apply_ssa) {
     make_ssa(ra, bbcon);
     copy_propagation(ra, bbcon);
+    share_pure_calls(bbcon);
+    lower_const_arith(ra, bbcon);
     remove_unused_vregs(ra, bbcon);
     if (!keep_phi) {
       resolve_phis(ra, bbcon);
       remove_unnecessary_bb(bbcon);
     }
   } else {
+    share_pure_calls(bbcon);
+    lower_const_arith(ra, bbcon);
     remove_unused_vregs(ra, bbcon);
     remove_unnecessary_bb(bbcon);
   }
+  fold_mem_operands(ra, bbcon);
+  if (!apply_ssa || !keep_phi) {
+    if (convert_branches_to_selects(ra, bbcon))
+      remove_unnecessary_bb(bbcon);
+    layout_basic_blocks(bbcon);
+  }
   detect_from_bbs(bbcon);
 }
@@ -36,6 +36,7 @@ inline VReg *alloc_vreg(enum VRegSize vsize, int vflag) {
   vreg->version = 0;
   vreg->reg_param_index = -1;
   vreg->frame.offset = 0;
+  vreg->frame.flag = 0;
   return vreg;
 }
 
@@ -105,9 +106,9 @@ static int sort_live_interval(const void *pa, const void *pb) {
 
 static void split_at_interval(RegAlloc *ra, LiveInterval **active, int active_count,
                               LiveInterval *li) {
-  assert(active_count > 0);
-  LiveInterval *spill = active[active_count - 1];
-  if (spill->end > li->end) {
+  // Take over the register of the furthest active interval, if it is usable.
+  LiveInterval *spill = active_count > 0 ? active[active_count - 1] : NULL;
+  if (spill != NULL && spill->end > li->end && !(li->occupied_reg_bit & (1UL << spill->phys))) {
     li->phys = spill->phys;
     spill->phys = ra->settings->phys_max;
     spill->state = LI_SPILL;
@@ -122,6 +123,7 @@ typedef struct {
   LiveInterval **active;
   int phys_max;
   int phys_temporary;
+  unsigned long callee_save_bits;
   int active_count;
   unsigned long using_bits;
   unsigned long used_bits;
@@ -177,8 +179,14 @@ static void check_live_interval(BBContainer *bbcon, int vreg_count, LiveInterval
 
     for (int j = 0; j < bb->irs->len; ++j, ++nip) {
       IR *ir = bb->irs->data[j];
-      VReg *vregs[] = {ir->dst, ir->opr1, ir->opr2};
-      for (int k = 0; k < 3; ++k) {
+      VReg *vregs[] = {ir->dst, ir->opr1, ir->opr2, NULL, NULL};
+      if (ir->kind == IR_LOAD || ir->kind == IR_STORE) {
+        vregs[3] = ir->mem.index;
+      } else if (ir->kind == IR_SELECT) {
+        vregs[3] = ir->select.tval;
+        vregs[4] = ir->select.fval;
+      }
+      for (int k = 0; k < 5; ++k) {
         VReg *vreg = vregs[k];
         if (vreg == NULL || (vreg->flag & VRF_CONST))
           continue;
@@ -206,20 +214,25 @@ static void occupy_regs(RegAlloc *ra, Vector *actives, unsigned long ioccupy,
 
 static void detect_live_interval_flags(RegAlloc *ra, BBContainer *bbcon, int vreg_count,
                                        LiveInterval **sorted_intervals) {
+  const RegAllocSettings *settings = ra->settings;
   Vector *inactives = new_vector();
   Vector *actives = new_vector();
   for (int i = 0; i < vreg_count; ++i) {
     LiveInterval *li = sorted_intervals[i];
     if (li->end < 0)
       continue;
+    // Short vector is held only in the vector register class.
+    VReg *vreg = ra->vregs->data[li->virt];
+    if (vreg != NULL && vreg->vsize == VRegSize16)
+      li->occupied_reg_bit |= ~settings->vector_fregs;
     vec_push(li->start < 0 ? actives : inactives, li);
   }
 
-  const RegAllocSettings *settings = ra->settings;
   int nip = 0;
   unsigned long iargset = 0, fargset = 0;
   for (int i = 0; i < bbcon->len; ++i) {
     BB *bb = bbcon->data[i];
+    unsigned long iresultset = 0, fresultset = 0;
     for (int j = 0; j < bb->irs->len; ++j, ++nip) {
       IR *ir = bb->irs->data[j];
       if (settings->detect_extra_occupied != NULL) {
@@ -230,6 +243,8 @@ static void detect_live_interval_flags(RegAlloc *ra, BBContainer *bbcon, int vre
 
       if (iargset != 0 || fargset != 0)
         occupy_regs(ra, actives, iargset, fargset);
+      if (iresultset != 0 || fresultset != 0)
+        occupy_regs(ra, actives, iresultset, fresultset);
 
       // Deactivate registers which end at this ip.
       for (int k = 0; k < actives->len; ++k) {
@@ -256,12 +271,29 @@ static void detect_live_interval_flags(RegAlloc *ra, BBContainer *bbcon, int vre
         }
       }
 
+      // Result registers are set one by one, so keep them for the following results.
+      if (ir->kind == IR_RESULT && ir->dst == NULL) {
+        if (ir->opr1->flag & VRF_FLONUM)
+          fresultset |= 1UL << ir->result.index;
+        else
+          iresultset |= 1UL << settings->reg_result_mapping[ir->result.index];
+      }
+
       // Call instruction breaks registers which contain in their live interval (start < nip < end).
       if (ir->kind == IR_CALL) {
-        // Non-saved registers on calling convention.
-        const unsigned long ibroken = (1UL << settings->phys_temporary_count) - 1;
-        const unsigned long fbroken = (1UL << settings->fphys_temporary_count) - 1;
+        // Non-saved registers on calling convention, narrowed to those the callee breaks:
+        // values living across the call are put into preserved registers, or spilled.
+        const unsigned long ibroken = (((1UL << settings->phys_temporary_count) - 1) |
+                                       settings->caller_save_bits) & ir->call.clobbered_regs;
+        const unsigned long fbroken = (((1UL << settings->fphys_temporary_count) - 1) |
+                                       settings->fcaller_save_bits) & ir->call.clobbered_fregs;
         occupy_regs(ra, actives, ibroken, fbroken);
+        // Registers are saved only in 64bit over the call, so short vector across it is spilled.
+        for (int k = 0; k < actives->len; ++k) {
+          LiveInterval *li = actives->data[k];
+          if (((VReg*)ra->vregs->data[li->virt])->vsize == VRegSize16)
+            li->occupied_reg_bit = ~0UL;
+        }
         iargset = fargset = 0;
       }
 
@@ -286,6 +318,8 @@ static void linear_scan_register_allocation(RegAlloc *ra, LiveInterval **sorted_
     .active = ALLOCA(sizeof(LiveInterval*) * ra->settings->phys_max),
     .phys_max = ra->settings->phys_max,
     .phys_temporary = ra->settings->phys_temporary_count,
+    .callee_save_bits = REG_BIT_RANGE(ra->settings->phys_temporary_count, ra->settings->phys_max) &
+                        ~ra->settings->caller_save_bits,
     .active_count = 0,
     .using_bits = 0,
     .used_bits = 0,
@@ -294,6 +328,8 @@ static void linear_scan_register_allocation(RegAlloc *ra, LiveInterval **sorted_
     .active = ALLOCA(sizeof(LiveInterval*) * ra->settings->fphys_max),
     .phys_max = ra->settings->fphys_max,
     .phys_temporary = ra->settings->fphys_temporary_count,
+    .callee_save_bits = REG_BIT_RANGE(ra->settings->fphys_temporary_count, ra->settings->fphys_max) &
+                        ~ra->settings->fcaller_save_bits,
     .active_count = 0,
     .using_bits = 0,
     .used_bits = 0,
@@ -330,10 +366,14 @@ static void linear_scan_register_allocation(RegAlloc *ra, LiveInterval **sorted_
         start_index = prsp->phys_temporary;
     }
     if (regno < 0) {
-      for (int j = start_index; j < prsp->phys_max; ++j) {
-        if (!(occupied & (1UL << j))) {
-          regno = j;
-          break;
+      // Prefer registers which are not needed to be saved in prologue.
+      for (int pass = 0; pass < 2 && regno < 0; ++pass) {
+        unsigned long skip = occupied | (pass == 0 ? prsp->callee_save_bits : 0);
+        for (int j = start_index; j < prsp->phys_max; ++j) {
+          if (!(skip & (1UL << j))) {
+            regno = j;
+            break;
+          }
         }
       }
     }
@@ -355,13 +395,21 @@ static void linear_scan_register_allocation(RegAlloc *ra, LiveInterval **sorted_
 static int insert_tmp_reg(RegAlloc *ra, Vector *irs, int j, VReg *spilled) {
   VReg *tmp = reg_alloc_spawn(ra, spilled->vsize, VRF_NO_SPILL | (spilled->flag & VRF_MASK));
   IR *ir = irs->data[j];
-  VReg *opr = ir->opr1 == spilled ? ir->opr1 : ir->opr2 == spilled ? ir->opr2 : NULL;
-  if (opr != NULL) {
-    vec_insert(irs, j++, new_ir_load_spilled(tmp, opr, ir->flag));
+  bool mem = ir->kind == IR_LOAD || ir->kind == IR_STORE;
+  bool sel = ir->kind == IR_SELECT;
+  if (ir->opr1 == spilled || ir->opr2 == spilled || (mem && ir->mem.index == spilled) ||
+      (sel && (ir->select.tval == spilled || ir->select.fval == spilled))) {
+    vec_insert(irs, j++, new_ir_load_spilled(tmp, spilled, ir->flag));
     if (ir->opr1 == spilled)
       ir->opr1 = tmp;
     if (ir->opr2 == spilled)
       ir->opr2 = tmp;
+    if (mem && ir->mem.index == spilled)
+      ir->mem.index = tmp;
+    if (sel && ir->select.tval == spilled)
+      ir->select.tval = tmp;
+    if (sel && ir->select.fval == spilled)
+      ir->select.fval = tmp;
   }
   if (ir->dst == spilled) {
     vec_insert(irs, ++j, new_ir_store_spilled(ir->dst, tmp));
@@ -381,12 +429,14 @@ static int insert_load_store_spilled_irs(RegAlloc *ra, BBContainer *bbcon) {
   };
   static const int kSpillTable[] = {
     [IR_LOAD]    = D12, [IR_STORE]   = D12, [IR_ADD]     = D12, [IR_SUB]     = D12,
-    [IR_MUL]     = D12, [IR_DIV]     = D12, [IR_MOD]     = D12, [IR_BITAND]  = D12,
-    [IR_BITOR]   = D12, [IR_BITXOR]  = D12, [IR_LSHIFT]  = D12, [IR_RSHIFT]  = D12,
-    [IR_NEG]     = D12, [IR_BITNOT]  = D12, [IR_COND]    = D12,
+    [IR_MUL]     = D12, [IR_MULHI]   = D12, [IR_DIV]     = D12, [IR_MOD]     = D12,
+    [IR_BITAND]  = D12, [IR_BITOR]   = D12, [IR_BITXOR]  = D12, [IR_LSHIFT]  = D12,
+    [IR_RSHIFT]  = D12, [IR_NEG]     = D12, [IR_BITNOT]  = D12, [IR_COND]    = D12,
+    [IR_POPCNT]  = D12, [IR_CLZ]     = D12, [IR_CTZ]     = D12, [IR_BSWAP]   = D12,
+    [IR_SELECT]  = D12,
     [IR_JMP]     = D12, [IR_TJMP]    = D12, [IR_PRECALL] = D12, [IR_PUSHARG] = D12,
     [IR_CALL]    = D12, [IR_RESULT]  = D12, [IR_SUBSP]   = D12, [IR_CAST]    = D12,
-    [IR_MOV]     = D12, [IR_KEEP]    = D12, [IR_ASM]     = D12,
+    [IR_MOV]     = D12, [IR_KEEP]    = D12, [IR_ASM]     = D12, [IR_VOP]     = D12,
 
     [IR_BOFS]    = D__, [IR_IOFS]    = D__, [IR_SOFS]    = D__,
 
@@ -417,6 +467,22 @@ static int insert_load_store_spilled_irs(RegAlloc *ra, BBContainer *bbcon) {
         ++inserted;
       }
 
+      if ((ir->kind == IR_LOAD || ir->kind == IR_STORE) && ir->mem.index != NULL &&
+          (ir->mem.index->flag & VRF_SPILLED)) {
+        j = insert_tmp_reg(ra, irs, j, ir->mem.index);
+        ++inserted;
+      }
+
+      if (ir->kind == IR_SELECT) {
+        VReg *vals[] = {ir->select.tval, ir->select.fval};
+        for (int k = 0; k < 2; ++k) {
+          if (vals[k]->flag & VRF_SPILLED) {
+            j = insert_tmp_reg(ra, irs, j, vals[k]);
+            ++inserted;
+          }
+        }
+      }
+
       if (ir->dst != NULL && (flag & DST) != 0 && (ir->dst->flag & VRF_SPILLED)) {
         assert(!(ir->dst->flag & VRF_CONST));
         j = insert_tmp_reg(ra, irs, j, ir->dst);
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <limits.h>  // CHAR_BIT
 #include <stdbool.h>
 #include <stddef.h>  // size_t
 
@@ -30,12 +31,22 @@ typedef struct LiveInterval {
 typedef struct RegAllocSettings {
   unsigned long (*detect_extra_occupied)(RegAlloc *ra, IR *ir);
   const int *reg_param_mapping;
+  const int *reg_result_mapping;  // Integer registers for results, floating-point ones from index 0.
   int phys_max;              // Max physical register count.
   int phys_temporary_count;  // Temporary register count (= start index for saved registers)
   int fphys_max;             // Floating-point register.
   int fphys_temporary_count;
+  // Registers (other than temporaries) which are not preserved across function calls.
+  unsigned long caller_save_bits;
+  unsigned long fcaller_save_bits;
+  // Floating-point registers which hold a 128bit vector: register class for VRegSize16.
+  unsigned long vector_fregs;
 } RegAllocSettings;
 
+// Bits for registers [start, end).
+#define REG_BIT_RANGE(start, end) \
+  ((end) <= (start) ? 0UL : (~0UL >> (sizeof(unsigned long) * CHAR_BIT - (end))) & ~((1UL << (start)) - 1))
+
 #define RAF_STACK_FRAME  (1 << 0)  // Require stack frame
 
 typedef struct RegAlloc {
@@ -23,6 +23,13 @@ static inline void assign_new_vregs(RegAlloc *ra, Vector **vreg_table, BB *bb, V
     if (ir->opr2 != NULL && !(ir->opr2->flag & (VRF_CONST | VRF_REF))) {
       ir->opr2 = vregs[ORIG_VIRT(ir->opr2)];
     }
+    if (ir->kind == IR_CALL) {
+      VReg **args = ir->call.args;
+      for (int i = 0, n = ir->call.total_arg_count; i < n; ++i) {
+        if (!(args[i]->flag & (VRF_CONST | VRF_REF)))
+          args[i] = vregs[ORIG_VIRT(args[i])];
+      }
+    }
     if (ir->dst != NULL && !(ir->dst->flag & (VRF_CONST | VRF_REF))) {
       int virt = ORIG_VIRT(ir->dst);
       Vector *vt = vreg_table[virt];
@@ -53,6 +53,20 @@ static Expr *proc_builtin_nan(const Token *ident) {
 }
 #endif
 
+// Count registers used by the aggregate parameter passed through registers.
+static void count_aggregate_param_regs(const VarInfo *info, int *gn, int *fn) {
+  if (!(info->local.frameinfo->flag & FIF_REG_PARAM))
+    return;
+  AggregatePart parts[MAX_AGGREGATE_PARTS];
+  int n = classify_aggregate(info->type, parts);
+  for (int i = 0; i < n; ++i) {
+    if (parts[i].is_flo)
+      ++*fn;
+    else
+      ++*gn;
+  }
+}
+
 #if VAARG_ON_STACK
 static VReg *gen_builtin_va_start(Expr *expr) {
   assert(expr->kind == EX_FUNCALL);
@@ -100,8 +114,12 @@ static VReg *gen_builtin_va_start(Expr *expr) {
     const Type *t = info->type;
     int size = 0, align = 0;
     if (t->kind == TY_STRUCT) {
-      size = type_size(t);
-      align = align_size(t);
+      if (info->local.frameinfo->flag & FIF_REG_PARAM) {
+        count_aggregate_param_regs(info, &gn, &fn);
+      } else {
+        size = type_size(t);
+        align = align_size(t);
+      }
     } else {
       if (is_flonum(t)) {
         if (fn >= MAX_FREG_ARGS)
@@ -153,13 +171,15 @@ static VReg *gen_builtin_va_start(Expr *expr) {
     return NULL;
   }
 
-  int gn = 0;
+  int gn = 0, fn = 0;
   for (int i = 0; i < params->len; ++i) {
     VarInfo *info = params->data[i];
     const Type *t = info->type;
     if (t->kind != TY_STRUCT) {
       if (!is_flonum(t))
         ++gn;
+    } else {
+      count_aggregate_param_regs(info, &gn, &fn);
     }
   }
 
@@ -231,6 +251,8 @@ static VReg *gen_builtin_va_start(Expr *expr) {
         ++fn;
       else
         ++gn;
+    } else {
+      count_aggregate_param_regs(info, &gn, &fn);
     }
   }
 
@@ -270,6 +292,7 @@ static VReg *gen_builtin_va_start(Expr *expr) {
         vsize, IRF_UNSIGNED);
     FrameInfo *fi = malloc_or_die(sizeof(*fi));
     fi->offset = -(MAX_REG_ARGS + MAX_FREG_ARGS) * TARGET_POINTER_SIZE;
+    fi->flag = 0;
     VReg *p = new_ir_bofs(fi);
     new_ir_store(reg_save_area, p, 0);
   }
@@ -297,6 +320,139 @@ static VReg *gen_alloca(Expr *expr) {
   return result;
 }
 
+static VReg *gen_builtin_expect(Expr *expr) {
+  // Branch hint is handled in `gen_if`.
+  Vector *args = expr->funcall.args;
+  assert(args->len == 2);
+  VReg *result = gen_expr(args->data[0]);
+  gen_expr(args->data[1]);
+  return result;
+}
+
+static VReg *gen_builtin_unreachable(Expr *expr) {
+  UNUSED(expr);
+  curbb->cold = true;
+  FuncBackend *fnbe = curfunc->extra;
+  new_ir_jmp(fnbe->ret_bb);
+  set_curbb(new_bb());
+  return NULL;
+}
+
+static VReg *gen_builtin_prefetch(Expr *expr) {
+  // Evaluate arguments only: rely on the hardware prefetcher.
+  Vector *args = expr->funcall.args;
+  for (int i = 0; i < args->len; ++i)
+    gen_expr(args->data[i]);
+  return NULL;
+}
+
+static VReg *gen_builtin_assume_aligned(Expr *expr) {
+  Vector *args = expr->funcall.args;
+  VReg *result = gen_expr(args->data[0]);
+  for (int i = 1; i < args->len; ++i)
+    gen_expr(args->data[i]);
+  return result;
+}
+
+// Bit operations
+
+static VReg *bitop_const(uint64_t value, enum VRegSize vsize) {
+  int bits = 8 << vsize;
+  if (bits < 64)
+    value &= (1ULL << bits) - 1;
+  return new_const_vreg(value, vsize);
+}
+
+static VReg *bitop_bop(enum IrKind kind, VReg *lhs, VReg *rhs, enum VRegSize vsize) {
+  return new_ir_bop(kind, lhs, rhs, vsize, IRF_UNSIGNED);
+}
+
+static VReg *gen_popcount(VReg *x, enum VRegSize vsize) {
+#if ARCH_HAS_POPCNT
+  return new_ir_unary(IR_POPCNT, x, vsize, IRF_UNSIGNED);
+#else
+  // Count bits in each 2, 4 and 8 bits, then sum up the bytes with multiplication.
+  int bits = 8 << vsize;
+  x = bitop_bop(IR_SUB, x, bitop_bop(IR_BITAND, bitop_bop(IR_RSHIFT, x, bitop_const(1, vsize), vsize),
+                                     bitop_const(0x5555555555555555ULL, vsize), vsize), vsize);
+  VReg *m2 = bitop_const(0x3333333333333333ULL, vsize);
+  x = bitop_bop(IR_ADD, bitop_bop(IR_BITAND, x, m2, vsize),
+                bitop_bop(IR_BITAND, bitop_bop(IR_RSHIFT, x, bitop_const(2, vsize), vsize), m2, vsize),
+                vsize);
+  x = bitop_bop(IR_BITAND, bitop_bop(IR_ADD, x, bitop_bop(IR_RSHIFT, x, bitop_const(4, vsize), vsize), vsize),
+                bitop_const(0x0f0f0f0f0f0f0f0fULL, vsize), vsize);
+  x = bitop_bop(IR_MUL, x, bitop_const(0x0101010101010101ULL, vsize), vsize);
+  return bitop_bop(IR_RSHIFT, x, bitop_const(bits - 8, vsize), vsize);
+#endif
+}
+
+static VReg *gen_clz(VReg *x, enum VRegSize vsize) {
+#if ARCH_HAS_CLZ
+  return new_ir_unary(IR_CLZ, x, vsize, IRF_UNSIGNED);
+#else
+  // Fill the bits below the most significant 1, and count the remaining zeros.
+  int bits = 8 << vsize;
+  for (int shift = 1; shift < bits; shift <<= 1)
+    x = bitop_bop(IR_BITOR, x, bitop_bop(IR_RSHIFT, x, bitop_const(shift, vsize), vsize), vsize);
+  return gen_popcount(new_ir_unary(IR_BITNOT, x, vsize, IRF_UNSIGNED), vsize);
+#endif
+}
+
+static VReg *gen_ctz(VReg *x, enum VRegSize vsize) {
+#if ARCH_HAS_CTZ
+  return new_ir_unary(IR_CTZ, x, vsize, IRF_UNSIGNED);
+#else
+  // Count the bits below the least significant 1.
+  VReg *lsb = bitop_bop(IR_BITAND, x, new_ir_unary(IR_NEG, x, vsize, IRF_UNSIGNED), vsize);
+  return gen_popcount(bitop_bop(IR_SUB, lsb, bitop_const(1, vsize), vsize), vsize);
+#endif
+}
+
+static VReg *gen_bswap(VReg *x, enum VRegSize vsize) {
+#if ARCH_HAS_BSWAP
+  if (vsize >= VRegSize4)
+    return new_ir_unary(IR_BSWAP, x, vsize, IRF_UNSIGNED);
+#endif
+  int bytes = 1 << vsize;
+  VReg *result = NULL;
+  for (int i = 0; i < bytes; ++i) {
+    VReg *byte = bitop_bop(IR_BITAND, bitop_bop(IR_RSHIFT, x, bitop_const(i * 8, vsize), vsize),
+                           bitop_const(0xff, vsize), vsize);
+    byte = bitop_bop(IR_LSHIFT, byte, bitop_const((bytes - 1 - i) * 8, vsize), vsize);
+    result = result == NULL ? byte : bitop_bop(IR_BITOR, result, byte, vsize);
+  }
+  return result;
+}
+
+static VReg *cast_to_int(VReg *vreg) {
+  enum VRegSize vsize = to_vsize(&tyInt);
+  if (vreg->vsize == vsize)
+    return vreg;
+  if (vreg->flag & VRF_CONST)
+    return new_const_vreg(vreg->fixnum, vsize);
+  return new_ir_cast(vreg, vsize, 0)->dst;
+}
+
+static VReg *gen_builtin_popcount(Expr *expr) {
+  Expr *arg = expr->funcall.args->data[0];
+  return cast_to_int(gen_popcount(gen_expr(arg), to_vsize(arg->type)));
+}
+
+static VReg *gen_builtin_clz(Expr *expr) {
+  Expr *arg = expr->funcall.args->data[0];
+  return cast_to_int(gen_clz(gen_expr(arg), to_vsize(arg->type)));
+}
+
+static VReg *gen_builtin_ctz(Expr *expr) {
+  Expr *arg = expr->funcall.args->data[0];
+  return cast_to_int(gen_ctz(gen_expr(arg), to_vsize(arg->type)));
+}
+
+static VReg *gen_builtin_bswap(Expr *expr) {
+  Expr *arg = expr->funcall.args->data[0];
+  return gen_bswap(gen_expr(arg), to_vsize(arg->type));
+}
+
 void install_builtins(void) {
   static BuiltinExprProc p_type_kind = &proc_builtin_type_kind;
   add_builtin_expr_ident("__builtin_type_kind", &p_type_kind);
@@ -331,4 +487,75 @@ void install_builtins(void) {
 
     add_builtin_function("alloca", type, &p_alloca, false);
   }
+
+  {
+    static BuiltinFunctionProc p_expect = &gen_builtin_expect;
+    Type *tyLong = get_fixnum_type(FX_LONG, false, 0);
+    Vector *params = new_vector();
+    vec_push(params, tyLong);
+    vec_push(params, tyLong);
+    add_builtin_function("__builtin_expect", new_func_type(tyLong, params, false), &p_expect, true);
+  }
+  {
+    static BuiltinFunctionProc p_unreachable = &gen_builtin_unreachable;
+    add_builtin_function("__builtin_unreachable", new_func_type(&tyVoid, new_vector(), false),
+                         &p_unreachable, true);
+  }
+  {
+    static BuiltinFunctionProc p_prefetch = &gen_builtin_prefetch;
+    Vector *params = new_vector();
+    vec_push(params, &tyVoidPtr);
+    add_builtin_function("__builtin_prefetch", new_func_type(&tyVoid, params, true), &p_prefetch,
+                         true);
+  }
+  {
+    static BuiltinFunctionProc p_assume_aligned = &gen_builtin_assume_aligned;
+    Vector *params = new_vector();
+    vec_push(params, &tyVoidPtr);
+    vec_push(params, &tySize);
+    add_builtin_function("__builtin_assume_aligned", new_func_type(&tyVoidPtr, params, true),
+                         &p_assume_aligned, true);
+  }
+  {
+    static BuiltinFunctionProc p_popcount = &gen_builtin_popcount;
+    static BuiltinFunctionProc p_clz = &gen_builtin_clz;
+    static BuiltinFunctionProc p_ctz = &gen_builtin_ctz;
+    static const struct {
+      const char *name;
+      BuiltinFunctionProc *proc;
+      enum FixnumKind kind;
+    } kBitCounts[] = {
+      {"__builtin_popcount", &p_popcount, FX_INT},
+      {"__builtin_popcountl", &p_popcount, FX_LONG},
+      {"__builtin_popcountll", &p_popcount, FX_LLONG},
+      {"__builtin_clz", &p_clz, FX_INT},
+      {"__builtin_clzl", &p_clz, FX_LONG},
+      {"__builtin_clzll", &p_clz, FX_LLONG},
+      {"__builtin_ctz", &p_ctz, FX_INT},
+      {"__builtin_ctzl", &p_ctz, FX_LONG},
+      {"__builtin_ctzll", &p_ctz, FX_LLONG},
+    };
+    for (int i = 0; i < (int)ARRAY_SIZE(kBitCounts); ++i) {
+      Vector *params = new_vector();
+      vec_push(params, get_fixnum_type(kBitCounts[i].kind, true, 0));
+      add_builtin_function(kBitCounts[i].name, new_func_type(&tyInt, params, false),
+                           kBitCounts[i].proc, true);
+    }
+
+    static BuiltinFunctionProc p_bswap = &gen_builtin_bswap;
+    static const struct {
+      const char *name;
+      enum FixnumKind kind;
+    } kBswaps[] = {
+      {"__builtin_bswap16", FX_SHORT},
+      {"__builtin_bswap32", FX_INT},
+      {"__builtin_bswap64", FX_LLONG},
+    };
+    for (int i = 0; i < (int)ARRAY_SIZE(kBswaps); ++i) {
+      Type *type = get_fixnum_type(kBswaps[i].kind, true, 0);
+      Vector *params = new_vector();
+      vec_push(params, type);
+      add_builtin_function(kBswaps[i].name, new_func_type(type, params, false), &p_bswap, true);
+    }
+  }
 }
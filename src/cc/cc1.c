@@ -53,6 +53,9 @@ static bool parse_fopt(const char *optarg, bool value) {
     off_t flag_offset;
   } kFlagTable[] = {
     {"common", offsetof(CcFlags, common)},
+    {"function-sections", offsetof(CcFlags, function_sections)},
+    {"data-sections", offsetof(CcFlags, data_sections)},
+    {"omit-frame-pointer", offsetof(CcFlags, omit_frame_pointer)},
   };
 
   for (size_t i = 0; i < ARRAY_SIZE(kFlagTable); ++i) {
@@ -72,6 +75,7 @@ int main(int argc, char *argv[]) {
   enum {
     OPT_FNO = 128,
     OPT_SSA,
+    OPT_DUMP_FRAME_SIZE,
   };
 
   static const struct option options[] = {
@@ -87,6 +91,9 @@ int main(int argc, char *argv[]) {
     // Feature flag.
     {"-apply-ssa", no_argument, OPT_SSA},
 
+    // Debug flag.
+    {"-dump-frame-size", no_argument, OPT_DUMP_FRAME_SIZE},
+
     {NULL},
   };
   int opt;
@@ -142,6 +149,10 @@ int main(int argc, char *argv[]) {
       }
       break;
 
+    case OPT_DUMP_FRAME_SIZE:
+      dump_frame_size = true;
+      break;
+
     case '?':
       fprintf(stderr, "Warning: unknown option: %s\n", argv[optind - 1]);
       break;
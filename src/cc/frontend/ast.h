@@ -470,6 +470,13 @@ typedef struct Function {
 #define FUNCF_NORETURN        (1 << 0)
 #define FUNCF_STACK_MODIFIED  (1 << 1)
 #define FUNCF_HAS_FUNCALL     (1 << 2)
+// Set from function attributes:
+#define FUNCF_NOINLINE        (1 << 3)
+#define FUNCF_ALWAYS_INLINE   (1 << 4)
+#define FUNCF_HOT             (1 << 5)
+#define FUNCF_COLD            (1 << 6)
+#define FUNCF_PURE            (1 << 7)  // No side effects, result depends on arguments and memory.
+#define FUNCF_CONST           (1 << 8)  // No side effects, result depends only on arguments.
 
 Function *new_func(Type *type, const Name *name, const Vector *params, Table *attributes, int flag);
 
@@ -3,6 +3,7 @@
 
 #include <assert.h>
 #include <inttypes.h>  // PRId64
+#include <stdlib.h>  // qsort
 
 #include "ast.h"
 #include "type.h"
@@ -255,3 +256,146 @@ void construct_initial_value(const Type *type, const Initializer *init,
   case TY_FUNC: case TY_VOID: assert(false); break;
   }
 }
+
+// Switch lowering
+
+#define MIN_JUMP_TABLE_CASES    (4)
+#define MIN_JUMP_TABLE_DENSITY  (40)  // Percentage of cases in the range.
+#define MAX_JUMP_TABLE_RANGE    (1 << 12)
+#define MAX_BIT_TEST_TARGETS    (3)
+
+static int compare_switch_cases(const void *pa, const void *pb) {
+  const SwitchCase *ca = pa;
+  const SwitchCase *cb = pb;
+  return ca->value > cb->value ? 1 : ca->value < cb->value ? -1 : 0;
+}
+
+static int compare_switch_cases_unsigned(const void *pa, const void *pb) {
+  UFixnum a = ((const SwitchCase*)pa)->value;
+  UFixnum b = ((const SwitchCase*)pb)->value;
+  return a > b ? 1 : a < b ? -1 : 0;
+}
+
+// Collect cases except default, in increasing order of their values.
+SwitchCase *sort_switch_cases(Stmt *swtch, bool is_unsigned, int *pcount) {
+  Vector *stmts = swtch->switch_.cases;
+  SwitchCase *cases = malloc_or_die(sizeof(*cases) * (stmts->len + 1));
+  int count = 0;
+  for (int i = 0; i < stmts->len; ++i) {
+    Stmt *c = stmts->data[i];
+    if (c->case_.value == NULL)
+      continue;
+    // Successive case labels (`case 1: case 2: ...`) share the target.
+    Stmt *target = c;
+    while (target->case_.stmt != NULL && target->case_.stmt->kind == ST_CASE)
+      target = target->case_.stmt;
+    SwitchCase *sc = &cases[count++];
+    sc->value = c->case_.value->fixnum;
+    sc->stmt = c;
+    sc->target = target;
+    sc->index = i;
+  }
+  qsort(cases, count, sizeof(*cases),
+        is_unsigned ? compare_switch_cases_unsigned : compare_switch_cases);
+  *pcount = count;
+  return cases;
+}
+
+static inline uint64_t case_span(const SwitchCase *cases, int first, int last) {
+  return (uint64_t)cases[last].value - (uint64_t)cases[first].value;
+}
+
+static int count_case_targets(const SwitchCase *cases, int first, int last, int limit) {
+  Stmt *targets[MAX_BIT_TEST_TARGETS + 1];
+  int n = 0;
+  for (int i = first; i <= last; ++i) {
+    int j;
+    for (j = 0; j < n; ++j) {
+      if (targets[j] == cases[i].target)
+        break;
+    }
+    if (j >= n) {
+      if (n >= limit)
+        return n + 1;
+      targets[n++] = cases[i].target;
+    }
+  }
+  return n;
+}
+
+// Whether a bit test is cheaper than comparing each case.
+static bool is_bit_test_profitable(int case_count, int target_count) {
+  switch (target_count) {
+  case 1:  return case_count >= 3;
+  case 2:  return case_count >= 5;
+  case 3:  return case_count >= 6;
+  default: return false;
+  }
+}
+
+// Split sorted cases into clusters: dense ranges become jump tables,
+// and neighbouring cases to a few targets within `max_bits` become bit tests.
+// `clusters` must have room for `count` elements. Returns the number of clusters.
+int cluster_switch_cases(const SwitchCase *cases, int count, int max_bits,
+                         SwitchCluster *clusters) {
+  // Partition into jump tables and single cases with the least number of clusters.
+  int *min_partitions = malloc_or_die(sizeof(*min_partitions) * (count + 1));
+  int *last = malloc_or_die(sizeof(*last) * (count + 1));
+  min_partitions[count] = 0;
+  for (int i = count; --i >= 0; ) {
+    min_partitions[i] = 1 + min_partitions[i + 1];
+    last[i] = i;
+    for (int j = i + MIN_JUMP_TABLE_CASES - 1; j < count; ++j) {
+      uint64_t span = case_span(cases, i, j);
+      if (span >= MAX_JUMP_TABLE_RANGE)
+        break;
+      if ((uint64_t)(j - i + 1) * 100 < (span + 1) * MIN_JUMP_TABLE_DENSITY)
+        continue;
+      int n = 1 + min_partitions[j + 1];
+      if (n <= min_partitions[i]) {
+        min_partitions[i] = n;
+        last[i] = j;
+      }
+    }
+  }
+
+  int cluster_count = 0;
+  for (int i = 0; i < count; i = last[i] + 1) {
+    SwitchCluster *cluster = &clusters[cluster_count++];
+    cluster->kind = last[i] > i ? SC_JUMP_TABLE : SC_CASE;
+    cluster->start = i;
+    cluster->count = last[i] - i + 1;
+  }
+  free(last);
+  free(min_partitions);
+
+  // Merge neighbouring clusters into bit tests.
+  if (max_bits > 0) {
+    int n = 0;
+    for (int k = 0; k < cluster_count; ) {
+      int first = clusters[k].start;
+      int end = -1, target_count = 0;
+      for (int m = k; m < cluster_count; ++m) {
+        int e = clusters[m].start + clusters[m].count - 1;
+        if (case_span(cases, first, e) >= (uint64_t)max_bits)
+          break;
+        int t = count_case_targets(cases, first, e, MAX_BIT_TEST_TARGETS);
+        if (t > MAX_BIT_TEST_TARGETS)
+          break;
+        end = m;
+        target_count = t;
+      }
+      if (end >= 0) {
+        int case_count = clusters[end].start + clusters[end].count - first;
+        if (is_bit_test_profitable(case_count, target_count)) {
+          clusters[n++] = (SwitchCluster){SC_BIT_TEST, first, case_count};
+          k = end + 1;
+          continue;
+        }
+      }
+      clusters[n++] = clusters[k++];
+    }
+    cluster_count = n;
+  }
+  return cluster_count;
+}
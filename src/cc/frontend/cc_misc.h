@@ -1,9 +1,11 @@
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
 
 typedef struct Expr Expr;
 typedef struct Initializer Initializer;
+typedef struct Stmt Stmt;
 typedef struct Type Type;
 
 typedef struct {
@@ -13,3 +15,28 @@ typedef struct {
 } ConstructInitialValueVTable;
 void construct_initial_value(const Type *type, const Initializer *init,
                              const ConstructInitialValueVTable *vtable, void *ud);
+
+// Switch lowering
+
+typedef struct {
+  int64_t value;
+  Stmt *stmt;    // Case statement.
+  Stmt *target;  // Cases which have same target reach the same statement.
+  int index;     // Index in `switch_.cases`.
+} SwitchCase;
+
+enum SwitchClusterKind {
+  SC_CASE,        // Single case: compare and jump.
+  SC_JUMP_TABLE,  // Dense cases: table jump.
+  SC_BIT_TEST,    // Cases to a few targets in a narrow range: test bit masks.
+};
+
+typedef struct {
+  enum SwitchClusterKind kind;
+  int start;  // Index of the first case.
+  int count;
+} SwitchCluster;
+
+SwitchCase *sort_switch_cases(Stmt *swtch, bool is_unsigned, int *pcount);
+int cluster_switch_cases(const SwitchCase *cases, int count, int max_bits,
+                         SwitchCluster *clusters);
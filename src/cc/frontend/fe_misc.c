@@ -24,6 +24,9 @@ int compile_error_count;
 CcFlags cc_flags = {
   .warn_as_error = false,
   .common = false,
+  .function_sections = false,
+  .data_sections = false,
+  .omit_frame_pointer = false,
   .optimize_level = 0,
 };
 
@@ -547,7 +550,25 @@ Expr *promote_to_int(Expr *expr) {
   return make_cast(&tyInt, expr->token, expr, false);
 }
 
+// Element-wise operation between same vector types.
+static Expr *new_expr_vector_bop(enum ExprKind kind, const Token *tok, Expr *lhs, Expr *rhs) {
+  if (!is_vector(lhs->type) || !same_type_without_qualifier(lhs->type, rhs->type, true)) {
+    parse_error(PE_NOFATAL, tok, "Cannot apply `%.*s' except same vector types",
+                (int)(tok->end - tok->begin), tok->begin);
+    return lhs;
+  }
+  Type *elem_type = lhs->type->struct_.info->members[0].type;
+  if (is_flonum(elem_type) && !(kind == EX_ADD || kind == EX_SUB || kind == EX_MUL || kind == EX_DIV))
+    parse_error(PE_NOFATAL, tok, "Cannot apply `%.*s' to floating-point vectors",
+                (int)(tok->end - tok->begin), tok->begin);
+  Type *type = get_vector_type(elem_type, type_size(lhs->type));
+  return new_expr_bop(kind, type, tok, lhs, rhs);
+}
+
 Expr *new_expr_num_bop(enum ExprKind kind, const Token *tok, Expr *lhs, Expr *rhs) {
+  if (is_vector(lhs->type) || is_vector(rhs->type))
+    return new_expr_vector_bop(kind, tok, lhs, rhs);
+
   if (is_const(lhs) && is_number(lhs->type) &&
       is_const(rhs) && is_number(rhs->type)) {
 #ifndef __NO_FLONUM
@@ -618,6 +639,8 @@ Expr *new_expr_num_bop(enum ExprKind kind, const Token *tok, Expr *lhs, Expr *rh
 }
 
 Expr *new_expr_int_bop(enum ExprKind kind, const Token *tok, Expr *lhs, Expr *rhs) {
+  if (is_vector(lhs->type) || is_vector(rhs->type))
+    return new_expr_vector_bop(kind, tok, lhs, rhs);
   if (!is_fixnum(lhs->type->kind))
     parse_error(PE_FATAL, lhs->token, "int type expected");
   if (!is_fixnum(rhs->type->kind))
@@ -626,6 +649,9 @@ Expr *new_expr_int_bop(enum ExprKind kind, const Token *tok, Expr *lhs, Expr *rh
 }
 
 Expr *new_expr_addsub(enum ExprKind kind, const Token *tok, Expr *lhs, Expr *rhs) {
+  if (is_vector(lhs->type) || is_vector(rhs->type))
+    return new_expr_vector_bop(kind, tok, lhs, rhs);
+
   lhs = str_to_char_array_var(curscope, lhs);
   rhs = str_to_char_array_var(curscope, rhs);
 
@@ -1605,6 +1631,9 @@ static void check_reachability_stmt(Stmt *stmt) {
             if (decl->defun.func->flag & FUNCF_NORETURN) {
               stmt->reach |= REACH_STOP;
             }
+          } else if (equal_name(fexpr->var.name,
+                                alloc_name("__builtin_unreachable", NULL, false))) {
+            stmt->reach |= REACH_STOP;
           }
         }
       }
@@ -1709,7 +1738,7 @@ bool satisfy_inline_criteria(const VarInfo *varinfo, int storage) {
   const Type *type = varinfo->type;
   if (type->kind == TY_FUNC && (varinfo->storage & VS_INLINE) && !type->func.vaargs) {
     Function *func = varinfo->global.func;
-    if (func != NULL) {
+    if (func != NULL && !(func->flag & FUNCF_NOINLINE)) {
       // Self-recursion or mutual recursion are prevented,
       // because some inline function must not be defined at funcall point.
       return func->body_block != NULL && func->label_table == NULL && func->gotos == NULL;
@@ -1718,6 +1747,21 @@ bool satisfy_inline_criteria(const VarInfo *varinfo, int storage) {
   return false;
 }
 
+bool can_inline_funcall(const VarInfo *varinfo) {
+  if (satisfy_inline_criteria(varinfo, 0))
+    return true;
+
+  // `always_inline' function is expanded even without `inline' specifier,
+  // but its definition is emitted as usual.
+  const Type *type = varinfo->type;
+  if (type->kind == TY_FUNC && !type->func.vaargs) {
+    Function *func = varinfo->global.func;
+    if (func != NULL && (func->flag & (FUNCF_ALWAYS_INLINE | FUNCF_NOINLINE)) == FUNCF_ALWAYS_INLINE)
+      return func->body_block != NULL && func->label_table == NULL && func->gotos == NULL;
+  }
+  return false;
+}
+
 static Stmt *duplicate_inline_function_stmt(Function *targetfunc, Scope *targetscope, Stmt *stmt);
 
 static Expr *duplicate_inline_function_expr(Function *targetfunc, Scope *targetscope, Expr *expr) {
@@ -1822,7 +1866,7 @@ static Expr *duplicate_inline_function_expr(Function *targetfunc, Scope *targets
       // Duplicate from original to receive function parameters correctly.
       VarInfo *varinfo = scope_find(global_scope, expr->inlined.funcname, NULL);
       assert(varinfo != NULL);
-      assert(satisfy_inline_criteria(varinfo, 0));
+      assert(can_inline_funcall(varinfo));
       return new_expr_inlined(expr->token, varinfo->name, expr->type, args,
                               embed_inline_funcall(varinfo));
     }
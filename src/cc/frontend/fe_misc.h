@@ -29,6 +29,9 @@ enum ParseErrorLevel {
 typedef struct {
   bool warn_as_error;  // Treat warnings as errors
   bool common;
+  bool function_sections;  // Put each function into its own section.
+  bool data_sections;  // Put each variable into its own section.
+  bool omit_frame_pointer;
   int optimize_level;
 } CcFlags;
 
@@ -112,4 +115,5 @@ bool check_funcend_return(Stmt *stmt);
 int get_funparam_index(Function *func, const Name *name);  // -1: Not funparam.
 
 bool satisfy_inline_criteria(const VarInfo *varinfo, int storage);
+bool can_inline_funcall(const VarInfo *varinfo);  // Whether funcall can be expanded in place.
 Stmt *embed_inline_funcall(VarInfo *varinfo);
@@ -0,0 +1,866 @@
+// Loop optimizations
+
+#include "../../config.h"
+#include "loop.h"
+
+#include <assert.h>
+
+#include "ast.h"
+#include "fe_misc.h"  // curfunc, curscope, cc_flags
+#include "type.h"
+#include "util.h"
+#include "var.h"
+
+static bool same_var(const Expr *a, const Expr *b) {
+  return a->kind == EX_VAR && b->kind == EX_VAR &&
+         a->var.name == b->var.name && a->var.scope == b->var.scope;
+}
+
+// Local variable which is never changed behind: not volatile and its address is not taken.
+static bool is_plain_local(const Expr *expr) {
+  if (expr->kind != EX_VAR || (expr->type->qualifier & TQ_VOLATILE))
+    return false;
+  Scope *scope;
+  VarInfo *varinfo = scope_find(expr->var.scope, expr->var.name, &scope);
+  return varinfo != NULL && !is_global_scope(scope) && is_local_storage(varinfo) &&
+         !(varinfo->storage & VS_REF_TAKEN);
+}
+
+static Expr *strip_int_cast(Expr *expr, size_t size) {
+  while (expr->kind == EX_CAST && is_fixnum(expr->type->kind) &&
+         is_fixnum(expr->unary.sub->type->kind) && !is_bool(expr->unary.sub->type) &&
+         type_size(expr->type) >= size && type_size(expr->unary.sub->type) >= size)
+    expr = expr->unary.sub;
+  return expr;
+}
+
+static Expr *clone_leaf(Expr *expr) {
+  switch (expr->kind) {
+  case EX_VAR:
+    return new_expr_variable(expr->var.name, expr->type, expr->token, expr->var.scope);
+  case EX_FIXNUM:
+    return new_expr_fixlit(expr->type, expr->token, expr->fixnum);
+  case EX_CAST:
+    return new_expr_cast(expr->type, expr->token, clone_leaf(expr->unary.sub));
+  default:
+    assert(false);
+    return expr;
+  }
+}
+
+// `(U)lhs - (U)rhs` for operands of a comparison, which does not overflow when `lhs >= rhs`.
+static Expr *gen_distance(const Token *tok, Expr *lhs, Expr *rhs) {
+  Type *utype = get_fixnum_type(lhs->type->fixnum.kind, true, 0);
+  return new_expr_addsub(EX_SUB, tok, make_cast(utype, tok, clone_leaf(lhs), false),
+                         make_cast(utype, tok, clone_leaf(rhs), false));
+}
+
+// `while (cond) { body; post; }`: Rest of the loop, which is not processed again.
+static Stmt *gen_remainder_loop(Stmt *stmt) {
+  const Token *tok = stmt->token;
+  Vector *stmts = new_vector();
+  vec_push(stmts, stmt->for_.body);
+  vec_push(stmts, new_stmt_expr(stmt->for_.post));
+  return new_stmt_while(tok, stmt->for_.cond, new_stmt_block(tok, stmts, NULL, NULL));
+}
+
+////////////////////////////////////////////////
+// Vectorization
+//
+// Innermost counted loop like
+//   for (i = 0; i < n; ++i) a[i] = b[i] * k + c[i];
+// is rewritten into
+//   i = 0;
+//   if (no overlap between `a`, `b` and `c`) {
+//     kv = {k, k, ...};
+//     for (; i < n && n - i >= W; i += W)
+//       *(V*)&a[i] = *(V*)&b[i] * kv + *(V*)&c[i];
+//   }
+//   while (i < n) { a[i] = b[i] * k + c[i]; ++i; }  // Scalar epilogue
+// so the element-wise operations on the vector types become SIMD instructions.
+// Reductions like `s += d[i]` are not targets: vector accumulators live in memory,
+// which is slower than the scalar sum in a register.
+// Loops with a small constant trip count are left to the full unrolling.
+
+#define VECTOR_SIZE  (16)
+
+// Array access in the loop: `base[i + offset]`.
+typedef struct {
+  Expr *base;  // Variable which holds the array or the pointer.
+  Fixnum offset;
+  bool store;
+} Access;
+
+typedef struct {
+  VectorOpChecker checker;
+  const Token *token;
+  Expr *ivar;  // Induction variable.
+  Expr *cond;  // `ivar < limit`.
+  Type *elem_type;  // Lane type, integers are treated as signed.
+  Type *vtype;
+  Vector *accesses;  // <Access*>
+  Vector *invariants;  // <Expr*>: Variables and constants, broadcast to all lanes.
+  Vector *bcasts;  // <Expr*>: Vector variables for `invariants`.
+} Loop;
+
+static bool is_full_unroll_target(Stmt *stmt);
+
+// Whether the value of the expression is usable as a lane: same floating point type,
+// or an integer at least the lane size (lower bits are same under add, sub, mul and bit ops).
+static bool is_lane_type(Loop *loop, const Type *type) {
+  const Type *elem_type = loop->elem_type;
+  if (is_flonum(elem_type))
+    return type->kind == TY_FLONUM && type->flonum.kind == elem_type->flonum.kind;
+  return is_fixnum(type->kind) && !is_bool(type) && type_size(type) >= type_size(elem_type);
+}
+
+static Type *lane_type_of(const Type *type) {
+  switch (type->kind) {
+  case TY_FIXNUM:
+    if (is_bool(type))
+      return NULL;
+    return get_fixnum_type_from_size(type_size(type));
+#ifndef __NO_FLONUM
+  case TY_FLONUM:
+    switch (type->flonum.kind) {
+    case FL_FLOAT:   return &tyFloat;
+    case FL_DOUBLE:  return &tyDouble;
+    default:  return NULL;
+    }
+#endif
+  default:
+    return NULL;
+  }
+}
+
+static bool set_lane_type(Loop *loop, const Type *type) {
+  Type *elem_type = lane_type_of(type);
+  if (elem_type == NULL)
+    return false;
+  if (loop->elem_type == NULL) {
+    loop->elem_type = elem_type;
+    loop->vtype = get_vector_type(elem_type, VECTOR_SIZE);
+    return true;
+  }
+  return elem_type == loop->elem_type;
+}
+
+// `*(base + (size_t)(i + offset) * size)`
+static bool match_access(Loop *loop, Expr *expr, Access *access) {
+  if (expr->kind != EX_DEREF || (expr->type->qualifier & TQ_VOLATILE) ||
+      !is_lane_type(loop, expr->type) || type_size(expr->type) != type_size(loop->elem_type))
+    return false;
+  Expr *addr = expr->unary.sub;
+  if (addr->kind != EX_ADD)
+    return false;
+  Expr *base = addr->bop.lhs;
+  Expr *index = addr->bop.rhs;
+  if (base->kind != EX_VAR)
+    return false;
+  if (base->type->kind == TY_PTR) {
+    if (!is_plain_local(base))
+      return false;
+  } else if (base->type->kind != TY_ARRAY) {
+    return false;
+  }
+  if (index->kind == EX_MUL) {
+    Expr *size = index->bop.rhs;
+    if (size->kind != EX_FIXNUM || size->fixnum != (Fixnum)type_size(expr->type))
+      return false;
+    index = index->bop.lhs;
+  } else if (type_size(expr->type) != 1) {
+    return false;
+  }
+
+  index = strip_int_cast(index, 0);
+  Fixnum offset = 0;
+  if (index->kind == EX_ADD || index->kind == EX_SUB) {
+    Expr *rhs = index->bop.rhs;
+    if (rhs->kind != EX_FIXNUM)
+      return false;
+    offset = index->kind == EX_ADD ? rhs->fixnum : -rhs->fixnum;
+    index = strip_int_cast(index->bop.lhs, 0);
+  }
+  if (!same_var(index, loop->ivar))
+    return false;
+
+  access->base = base;
+  access->offset = offset;
+  return true;
+}
+
+static bool add_access(Loop *loop, Expr *expr, bool store) {
+  Access *access = malloc_or_die(sizeof(*access));
+  if (!match_access(loop, expr, access))
+    return false;
+  access->store = store;
+  vec_push(loop->accesses, access);
+  return true;
+}
+
+static bool same_const(const Expr *a, const Expr *b) {
+  if (a->kind != b->kind)
+    return false;
+  switch (a->kind) {
+  case EX_FIXNUM:  return a->fixnum == b->fixnum;
+#ifndef __NO_FLONUM
+  case EX_FLONUM:  return a->flonum == b->flonum;
+#endif
+  default:  return false;
+  }
+}
+
+static void add_invariant(Loop *loop, Expr *expr) {
+  Vector *invariants = loop->invariants;
+  for (int i = 0; i < invariants->len; ++i) {
+    Expr *e = invariants->data[i];
+    if (same_var(e, expr) || same_const(e, expr))
+      return;
+  }
+  vec_push(invariants, expr);
+}
+
+// Whether the expression can be calculated lane by lane.
+static bool check_vector_expr(Loop *loop, Expr *expr) {
+  if (!is_flonum(loop->elem_type))
+    expr = strip_int_cast(expr, type_size(loop->elem_type));
+  if (!is_lane_type(loop, expr->type))
+    return false;
+
+  switch (expr->kind) {
+  case EX_FIXNUM:
+#ifndef __NO_FLONUM
+  case EX_FLONUM:
+#endif
+    add_invariant(loop, expr);
+    return true;
+  case EX_VAR:
+    if (!is_plain_local(expr) || same_var(expr, loop->ivar))
+      return false;
+    add_invariant(loop, expr);
+    return true;
+  case EX_DEREF:
+    return add_access(loop, expr, false);
+
+  case EX_ADD: case EX_SUB: case EX_MUL:
+    break;
+  case EX_DIV:
+    if (!is_flonum(expr->type))
+      return false;
+    break;
+  case EX_BITAND: case EX_BITOR: case EX_BITXOR:
+    if (is_flonum(expr->type))
+      return false;
+    break;
+  default:
+    return false;
+  }
+  return (*loop->checker)(expr->kind, loop->vtype) &&
+         check_vector_expr(loop, expr->bop.lhs) && check_vector_expr(loop, expr->bop.rhs);
+}
+
+// `a[i] = expr`
+static bool check_vector_stmt(Loop *loop, Expr *expr) {
+  if (expr->kind != EX_ASSIGN)
+    return false;
+  Expr *lhs = expr->bop.lhs;
+  return lhs->kind == EX_DEREF && set_lane_type(loop, lhs->type) &&
+         add_access(loop, lhs, true) && check_vector_expr(loop, expr->bop.rhs);
+}
+
+static bool check_vector_body(Loop *loop, Stmt *stmt) {
+  switch (stmt->kind) {
+  case ST_EXPR:
+    return check_vector_stmt(loop, stmt->expr);
+  case ST_BLOCK:
+    if (stmt->block.scope != NULL && stmt->block.scope->vars != NULL &&
+        stmt->block.scope->vars->len > 0)
+      return false;
+    for (int i = 0; i < stmt->block.stmts->len; ++i) {
+      Stmt *s = stmt->block.stmts->data[i];
+      if (s != NULL && !check_vector_body(loop, s))
+        return false;
+    }
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Stores must not be overlapped with other arrays in the vector width.
+static bool check_dependency(Loop *loop) {
+  Vector *accesses = loop->accesses;
+  for (int i = 0; i < accesses->len; ++i) {
+    Access *store = accesses->data[i];
+    if (!store->store)
+      continue;
+    for (int j = 0; j < accesses->len; ++j) {
+      Access *access = accesses->data[j];
+      if (same_var(store->base, access->base) && store->offset != access->offset)
+        return false;
+    }
+  }
+  return true;
+}
+
+static bool match_loop(Loop *loop, Stmt *stmt) {
+  // cond: `i < n`
+  Expr *cond = stmt->for_.cond;
+  if (cond == NULL || cond->kind != EX_LT)
+    return false;
+  Expr *ivar = strip_int_cast(cond->bop.lhs, 0);
+  Expr *limit = strip_int_cast(cond->bop.rhs, 0);
+  const Type *ctype = cond->bop.lhs->type;
+  if (!is_plain_local(ivar) || !is_fixnum(ivar->type->kind) ||
+      ivar->type->fixnum.kind < FX_INT || ivar->type->fixnum.kind > FX_LLONG ||
+      !is_fixnum(ctype->kind) || ctype->fixnum.kind > FX_LLONG)
+    return false;
+  if (!(limit->kind == EX_FIXNUM || (is_plain_local(limit) && !same_var(limit, ivar))))
+    return false;
+
+  // post: `++i`, `i++`, `i += 1`
+  Expr *post = stmt->for_.post;
+  if (post == NULL)
+    return false;
+  switch (post->kind) {
+  case EX_PREINC: case EX_POSTINC:
+    if (!same_var(post->unary.sub, ivar))
+      return false;
+    break;
+  case EX_ASSIGN:
+    {
+      Expr *rhs = strip_int_cast(post->bop.rhs, 0);
+      if (!same_var(post->bop.lhs, ivar) || rhs->kind != EX_ADD ||
+          !same_var(strip_int_cast(rhs->bop.lhs, 0), ivar) ||
+          rhs->bop.rhs->kind != EX_FIXNUM || rhs->bop.rhs->fixnum != 1)
+        return false;
+    }
+    break;
+  default:
+    return false;
+  }
+
+  loop->ivar = ivar;
+  loop->cond = cond;
+  return check_vector_body(loop, stmt->for_.body) && loop->elem_type != NULL &&
+         check_dependency(loop);
+}
+
+// `&base[i + offset]`
+static Expr *access_addr(Loop *loop, const Access *access) {
+  const Token *tok = loop->token;
+  Expr *addr = new_expr_addsub(EX_ADD, tok, clone_leaf(access->base),
+                               new_expr_fixlit(&tySSize, tok, access->offset));
+  return new_expr_addsub(EX_ADD, tok, addr, clone_leaf(loop->ivar));
+}
+
+// `((T*)&var)[index]`
+static Expr *vector_lane(Loop *loop, Expr *var, int index) {
+  const Token *tok = loop->token;
+  Expr *ptr = make_cast(ptrof(loop->elem_type), tok, make_refer(tok, clone_leaf(var)), true);
+  return new_expr_deref(tok, new_expr_addsub(EX_ADD, tok, ptr,
+                                             new_expr_fixlit(&tyInt, tok, index)));
+}
+
+static Expr *gen_vector_expr(Loop *loop, Expr *expr) {
+  if (!is_flonum(loop->elem_type))
+    expr = strip_int_cast(expr, type_size(loop->elem_type));
+  switch (expr->kind) {
+  case EX_FIXNUM: case EX_FLONUM: case EX_VAR:
+    {
+      Vector *invariants = loop->invariants;
+      for (int i = 0; i < invariants->len; ++i) {
+        Expr *e = invariants->data[i];
+        if (same_var(e, expr) || same_const(e, expr))
+          return clone_leaf(loop->bcasts->data[i]);
+      }
+      assert(false);
+      return expr;
+    }
+  case EX_DEREF:
+    {
+      Access access;
+      bool ok = match_access(loop, expr, &access);
+      assert(ok); UNUSED(ok);
+      const Token *tok = loop->token;
+      return new_expr_deref(tok, make_cast(ptrof(loop->vtype), tok, access_addr(loop, &access),
+                                           true));
+    }
+  default:
+    return new_expr_bop(expr->kind, loop->vtype, expr->token, gen_vector_expr(loop, expr->bop.lhs),
+                        gen_vector_expr(loop, expr->bop.rhs));
+  }
+}
+
+static void gen_vector_body(Loop *loop, Stmt *stmt, Vector *stmts) {
+  if (stmt->kind == ST_BLOCK) {
+    for (int i = 0; i < stmt->block.stmts->len; ++i) {
+      Stmt *s = stmt->block.stmts->data[i];
+      if (s != NULL)
+        gen_vector_body(loop, s, stmts);
+    }
+    return;
+  }
+
+  assert(stmt->kind == ST_EXPR);
+  Expr *expr = stmt->expr;
+  vec_push(stmts, new_stmt_expr(new_expr_bop(EX_ASSIGN, loop->vtype, expr->token,
+                                             gen_vector_expr(loop, expr->bop.lhs),
+                                             gen_vector_expr(loop, expr->bop.rhs))));
+}
+
+// `(U)limit - (U)i >= W`
+static Expr *gen_lane_count_cond(Loop *loop, int lane_count) {
+  const Token *tok = loop->token;
+  Expr *cond = loop->cond;
+  Expr *diff = gen_distance(tok, cond->bop.rhs, cond->bop.lhs);
+  return new_expr_cmp(EX_GE, tok, diff, new_expr_fixlit(diff->type, tok, lane_count));
+}
+
+// `(char*)&a[offset] + 16 <= (char*)&b[offset] || (char*)&b[offset] + 16 <= (char*)&a[offset]`
+static Expr *gen_overlap_check(Loop *loop, const Access *a, const Access *b) {
+  const Token *tok = loop->token;
+  Expr *conds[2];
+  for (int i = 0; i < 2; ++i) {
+    const Access *p = i == 0 ? a : b;
+    const Access *q = i == 0 ? b : a;
+    Type *ptype = ptrof(&tyChar);
+    Expr *pend = new_expr_addsub(
+        EX_ADD, tok,
+        make_cast(ptype, tok, new_expr_addsub(EX_ADD, tok, clone_leaf(p->base),
+                                              new_expr_fixlit(&tySSize, tok, p->offset)), true),
+        new_expr_fixlit(&tyInt, tok, VECTOR_SIZE));
+    Expr *qstart = make_cast(ptype, tok, new_expr_addsub(EX_ADD, tok, clone_leaf(q->base),
+                                                         new_expr_fixlit(&tySSize, tok, q->offset)),
+                             true);
+    conds[i] = new_expr_cmp(EX_LE, tok, pend, qstart);
+  }
+  return new_expr_bop(EX_LOGIOR, &tyBool, tok, conds[0], conds[1]);
+}
+
+static Expr *gen_alias_check(Loop *loop) {
+  Expr *result = NULL;
+  Vector *accesses = loop->accesses;
+  for (int i = 0; i < accesses->len; ++i) {
+    Access *store = accesses->data[i];
+    if (!store->store)
+      continue;
+    for (int j = 0; j < accesses->len; ++j) {
+      Access *access = accesses->data[j];
+      if (same_var(store->base, access->base) || (access->store && j < i) ||
+          (store->base->type->kind == TY_ARRAY && access->base->type->kind == TY_ARRAY))
+        continue;
+      bool dup = false;
+      for (int k = 0; k < j; ++k) {
+        Access *prev = accesses->data[k];
+        if (same_var(prev->base, access->base) && prev->offset == access->offset) {
+          dup = true;
+          break;
+        }
+      }
+      if (dup)
+        continue;
+      Expr *cond = gen_overlap_check(loop, store, access);
+      result = result == NULL ? cond
+                              : new_expr_bop(EX_LOGAND, &tyBool, loop->token, result, cond);
+    }
+  }
+  return result;
+}
+
+Stmt *vectorize_loop(Stmt *stmt, VectorOpChecker checker) {
+  assert(stmt->kind == ST_FOR);
+  int level = cc_flags.optimize_level;
+  if (checker == NULL || level == 's' || level == 'z' || level < 2)
+    return NULL;
+
+  Loop loop = {
+    .checker = checker,
+    .token = stmt->token,
+    .accesses = new_vector(),
+    .invariants = new_vector(),
+    .bcasts = new_vector(),
+  };
+  if (!match_loop(&loop, stmt) || is_full_unroll_target(stmt))
+    return NULL;
+
+  const Token *tok = stmt->token;
+  Type *elem_type = loop.elem_type;
+  Type *vtype = loop.vtype;
+  int lane_count = VECTOR_SIZE / type_size(elem_type);
+
+  Scope *scope = enter_scope(curfunc);
+  Vector *stmts = new_vector();
+  if (stmt->for_.pre != NULL)
+    vec_push(stmts, new_stmt_expr(stmt->for_.pre));
+
+  // Broadcast invariants.
+  Vector *vstmts = new_vector();
+  for (int i = 0; i < loop.invariants->len; ++i) {
+    Expr *invariant = loop.invariants->data[i];
+    Expr *var = alloc_tmp_var(scope, vtype);
+    vec_push(loop.bcasts, var);
+    for (int j = 0; j < lane_count; ++j) {
+      Expr *value = invariant->kind == EX_VAR ? clone_leaf(invariant)
+#ifndef __NO_FLONUM
+                    : invariant->kind == EX_FLONUM ? new_expr_flolit(elem_type, tok, invariant->flonum)
+#endif
+                    : new_expr_fixlit(elem_type, tok, wrap_value(invariant->fixnum, type_size(elem_type), false));
+      vec_push(vstmts, new_stmt_expr(new_expr_bop(EX_ASSIGN, elem_type, tok, vector_lane(&loop, var, j),
+                                                  make_cast(elem_type, tok, value, false))));
+    }
+  }
+
+  // Vector loop.
+  {
+    Vector *body = new_vector();
+    gen_vector_body(&loop, stmt->for_.body, body);
+    Expr *cond = new_expr_bop(EX_LOGAND, &tyBool, tok,
+                              new_expr_cmp(EX_LT, tok, clone_leaf(loop.cond->bop.lhs),
+                                           clone_leaf(loop.cond->bop.rhs)),
+                              gen_lane_count_cond(&loop, lane_count));
+    Expr *ivar = loop.ivar;
+    Expr *post = new_expr_bop(EX_ASSIGN, ivar->type, tok, clone_leaf(ivar),
+                              make_cast(ivar->type, tok,
+                                        new_expr_addsub(EX_ADD, tok, clone_leaf(ivar),
+                                                        new_expr_fixlit(&tyInt, tok, lane_count)),
+                                        false));
+    vec_push(vstmts, new_stmt_for(tok, NULL, cond, post, new_stmt_block(tok, body, NULL, NULL)));
+  }
+
+
+  Stmt *vblock = new_stmt_block(tok, vstmts, NULL, NULL);
+  Expr *alias_check = gen_alias_check(&loop);
+  vec_push(stmts, alias_check == NULL ? vblock : new_stmt_if(tok, alias_check, vblock, NULL));
+
+  // Scalar epilogue.
+  vec_push(stmts, gen_remainder_loop(stmt));
+
+  exit_scope();
+  return new_stmt_block(tok, stmts, scope, NULL);
+}
+
+////////////////////////////////////////////////
+// Unrolling
+//
+// Loop with a small constant trip count is expanded fully:
+//   for (i = 0; i < 3; ++i) body;
+//   =>  i = 0; body; ++i; body; ++i; body; ++i;
+// Otherwise the body is repeated in the loop, and the rest runs one by one:
+//   for (i = 0; i < n; ++i) body;
+//   =>  i = 0;
+//       while (i < n && n - i >= 4) { body; ++i; body; ++i; body; ++i; body; ++i; }
+//       while (i < n) { body; ++i; }
+
+// Code growth budget in expression nodes for -O2 and -O3.
+#define UNROLL_BUDGET     (128)
+#define UNROLL_BUDGET_O3  (256)
+#define MAX_FULL_UNROLL     (16)
+#define MAX_PARTIAL_UNROLL  (4)
+
+typedef struct {
+  Expr *ivar;  // Induction variable.
+  Expr *lhs, *rhs;  // Operands of the condition: `lhs` is the induction variable.
+  enum ExprKind cond_kind;  // EX_LT, EX_LE, EX_GT or EX_GE.
+  Fixnum step;
+  int cost;  // Node count of the body and the post expression.
+  int loop_depth;  // Nested loops and switches in the body:
+  int switch_depth;  // `break` and `continue` in them don't leave the loop.
+} Unroll;
+
+int loop_unroll_budget(void) {
+  int level = cc_flags.optimize_level;
+  if (level == 's' || level == 'z' || level < 2)
+    return 0;
+  return level >= 3 ? UNROLL_BUDGET_O3 : UNROLL_BUDGET;
+}
+
+// The induction variable and the limit must not be changed in the body.
+static bool is_unroll_invariant(Unroll *unroll, Expr *target) {
+  return !same_var(target, unroll->ivar) && !same_var(target, strip_int_cast(unroll->rhs, 0));
+}
+
+static bool check_unroll_expr(Unroll *unroll, Expr *expr) {
+  if (expr == NULL)
+    return true;
+  ++unroll->cost;
+  switch (expr->kind) {
+  case EX_FIXNUM: case EX_FLONUM: case EX_STR: case EX_VAR:
+    return true;
+
+  case EX_ASSIGN:
+    if (!is_unroll_invariant(unroll, expr->bop.lhs))
+      return false;
+    // Fallthrough
+  case EX_ADD: case EX_SUB: case EX_MUL: case EX_DIV: case EX_MOD:
+  case EX_BITAND: case EX_BITOR: case EX_BITXOR: case EX_LSHIFT: case EX_RSHIFT:
+  case EX_EQ: case EX_NE: case EX_LT: case EX_LE: case EX_GE: case EX_GT:
+  case EX_LOGAND: case EX_LOGIOR: case EX_COMMA:
+    return check_unroll_expr(unroll, expr->bop.lhs) && check_unroll_expr(unroll, expr->bop.rhs);
+
+  case EX_PREINC: case EX_PREDEC: case EX_POSTINC: case EX_POSTDEC:
+    if (!is_unroll_invariant(unroll, expr->unary.sub))
+      return false;
+    // Fallthrough
+  case EX_POS: case EX_NEG: case EX_BITNOT: case EX_REF: case EX_DEREF: case EX_CAST:
+    return check_unroll_expr(unroll, expr->unary.sub);
+
+  case EX_TERNARY:
+    return check_unroll_expr(unroll, expr->ternary.cond) &&
+           check_unroll_expr(unroll, expr->ternary.tval) &&
+           check_unroll_expr(unroll, expr->ternary.fval);
+  case EX_MEMBER:
+    return check_unroll_expr(unroll, expr->member.target);
+  case EX_FUNCALL:
+    {
+      Vector *vecs[] = {expr->funcall.args, expr->funcall.unnested};
+      for (int i = 0; i < 2; ++i) {
+        Vector *v = vecs[i];
+        if (v == NULL)
+          continue;
+        for (int j = 0; j < v->len; ++j) {
+          if (!check_unroll_expr(unroll, v->data[j]))
+            return false;
+        }
+      }
+      return check_unroll_expr(unroll, expr->funcall.func);
+    }
+
+  // Inlined functions and statement expressions are not duplicated.
+  default:
+    return false;
+  }
+}
+
+static bool check_unroll_stmt(Unroll *unroll, Stmt *stmt) {
+  if (stmt == NULL)
+    return true;
+  ++unroll->cost;
+  switch (stmt->kind) {
+  case ST_EMPTY:
+    return true;
+  case ST_EXPR:
+    return check_unroll_expr(unroll, stmt->expr);
+  case ST_BLOCK:
+    for (int i = 0; i < stmt->block.stmts->len; ++i) {
+      if (!check_unroll_stmt(unroll, stmt->block.stmts->data[i]))
+        return false;
+    }
+    return true;
+  case ST_IF:
+    return check_unroll_expr(unroll, stmt->if_.cond) &&
+           check_unroll_stmt(unroll, stmt->if_.tblock) &&
+           check_unroll_stmt(unroll, stmt->if_.fblock);
+  case ST_SWITCH:
+    {
+      ++unroll->switch_depth;
+      bool result = check_unroll_expr(unroll, stmt->switch_.value) &&
+                    check_unroll_stmt(unroll, stmt->switch_.body);
+      --unroll->switch_depth;
+      return result;
+    }
+  case ST_CASE:
+    return unroll->switch_depth > 0 && check_unroll_stmt(unroll, stmt->case_.stmt);
+  case ST_WHILE: case ST_DO_WHILE:
+    {
+      ++unroll->loop_depth;
+      bool result = check_unroll_expr(unroll, stmt->while_.cond) &&
+                    check_unroll_stmt(unroll, stmt->while_.body);
+      --unroll->loop_depth;
+      return result;
+    }
+  case ST_FOR:
+    {
+      ++unroll->loop_depth;
+      bool result = check_unroll_expr(unroll, stmt->for_.pre) &&
+                    check_unroll_expr(unroll, stmt->for_.cond) &&
+                    check_unroll_expr(unroll, stmt->for_.post) &&
+                    check_unroll_stmt(unroll, stmt->for_.body);
+      --unroll->loop_depth;
+      return result;
+    }
+  case ST_BREAK:
+    return unroll->loop_depth > 0 || unroll->switch_depth > 0;
+  case ST_CONTINUE:
+    return unroll->loop_depth > 0;
+  case ST_RETURN:
+    return check_unroll_expr(unroll, stmt->return_.val);
+  case ST_VARDECL:
+    return check_unroll_stmt(unroll, stmt->vardecl->init_stmt);
+
+  // Labels are bound to basic blocks, so they cannot be duplicated.
+  case ST_GOTO: case ST_LABEL: case ST_ASM:
+  default:
+    return false;
+  }
+}
+
+static bool match_unroll_loop(Unroll *unroll, Stmt *stmt) {
+  Expr *cond = stmt->for_.cond;
+  if (cond == NULL || stmt->for_.post == NULL)
+    return false;
+  enum ExprKind kind = cond->kind;
+  Expr *lhs = cond->bop.lhs, *rhs = cond->bop.rhs;
+  switch (kind) {
+  case EX_LT: case EX_LE: case EX_GT: case EX_GE:
+    if (!is_plain_local(strip_int_cast(lhs, 0))) {
+      // `n > i` => `i < n`
+      static const enum ExprKind kSwapped[] = {
+        [EX_LT] = EX_GT, [EX_LE] = EX_GE, [EX_GE] = EX_LE, [EX_GT] = EX_LT,
+      };
+      Expr *tmp = lhs;
+      lhs = rhs;
+      rhs = tmp;
+      kind = kSwapped[kind];
+    }
+    break;
+  default:
+    return false;
+  }
+
+  Expr *ivar = strip_int_cast(lhs, 0);
+  Expr *limit = strip_int_cast(rhs, 0);
+  if (!is_plain_local(ivar) || !is_fixnum(ivar->type->kind) ||
+      ivar->type->fixnum.kind > FX_LLONG ||
+      !is_fixnum(lhs->type->kind) || lhs->type->fixnum.kind > FX_LLONG ||
+      !(limit->kind == EX_FIXNUM || (is_plain_local(limit) && !same_var(limit, ivar))))
+    return false;
+
+  // post: `++i`, `i--`, `i += c`, `i -= c`
+  Expr *post = stmt->for_.post;
+  Fixnum step;
+  switch (post->kind) {
+  case EX_PREINC: case EX_POSTINC:
+  case EX_PREDEC: case EX_POSTDEC:
+    if (!same_var(post->unary.sub, ivar))
+      return false;
+    step = post->kind == EX_PREINC || post->kind == EX_POSTINC ? 1 : -1;
+    break;
+  case EX_ASSIGN:
+    {
+      Expr *value = strip_int_cast(post->bop.rhs, 0);
+      if (!same_var(post->bop.lhs, ivar) || (value->kind != EX_ADD && value->kind != EX_SUB) ||
+          !same_var(strip_int_cast(value->bop.lhs, 0), ivar) || value->bop.rhs->kind != EX_FIXNUM)
+        return false;
+      step = value->kind == EX_ADD ? value->bop.rhs->fixnum : -value->bop.rhs->fixnum;
+    }
+    break;
+  default:
+    return false;
+  }
+  if ((kind == EX_LT || kind == EX_LE) ? step <= 0 : step >= 0)
+    return false;
+
+  unroll->ivar = ivar;
+  unroll->lhs = lhs;
+  unroll->rhs = rhs;
+  unroll->cond_kind = kind;
+  unroll->step = step;
+  // The post expression updates the induction variable by design,
+  // so only its operands are checked.
+  ++unroll->cost;
+  Expr *operand = post->kind == EX_ASSIGN ? post->bop.rhs : post->unary.sub;
+  return check_unroll_stmt(unroll, stmt->for_.body) && check_unroll_expr(unroll, operand);
+}
+
+// Returns the trip count, or -1 if it is unknown or larger than `max`.
+static int count_trips(Unroll *unroll, Expr *pre, int max) {
+  if (pre == NULL || pre->kind != EX_ASSIGN || !same_var(pre->bop.lhs, unroll->ivar))
+    return -1;
+  Expr *start = strip_int_cast(pre->bop.rhs, 0);
+  Expr *limit = strip_int_cast(unroll->rhs, 0);
+  if (start->kind != EX_FIXNUM || limit->kind != EX_FIXNUM)
+    return -1;
+
+  const Type *itype = unroll->ivar->type;
+  const Type *ctype = unroll->lhs->type;
+  int isize = type_size(itype), csize = type_size(ctype);
+  bool cunsigned = ctype->fixnum.is_unsigned;
+  Fixnum r = wrap_value(limit->fixnum, csize, cunsigned);
+  Fixnum v = wrap_value(start->fixnum, isize, itype->fixnum.is_unsigned);
+  for (int count = 0; count <= max; ++count) {
+    Fixnum l = wrap_value(v, csize, cunsigned);
+    int cmp = cunsigned ? ((UFixnum)l < (UFixnum)r ? -1 : (UFixnum)l > (UFixnum)r ? 1 : 0)
+                        : (l < r ? -1 : l > r ? 1 : 0);
+    bool cont;
+    switch (unroll->cond_kind) {
+    case EX_LT:  cont = cmp < 0; break;
+    case EX_LE:  cont = cmp <= 0; break;
+    case EX_GT:  cont = cmp > 0; break;
+    case EX_GE:  cont = cmp >= 0; break;
+    default:  assert(false); cont = false; break;
+    }
+    if (!cont)
+      return count;
+    v = wrap_value(v + unroll->step, isize, itype->fixnum.is_unsigned);
+  }
+  return -1;
+}
+
+// Returns the trip count if the loop is expanded fully within the budget, otherwise -1.
+static int count_full_unroll(Unroll *unroll, Stmt *stmt, int budget) {
+  int trips = count_trips(unroll, stmt->for_.pre, MAX_FULL_UNROLL);
+  return trips >= 0 && trips * unroll->cost <= budget ? trips : -1;
+}
+
+static bool is_full_unroll_target(Stmt *stmt) {
+  int budget = loop_unroll_budget();
+  Unroll unroll = {0};
+  return budget > 0 && match_unroll_loop(&unroll, stmt) &&
+         count_full_unroll(&unroll, stmt, budget) >= 0;
+}
+
+static void push_body_copies(Vector *stmts, Stmt *stmt, int count) {
+  Stmt *post = new_stmt_expr(stmt->for_.post);
+  for (int i = 0; i < count; ++i) {
+    vec_push(stmts, stmt->for_.body);
+    vec_push(stmts, post);
+  }
+}
+
+Stmt *unroll_loop(Stmt *stmt) {
+  assert(stmt->kind == ST_FOR);
+  int budget = loop_unroll_budget();
+  if (budget <= 0)
+    return NULL;
+
+  Unroll unroll = {0};
+  if (!match_unroll_loop(&unroll, stmt))
+    return NULL;
+
+  const Token *tok = stmt->token;
+  Vector *stmts = new_vector();
+  if (stmt->for_.pre != NULL)
+    vec_push(stmts, new_stmt_expr(stmt->for_.pre));
+
+  int trips = count_full_unroll(&unroll, stmt, budget);
+  if (trips >= 0) {
+    push_body_copies(stmts, stmt, trips);
+    return new_stmt_block(tok, stmts, NULL, NULL);
+  }
+
+  // Narrower induction variable might wrap around within the duplicated bodies.
+  if ((unroll.step != 1 && unroll.step != -1) ||
+      type_size(unroll.ivar->type) < type_size(unroll.lhs->type))
+    return NULL;
+  int factor = MAX_PARTIAL_UNROLL;
+  while (factor * unroll.cost > budget)
+    factor >>= 1;
+  if (factor < 2)
+    return NULL;
+
+  // `i < n && (U)n - (U)i >= factor`: `factor - 1` for `<=`.
+  enum ExprKind kind = unroll.cond_kind;
+  Expr *dist = kind == EX_LT || kind == EX_LE ? gen_distance(tok, unroll.rhs, unroll.lhs)
+                                              : gen_distance(tok, unroll.lhs, unroll.rhs);
+  int min_dist = kind == EX_LT || kind == EX_GT ? factor : factor - 1;
+  Expr *cond = new_expr_bop(EX_LOGAND, &tyBool, tok,
+                            new_expr_cmp(kind, tok, clone_leaf(unroll.lhs), clone_leaf(unroll.rhs)),
+                            new_expr_cmp(EX_GE, tok, dist,
+                                         new_expr_fixlit(dist->type, tok, min_dist)));
+  Vector *body = new_vector();
+  push_body_copies(body, stmt, factor);
+  vec_push(stmts, new_stmt_while(tok, cond, new_stmt_block(tok, body, NULL, NULL)));
+  vec_push(stmts, gen_remainder_loop(stmt));
+  return new_stmt_block(tok, stmts, NULL, NULL);
+}
@@ -0,0 +1,23 @@
+// Loop optimizations
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "ast.h"  // ExprKind
+
+typedef struct Stmt Stmt;
+typedef struct Type Type;
+
+// Whether the element-wise operation on the vector type is done in SIMD instructions.
+typedef bool (*VectorOpChecker)(enum ExprKind kind, const Type *type);
+
+// Returns the statement which runs `for` loop in vectors, or NULL if the loop is not a target.
+Stmt *vectorize_loop(Stmt *stmt, VectorOpChecker checker);
+
+// Code growth allowed for unrolling, in expression nodes: 0 if unrolling is disabled.
+int loop_unroll_budget(void);
+
+// Returns the statement which runs `for` loop with duplicated bodies, or NULL if not a target.
+// The result shares the nodes of the loop, so it is for the code generation only.
+Stmt *unroll_loop(Stmt *stmt);
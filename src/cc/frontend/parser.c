@@ -16,6 +16,9 @@
 #include "var.h"
 
 static Stmt *parse_stmt(void);
+static Table *parse_attributes(Table *attributes);
+static size_t get_aligned_attribute(Table *attributes);
+static Type *apply_vector_size_attribute(Type *type, Table *attributes);
 
 Token *consume(enum TokenKind kind, const char *error) {
   Token *tok = match(kind);
@@ -191,6 +194,9 @@ static Vector *parse_vardecl_cont(Type *rawType, Type *type, int storage, Token
       }
     }
 
+    Table *attributes = parse_attributes(NULL);
+    type = apply_vector_size_attribute(type, attributes);
+
     if (type->kind == TY_FUNC /* && !is_global_scope(curscope)*/) {
       // Must be prototype.
       tmp_storage |= VS_EXTERN;
@@ -254,6 +260,15 @@ static Vector *parse_vardecl_cont(Type *rawType, Type *type, int storage, Token
 #endif
 
     VarInfo *varinfo = add_var_to_scope(curscope, ident, type, tmp_storage);
+    size_t align = get_aligned_attribute(attributes);
+    if (align > 0 && type->kind != TY_FUNC) {
+      if (tmp_storage & VS_STATIC) {
+        VarInfo *gvar = varinfo->static_.gvar;
+        gvar->global.align = MAX(gvar->global.align, align);
+      } else if (!(tmp_storage & VS_EXTERN)) {
+        parse_error(PE_WARNING, ident, "`aligned' attribute ignored for automatic variable");
+      }
+    }
     Initializer *init = (type->kind != TY_FUNC && match(TK_ASSIGN)) ? parse_initializer() : NULL;
     init = check_vardecl(&type, ident, tmp_storage, init);
     varinfo->type = type;  // type might be changed.
@@ -463,6 +478,15 @@ static Stmt *parse_for(const Token *tok) {
     construct_initializing_stmts(decls);
     for (int i = 0, len = decls->len; i < len; ++i) {
       VarDecl *vardecl = decls->data[i];
+      Stmt *init = vardecl->init_stmt;
+      if (len == 1 && is_fixnum(vardecl->varinfo->type->kind) && init != NULL &&
+          init->kind == ST_BLOCK &&
+          init->block.stmts->len == 1 &&
+          ((Stmt*)init->block.stmts->data[0])->kind == ST_EXPR) {
+        // `for (int i = 0; ...)` => `int i; for (i = 0; ...)`: Exposes the initial value.
+        stmt->for_.pre = ((Stmt*)init->block.stmts->data[0])->expr;
+        continue;
+      }
       Stmt *stmt = new_stmt_vardecl(vardecl);
       vec_push(stmts, stmt);
     }
@@ -658,8 +682,8 @@ static Table *parse_attribute(Table *attributes) {  // <Token*>
     if (match(TK_RPAR))
       break;
 
-    const Token *name = consume(TK_IDENT, "attribute name expected");
-    if (name == NULL)
+    const Token *name = match(TK_CONST);  // `const' is a keyword.
+    if (name == NULL && (name = consume(TK_IDENT, "attribute name expected")) == NULL)
       break;
 
     Vector *params = NULL;
@@ -681,9 +705,16 @@ static Table *parse_attribute(Table *attributes) {  // <Token*>
         }
       }
     }
+    // `__name__' is same as `name'.
+    const Name *attrname = name->kind == TK_IDENT ? name->ident
+                                                  : alloc_name(name->begin, name->end, false);
+    if (attrname->bytes > 4 && strncmp(attrname->chars, "__", 2) == 0 &&
+        strncmp(&attrname->chars[attrname->bytes - 2], "__", 2) == 0)
+      attrname = alloc_name(attrname->chars + 2, attrname->chars + attrname->bytes - 2, false);
+
     if (attributes == NULL)
       attributes = alloc_table();
-    table_put(attributes, name->ident, params);
+    table_put(attributes, attrname, params);
 
     if (!match(TK_COMMA)) {
       if (!match(TK_RPAR))
@@ -711,12 +742,73 @@ static Table *parse_attributes(Table *attributes) {
   return attributes;
 }
 
+// Alignment specified by `__attribute__((aligned(N)))`, 0 if not specified.
+static size_t get_aligned_attribute(Table *attributes) {
+  Vector *params;
+  if (attributes == NULL ||
+      !table_try_get(attributes, alloc_name("aligned", NULL, false), (void**)&params))
+    return 0;
+  if (params == NULL || params->len == 0)
+    return 16;  // Largest alignment for any type.
+
+  const Token *tok = params->data[0];
+  if (params->len != 1 || !(tok->kind >= TK_INTLIT && tok->kind <= TK_ULLONGLIT) ||
+      !IS_POWER_OF_2(tok->fixnum)) {
+    parse_error(PE_NOFATAL, tok, "power of 2 constant expected for `aligned'");
+    return 0;
+  }
+  return tok->fixnum;
+}
+
+// Make vector type if `__attribute__((vector_size(N)))` is specified.
+static Type *apply_vector_size_attribute(Type *type, Table *attributes) {
+  Vector *params;
+  if (attributes == NULL ||
+      !table_try_get(attributes, alloc_name("vector_size", NULL, false), (void**)&params))
+    return type;
+
+  const Token *tok = params != NULL && params->len > 0 ? params->data[0] : NULL;
+  if (tok == NULL || params->len != 1 || !(tok->kind >= TK_INTLIT && tok->kind <= TK_ULLONGLIT)) {
+    parse_error(PE_NOFATAL, tok, "constant expected for `vector_size'");
+    return type;
+  }
+  if (!((type->kind == TY_FIXNUM && type->fixnum.kind < FX_ENUM) ||
+        (is_flonum(type) && type->flonum.kind < FL_LDOUBLE))) {
+    parse_error(PE_NOFATAL, tok, "invalid vector element type");
+    return type;
+  }
+  size_t elem_size = type_size(type);
+  if (!IS_POWER_OF_2(tok->fixnum) || tok->fixnum <= (Fixnum)elem_size) {
+    parse_error(PE_NOFATAL, tok, "invalid vector size");
+    return type;
+  }
+  Type *vtype = get_vector_type(type, tok->fixnum);
+  return type->qualifier != 0 ? qualified_type(vtype, type->qualifier) : vtype;
+}
+
 static Function *define_func(Type *functype, const Token *ident, const Vector *param_vars,
                              int storage, Table *attributes) {
+  static const struct {
+    const char *name;
+    int flag;
+  } kFuncAttributes[] = {
+    {"noreturn", FUNCF_NORETURN},
+    {"noinline", FUNCF_NOINLINE},
+    {"always_inline", FUNCF_ALWAYS_INLINE},
+    {"hot", FUNCF_HOT},
+    {"cold", FUNCF_COLD},
+    {"pure", FUNCF_PURE},
+    {"const", FUNCF_CONST},
+  };
+  const int kAttrFlagMask = FUNCF_NORETURN | FUNCF_NOINLINE | FUNCF_ALWAYS_INLINE | FUNCF_HOT |
+                            FUNCF_COLD | FUNCF_PURE | FUNCF_CONST;
+
   int flag = 0;
   if (attributes != NULL) {
-    if (table_try_get(attributes, alloc_name("noreturn", NULL, false), NULL))
-      flag |= FUNCF_NORETURN;
+    for (int i = 0; i < (int)ARRAY_SIZE(kFuncAttributes); ++i) {
+      if (table_try_get(attributes, alloc_name(kFuncAttributes[i].name, NULL, false), NULL))
+        flag |= kFuncAttributes[i].flag;
+    }
   }
 
   Function *func = new_func(functype, ident->ident, functype->func.param_vars, attributes, flag);
@@ -729,7 +821,7 @@ static Function *define_func(Type *functype, const Token *ident, const Vector *p
     if (predecl != NULL) {
       assert(predecl->kind == DCL_DEFUN);
       if (predecl->defun.func != NULL) {
-        int merge_flag = (flag | predecl->defun.func->flag) & FUNCF_NORETURN;
+        int merge_flag = (flag | predecl->defun.func->flag) & kAttrFlagMask;
         func->flag |= merge_flag;
         predecl->defun.func->flag |= merge_flag;
 
@@ -758,6 +850,7 @@ static Function *define_func(Type *functype, const Token *ident, const Vector *p
       }
     }
   }
+  varinfo->global.align = MAX(varinfo->global.align, get_aligned_attribute(attributes));
   return func;
 }
 
@@ -862,6 +955,7 @@ static void parse_global_var_decl(Type *rawtype, int storage, Type *type, Token
     if (!(type->kind == TY_PTR && type->pa.ptrof->kind == TY_FUNC) &&
         type->kind != TY_VOID)
       type = parse_type_suffix(type);
+    type = apply_vector_size_attribute(type, attributes);
 
 #ifndef __NO_VLA
     if (type->kind == TY_ARRAY && type->pa.vla != NULL)
@@ -917,6 +1011,7 @@ static void parse_global_var_decl(Type *rawtype, int storage, Type *type, Token
         if (ident != NULL) {
           varinfo->global.init = check_vardecl(&type, ident, storage, init);
           varinfo->type = type;  // type might be changed.
+          varinfo->global.align = MAX(varinfo->global.align, get_aligned_attribute(attributes));
         }
       }
     }
@@ -1000,7 +1095,6 @@ static Function *generate_dtor_caller_func(Vector *dtors) {
   const Token *functok = alloc_dummy_ident();
   Table *attributes = NULL;
   Function *func = define_func(functype, functok, top_vars, VS_STATIC, attributes);
-  func->flag |= FUNCF_HAS_FUNCALL;
 
   assert(curfunc == NULL);
   assert(is_global_scope(curscope));
@@ -1067,7 +1161,6 @@ static Function *generate_dtor_register_func(Function *dtor_caller_func) {
   assert(attributes != NULL);
   table_put(attributes, alloc_name("constructor", NULL, false), NULL);
   Function *func = define_func(functype, functok, top_vars, VS_STATIC, attributes);
-  func->flag |= FUNCF_HAS_FUNCALL;
 
   assert(curfunc == NULL);
   assert(is_global_scope(curscope));
@@ -48,9 +48,6 @@ static Expr *parse_funcall(Expr *func) {
   Token *token;
   Vector *args = parse_args(&token);
 
-  assert(curfunc != NULL);
-  curfunc->flag |= FUNCF_HAS_FUNCALL;
-
   check_funcall_args(func, args, curscope);
   Type *functype = get_callee_type(func->type);
   if (functype == NULL) {
@@ -64,7 +61,7 @@ static Expr *parse_funcall(Expr *func) {
   if (func->kind == EX_VAR && is_global_scope(func->var.scope)) {
     VarInfo *varinfo = scope_find(func->var.scope, func->var.name, NULL);
     assert(varinfo != NULL);
-    if (satisfy_inline_criteria(varinfo, 0))
+    if (can_inline_funcall(varinfo))
       return new_expr_inlined(token, varinfo->name, rettype, args,
                               embed_inline_funcall(varinfo));
   }
@@ -78,6 +75,20 @@ static Expr *parse_array_index(const Token *token, Expr *expr) {
   consume(TK_RBRACKET, "`]' expected");
   expr = str_to_char_array_var(curscope, expr);
   index = str_to_char_array_var(curscope, index);
+  if (is_vector(expr->type)) {
+    // Access the lane through a pointer to the element type: `((elem*)&vec)[index]`.
+    Type *elem_type = expr->type->struct_.info->members[0].type;
+    Type *ptype = ptrof(qualified_type(elem_type, expr->type->qualifier));
+    if (expr->kind == EX_VAR || expr->kind == EX_DEREF || expr->kind == EX_MEMBER ||
+        expr->kind == EX_COMPLIT) {
+      expr = make_cast(ptype, token, make_refer(token, expr), true);
+    } else {
+      Expr *tmp = alloc_tmp_var(curscope, expr->type);
+      Expr *assign = new_expr_bop(EX_ASSIGN, expr->type, token, tmp, expr);
+      expr = new_expr_bop(EX_COMMA, ptype, token, assign,
+                          make_cast(ptype, token, make_refer(token, tmp), true));
+    }
+  }
   if (!ptr_or_array(expr->type)) {
     if (!ptr_or_array(index->type)) {
       parse_error(PE_NOFATAL, expr->token, "array or pointer required for `['");
@@ -352,6 +352,7 @@ StructInfo *create_struct_info(MemberInfo *members, int count, bool is_union, bo
   sinfo->member_count = count;
   sinfo->is_union = is_union;
   sinfo->is_flexible = is_flexible;
+  sinfo->is_vector = false;
   sinfo->size = -1;
   sinfo->align = 0;
   calc_struct_size(sinfo);
@@ -377,6 +378,45 @@ int find_struct_member(const StructInfo *sinfo, const Name *name) {
   return -1;
 }
 
+// Vector
+
+extern inline bool is_vector(const Type *type);
+
+Type *get_vector_type(Type *elem_type, size_t size) {
+  static Vector *vector_types;  // <Type*>
+  if (vector_types == NULL)
+    vector_types = new_vector();
+
+  size_t elem_size = type_size(elem_type);
+  assert(size % elem_size == 0);
+  int count = size / elem_size;
+  for (int i = 0; i < vector_types->len; ++i) {
+    Type *type = vector_types->data[i];
+    const StructInfo *sinfo = type->struct_.info;
+    if (sinfo->member_count == count &&
+        same_type_without_qualifier(sinfo->members[0].type, elem_type, true))
+      return type;
+  }
+
+  if (elem_type->qualifier != 0) {
+    elem_type = clone_type(elem_type);
+    elem_type->qualifier = 0;
+  }
+  MemberInfo *members = calloc_or_die(sizeof(*members) * count);
+  for (int i = 0; i < count; ++i) {
+    members[i].type = elem_type;
+#ifndef __NO_BITFIELD
+    members[i].bitfield.width = -1;
+#endif
+  }
+  StructInfo *sinfo = create_struct_info(members, count, false, false);
+  sinfo->is_vector = true;
+  sinfo->align = size;  // Vectors are aligned to their whole size.
+  Type *type = create_struct_type(sinfo, NULL, 0);
+  vec_push(vector_types, type);
+  return type;
+}
+
 // Enum
 
 Type *create_enum_type(const Name *name) {
@@ -548,6 +588,11 @@ bool can_cast(const Type *dst, const Type *src, bool zero, bool is_explicit) {
     default:  break;
     }
     break;
+  case TY_STRUCT:
+    // Reinterpret a vector as another vector type of the same size.
+    if (is_explicit && is_vector(dst) && is_vector(src) && type_size(dst) == type_size(src))
+      return true;
+    break;
   default:
     break;
   }
@@ -749,7 +794,10 @@ void print_type_recur(FILE *fp, const Type *type, PrintTypeChain *parent) {
     }
     break;
   case TY_STRUCT:
-    if (type->struct_.name != NULL) {
+    if (is_vector(type)) {
+      print_type(fp, type->struct_.info->members[0].type);
+      fprintf(fp, " __attribute__((vector_size(%zu)))", type_size(type));
+    } else if (type->struct_.name != NULL) {
       fprintf(fp, "struct %.*s", NAMES(type->struct_.name));
     } else {
       fprintf(fp, "struct (anonymous)");
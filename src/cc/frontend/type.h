@@ -72,6 +72,7 @@ typedef struct StructInfo {
   size_t align;
   bool is_union;
   bool is_flexible;
+  bool is_vector;  // `__attribute__((vector_size(N)))`: members are the lanes.
 } StructInfo;
 
 #define LEN_UND  (-1)  // Indicate array length is not specified (= []).
@@ -164,6 +165,12 @@ StructInfo *create_struct_info(MemberInfo *members, int count, bool is_union, bo
 Type *create_struct_type(StructInfo *sinfo, const Name *name, int qualifier);
 int find_struct_member(const StructInfo *sinfo, const Name *name);
 
+// Vector: Struct with unnamed lanes, which is operated element-wise.
+Type *get_vector_type(Type *elem_type, size_t size);
+inline bool is_vector(const Type *type) {
+  return type->kind == TY_STRUCT && type->struct_.info != NULL && type->struct_.info->is_vector;
+}
+
 Type *create_enum_type(const Name *name);
 
 bool same_type_without_qualifier(const Type *type1, const Type *type2, bool ignore_qualifier);
@@ -40,12 +40,15 @@ typedef struct VarInfo {
       VReg *vreg;
       FrameInfo *frameinfo;
     } local;
-    union {
-      Initializer *init;
-      struct {
-        Function *func;
-        Declaration *funcdecl;
+    struct {
+      union {
+        Initializer *init;
+        struct {
+          Function *func;
+          Declaration *funcdecl;
+        };
       };
+      size_t align;  // Specified by `aligned` attribute, 0 => natural alignment.
     } global;
     struct {
       struct VarInfo *gvar;  // which points to global(static) variable.
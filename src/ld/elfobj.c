@@ -8,16 +8,25 @@
 #include "table.h"
 #include "util.h"
 
-static Elf64_Shdr *read_all_section_headers(FILE *fp, size_t start_offset, Elf64_Ehdr *ehdr) {
-  if (ehdr->e_shnum <= 0)
-    return NULL;
-  return read_or_die(fp, NULL, ehdr->e_shoff + start_offset,
-                     ehdr->e_shnum * sizeof(Elf64_Shdr), "read section header failed");
+// Returns a pointer into the image when it is suitably aligned, otherwise an aligned copy.
+static const void *elfobj_data(ElfObj *elfobj, size_t offset, size_t size, size_t align) {
+  if (offset > elfobj->size || size > elfobj->size - offset)
+    error("out of range");
+  const unsigned char *p = elfobj->image + offset;
+  if ((VOIDP2UINT(p) & (align - 1)) == 0)
+    return p;
+  void *buf = malloc_or_die(size);
+  memcpy(buf, p, size);
+  return buf;
+}
+
+const void *elfobj_section_data(ElfObj *elfobj, const Elf64_Shdr *shdr, size_t align) {
+  return elfobj_data(elfobj, shdr->sh_offset, shdr->sh_size, align);
 }
 
-static char *read_strtab(FILE *fp, size_t start_offset, Elf64_Shdr *sec) {
+static const char *read_strtab(ElfObj *elfobj, Elf64_Shdr *sec) {
   assert(sec->sh_type == SHT_STRTAB);
-  return read_or_die(fp, NULL, sec->sh_offset + start_offset, sec->sh_size, "read strtab failed");
+  return elfobj_section_data(elfobj, sec, 1);
 }
 
 static void load_symtab(ElfObj *elfobj) {
@@ -30,8 +39,7 @@ static void load_symtab(ElfObj *elfobj) {
     if (shdr->sh_size % sizeof(Elf64_Sym) != 0)
       error("illega symtab size");
 
-    Elf64_Sym *symbols = read_or_die(elfobj->fp, NULL, shdr->sh_offset + elfobj->start_offset,
-                                     shdr->sh_size, "read symtab failed");
+    Elf64_Sym *symbols = (Elf64_Sym*)elfobj_section_data(elfobj, shdr, _Alignof(Elf64_Sym));
 
     ElfSectionInfo *p = &elfobj->section_infos[sec];
     p->symtab.syms = symbols;
@@ -45,7 +53,7 @@ static void load_symtab(ElfObj *elfobj) {
     if (strtab_sec->sh_type != SHT_STRTAB)
       error("malformed symtab");
 
-    const char *strbuf = read_strtab(elfobj->fp, elfobj->start_offset, strtab_sec);
+    const char *strbuf = read_strtab(elfobj, strtab_sec);
     if (strbuf == NULL)
       error("read strtab failed");
     elfobj->section_infos[shdr->sh_link].strtab.buf = strbuf;
@@ -67,11 +75,14 @@ static void load_symtab(ElfObj *elfobj) {
     error("no symtab");
 }
 
-ElfObj *read_elf(FILE *fp, const char *fn) {
-  long start_offset = ftell(fp);
+ElfObj *read_elf(const void *image, size_t size, const char *fn) {
   Elf64_Ehdr ehdr;
-  ssize_t size = fread(&ehdr, sizeof(ehdr), 1, fp);
-  if (size != 1 || ehdr.e_ident[0] != ELFMAG0 || ehdr.e_ident[1] != ELFMAG1 ||
+  if (size < sizeof(ehdr)) {
+    fprintf(stderr, "no elf file: %s\n", fn);
+    return NULL;
+  }
+  memcpy(&ehdr, image, sizeof(ehdr));
+  if (ehdr.e_ident[0] != ELFMAG0 || ehdr.e_ident[1] != ELFMAG1 ||
       ehdr.e_ident[2] != ELFMAG2 || ehdr.e_ident[3] != ELFMAG3) {
     fprintf(stderr, "no elf file: %s\n", fn);
     return NULL;
@@ -83,18 +94,18 @@ ElfObj *read_elf(FILE *fp, const char *fn) {
     fprintf(stderr, "illegal elf: %s\n", fn);
     return NULL;
   }
-  Elf64_Shdr *shdrs = read_all_section_headers(fp, start_offset, &ehdr);
-  if (shdrs == NULL)
-    return NULL;
 
   ElfObj *elfobj = calloc_or_die(sizeof(*elfobj));
-  elfobj->fp = fp;
-  elfobj->start_offset = start_offset;
+  elfobj->filename = fn;
+  elfobj->image = image;
+  elfobj->size = size;
   elfobj->ehdr = ehdr;
-  elfobj->shdrs = shdrs;
+  elfobj->shdrs = (Elf64_Shdr*)elfobj_data(elfobj, ehdr.e_shoff, ehdr.e_shnum * sizeof(Elf64_Shdr),
+                                           _Alignof(Elf64_Shdr));
   elfobj->symbol_table = NULL;
   elfobj->symtab_section = NULL;
   elfobj->nobit_shndx = -1;
+  Elf64_Shdr *shdrs = elfobj->shdrs;
 
   Vector *prog_sections = new_vector();
   ElfSectionInfo *section_infos = calloc_or_die(ehdr.e_shnum * sizeof(ElfSectionInfo));
@@ -106,12 +117,8 @@ ElfObj *read_elf(FILE *fp, const char *fn) {
     p->shdr = shdr;
     if (shdr->sh_size > 0) {
       switch (shdr->sh_type) {
-      case SHT_NOBITS:
-        if (elfobj->nobit_shndx >= 0)
-          error("Multiple NOBITS sections not supported");
-        elfobj->nobit_shndx = i;
-        // Fallthrough
       case SHT_PROGBITS:
+      case SHT_NOBITS:
       case SHT_INIT_ARRAY:
       case SHT_FINI_ARRAY:
       case SHT_PREINIT_ARRAY:
@@ -123,6 +130,13 @@ ElfObj *read_elf(FILE *fp, const char *fn) {
   }
   elfobj->prog_sections = prog_sections;
 
+  // Mark relocation targets, which need their own writable copy.
+  for (unsigned short i = 0; i < ehdr.e_shnum; ++i) {
+    Elf64_Shdr *shdr = &shdrs[i];
+    if (shdr->sh_type == SHT_RELA && shdr->sh_size > 0 && shdr->sh_info < ehdr.e_shnum)
+      section_infos[shdr->sh_info].progbits.rela = shdr;
+  }
+
   load_symtab(elfobj);
 
   {
@@ -132,23 +146,24 @@ ElfObj *read_elf(FILE *fp, const char *fn) {
       return NULL;
     }
     if (shstrtab->strtab.buf == NULL) {
-      const char *buf = read_strtab(elfobj->fp, elfobj->start_offset, shstrtab->shdr);
+      const char *buf = read_strtab(elfobj, shstrtab->shdr);
       if (buf == NULL)
         error("read shstrtab failed");
       shstrtab->strtab.buf = buf;
     }
+
+    // Common symbols are allocated in `.bss`, even if there are other NOBITS sections (`.bss.*`).
+    for (int i = 0; i < prog_sections->len; ++i) {
+      ElfSectionInfo *p = prog_sections->data[i];
+      if (p->shdr->sh_type == SHT_NOBITS &&
+          (elfobj->nobit_shndx < 0 || strcmp(&shstrtab->strtab.buf[p->shdr->sh_name], ".bss") == 0))
+        elfobj->nobit_shndx = p - section_infos;
+    }
   }
 
   return elfobj;
 }
 
-void close_elf(ElfObj *elfobj) {
-  if (elfobj->fp != NULL) {
-    fclose(elfobj->fp);
-    elfobj->fp = NULL;
-  }
-}
-
 Elf64_Sym *elfobj_find_symbol(ElfObj *elfobj, const Name *name) {
   Elf64_Sym *sym = table_get(elfobj->symbol_table, name);
   return (sym != NULL && sym->st_shndx != SHN_UNDEF) ? sym : NULL;
@@ -20,7 +20,11 @@ typedef struct ElfSectionInfo {
   union {
     struct {
       uintptr_t address;
-      unsigned char *content;
+      const unsigned char *content;  // Points into the mapped image unless relocated.
+      const Elf64_Shdr *rela;  // Relocations applied to this section, or NULL.
+      bool marked;  // Reachable from the entry, for `--gc-sections`.
+      int icf_class;  // Equivalence class for `--icf`: 0=not folded, -1=address taken.
+      struct ElfSectionInfo *folded;  // Identical section which this one is folded into.
     } progbits;
     struct {
       const char *buf;
@@ -34,8 +38,9 @@ typedef struct ElfSectionInfo {
 } ElfSectionInfo;
 
 typedef struct ElfObj {
-  FILE *fp;
-  size_t start_offset;
+  const char *filename;
+  const unsigned char *image;  // Mapped file or archive member.
+  size_t size;
   Elf64_Ehdr ehdr;
   Elf64_Shdr *shdrs;
   Table *symbol_table;  // <Elf64_Sym*>, global only
@@ -46,6 +51,6 @@ typedef struct ElfObj {
   int nobit_shndx;
 } ElfObj;
 
-ElfObj *read_elf(FILE *fp, const char *fn);
-void close_elf(ElfObj *elfobj);
+ElfObj *read_elf(const void *image, size_t size, const char *fn);
+const void *elfobj_section_data(ElfObj *elfobj, const Elf64_Shdr *shdr, size_t align);
 Elf64_Sym *elfobj_find_symbol(ElfObj *elfobj, const Name *name);
@@ -10,6 +10,8 @@
 #include <string.h>
 #include <strings.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "archive.h"
 #include "elfobj.h"
@@ -74,7 +76,7 @@ static LinkElem *new_link_elem(enum LinkElemKind kind) {
 typedef struct {
   size_t align;
   uint64_t start_address;
-  DataStorage *ds;
+  size_t size;  // File image size, without bss.
   size_t bss_size;
 } SectionGroup;
 
@@ -83,6 +85,8 @@ typedef struct {
   int nfiles;
   Table *symbol_table;  // <ElfObj*>
   Table *generated_symbol_table;  // <LinkElem*>
+  Vector *folded_sections;  // <ElfSectionInfo*>
+  bool gc_sections;
 } LinkEditor;
 
 void ld_init(LinkEditor *ld, int nfiles) {
@@ -92,6 +96,8 @@ void ld_init(LinkEditor *ld, int nfiles) {
   assert(ld->symbol_table != NULL);
   ld->generated_symbol_table = alloc_table();
   assert(ld->generated_symbol_table != NULL);
+  ld->folded_sections = new_vector();
+  ld->gc_sections = false;
 }
 
 void ld_load(LinkEditor *ld, int i, const char *filename) {
@@ -99,11 +105,12 @@ void ld_load(LinkEditor *ld, int i, const char *filename) {
   File *file = &ld->files[i];
   file->filename = filename;
   if (strcasecmp(ext, "o") == 0) {
-    FILE *fp;
-    if (!is_file(filename) || (fp = fopen(filename, "rb")) == NULL) {
+    void *image;
+    size_t size;
+    if (!is_file(filename) || (image = map_file(filename, &size)) == NULL) {
       fprintf(stderr, "cannot open: %s\n", filename);
     } else {
-      ElfObj *elfobj = read_elf(fp, filename);
+      ElfObj *elfobj = read_elf(image, size, filename);
       if (elfobj == NULL)
         exit(1);
       file->kind = FK_ELFOBJ;
@@ -214,186 +221,180 @@ static uint64_t calc_rela_sym_address(LinkEditor *ld, ElfObj *elfobj, const Elf6
   return address + rela->r_addend;
 }
 
-static int resolve_rela_elfobj(LinkEditor *ld, ElfObj *elfobj) {
+// Apply relocations for `dst_info` onto `content`, a private copy of the section.
+static int resolve_rela_section(LinkEditor *ld, const ElfSectionInfo *dst_info, unsigned char *content) {
   int error_count = 0;
-  for (Elf64_Half sec = 0; sec < elfobj->ehdr.e_shnum; ++sec) {
-    Elf64_Shdr *shdr = &elfobj->shdrs[sec];
-    if (shdr->sh_type != SHT_RELA || shdr->sh_size <= 0)
-      continue;
-    const Elf64_Rela *relas = read_or_die(elfobj->fp, NULL, shdr->sh_offset + elfobj->start_offset,
-                                          shdr->sh_size, "read error");
-    const Elf64_Shdr *symhdr = &elfobj->shdrs[shdr->sh_link];
-    const ElfSectionInfo *symhdrinfo = &elfobj->section_infos[shdr->sh_link];
-    const ElfSectionInfo *strinfo = &elfobj->section_infos[symhdr->sh_link];
-    const ElfSectionInfo *dst_info = &elfobj->section_infos[shdr->sh_info];
-    assert(dst_info->shdr->sh_type == SHT_PROGBITS || dst_info->shdr->sh_type == SHT_INIT_ARRAY ||
-           dst_info->shdr->sh_type == SHT_FINI_ARRAY || dst_info->shdr->sh_type == SHT_PREINIT_ARRAY);
-    if (dst_info->progbits.content == NULL) {
-      // Target section is not collected, so skip relocation.
-      continue;
-    }
-
-    size_t symbol_count = elfobj->symtab_section->symtab.count;
-    for (size_t j = 0, n = shdr->sh_size / sizeof(Elf64_Rela); j < n; ++j) {
-      const Elf64_Rela *rela = &relas[j];
-      assert(ELF64_R_SYM(rela->r_info) < symbol_count);
-      const Elf64_Sym *sym = &symhdrinfo->symtab.syms[ELF64_R_SYM(rela->r_info)];
-      uint64_t address = calc_rela_sym_address(ld, elfobj, rela, sym, strinfo);
-
-      void *p = dst_info->progbits.content + rela->r_offset;
-      uint64_t pc = elfobj->section_infos[shdr->sh_info].progbits.address + rela->r_offset;
-      switch (ELF64_R_TYPE(rela->r_info)) {
+  ElfObj *elfobj = dst_info->elfobj;
+  const Elf64_Shdr *shdr = dst_info->progbits.rela;
+  assert(shdr != NULL);
+  assert(dst_info->shdr->sh_type == SHT_PROGBITS || dst_info->shdr->sh_type == SHT_INIT_ARRAY ||
+         dst_info->shdr->sh_type == SHT_FINI_ARRAY || dst_info->shdr->sh_type == SHT_PREINIT_ARRAY);
+  const Elf64_Rela *relas = elfobj_section_data(elfobj, shdr, _Alignof(Elf64_Rela));
+  const Elf64_Shdr *symhdr = &elfobj->shdrs[shdr->sh_link];
+  const ElfSectionInfo *symhdrinfo = &elfobj->section_infos[shdr->sh_link];
+  const ElfSectionInfo *strinfo = &elfobj->section_infos[symhdr->sh_link];
+
+  size_t symbol_count = elfobj->symtab_section->symtab.count;
+  for (size_t j = 0, n = shdr->sh_size / sizeof(Elf64_Rela); j < n; ++j) {
+    const Elf64_Rela *rela = &relas[j];
+    assert(ELF64_R_SYM(rela->r_info) < symbol_count);
+    const Elf64_Sym *sym = &symhdrinfo->symtab.syms[ELF64_R_SYM(rela->r_info)];
+    uint64_t address = calc_rela_sym_address(ld, elfobj, rela, sym, strinfo);
+
+    void *p = content + rela->r_offset;
+    uint64_t pc = dst_info->progbits.address + rela->r_offset;
+    switch (ELF64_R_TYPE(rela->r_info)) {
 #if XCC_TARGET_ARCH == XCC_ARCH_X64
-      case R_X86_64_64:
-        *(uint64_t*)p = address;
-        break;
-      case R_X86_64_PC32:
-      case R_X86_64_PLT32:
-        *(uint32_t*)p = address - pc;
-        break;
+    case R_X86_64_64:
+      *(uint64_t*)p = address;
+      break;
+    case R_X86_64_PC32:
+    case R_X86_64_PLT32:
+      *(uint32_t*)p = address - pc;
+      break;
 
 #elif XCC_TARGET_ARCH == XCC_ARCH_AARCH64
-      case R_AARCH64_ABS64:
-        *(uint64_t*)p = address;
-        break;
-      case R_AARCH64_ADR_PREL_PG_HI21:  // Page(S+A)-Page(P)
-        {
-          const int PAGE = 12;
-          const uint32_t MASK = ~0x60ffffe0;
-          uint32_t d = (address >> PAGE) - (pc >> PAGE);
-          *(uint32_t*)p = (*(uint32_t*)p & MASK) | ((d & 0x03) << 29) | ((d & 0x1ffffc) << 3);
-        }
-        break;
-      case R_AARCH64_ADD_ABS_LO12_NC:  // S + A
-        {
-          const uint32_t MASK = ~(((1U << 12) - 1) << 10);
-          *(uint32_t*)p = (*(uint32_t*)p & MASK) | ((address << 10) & ~MASK);
-        }
-        break;
-      case R_AARCH64_CALL26:  // S+A-P
-        {
-          const uint32_t MASK = -(1U << 26);
-          *(uint32_t*)p = (*(uint32_t*)p & MASK) | (((address - pc) >> 2) & ~MASK);
-        }
-        break;
+    case R_AARCH64_ABS64:
+      *(uint64_t*)p = address;
+      break;
+    case R_AARCH64_ADR_PREL_PG_HI21:  // Page(S+A)-Page(P)
+      {
+        const int PAGE = 12;
+        const uint32_t MASK = ~0x60ffffe0;
+        uint32_t d = (address >> PAGE) - (pc >> PAGE);
+        *(uint32_t*)p = (*(uint32_t*)p & MASK) | ((d & 0x03) << 29) | ((d & 0x1ffffc) << 3);
+      }
+      break;
+    case R_AARCH64_ADD_ABS_LO12_NC:  // S + A
+      {
+        const uint32_t MASK = ~(((1U << 12) - 1) << 10);
+        *(uint32_t*)p = (*(uint32_t*)p & MASK) | ((address << 10) & ~MASK);
+      }
+      break;
+    case R_AARCH64_CALL26:  // S+A-P
+      {
+        const uint32_t MASK = -(1U << 26);
+        *(uint32_t*)p = (*(uint32_t*)p & MASK) | (((address - pc) >> 2) & ~MASK);
+      }
+      break;
 
-      case R_AARCH64_ADR_GOT_PAGE:
-      case R_AARCH64_LD64_GOT_LO12_NC:
-        assert(!"TODO: Implement");
-        break;
+    case R_AARCH64_ADR_GOT_PAGE:
+    case R_AARCH64_LD64_GOT_LO12_NC:
+      assert(!"TODO: Implement");
+      break;
 
 #elif XCC_TARGET_ARCH == XCC_ARCH_RISCV64
-      case R_RISCV_64:
-        *(uint64_t*)p = address;
-        break;
-      case R_RISCV_CALL:
-        {
-          int64_t offset = address - pc;
-          assert(offset < (1L << 19) && offset >= -(1L << 19));  // TODO
-          *(uint32_t*)p = W_JAL(RA, offset);
-        }
-        break;
-      case R_RISCV_RELAX:
-        {
-          // TODO: Check
-          assert(j > 0);
-          const Elf64_Rela *rela0 = &relas[j - 1];
-          switch (ELF64_R_TYPE(rela0->r_info)) {
-          case R_RISCV_CALL:
-            ((uint32_t*)p)[1] = P_NOP();
-            break;
-          case R_RISCV_PCREL_HI20:
-          case R_RISCV_PCREL_LO12_I:
-          case R_RISCV_HI20:
-          case R_RISCV_LO12_I:
-            break;
-          default: assert(false); break;
-          }
-        }
-        break;
-      case R_RISCV_PCREL_HI20:
-      case R_RISCV_HI20:
-        {
-          int64_t offset = address - (ELF64_R_TYPE(rela->r_info) == R_RISCV_PCREL_HI20 ? pc : 0);
-          assert(offset < (1L << 31) && offset >= -(1L << 31));
-          // const uint32_t MASK20 = (1U << 20) - 1;
-          const uint32_t MASK12 = (1U << 12) - 1;
-          if ((offset & MASK12) >= (1U << 11))
-            offset += 1U << 12;
-          *(uint32_t*)p = (*(uint32_t*)p & MASK12) | ((uint32_t)offset & ~MASK12);
-        }
-        break;
-      case R_RISCV_PCREL_LO12_I:
-      case R_RISCV_LO12_I:
-        {
-          // Get corresponding HI20 rela, and calculate the offset.
-          // Assume [..., [j-2]=PCREL_HI20, [j-1]=RELAX, [j]=PCREL_LO12_I, ...]
-          assert(j >= 2);
-          const Elf64_Rela *hirela = &relas[j - 2];
-          assert((ELF64_R_TYPE(rela->r_info) == R_RISCV_PCREL_LO12_I && ELF64_R_TYPE(hirela->r_info) == R_RISCV_PCREL_HI20) ||
-                 (ELF64_R_TYPE(rela->r_info) == R_RISCV_LO12_I && ELF64_R_TYPE(hirela->r_info) == R_RISCV_HI20));
-          const Elf64_Sym *hisym = &symhdrinfo->symtab.syms[ELF64_R_SYM(hirela->r_info)];
-          uint64_t hiaddress = calc_rela_sym_address(ld, elfobj, hirela, hisym, strinfo);
-          uint64_t hipc = elfobj->section_infos[shdr->sh_info].progbits.address + hirela->r_offset;
-
-          int64_t offset = hiaddress - (ELF64_R_TYPE(rela->r_info) == R_RISCV_PCREL_LO12_I ? hipc : 0);
-          assert(offset < (1L << 31) && offset >= -(1L << 31));
-          const uint32_t MASK20 = (1U << 20) - 1;
-          const uint32_t MASK12 = (1U << 12) - 1;
-          *(uint32_t*)p = (*(uint32_t*)p & MASK20) | (((uint32_t)offset & MASK12) << 20);
+    case R_RISCV_64:
+      *(uint64_t*)p = address;
+      break;
+    case R_RISCV_CALL:
+      {
+        int64_t offset = address - pc;
+        assert(offset < (1L << 19) && offset >= -(1L << 19));  // TODO
+        *(uint32_t*)p = W_JAL(RA, offset);
+      }
+      break;
+    case R_RISCV_RELAX:
+      {
+        // TODO: Check
+        assert(j > 0);
+        const Elf64_Rela *rela0 = &relas[j - 1];
+        switch (ELF64_R_TYPE(rela0->r_info)) {
+        case R_RISCV_CALL:
+          ((uint32_t*)p)[1] = P_NOP();
+          break;
+        case R_RISCV_PCREL_HI20:
+        case R_RISCV_PCREL_LO12_I:
+        case R_RISCV_HI20:
+        case R_RISCV_LO12_I:
+          break;
+        default: assert(false); break;
         }
-        break;
-      case R_RISCV_RVC_JUMP:
-        {
-          int64_t offset = address - pc;
-          assert(offset < (1L << 11) && offset >= -(1L << 11));
+      }
+      break;
+    case R_RISCV_PCREL_HI20:
+    case R_RISCV_HI20:
+      {
+        int64_t offset = address - (ELF64_R_TYPE(rela->r_info) == R_RISCV_PCREL_HI20 ? pc : 0);
+        assert(offset < (1L << 31) && offset >= -(1L << 31));
+        // const uint32_t MASK20 = (1U << 20) - 1;
+        const uint32_t MASK12 = (1U << 12) - 1;
+        if ((offset & MASK12) >= (1U << 11))
+          offset += 1U << 12;
+        *(uint32_t*)p = (*(uint32_t*)p & MASK12) | ((uint32_t)offset & ~MASK12);
+      }
+      break;
+    case R_RISCV_PCREL_LO12_I:
+    case R_RISCV_LO12_I:
+      {
+        // Get corresponding HI20 rela, and calculate the offset.
+        // Assume [..., [j-2]=PCREL_HI20, [j-1]=RELAX, [j]=PCREL_LO12_I, ...]
+        assert(j >= 2);
+        const Elf64_Rela *hirela = &relas[j - 2];
+        assert((ELF64_R_TYPE(rela->r_info) == R_RISCV_PCREL_LO12_I && ELF64_R_TYPE(hirela->r_info) == R_RISCV_PCREL_HI20) ||
+               (ELF64_R_TYPE(rela->r_info) == R_RISCV_LO12_I && ELF64_R_TYPE(hirela->r_info) == R_RISCV_HI20));
+        const Elf64_Sym *hisym = &symhdrinfo->symtab.syms[ELF64_R_SYM(hirela->r_info)];
+        uint64_t hiaddress = calc_rela_sym_address(ld, elfobj, hirela, hisym, strinfo);
+        uint64_t hipc = dst_info->progbits.address + hirela->r_offset;
+
+        int64_t offset = hiaddress - (ELF64_R_TYPE(rela->r_info) == R_RISCV_PCREL_LO12_I ? hipc : 0);
+        assert(offset < (1L << 31) && offset >= -(1L << 31));
+        const uint32_t MASK20 = (1U << 20) - 1;
+        const uint32_t MASK12 = (1U << 12) - 1;
+        *(uint32_t*)p = (*(uint32_t*)p & MASK20) | (((uint32_t)offset & MASK12) << 20);
+      }
+      break;
+    case R_RISCV_RVC_JUMP:
+      {
+        int64_t offset = address - pc;
+        assert(offset < (1L << 11) && offset >= -(1L << 11));
 
-          uint16_t *q = (uint16_t*)p;
-          assert((*q & 0xe003) == 0xa001);  // c.j
-          *q = (*q & 0xe003) | SWIZZLE_C_J(offset);
-        }
-        break;
-      case R_RISCV_JAL:
-        {
-          int64_t offset = address - pc;
-          assert(offset < (1L << 19) && offset >= -(1L << 19));
+        uint16_t *q = (uint16_t*)p;
+        assert((*q & 0xe003) == 0xa001);  // c.j
+        *q = (*q & 0xe003) | SWIZZLE_C_J(offset);
+      }
+      break;
+    case R_RISCV_JAL:
+      {
+        int64_t offset = address - pc;
+        assert(offset < (1L << 19) && offset >= -(1L << 19));
 
+        uint32_t *q = (uint32_t*)p;
+        assert((*q & 0x0000007f) == 0x6f);  // jal
+        *q = (*q & 0x0000007f) | SWIZZLE_JAL(offset);
+      }
+      break;
+    case R_RISCV_BRANCH:
+    case R_RISCV_RVC_BRANCH:
+      {
+        int64_t offset = address - pc;
+
+        if (ELF64_R_TYPE(rela->r_info) == R_RISCV_RVC_BRANCH) {
+          assert(offset < (1 << 8) && offset >= -(1 << 8));
+          // c.beqz, c.bnez
+          uint16_t *q = (uint16_t*)p;
+          assert((*q & 0xc003) == 0xc001);  // c.beqz or c.bnez
+          *q = (*q & 0xe383) | SWIZZLE_C_BXX(offset);
+        } else {
+          assert(offset < (1 << 13) && offset >= -(1 << 13));
           uint32_t *q = (uint32_t*)p;
-          assert((*q & 0x0000007f) == 0x6f);  // jal
-          *q = (*q & 0x0000007f) | SWIZZLE_JAL(offset);
-        }
-        break;
-      case R_RISCV_BRANCH:
-      case R_RISCV_RVC_BRANCH:
-        {
-          int64_t offset = address - pc;
-
-          if (ELF64_R_TYPE(rela->r_info) == R_RISCV_RVC_BRANCH) {
-            assert(offset < (1 << 8) && offset >= -(1 << 8));
-            // c.beqz, c.bnez
-            uint16_t *q = (uint16_t*)p;
-            assert((*q & 0xc003) == 0xc001);  // c.beqz or c.bnez
-            *q = (*q & 0xe383) | SWIZZLE_C_BXX(offset);
-          } else {
-            assert(offset < (1 << 13) && offset >= -(1 << 13));
-            uint32_t *q = (uint32_t*)p;
-            *q = (*q & 0x01fff07f) | SWIZZLE_BXX(offset);
-          }
+          *q = (*q & 0x01fff07f) | SWIZZLE_BXX(offset);
         }
-        break;
+      }
+      break;
 #endif
 
-      default:
-        fprintf(stderr, "Unhandled rela type: %" PRIx32 "\n", (uint32_t)ELF64_R_TYPE(rela->r_info));
-        ++error_count;
-        break;
-      }
+    default:
+      fprintf(stderr, "Unhandled rela type: %" PRIx32 "\n", (uint32_t)ELF64_R_TYPE(rela->r_info));
+      ++error_count;
+      break;
     }
   }
   return error_count;
 }
 
-static int resolve_symbols_elfobj(LinkEditor *ld, ElfObj *elfobj, Table *unresolved) {
+// Newly unresolved symbols are also pushed onto `queue`, if given.
+static int resolve_symbols_elfobj(LinkEditor *ld, ElfObj *elfobj, Table *unresolved, Vector *queue) {
   ElfSectionInfo *symtab_section = elfobj->symtab_section;
   assert(symtab_section != NULL);
   ElfSectionInfo *strtab_section = symtab_section->symtab.strtab;
@@ -429,6 +430,8 @@ static int resolve_symbols_elfobj(LinkEditor *ld, ElfObj *elfobj, Table *unresol
       }
     } else {
       if (sym->st_shndx == SHN_UNDEF) {
+        if (queue != NULL && !table_try_get(unresolved, name, NULL))
+          vec_push(queue, name);
         table_put(unresolved, name, (void*)name);
       } else {
         table_delete(unresolved, name);
@@ -453,40 +456,42 @@ static void collect_sections_elfobj(LinkEditor *ld, ElfObj *elfobj, const char *
            shdr->sh_type == SHT_FINI_ARRAY || shdr->sh_type == SHT_PREINIT_ARRAY);
     assert(shdr->sh_size > 0);
 
+    // Match `name` and `name.*`, e.g. `.text.foo` is collected into `.text`.
     const char *s = &strbuf[shdr->sh_name];
-    if (strcmp(s, name) == 0) {  // TODO: Wild card
+    size_t len = strlen(name);
+    if (strncmp(s, name, len) == 0 && (s[len] == '\0' || s[len] == '.')) {
       vec_push(seclist, section);
       elfobj->prog_sections->data[i] = NULL;
     }
   }
 }
 
-static void *load_elfobj(FILE *fp, const char *fn, size_t size) {
-  UNUSED(size);
-  return read_elf(fp, fn);
+static void *load_elfobj(const void *image, size_t size, const char *fn) {
+  return read_elf(image, size, fn);
 }
 
 static int resolve_symbols_archive(LinkEditor *ld, Archive *ar, Table *unresolved) {
+  // Worklist: each unresolved symbol is looked up in the archive exactly once,
+  // and symbols newly referenced by pulled members are appended to the queue.
+  Vector *queue = new_vector();  // <const Name*>
+  const Name *name;
+  for (int it = 0; (it = table_iterate(unresolved, it, &name, NULL)) != -1;)
+    vec_push(queue, name);
+
   int error_count = 0;
   Table *table = &ar->symbol_table;
-  for (;;) {
-    bool retry = false;
-    const Name *name;
-    for (int it = 0; (it = table_iterate(unresolved, it, &name, NULL)) != -1;) {
-      ArSymbol *symbol;
-      if (!table_try_get(table, name, (void**)&symbol))
-        continue;
+  for (int i = 0; i < queue->len; ++i) {
+    name = queue->data[i];
+    ArSymbol *symbol;
+    if (!table_try_get(unresolved, name, NULL) || !table_try_get(table, name, (void**)&symbol) ||
+        symbol->content->obj != NULL)
+      continue;
 
-      ElfObj *elfobj = load_archive_content(ar, symbol, load_elfobj);
-      if (elfobj != NULL) {
-        error_count += resolve_symbols_elfobj(ld, elfobj, unresolved);
-        retry = true;
-        break;
-      }
-    }
-    if (!retry)
-      break;
+    ElfObj *elfobj = load_archive_content_image(ar, symbol, load_elfobj);
+    if (elfobj != NULL)
+      error_count += resolve_symbols_elfobj(ld, elfobj, unresolved, queue);
   }
+  free_vector(queue);
   return error_count;
 }
 
@@ -500,72 +505,418 @@ static void collect_sections_archive(LinkEditor *ld, Archive *ar, const char *na
   }
 }
 
-static int resolve_rela_archive(LinkEditor *ld, Archive *ar) {
-  int error_count = 0;
-  FOREACH_FILE_ARCONTENT(ar, content, {
-    error_count += resolve_rela_elfobj(ld, content->obj);
-  });
-  return error_count;
-}
-
-static int ld_resolve_relas(LinkEditor *ld) {
+static int ld_resolve_symbols(LinkEditor *ld, Table *unresolved) {
   int error_count = 0;
   for (int i = 0; i < ld->nfiles; ++i) {
     File *file = &ld->files[i];
     switch (file->kind) {
     case FK_ELFOBJ:
-      error_count += resolve_rela_elfobj(ld, file->elfobj);
+      error_count += resolve_symbols_elfobj(ld, file->elfobj, unresolved, NULL);
       break;
     case FK_ARCHIVE:
-      error_count += resolve_rela_archive(ld, file->archive);
+      error_count += resolve_symbols_archive(ld, file->archive, unresolved);
       break;
     }
   }
   return error_count;
 }
 
-static void add_elf_section(SectionGroup section_groups[SECTION_COUNT], const ElfSectionInfo *p, int secno) {
-  Elf64_Shdr *shdr = p->shdr;
-  if (shdr->sh_type == SHT_NOBITS)
-    return;
-  Elf64_Xword align = shdr->sh_addralign;
-  SectionGroup *secgroup = &section_groups[secno];
-  assert(align <= secgroup->align);
-  assert(secgroup->ds != NULL);
-  data_align(secgroup->ds, align);
-  void *content = p->progbits.content;
-  assert(content != NULL);
-  data_append(secgroup->ds, content, shdr->sh_size);
+// 0: `.text.hot.*`, 2: `.text.unlikely.*`, 1: others.
+static int text_section_rank(ElfSectionInfo *section) {
+  ElfObj *elfobj = section->elfobj;
+  const char *s = &elfobj->section_infos[elfobj->ehdr.e_shstrndx].strtab.buf[section->shdr->sh_name];
+  static const char *kPrefixes[] = {".text.hot", ".text.unlikely"};
+  for (int i = 0; i < (int)ARRAY_SIZE(kPrefixes); ++i) {
+    size_t len = strlen(kPrefixes[i]);
+    if (strncmp(s, kPrefixes[i], len) == 0 && (s[len] == '\0' || s[len] == '.'))
+      return i * 2;
+  }
+  return 1;
 }
 
-static int ld_resolve_symbols(LinkEditor *ld, Table *unresolved) {
-  int error_count = 0;
+static void ld_collect_sections(LinkEditor *ld, const char *name, Vector *seclist) {
   for (int i = 0; i < ld->nfiles; ++i) {
     File *file = &ld->files[i];
     switch (file->kind) {
     case FK_ELFOBJ:
-      error_count += resolve_symbols_elfobj(ld, file->elfobj, unresolved);
+      collect_sections_elfobj(ld, file->elfobj, name, seclist);
       break;
     case FK_ARCHIVE:
-      error_count += resolve_symbols_archive(ld, file->archive, unresolved);
+      collect_sections_archive(ld, file->archive, name, seclist);
       break;
     }
   }
-  return error_count;
+
+  if (strcmp(name, ".text") == 0) {
+    // Gather hot functions at the beginning, and cold ones at the end (stable).
+    int n = seclist->len;
+    void **sorted = malloc_or_die(sizeof(*sorted) * n);
+    int count = 0;
+    for (int rank = 0; rank < 3; ++rank) {
+      for (int i = 0; i < n; ++i) {
+        if (text_section_rank(seclist->data[i]) == rank)
+          sorted[count++] = seclist->data[i];
+      }
+    }
+    memcpy(seclist->data, sorted, sizeof(*sorted) * n);
+    free(sorted);
+  }
 }
 
-static void ld_collect_sections(LinkEditor *ld, const char *name, Vector *seclist) {
+static ElfSectionInfo *elfobj_symbol_section(ElfObj *elfobj, const Elf64_Sym *sym) {
+  int shndx = sym->st_shndx;
+  if (shndx == SHN_COMMON)
+    shndx = elfobj->nobit_shndx;
+  if (shndx <= SHN_UNDEF || shndx >= elfobj->ehdr.e_shnum)
+    return NULL;
+  return &elfobj->section_infos[shndx];
+}
+
+static ElfSectionInfo *ld_symbol_section(LinkEditor *ld, const Name *name) {
+  ElfObj *elfobj = table_get(ld->symbol_table, name);
+  if (elfobj == NULL)  // Generated or undefined weak symbol.
+    return NULL;
+  Elf64_Sym *sym = elfobj_find_symbol(elfobj, name);
+  return sym != NULL ? elfobj_symbol_section(elfobj, sym) : NULL;
+}
+
+// Section which the relocation refers to, or NULL for generated and undefined weak symbols.
+// `*pvalue` is set to the offset within the section, and `*pname` to the symbol name.
+static ElfSectionInfo *rela_target(LinkEditor *ld, ElfObj *elfobj, const Elf64_Shdr *relhdr,
+                                   const Elf64_Rela *rela, uint64_t *pvalue, const char **pname) {
+  const ElfSectionInfo *symhdrinfo = &elfobj->section_infos[relhdr->sh_link];
+  size_t symidx = ELF64_R_SYM(rela->r_info);
+  assert(symidx < symhdrinfo->symtab.count);
+  const Elf64_Sym *sym = &symhdrinfo->symtab.syms[symidx];
+  const char *name = &symhdrinfo->symtab.strtab->strtab.buf[sym->st_name];
+  *pname = name;
+  *pvalue = 0;
+  if (ELF64_ST_BIND(sym->st_info) != STB_LOCAL) {
+    const Name *symname = alloc_name(name, NULL, false);
+    elfobj = table_get(ld->symbol_table, symname);
+    if (elfobj == NULL || (sym = elfobj_find_symbol(elfobj, symname)) == NULL)
+      return NULL;
+  }
+  if (ELF64_ST_TYPE(sym->st_info) != STT_SECTION)
+    *pvalue = sym->st_value;
+  return elfobj_symbol_section(elfobj, sym);
+}
+
+static Vector *ld_loaded_elfobjs(LinkEditor *ld) {
+  Vector *elfobjs = new_vector();  // <ElfObj*>
   for (int i = 0; i < ld->nfiles; ++i) {
     File *file = &ld->files[i];
     switch (file->kind) {
     case FK_ELFOBJ:
-      collect_sections_elfobj(ld, file->elfobj, name, seclist);
+      vec_push(elfobjs, file->elfobj);
       break;
     case FK_ARCHIVE:
-      collect_sections_archive(ld, file->archive, name, seclist);
+      FOREACH_FILE_ARCONTENT(file->archive, content, {
+        if (content->obj != NULL)
+          vec_push(elfobjs, content->obj);
+      });
       break;
     }
   }
+  return elfobjs;
+}
+
+static void mark_section(ElfSectionInfo *section, Vector *queue) {
+  if (!section->progbits.marked) {
+    section->progbits.marked = true;
+    vec_push(queue, section);
+  }
+}
+
+static void mark_rela_targets(LinkEditor *ld, ElfSectionInfo *section, Vector *queue) {
+  const Elf64_Shdr *shdr = section->progbits.rela;
+  if (shdr == NULL)
+    return;
+  ElfObj *elfobj = section->elfobj;
+  const Elf64_Rela *relas = elfobj_section_data(elfobj, shdr, _Alignof(Elf64_Rela));
+  for (size_t i = 0, n = shdr->sh_size / sizeof(Elf64_Rela); i < n; ++i) {
+    uint64_t value;
+    const char *name;
+    ElfSectionInfo *target = rela_target(ld, elfobj, shdr, &relas[i], &value, &name);
+    if (target != NULL)
+      mark_section(target, queue);
+  }
+}
+
+// Keep sections reachable from the entry and init/fini arrays, and drop the others.
+static void ld_gc_sections(LinkEditor *ld, const Name *entry_name) {
+  Vector *elfobjs = ld_loaded_elfobjs(ld);
+
+  Vector *queue = new_vector();  // <ElfSectionInfo*>
+  ElfSectionInfo *entry = ld_symbol_section(ld, entry_name);
+  if (entry != NULL)
+    mark_section(entry, queue);
+  for (int i = 0; i < elfobjs->len; ++i) {
+    ElfObj *elfobj = elfobjs->data[i];
+    for (int j = 0; j < elfobj->prog_sections->len; ++j) {
+      ElfSectionInfo *section = elfobj->prog_sections->data[j];
+      Elf64_Word type = section->shdr->sh_type;
+      if (type == SHT_INIT_ARRAY || type == SHT_FINI_ARRAY || type == SHT_PREINIT_ARRAY)
+        mark_section(section, queue);
+    }
+  }
+
+  for (int i = 0; i < queue->len; ++i)
+    mark_rela_targets(ld, queue->data[i], queue);
+
+  // Unmarked sections are never collected.
+  for (int i = 0; i < elfobjs->len; ++i) {
+    ElfObj *elfobj = elfobjs->data[i];
+    for (int j = 0; j < elfobj->prog_sections->len; ++j) {
+      ElfSectionInfo *section = elfobj->prog_sections->data[j];
+      if (!section->progbits.marked)
+        elfobj->prog_sections->data[j] = NULL;
+    }
+  }
+
+  free_vector(queue);
+  free_vector(elfobjs);
+}
+
+// Identical code folding
+
+typedef struct {
+  uint32_t type;
+  uint64_t offset;
+  int64_t addend;
+  ElfSectionInfo *target;  // NULL for generated symbols.
+  const char *name;  // Symbol name, compared if `target` is NULL.
+  uint64_t value;  // Offset in the target section.
+} IcfRela;
+
+typedef struct {
+  ElfSectionInfo *section;
+  const unsigned char *content;
+  IcfRela *relas;
+  size_t rela_count;
+  uint32_t hash;
+  int index;  // Original order, the first one in a class is kept.
+} IcfSection;
+
+static bool is_call_rela(uint32_t type) {
+  switch (type) {
+#if XCC_TARGET_ARCH == XCC_ARCH_X64
+  case R_X86_64_PLT32:
+#elif XCC_TARGET_ARCH == XCC_ARCH_AARCH64
+  case R_AARCH64_CALL26:
+#elif XCC_TARGET_ARCH == XCC_ARCH_RISCV64
+  case R_RISCV_CALL:
+  case R_RISCV_JAL:
+  case R_RISCV_RVC_JUMP:
+  case R_RISCV_BRANCH:
+  case R_RISCV_RVC_BRANCH:
+  case R_RISCV_RELAX:
+#endif
+    return true;
+  default:
+    return false;
+  }
+}
+
+static uint32_t hash_bytes(uint32_t hash, const void *data, size_t size) {
+  // FNV-1a
+  const unsigned char *p = data;
+  for (size_t i = 0; i < size; ++i)
+    hash = (hash ^ p[i]) * 16777619u;
+  return hash;
+}
+
+#define CMP(a, b)  do { if ((a) != (b)) return (a) < (b) ? -1 : 1; } while (0)
+
+// Compare contents and relocations, except targets which are also folding candidates.
+static int compare_icf_contents(const IcfSection *a, const IcfSection *b) {
+  const Elf64_Shdr *sa = a->section->shdr, *sb = b->section->shdr;
+  CMP(a->hash, b->hash);
+  CMP(sa->sh_size, sb->sh_size);
+  CMP(sa->sh_addralign, sb->sh_addralign);
+  CMP(a->rela_count, b->rela_count);
+  int d = memcmp(a->content, b->content, sa->sh_size);
+  if (d != 0)
+    return d;
+  for (size_t i = 0; i < a->rela_count; ++i) {
+    const IcfRela *ra = &a->relas[i], *rb = &b->relas[i];
+    CMP(ra->type, rb->type);
+    CMP(ra->offset, rb->offset);
+    CMP(ra->addend, rb->addend);
+    CMP(ra->value, rb->value);
+    bool ca = ra->target != NULL && ra->target->progbits.icf_class > 0;
+    bool cb = rb->target != NULL && rb->target->progbits.icf_class > 0;
+    CMP(ca, cb);
+    if (!ca) {
+      CMP(VOIDP2UINT(ra->target), VOIDP2UINT(rb->target));
+      if (ra->target == NULL && (d = strcmp(ra->name, rb->name)) != 0)
+        return d;
+    }
+  }
+  return 0;
+}
+
+// Compare the current classes of sections and their candidate targets.
+static int compare_icf_classes(const IcfSection *a, const IcfSection *b) {
+  CMP(a->section->progbits.icf_class, b->section->progbits.icf_class);
+  for (size_t i = 0; i < a->rela_count; ++i) {
+    const ElfSectionInfo *ta = a->relas[i].target, *tb = b->relas[i].target;
+    if (ta == NULL || ta->progbits.icf_class <= 0)
+      continue;  // Already compared in `compare_icf_contents`.
+    // Recursion to itself is equivalent.
+    int ka = ta == a->section ? 0 : ta->progbits.icf_class;
+    int kb = tb == b->section ? 0 : tb->progbits.icf_class;
+    CMP(ka, kb);
+  }
+  return 0;
+}
+
+#undef CMP
+
+static int sort_icf_contents(const void *pa, const void *pb) {
+  const IcfSection *a = *(const IcfSection**)pa, *b = *(const IcfSection**)pb;
+  int d = compare_icf_contents(a, b);
+  return d != 0 ? d : a->index - b->index;
+}
+
+static int sort_icf_classes(const void *pa, const void *pb) {
+  const IcfSection *a = *(const IcfSection**)pa, *b = *(const IcfSection**)pb;
+  int d = compare_icf_classes(a, b);
+  return d != 0 ? d : a->index - b->index;
+}
+
+// Number sorted sections by equivalence class, and returns the count of classes.
+static int assign_icf_classes(Vector *icfs, int (*compare)(const IcfSection*, const IcfSection*)) {
+  int *classes = malloc_or_die(sizeof(*classes) * icfs->len);
+  int count = 0;
+  for (int i = 0; i < icfs->len; ++i) {
+    if (i == 0 || (*compare)(icfs->data[i - 1], icfs->data[i]) != 0)
+      ++count;
+    classes[i] = count;
+  }
+  for (int i = 0; i < icfs->len; ++i) {
+    IcfSection *p = icfs->data[i];
+    p->section->progbits.icf_class = classes[i];
+  }
+  free(classes);
+  return count;
+}
+
+static IcfSection *new_icf_section(LinkEditor *ld, ElfSectionInfo *section, int index) {
+  ElfObj *elfobj = section->elfobj;
+  const Elf64_Shdr *shdr = section->shdr;
+  IcfSection *p = calloc_or_die(sizeof(*p));
+  p->section = section;
+  p->index = index;
+  p->content = elfobj_section_data(elfobj, shdr, 1);
+  p->hash = hash_bytes(2166136261u, p->content, shdr->sh_size);
+
+  const Elf64_Shdr *relhdr = section->progbits.rela;
+  if (relhdr != NULL) {
+    const Elf64_Rela *relas = elfobj_section_data(elfobj, relhdr, _Alignof(Elf64_Rela));
+    size_t n = relhdr->sh_size / sizeof(Elf64_Rela);
+    p->relas = malloc_or_die(sizeof(*p->relas) * n);
+    p->rela_count = n;
+    for (size_t i = 0; i < n; ++i) {
+      const Elf64_Rela *rela = &relas[i];
+      IcfRela *r = &p->relas[i];
+      r->type = ELF64_R_TYPE(rela->r_info);
+      r->offset = rela->r_offset;
+      r->addend = rela->r_addend;
+      r->target = rela_target(ld, elfobj, relhdr, rela, &r->value, &r->name);
+      p->hash = hash_bytes(p->hash, &r->type, sizeof(r->type));
+      p->hash = hash_bytes(p->hash, &r->offset, sizeof(r->offset));
+      p->hash = hash_bytes(p->hash, &r->addend, sizeof(r->addend));
+    }
+  }
+  return p;
+}
+
+// Fold identical code sections into one, except ones whose address is taken.
+static void ld_icf(LinkEditor *ld) {
+  Vector *elfobjs = ld_loaded_elfobjs(ld);
+
+  // A section referred other than by calls or jumps has its address taken,
+  // even when the reference is from itself.
+  for (int i = 0; i < elfobjs->len; ++i) {
+    ElfObj *elfobj = elfobjs->data[i];
+    for (int j = 0; j < elfobj->prog_sections->len; ++j) {
+      ElfSectionInfo *section = elfobj->prog_sections->data[j];
+      const Elf64_Shdr *relhdr;
+      if (section == NULL || (relhdr = section->progbits.rela) == NULL)
+        continue;
+      const Elf64_Rela *relas = elfobj_section_data(elfobj, relhdr, _Alignof(Elf64_Rela));
+      for (size_t k = 0, n = relhdr->sh_size / sizeof(Elf64_Rela); k < n; ++k) {
+        if (is_call_rela(ELF64_R_TYPE(relas[k].r_info)))
+          continue;
+        uint64_t value;
+        const char *name;
+        ElfSectionInfo *target = rela_target(ld, elfobj, relhdr, &relas[k], &value, &name);
+        if (target != NULL)
+          target->progbits.icf_class = -1;
+      }
+    }
+  }
+
+  Vector *icfs = new_vector();  // <IcfSection*>
+  for (int i = 0; i < elfobjs->len; ++i) {
+    ElfObj *elfobj = elfobjs->data[i];
+    for (int j = 0; j < elfobj->prog_sections->len; ++j) {
+      ElfSectionInfo *section = elfobj->prog_sections->data[j];
+      if (section == NULL || section->shdr->sh_type != SHT_PROGBITS ||
+          !(section->shdr->sh_flags & SHF_EXECINSTR) || section->progbits.icf_class != 0)
+        continue;
+      section->progbits.icf_class = 1;  // Candidate.
+    }
+  }
+  for (int i = 0; i < elfobjs->len; ++i) {
+    ElfObj *elfobj = elfobjs->data[i];
+    for (int j = 0; j < elfobj->prog_sections->len; ++j) {
+      ElfSectionInfo *section = elfobj->prog_sections->data[j];
+      if (section != NULL && section->progbits.icf_class > 0)
+        vec_push(icfs, new_icf_section(ld, section, icfs->len));
+    }
+  }
+
+  // Split classes until a fixed point is reached.
+  qsort(icfs->data, icfs->len, sizeof(*icfs->data), sort_icf_contents);
+  int count = assign_icf_classes(icfs, compare_icf_contents);
+  for (;;) {
+    qsort(icfs->data, icfs->len, sizeof(*icfs->data), sort_icf_classes);
+    int n = assign_icf_classes(icfs, compare_icf_classes);
+    if (n == count)
+      break;
+    count = n;
+  }
+
+  // Sorted by class and original order: keep the first one in each class.
+  IcfSection *kept = NULL;
+  for (int i = 0; i < icfs->len; ++i) {
+    IcfSection *p = icfs->data[i];
+    if (kept != NULL && p->section->progbits.icf_class == kept->section->progbits.icf_class) {
+      p->section->progbits.folded = kept->section;
+      vec_push(ld->folded_sections, p->section);
+    } else {
+      kept = p;
+    }
+  }
+
+  for (int i = 0; i < elfobjs->len; ++i) {
+    ElfObj *elfobj = elfobjs->data[i];
+    for (int j = 0; j < elfobj->prog_sections->len; ++j) {
+      ElfSectionInfo *section = elfobj->prog_sections->data[j];
+      if (section != NULL && section->progbits.folded != NULL)
+        elfobj->prog_sections->data[j] = NULL;
+    }
+  }
+
+  for (int i = 0; i < icfs->len; ++i) {
+    IcfSection *p = icfs->data[i];
+    free(p->relas);
+    free(p);
+  }
+  free_vector(icfs);
+  free_vector(elfobjs);
 }
 
 static void ld_calc_address(SectionGroup section_groups[SECTION_COUNT], Vector *section_lists[SECTION_COUNT], uint64_t start_address) {
@@ -597,6 +948,8 @@ static void ld_calc_address(SectionGroup section_groups[SECTION_COUNT], Vector *
 
             if (p->shdr->sh_type == SHT_NOBITS)
               secgroup->bss_size += size;
+            else
+              secgroup->size = address - secgroup->start_address;
           }
         }
         break;
@@ -605,6 +958,7 @@ static void ld_calc_address(SectionGroup section_groups[SECTION_COUNT], Vector *
         break;
       case LEK_ALIGN:
         address = ALIGN(address, elem->align);
+        secgroup->size = ALIGN(secgroup->size, elem->align);
         break;
       }
     }
@@ -631,14 +985,8 @@ static void ld_load_elf_objects(Vector *section_lists[SECTION_COUNT]) {
             case SHT_INIT_ARRAY:
             case SHT_FINI_ARRAY:
             case SHT_PREINIT_ARRAY:
-              {
-                Elf64_Xword size = shdr->sh_size;
-                assert(size > 0);
-
-                ElfObj *elfobj = p->elfobj;
-                void *buf = read_or_die(elfobj->fp, NULL, shdr->sh_offset + elfobj->start_offset, size, "read error");
-                p->progbits.content = buf;
-              }
+              assert(shdr->sh_size > 0);
+              p->progbits.content = elfobj_section_data(p->elfobj, shdr, 1);
               break;
             default: break;
             }
@@ -653,33 +1001,102 @@ static void ld_load_elf_objects(Vector *section_lists[SECTION_COUNT]) {
   }
 }
 
-static void output_section(FILE *fp, SectionGroup *secgroup) {
-  if (secgroup->ds == NULL)
-    return;
-  DataStorage *ds = secgroup->ds;
-  const void *buf = ds->buf;
-  fwrite(buf, ds->len, 1, fp);
+typedef struct {
+  ElfSectionInfo *section;
+  uint64_t offset;  // File offset.
+} OutputSection;
+
+static void add_output_sections(Vector *outsecs, Vector *seclist, SectionGroup *secgroup, uint64_t offset) {
+  for (int i = 0; i < seclist->len; ++i) {
+    LinkElem *elem = seclist->data[i];
+    if (elem->kind != LEK_SECTION)
+      continue;
+    Vector *list = elem->section.list;
+    for (int j = 0; j < list->len; ++j) {
+      ElfSectionInfo *p = list->data[j];
+      if (p->shdr->sh_type == SHT_NOBITS)
+        continue;
+      assert(p->progbits.content != NULL);
+      OutputSection *os = malloc_or_die(sizeof(*os));
+      os->section = p;
+      os->offset = offset + (p->progbits.address - secgroup->start_address);
+      vec_push(outsecs, os);
+    }
+  }
 }
 
-static bool output_exe(const char *ofn, uint64_t entry_address, SectionGroup section_groups[SECTION_COUNT]) {
-  int phnum = section_groups[SEC_DATA].ds->len > 0 || section_groups[SEC_DATA].bss_size > 0 ? 2 : 1;
-
-  FILE *fp;
-  if (ofn == NULL) {
-    fp = stdout;
-  } else {
-    const int mod = S_IRUSR | S_IWUSR | S_IXUSR | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH;  // 0755
-    const int flag = O_WRONLY | O_CREAT | O_TRUNC;
-    int fd = open(ofn, flag, mod);
-    if (fd < 0) {
-      perror("open failed");
-      return false;
+// Relocate every `step`-th section from `start`, and write it at its final offset.
+static int output_sections(LinkEditor *ld, int fd, Vector *outsecs, int start, int step) {
+  int error_count = 0;
+  for (int i = start; i < outsecs->len; i += step) {
+    OutputSection *os = outsecs->data[i];
+    ElfSectionInfo *p = os->section;
+    size_t size = p->shdr->sh_size;
+    const void *content = p->progbits.content;
+    unsigned char *buf = NULL;
+    if (p->progbits.rela != NULL) {
+      // Make private copy to apply relocations.
+      buf = malloc_or_die(size);
+      memcpy(buf, content, size);
+      error_count += resolve_rela_section(ld, p, buf);
+      content = buf;
+    }
+    if (pwrite(fd, content, size, os->offset) != (ssize_t)size) {
+      perror("write failed");
+      ++error_count;
     }
-    fp = fdopen(fd, "wb");
-    assert(fp != NULL);
+    free(buf);
+  }
+  return error_count;
+}
+
+// Sections are independent once addresses are fixed, so worker processes
+// relocate and write them into the shared output file concurrently.
+static int run_output_workers(LinkEditor *ld, int fd, Vector *outsecs, int nthreads) {
+  if (nthreads > outsecs->len)
+    nthreads = outsecs->len;
+  if (nthreads <= 1)
+    return output_sections(ld, fd, outsecs, 0, 1);
+
+  fflush(stdout);
+  fflush(stderr);
+  int error_count = 0;
+  pid_t *pids = malloc_or_die(sizeof(*pids) * nthreads);
+  for (int i = 0; i < nthreads; ++i) {
+    pid_t pid = fork();
+    if (pid == 0)
+      exit(output_sections(ld, fd, outsecs, i, nthreads) > 0 ? 1 : 0);
+    if (pid < 0)  // Fallback: Process the chunk by myself.
+      error_count += output_sections(ld, fd, outsecs, i, nthreads);
+    pids[i] = pid;
+  }
+  for (int i = 0; i < nthreads; ++i) {
+    int status;
+    if (pids[i] > 0 && (waitpid(pids[i], &status, 0) < 0 || !WIFEXITED(status) ||
+                        WEXITSTATUS(status) != 0))
+      ++error_count;
+  }
+  free(pids);
+  return error_count;
+}
+
+static bool output_exe(LinkEditor *ld, const char *ofn, uint64_t entry_address,
+                       Vector *section_lists[SECTION_COUNT], SectionGroup section_groups[SECTION_COUNT],
+                       int nthreads) {
+  int phnum = section_groups[SEC_DATA].size > 0 || section_groups[SEC_DATA].bss_size > 0 ? 2 : 1;
+
+  assert(ofn != NULL);
+  const int mod = S_IRUSR | S_IWUSR | S_IXUSR | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH;  // 0755
+  const int flag = O_WRONLY | O_CREAT | O_TRUNC;
+  int fd = open(ofn, flag, mod);
+  if (fd < 0) {
+    perror("open failed");
+    return false;
   }
+  FILE *fp = fdopen(fd, "wb");
+  assert(fp != NULL);
 
-  size_t code_rodata_sz = section_groups[SEC_TEXT].ds->len;
+  size_t code_rodata_sz = section_groups[SEC_TEXT].size;
 #if XCC_TARGET_ARCH == XCC_ARCH_RISCV64
   const int flags = EF_RISCV_RVC | EF_RISCV_FLOAT_ABI_DOUBLE;
 #else
@@ -688,25 +1105,41 @@ static bool output_exe(const char *ofn, uint64_t entry_address, SectionGroup sec
   out_elf_header(fp, entry_address, phnum, 0, flags, 0);
   out_program_header(fp, 0, PROG_START, section_groups[SEC_TEXT].start_address, code_rodata_sz, code_rodata_sz);
   if (phnum > 1) {
-    size_t datamemsz = section_groups[SEC_DATA].ds->len + section_groups[SEC_DATA].bss_size;
+    size_t datamemsz = section_groups[SEC_DATA].size + section_groups[SEC_DATA].bss_size;
     uint64_t offset = PROG_START + code_rodata_sz;
-    if (section_groups[SEC_DATA].ds->len > 0)
+    if (section_groups[SEC_DATA].size > 0)
       offset = ALIGN(offset, DATA_ALIGN);
-    out_program_header(fp, 1, offset, section_groups[SEC_DATA].start_address, section_groups[SEC_DATA].ds->len, datamemsz);
+    out_program_header(fp, 1, offset, section_groups[SEC_DATA].start_address, section_groups[SEC_DATA].size, datamemsz);
   }
 
-  uint64_t addr = PROG_START;
+  fflush(fp);
+
+  Vector *outsecs = new_vector();  // <OutputSection*>
+  uint64_t addr = PROG_START, file_size = addr;
   for (int sec = 0; sec < SECTION_COUNT; ++sec) {
     addr = ALIGN(addr, section_groups[sec].align);
-    size_t size = section_groups[sec].ds->len;
+    size_t size = section_groups[sec].size;
     if (size <= 0)
       continue;
-    put_padding(fp, addr);
-    output_section(fp, &section_groups[sec]);
-    addr += size;
+    add_output_sections(outsecs, section_lists[sec], &section_groups[sec], addr);
+    file_size = addr += size;
+  }
+
+  int error_count = run_output_workers(ld, fd, outsecs, nthreads);
+  if (ftruncate(fd, file_size) != 0) {  // Trailing padding.
+    perror("ftruncate failed");
+    ++error_count;
   }
   fclose(fp);
 
+  for (int i = 0; i < outsecs->len; ++i)
+    free(outsecs->data[i]);
+  free_vector(outsecs);
+
+  if (error_count > 0) {
+    unlink(ofn);
+    return false;
+  }
   return true;
 }
 
@@ -721,13 +1154,17 @@ typedef struct {
   int flag;
 } DumpSymbol;
 
+static bool is_section_discarded(LinkEditor *ld, const ElfSectionInfo *section) {
+  return ld->gc_sections && section != NULL && !section->progbits.marked;
+}
+
 static void dump_map_elfobj(LinkEditor *ld, ElfObj *elfobj, File *file, ArContent *content, Vector *symbols) {
   ElfSectionInfo *symtab = elfobj->symtab_section;
   assert(symtab != NULL);
   const char *strbuf = symtab->symtab.strtab->strtab.buf;
   for (size_t i = 0; i < symtab->symtab.count; ++i) {
     Elf64_Sym* sym = &symtab->symtab.syms[i];
-    if (sym->st_shndx == SHN_UNDEF)
+    if (sym->st_shndx == SHN_UNDEF || is_section_discarded(ld, elfobj_symbol_section(elfobj, sym)))
       continue;
 
     const char *name = &strbuf[sym->st_name];
@@ -794,6 +1231,52 @@ static void dump_map_file(LinkEditor *ld, Vector *symbols) {
   }
 }
 
+static void dump_discarded_elfobj(LinkEditor *ld, ElfObj *elfobj, const char *filename, FILE *fp) {
+  const char *strbuf = elfobj->section_infos[elfobj->ehdr.e_shstrndx].strtab.buf;
+  for (Elf64_Half sec = 0; sec < elfobj->ehdr.e_shnum; ++sec) {
+    const ElfSectionInfo *section = &elfobj->section_infos[sec];
+    const Elf64_Shdr *shdr = section->shdr;
+    switch (shdr->sh_type) {
+    case SHT_PROGBITS:
+    case SHT_NOBITS:
+      if (shdr->sh_size > 0 && is_section_discarded(ld, section))
+        fprintf(fp, "%9" PRIx64 ": %s  (%s)\n", (uint64_t)shdr->sh_size, &strbuf[shdr->sh_name], filename);
+      break;
+    default: break;
+    }
+  }
+}
+
+static void dump_discarded_sections(LinkEditor *ld, FILE *fp) {
+  for (int i = 0; i < ld->nfiles; ++i) {
+    File *file = &ld->files[i];
+    switch (file->kind) {
+    case FK_ELFOBJ:
+      dump_discarded_elfobj(ld, file->elfobj, file->filename, fp);
+      break;
+    case FK_ARCHIVE:
+      FOREACH_FILE_ARCONTENT(file->archive, content, {
+        dump_discarded_elfobj(ld, content->obj, content->name, fp);
+      });
+      break;
+    }
+  }
+}
+
+static const char *elfobj_section_name(const ElfSectionInfo *section) {
+  const ElfObj *elfobj = section->elfobj;
+  return &elfobj->section_infos[elfobj->ehdr.e_shstrndx].strtab.buf[section->shdr->sh_name];
+}
+
+static void dump_folded_sections(LinkEditor *ld, FILE *fp) {
+  for (int i = 0; i < ld->folded_sections->len; ++i) {
+    const ElfSectionInfo *p = ld->folded_sections->data[i];
+    const ElfSectionInfo *kept = p->progbits.folded;
+    fprintf(fp, "%9" PRIx64 ": %s  (%s)  =>  %s  (%s)\n", (uint64_t)p->shdr->sh_size,
+            elfobj_section_name(p), p->elfobj->filename, elfobj_section_name(kept), kept->elfobj->filename);
+  }
+}
+
 static int sort_dump_symbol(const void *a, const void *b) {
   DumpSymbol *dsa = *(DumpSymbol**)a;
   DumpSymbol *dsb = *(DumpSymbol**)b;
@@ -836,6 +1319,16 @@ static bool output_map_file(LinkEditor *ld, const char *outmapfn, uint64_t entry
   fprintf(mapfp, "\n### Entry point\n");
   fprintf(mapfp, "%9" PRIx64 ": %.*s\n", entry_address, NAMES(entry_name));
 
+  if (ld->gc_sections) {
+    fprintf(mapfp, "\n### Discarded sections (size: name)\n");
+    dump_discarded_sections(ld, mapfp);
+  }
+
+  if (ld->folded_sections->len > 0) {
+    fprintf(mapfp, "\n### Folded sections (size: name => kept)\n");
+    dump_folded_sections(ld, mapfp);
+  }
+
   if (mapfp != stdout)
     fclose(mapfp);
 
@@ -861,6 +1354,9 @@ typedef struct {
   const char *ofn;
   const char *entry;
   const char *outmapfn;
+  int nthreads;
+  bool gc_sections;
+  bool icf;
 } Options;
 
 static Vector *parse_options(int argc, char *argv[], Options *opts) {
@@ -868,6 +1364,9 @@ static Vector *parse_options(int argc, char *argv[], Options *opts) {
     OPT_HELP = 128,
     OPT_VERSION,
     OPT_OUTMAP,
+    OPT_GC_SECTIONS,
+    OPT_THREADS,
+    OPT_ICF,
 
     OPT_NO_PIE,
   };
@@ -879,6 +1378,9 @@ static Vector *parse_options(int argc, char *argv[], Options *opts) {
     {"L", required_argument},  // Add library path
     {"Map", required_argument, OPT_OUTMAP},  // Output map file
     {"-version", no_argument, 'V'},
+    {"-gc-sections", no_argument, OPT_GC_SECTIONS},  // Remove unreachable sections
+    {"-threads", required_argument, OPT_THREADS},  // Number of output workers
+    {"-icf", required_argument, OPT_ICF},  // Identical code folding: none, safe
 
     {"no-pie", no_argument, OPT_NO_PIE},
     {NULL},
@@ -925,6 +1427,30 @@ static Vector *parse_options(int argc, char *argv[], Options *opts) {
     case OPT_OUTMAP:
       opts->outmapfn = optarg;
       break;
+    case OPT_GC_SECTIONS:
+      opts->gc_sections = true;
+      break;
+    case OPT_ICF:
+      if (strcmp(optarg, "safe") == 0) {
+        opts->icf = true;
+      } else if (strcmp(optarg, "none") == 0) {
+        opts->icf = false;
+      } else {
+        fprintf(stderr, "--icf: unsupported mode: %s\n", optarg);
+        ++error_count;
+      }
+      break;
+    case OPT_THREADS:
+      {
+        int n = atoi(optarg);
+        if (n <= 0) {
+          fprintf(stderr, "--threads: illegal number: %s\n", optarg);
+          ++error_count;
+        } else {
+          opts->nthreads = n;
+        }
+      }
+      break;
     case OPT_NO_PIE:
       // Silently ignored.
       break;
@@ -1027,10 +1553,8 @@ static void prepare_section_groups(Vector *section_lists[SECTION_COUNT], Section
     SectionGroup *secgroup = &section_groups[secno];
     secgroup->align = secno == SEC_DATA ? DATA_ALIGN : 1;
     secgroup->start_address = 0;
-    secgroup->ds = NULL;
+    secgroup->size = 0;
     secgroup->bss_size = 0;
-    secgroup->ds = calloc_or_die(sizeof(*secgroup->ds));
-    data_init(secgroup->ds);
 
     Vector *seclist = section_lists[secno];
     for (int i = 0; i < seclist->len; ++i) {
@@ -1061,34 +1585,6 @@ static void prepare_section_groups(Vector *section_lists[SECTION_COUNT], Section
   }
 }
 
-static void collect_section_data(Vector *section_lists[SECTION_COUNT], SectionGroup section_groups[SECTION_COUNT]) {
-  for (int secno = 0; secno < SECTION_COUNT; ++secno) {
-    Vector *v = section_lists[secno];
-    for (int i = 0; i < v->len; ++i) {
-      LinkElem *elem = v->data[i];
-      switch (elem->kind) {
-      case LEK_SECTION:
-        {
-          Vector *list = elem->section.list;
-          for (int j = 0; j < list->len; ++j) {
-            ElfSectionInfo *p = list->data[j];
-            add_elf_section(section_groups, p, secno);
-          }
-        }
-        break;
-      case LEK_SYMBOL:
-        break;
-      case LEK_ALIGN:
-        {
-          SectionGroup *secgroup = &section_groups[secno];
-          data_align(secgroup->ds, elem->align);
-        }
-        break;
-      }
-    }
-  }
-}
-
 static int do_link(Vector *sources, const Options *opts) {
   LinkEditor *ld = malloc_or_die(sizeof(*ld));
   ld_init(ld, sources->len);
@@ -1116,24 +1612,27 @@ static int do_link(Vector *sources, const Options *opts) {
     return 1;
   }
 
+  ld->gc_sections = opts->gc_sections;
+  if (ld->gc_sections)
+    ld_gc_sections(ld, entry_name);
+  if (opts->icf)
+    ld_icf(ld);
   collect_sections(ld, section_lists);
 
   SectionGroup section_groups[SECTION_COUNT];
   prepare_section_groups(section_lists, section_groups);
 
   ld_calc_address(section_groups, section_lists, LOAD_ADDRESS);
+  for (int i = 0; i < ld->folded_sections->len; ++i) {
+    ElfSectionInfo *p = ld->folded_sections->data[i];
+    p->progbits.address = p->progbits.folded->progbits.address;
+  }
   ld_load_elf_objects(section_lists);
 
-  int error_count = ld_resolve_relas(ld);
-  if (error_count > 0)
-    return 1;
-
-  collect_section_data(section_lists, section_groups);
-
   uint64_t entry_address = ld_symbol_address(ld, entry_name);
   assert(entry_address != (uint64_t)-1);
 
-  bool result = output_exe(opts->ofn, entry_address, section_groups);
+  bool result = output_exe(ld, opts->ofn, entry_address, section_lists, section_groups, opts->nthreads);
 
   if (opts->outmapfn != NULL && result)
     result = output_map_file(ld, opts->outmapfn, entry_address, entry_name);
@@ -1145,6 +1644,9 @@ int main(int argc, char *argv[]) {
     .ofn = NULL,
     .entry = kDefaultEntryName,
     .outmapfn = NULL,
+    .nthreads = 1,
+    .gc_sections = false,
+    .icf = false,
   };
   Vector *sources = parse_options(argc, argv, &opts);
 
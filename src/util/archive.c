@@ -85,6 +85,9 @@ Archive *load_archive(const char *filename) {
 
   Archive *ar = calloc_or_die(sizeof(*ar));
   ar->fp = fp;
+  ar->filename = filename;
+  ar->image = NULL;
+  ar->image_size = 0;
   ar->symbol_count = 0;
   ar->symbols = NULL;
   table_init(&ar->symbol_table);
@@ -141,6 +144,21 @@ Archive *load_archive(const char *filename) {
   return ar;
 }
 
+static void read_content_header(ArContent *content, const struct ar_hdr *hdr) {
+  if (memcmp(hdr->ar_fmag, ARFMAG, sizeof(hdr->ar_fmag)) != 0)
+    error("Malformed archive");
+
+  memcpy(content->name, hdr->ar_name, sizeof(hdr->ar_name));
+  char *p = memchr(content->name, '/', sizeof(hdr->ar_name));
+  if (p != NULL)
+    *p = '\0';
+
+  char sizestr[sizeof(hdr->ar_size) + 1];
+  memcpy(sizestr, hdr->ar_size, sizeof(hdr->ar_size));
+  sizestr[sizeof(hdr->ar_size)] = '\0';
+  content->size = strtoul(sizestr, NULL, 10);
+}
+
 void *load_archive_content(Archive *ar, ArSymbol *symbol,
                            void *(*load)(FILE*, const char*, size_t)) {
   ArContent *content = symbol->content;
@@ -151,20 +169,40 @@ void *load_archive_content(Archive *ar, ArSymbol *symbol,
 
   struct ar_hdr hdr;
   read_or_die(ar->fp, &hdr, -1, sizeof(hdr), "hdr");
-  if (memcmp(hdr.ar_fmag, ARFMAG, sizeof(hdr.ar_fmag)) != 0)
-    error("Malformed archive");
+  read_content_header(content, &hdr);
 
-  memcpy(content->name, hdr.ar_name, sizeof(hdr.ar_name));
-  char *p = memchr(content->name, '/', sizeof(hdr.ar_name));
-  if (p != NULL)
-    *p = '\0';
+  void *obj = (*load)(ar->fp, content->name, content->size);
+  if (obj == NULL) {
+    error("Failed to extract .o: %.*s", (int)sizeof(content->name), content->name);
+  }
+  content->obj = obj;
+  vec_push(ar->contents, content);
 
-  char sizestr[sizeof(hdr.ar_size) + 1];
-  memcpy(sizestr, hdr.ar_size, sizeof(hdr.ar_size));
-  sizestr[sizeof(hdr.ar_size)] = '\0';
-  content->size = strtoul(sizestr, NULL, 10);
+  return obj;
+}
 
-  void *obj = (*load)(ar->fp, content->name, content->size);
+// Pass the member in the mapped archive to `load`, without reading it from the file.
+void *load_archive_content_image(Archive *ar, ArSymbol *symbol,
+                                 void *(*load)(const void*, size_t, const char*)) {
+  ArContent *content = symbol->content;
+  if (content->obj != NULL)
+    return content->obj;
+
+  if (ar->image == NULL) {
+    ar->image = map_file(ar->filename, &ar->image_size);
+    if (ar->image == NULL)
+      error("Failed to map archive: %s", ar->filename);
+  }
+
+  if (content->file_offset + sizeof(struct ar_hdr) > ar->image_size)
+    error("Malformed archive");
+  const unsigned char *p = ar->image + content->file_offset;
+  read_content_header(content, (const struct ar_hdr*)p);
+  p += sizeof(struct ar_hdr);
+  if (content->size > (size_t)(ar->image + ar->image_size - p))
+    error("Malformed archive");
+
+  void *obj = (*load)(p, content->size, content->name);
   if (obj == NULL) {
     error("Failed to extract .o: %.*s", (int)sizeof(content->name), content->name);
   }
@@ -20,6 +20,9 @@ typedef struct {
 
 typedef struct {
   FILE *fp;
+  const char *filename;
+  const unsigned char *image;  // Whole archive mapped on demand by `load_archive_content_image`.
+  size_t image_size;
   uint32_t symbol_count;
   ArSymbol *symbols;
   Table symbol_table;
@@ -29,6 +32,8 @@ typedef struct {
 Archive *load_archive(const char *filename);
 void *load_archive_content(Archive *ar, ArSymbol *symbol,
                            void *(*load)(FILE*, const char*, size_t));
+void *load_archive_content_image(Archive *ar, ArSymbol *symbol,
+                                 void *(*load)(const void*, size_t, const char*));
 
 #define FOREACH_FILE_ARCONTENT(ar, content, body) \
   {Vector *contents = (ar)->contents; \
@@ -8,6 +8,12 @@
 #include <string.h>  // strcmp
 #include <sys/stat.h>
 
+#if !defined(__WASM)
+#include <fcntl.h>  // open
+#include <sys/mman.h>
+#include <unistd.h>  // close
+#endif
+
 #include "../version.h"
 #include "table.h"
 
@@ -67,6 +73,43 @@ void *read_or_die(FILE *fp, void *buf, long offset, size_t size, const char *msg
   return buf;
 }
 
+// Map whole file read-only into memory, or read it into a heap buffer when mmap is unavailable.
+// The image is never released; returns NULL on failure.
+void *map_file(const char *path, size_t *psize) {
+#if !defined(__WASM)
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return NULL;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    close(fd);
+    return NULL;
+  }
+  size_t size = st.st_size;
+  void *image = NULL;
+  if (size > 0) {
+    image = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (image == MAP_FAILED)
+      image = NULL;
+  } else {
+    image = malloc_or_die(1);  // Dummy, not to be NULL.
+  }
+  close(fd);
+  if (image == NULL)
+    return NULL;
+#else
+  FILE *fp = fopen(path, "rb");
+  if (fp == NULL)
+    return NULL;
+  fseek(fp, 0, SEEK_END);
+  size_t size = ftell(fp);
+  void *image = read_or_die(fp, NULL, 0, size, "read failed");
+  fclose(fp);
+#endif
+  *psize = size;
+  return image;
+}
+
 void *malloc_or_die(size_t size) {
   void *p = malloc(size);
   if (p == NULL) {
@@ -29,6 +29,7 @@ int xvalue(char c);
 bool starts_with(const char *str, const char *prefix);
 int most_significant_bit(size_t x);
 void *read_or_die(FILE *fp, void *buf, long offset, size_t size, const char *msg);
+void *map_file(const char *path, size_t *psize);
 void *malloc_or_die(size_t size);
 void *calloc_or_die(size_t size);  // No `count` argument.
 void *realloc_or_die(void *ptr, size_t size);
@@ -194,7 +194,7 @@ static Vector *construct_data_segment(void) {  // <DataSegment*>
 
       DataSegment *segment = calloc_or_die(sizeof(*segment));
       segment->gvarinfo = info;
-      size_t align = align_size(varinfo->type);
+      size_t align = MAX(align_size(varinfo->type), varinfo->global.align);
       uint32_t p2align;
       for (p2align = 0; align > (1U << p2align); ++p2align)
         ;
@@ -13,6 +13,7 @@
 #endif
 
 #include "ast.h"
+#include "cc_misc.h"  // cluster_switch_cases
 #include "fe_misc.h"  // curfunc
 #include "parser.h"
 #include "table.h"
@@ -117,6 +118,50 @@ static void gen_store(const Type *type) {
   }
 }
 
+// Returns SIMD instruction for the element-wise vector operation, or -1 if not available.
+int get_simd_opcode(Expr *expr) {
+  enum ExprKind kind = expr->kind;
+  const Type *type = expr->type;
+  if (!is_vector(type) || type_size(type) != 16)
+    return -1;
+  const Type *elem_type = type->struct_.info->members[0].type;
+  int size = type_size(elem_type);
+  int index = size == 1 ? 0 : size == 2 ? 1 : size == 4 ? 2 : 3;
+  if (elem_type->kind == TY_FLONUM) {
+    static const int kFloatOps[][2] = {
+      [EX_ADD] = {OPSIMD_F32X4_ADD, OPSIMD_F64X2_ADD},
+      [EX_SUB] = {OPSIMD_F32X4_SUB, OPSIMD_F64X2_SUB},
+      [EX_MUL] = {OPSIMD_F32X4_MUL, OPSIMD_F64X2_MUL},
+      [EX_DIV] = {OPSIMD_F32X4_DIV, OPSIMD_F64X2_DIV},
+    };
+    if (kind < EX_ADD || kind > EX_DIV)
+      return -1;
+    return kFloatOps[kind][index - 2];
+  }
+
+  switch (kind) {
+  case EX_ADD:
+    {
+      static const int kOps[] = {OPSIMD_I8X16_ADD, OPSIMD_I16X8_ADD, OPSIMD_I32X4_ADD, OPSIMD_I64X2_ADD};
+      return kOps[index];
+    }
+  case EX_SUB:
+    {
+      static const int kOps[] = {OPSIMD_I8X16_SUB, OPSIMD_I16X8_SUB, OPSIMD_I32X4_SUB, OPSIMD_I64X2_SUB};
+      return kOps[index];
+    }
+  case EX_MUL:
+    {
+      static const int kOps[] = {-1, OPSIMD_I16X8_MUL, OPSIMD_I32X4_MUL, OPSIMD_I64X2_MUL};
+      return kOps[index];
+    }
+  case EX_BITAND:  return OPSIMD_V128_AND;
+  case EX_BITOR:   return OPSIMD_V128_OR;
+  case EX_BITXOR:  return OPSIMD_V128_XOR;
+  default:  return -1;
+  }
+}
+
 static void gen_arith(enum ExprKind kind, const Type *type) {
   assert(is_number(type) || ptr_or_array(type));
   int index = 0;
@@ -244,20 +289,36 @@ static void gen_cast_to(const Type *dst, Type *src) {
     }
     break;
   case TY_STRUCT:
-    assert(same_type_without_qualifier(dst, src, true));
+    assert(same_type_without_qualifier(dst, src, true) || (is_vector(dst) && is_vector(src)));
     return;
   default: break;
   }
   assert(!"Cast not handled");
 }
 
+// Whether the expression can be evaluated unconditionally.
+static bool is_select_operand(Expr *expr, unsigned char wt) {
+  return (is_const(expr) || expr->kind == EX_VAR) && is_number(expr->type) &&
+         to_wtype(expr->type) == wt;
+}
+
 static void gen_ternary(Expr *expr, bool needval) {
-  gen_cond(expr->ternary.cond, true, true);
   unsigned char wt = WT_VOID;
   if (needval && expr->type->kind != TY_VOID) {
     Type *type = expr->type;
     wt = to_wtype((is_number(type) || ptr_or_array(type)) ? type : ptrof(type));
   }
+  if (wt != WT_VOID && is_number(expr->type) && is_select_operand(expr->ternary.tval, wt) &&
+      is_select_operand(expr->ternary.fval, wt)) {
+    // Branchless.
+    gen_expr(expr->ternary.tval, true);
+    gen_expr(expr->ternary.fval, true);
+    gen_cond(expr->ternary.cond, true, true);
+    ADD_CODE(OP_SELECT);
+    return;
+  }
+
+  gen_cond(expr->ternary.cond, true, true);
   ADD_CODE(OP_IF, wt);
   ++cur_depth;
   gen_expr(expr->ternary.tval, wt != WT_VOID);
@@ -668,7 +729,35 @@ static void gen_str(Expr *expr, bool needval) {
   assert(false);
 }
 
+// Vector operation is modified to `lhs @= rhs` in traverse, and lhs is a variable.
+static void gen_vector_bop(Expr *expr, bool needval) {
+  Expr *lhs = expr->bop.lhs;
+  assert(lhs->kind == EX_VAR);
+  int op = get_simd_opcode(expr);
+  assert(op >= 0);
+  gen_expr(lhs, true);  // Destination address.
+  gen_expr(lhs, true);
+  ADD_CODE(OP_SIMD);
+  ADD_ULEB128(OPSIMD_V128_LOAD);
+  ADD_CODE(4, 0);
+  gen_expr(expr->bop.rhs, true);
+  ADD_CODE(OP_SIMD);
+  ADD_ULEB128(OPSIMD_V128_LOAD);
+  ADD_CODE(4, 0);
+  ADD_CODE(OP_SIMD);
+  ADD_ULEB128(op);
+  ADD_CODE(OP_SIMD);
+  ADD_ULEB128(OPSIMD_V128_STORE);
+  ADD_CODE(4, 0);
+  if (needval)
+    gen_expr(lhs, true);
+}
+
 static void gen_bop(Expr *expr, bool needval) {
+  if (is_vector(expr->type)) {
+    gen_vector_bop(expr, needval);
+    return;
+  }
   gen_expr(expr->bop.lhs, needval);
   gen_expr(expr->bop.rhs, needval);
   if (needval)
@@ -1098,42 +1187,95 @@ static void gen_cond_jmp(Expr *cond, bool tf, uint32_t depth) {
   ADD_ULEB128(depth);
 }
 
-static void gen_switch_table_jump(Stmt *stmt, Expr *value, Fixnum min, Fixnum max,
-                                  int default_index) {
-  Vector *cases = stmt->switch_.cases;
-  int case_count = cases->len;
+static void gen_switch_const(Fixnum value, bool is_i64) {
+  ADD_CODE(is_i64 ? OP_I64_CONST : OP_I32_CONST);
+  ADD_LEB128(is_i64 ? value : (int32_t)value);
+}
 
+// Push `value - min`.
+static void gen_switch_offset(Expr *value, Fixnum min, bool is_i64) {
+  gen_expr(value, true);
+  if (min != 0) {
+    gen_switch_const(min, is_i64);
+    ADD_CODE(is_i64 ? OP_I64_SUB : OP_I32_SUB);
+  }
+}
+
+// Cases are tested in a block: out of the range breaks it and goes to the next cluster.
+static void gen_switch_table_jump(Expr *value, const SwitchCase *cases, int len,
+                                  int default_index, bool is_i64) {
+  Fixnum min = cases[0].value;
+  Fixnum max = cases[len - 1].value;
   unsigned int vrange = max - min + 1;
   bool use_alloca = vrange <= 64;
   int *table = use_alloca ? alloca(sizeof(*table) * vrange)
                           : malloc_or_die(sizeof(*table) * vrange);
   for (unsigned int i = 0; i < vrange; ++i)
-    table[i] = default_index;
-  for (int i = 0; i < case_count; ++i) {
-    Stmt *c = cases->data[i];
-    if (c->case_.value != NULL)
-      table[c->case_.value->fixnum - min] = i;
-  }
+    table[i] = default_index + 1;
+  for (int i = 0; i < len; ++i)
+    table[cases[i].value - min] = cases[i].index + 1;
 
-  gen_expr(value, true);
-  bool is_i64 = type_size(value->type) > I32_SIZE;
-  if (min != 0) {
-    ADD_CODE(is_i64 ? OP_I64_CONST : OP_I32_CONST);
-    ADD_LEB128(min);
-    ADD_CODE(is_i64 ? OP_I64_SUB : OP_I32_SUB);
+  ADD_CODE(OP_BLOCK, WT_VOID);
+  if (is_i64) {
+    // br_table takes i32, so check the range beforehand.
+    gen_switch_offset(value, min, is_i64);
+    gen_switch_const(max - min, is_i64);
+    ADD_CODE(OP_I64_GT_U, OP_BR_IF, 0);
   }
+  gen_switch_offset(value, min, is_i64);
   if (is_i64)
     ADD_CODE(OP_I32_WRAP_I64);
   ADD_CODE(OP_BR_TABLE);
   ADD_ULEB128(vrange);
   for (unsigned int i = 0; i < vrange; ++i)
     ADD_ULEB128(table[i]);
-  ADD_ULEB128(default_index);
+  ADD_ULEB128(0);  // Out of range.
+  ADD_CODE(OP_END);
 
   if (!use_alloca)
     free(table);
 }
 
+static void gen_switch_bit_test(Expr *value, const SwitchCase *cases, int len,
+                                int default_index, bool is_i64) {
+  Fixnum min = cases[0].value;
+  Fixnum max = cases[len - 1].value;
+
+  ADD_CODE(OP_BLOCK, WT_VOID);
+  gen_switch_offset(value, min, is_i64);
+  gen_switch_const(max - min, is_i64);
+  ADD_CODE(is_i64 ? OP_I64_GT_U : OP_I32_GT_U, OP_BR_IF, 0);
+
+  // Test the mask for each target, in order of appearance.
+  for (int i = 0; i < len; ++i) {
+    Stmt *target = cases[i].target;
+    int j;
+    for (j = 0; j < i; ++j) {
+      if (cases[j].target == target)
+        break;
+    }
+    if (j < i)
+      continue;  // Already tested.
+
+    UFixnum mask = 0;
+    for (j = i; j < len; ++j) {
+      if (cases[j].target == target)
+        mask |= (UFixnum)1 << (cases[j].value - min);
+    }
+    ADD_CODE(OP_I64_CONST, 1);
+    gen_switch_offset(value, min, is_i64);
+    if (!is_i64)
+      ADD_CODE(OP_I64_EXTEND_I32_U);
+    ADD_CODE(OP_I64_SHL, OP_I64_CONST);
+    ADD_LEB128(mask);
+    ADD_CODE(OP_I64_AND, OP_I64_CONST, 0, OP_I64_NE, OP_BR_IF);
+    ADD_ULEB128(cases[i].index + 1);
+  }
+  ADD_CODE(OP_BR);
+  ADD_ULEB128(default_index + 1);
+  ADD_CODE(OP_END);
+}
+
 static void gen_switch(Stmt *stmt) {
   int save_depth = break_depth;
   break_depth = cur_depth;
@@ -1155,43 +1297,41 @@ static void gen_switch(Stmt *stmt) {
   assert(is_fixnum(value->type->kind));
 
   int default_index = case_count;
-  Fixnum min = INTPTR_MAX;
-  Fixnum max = INTPTR_MIN;
   for (int i = 0; i < case_count; ++i) {
     Stmt *c = cases->data[i];
-    if (c->case_.value == NULL) {
+    if (c->case_.value == NULL)
       default_index = i;
-      continue;
-    }
-    Fixnum v = c->case_.value->fixnum;
-    if (v < min)
-      min = v;
-    if (v > max)
-      max = v;
   }
 
-  if (case_count >= 4 && (max - min) / 2 <= case_count) {
-    gen_switch_table_jump(stmt, value, min, max, default_index);
-  } else {
-    bool is_i64 = type_size(value->type) > I32_SIZE;
-    unsigned char op_const = is_i64 ? OP_I64_CONST : OP_I32_CONST;
-    unsigned char op_eq = is_i64 ? OP_I64_EQ : OP_I32_EQ;
-    for (int i = 0; i < case_count; ++i) {
-      Stmt *c = cases->data[i];
-      if (c->case_.value == NULL) {  // default.
-        default_index = i;
-        continue;
-      }
+  // Clusters are tested in order, and not matched value goes to default.
+  bool is_i64 = type_size(value->type) > I32_SIZE;
+  int len;
+  SwitchCase *sorted = sort_switch_cases(stmt, is_unsigned(value->type), &len);
+  SwitchCluster *clusters = malloc_or_die(sizeof(*clusters) * (len + 1));
+  int cluster_count = cluster_switch_cases(sorted, len, 64, clusters);
+  for (int i = 0; i < cluster_count; ++i) {
+    const SwitchCluster *cluster = &clusters[i];
+    const SwitchCase *p = &sorted[cluster->start];
+    switch (cluster->kind) {
+    case SC_CASE:
       gen_expr(value, true);
-      ADD_CODE(op_const);
-      ADD_LEB128(c->case_.value->fixnum);
-      ADD_CODE(op_eq, OP_BR_IF);
-      ADD_ULEB128(i);
+      gen_switch_const(p->value, is_i64);
+      ADD_CODE(is_i64 ? OP_I64_EQ : OP_I32_EQ, OP_BR_IF);
+      ADD_ULEB128(p->index);
+      break;
+    case SC_JUMP_TABLE:
+      gen_switch_table_jump(value, p, cluster->count, default_index, is_i64);
+      break;
+    case SC_BIT_TEST:
+      gen_switch_bit_test(value, p, cluster->count, default_index, is_i64);
+      break;
     }
-    // Jump to default.
-    ADD_CODE(OP_BR);
-    ADD_ULEB128(default_index);
   }
+  free(clusters);
+  free(sorted);
+  // Jump to default.
+  ADD_CODE(OP_BR);
+  ADD_ULEB128(default_index);
 
   // Body.
   gen_stmt(stmt->switch_.body, false);
@@ -2060,6 +2200,123 @@ static void gen_builtin_memory_grow(Expr *expr, enum BuiltinFunctionPhase phase)
   ADD_CODE(OP_MEMORY_GROW, 0x00);
 }
 
+static void gen_builtin_expect(Expr *expr, enum BuiltinFunctionPhase phase) {
+  if (phase != BFP_GEN)
+    return;
+
+  assert(expr->kind == EX_FUNCALL);
+  Vector *args = expr->funcall.args;
+  assert(args->len == 2);
+  gen_expr(args->data[0], true);
+  gen_expr(args->data[1], false);
+}
+
+static void gen_builtin_unreachable(Expr *expr, enum BuiltinFunctionPhase phase) {
+  if (phase != BFP_GEN)
+    return;
+
+  assert(expr->kind == EX_FUNCALL);
+  ADD_CODE(OP_UNREACHABLE);
+}
+
+static void gen_builtin_prefetch(Expr *expr, enum BuiltinFunctionPhase phase) {
+  if (phase != BFP_GEN)
+    return;
+
+  // No prefetch instruction in wasm: just evaluate arguments for their side effects.
+  assert(expr->kind == EX_FUNCALL);
+  Vector *args = expr->funcall.args;
+  for (int i = 0; i < args->len; ++i)
+    gen_expr(args->data[i], false);
+}
+
+static void gen_builtin_assume_aligned(Expr *expr, enum BuiltinFunctionPhase phase) {
+  if (phase != BFP_GEN)
+    return;
+
+  assert(expr->kind == EX_FUNCALL);
+  Vector *args = expr->funcall.args;
+  assert(args->len >= 2);
+  gen_expr(args->data[0], true);
+  for (int i = 1; i < args->len; ++i)
+    gen_expr(args->data[i], false);
+}
+
+static void gen_bit_count(Expr *expr, unsigned char op32, unsigned char op64) {
+  assert(expr->kind == EX_FUNCALL);
+  Vector *args = expr->funcall.args;
+  assert(args->len == 1);
+  Expr *arg = args->data[0];
+  gen_expr(arg, true);
+  if (type_size(arg->type) <= I32_SIZE) {
+    ADD_CODE(op32);
+  } else {
+    ADD_CODE(op64, OP_I32_WRAP_I64);
+  }
+}
+
+static void gen_builtin_popcount(Expr *expr, enum BuiltinFunctionPhase phase) {
+  if (phase == BFP_GEN)
+    gen_bit_count(expr, OP_I32_POPCNT, OP_I64_POPCNT);
+}
+
+static void gen_builtin_clz(Expr *expr, enum BuiltinFunctionPhase phase) {
+  if (phase == BFP_GEN)
+    gen_bit_count(expr, OP_I32_CLZ, OP_I64_CLZ);
+}
+
+static void gen_builtin_ctz(Expr *expr, enum BuiltinFunctionPhase phase) {
+  if (phase == BFP_GEN)
+    gen_bit_count(expr, OP_I32_CTZ, OP_I64_CTZ);
+}
+
+// Wasm has no byte swap instruction, so expand it into shifts and masks:
+//   (t = x, ((t >> 0) & 0xff) << 24 | ((t >> 8) & 0xff) << 16 | ...)
+static Expr *proc_builtin_bswap(const Token *ident, int size) {
+  consume(TK_LPAR, "`(' expected");
+
+  Token *token;
+  Vector *args = parse_args(&token);
+  if (args->len != 1) {
+    parse_error(PE_FATAL, token, "one argument expected");
+    return NULL;
+  }
+
+  Type *type = get_fixnum_type(size == 2 ? FX_SHORT : size == 4 ? FX_INT : FX_LLONG, true, 0);
+  Type *optype = size <= I32_SIZE ? &tyUnsignedInt : type;
+  Expr *arg = args->data[0];
+  if (!is_fixnum(arg->type->kind))
+    parse_error(PE_FATAL, arg->token, "int type expected");
+  arg = make_cast(optype, arg->token, make_cast(type, arg->token, arg, false), false);
+
+  Expr *assign = NULL;
+  if (!is_const(arg) && arg->kind != EX_VAR) {
+    Expr *tmp = alloc_tmp_var(curscope, optype);
+    assign = new_expr_bop(EX_ASSIGN, &tyVoid, ident, tmp, arg);
+    arg = tmp;
+  }
+
+  Expr *result = NULL;
+  for (int i = 0; i < size; ++i) {
+    Expr *term = arg;
+    if (i > 0)
+      term = new_expr_bop(EX_RSHIFT, optype, ident, term, new_expr_fixlit(optype, ident, i * 8));
+    term = new_expr_int_bop(EX_BITAND, ident, term, new_expr_fixlit(optype, ident, 0xff));
+    int shift = (size - 1 - i) * 8;
+    if (shift > 0)
+      term = new_expr_bop(EX_LSHIFT, optype, ident, term, new_expr_fixlit(optype, ident, shift));
+    result = result == NULL ? term : new_expr_int_bop(EX_BITOR, ident, result, term);
+  }
+  result = make_cast(type, ident, result, false);
+  if (assign != NULL)
+    result = new_expr_bop(EX_COMMA, type, ident, assign, result);
+  return result;
+}
+
+static Expr *proc_builtin_bswap16(const Token *ident) { return proc_builtin_bswap(ident, 2); }
+static Expr *proc_builtin_bswap32(const Token *ident) { return proc_builtin_bswap(ident, 4); }
+static Expr *proc_builtin_bswap64(const Token *ident) { return proc_builtin_bswap(ident, 8); }
+
 void install_builtins(void) {
   // __builtin_va_list
   {
@@ -2140,4 +2397,65 @@ void install_builtins(void) {
 
     add_builtin_function("__builtin_try_catch_longjmp", type, &p_try_catch_longjmp, true);
   }
+  {
+    static BuiltinFunctionProc p_expect = &gen_builtin_expect;
+    Type *tyLong = get_fixnum_type(FX_LONG, false, 0);
+    Vector *params = new_vector();
+    vec_push(params, tyLong);
+    vec_push(params, tyLong);
+    add_builtin_function("__builtin_expect", new_func_type(tyLong, params, false), &p_expect, true);
+  }
+  {
+    static BuiltinFunctionProc p_unreachable = &gen_builtin_unreachable;
+    add_builtin_function("__builtin_unreachable", new_func_type(&tyVoid, new_vector(), false),
+                         &p_unreachable, true);
+  }
+  {
+    static BuiltinFunctionProc p_prefetch = &gen_builtin_prefetch;
+    Vector *params = new_vector();
+    vec_push(params, &tyVoidPtr);
+    add_builtin_function("__builtin_prefetch", new_func_type(&tyVoid, params, true), &p_prefetch,
+                         true);
+  }
+  {
+    static BuiltinFunctionProc p_assume_aligned = &gen_builtin_assume_aligned;
+    Vector *params = new_vector();
+    vec_push(params, &tyVoidPtr);
+    vec_push(params, &tySize);
+    add_builtin_function("__builtin_assume_aligned", new_func_type(&tyVoidPtr, params, true),
+                         &p_assume_aligned, true);
+  }
+  {
+    static BuiltinFunctionProc p_popcount = &gen_builtin_popcount;
+    static BuiltinFunctionProc p_clz = &gen_builtin_clz;
+    static BuiltinFunctionProc p_ctz = &gen_builtin_ctz;
+    static const struct {
+      const char *name;
+      BuiltinFunctionProc *proc;
+      enum FixnumKind kind;
+    } kBitCounts[] = {
+      {"__builtin_popcount", &p_popcount, FX_INT},
+      {"__builtin_popcountl", &p_popcount, FX_LONG},
+      {"__builtin_popcountll", &p_popcount, FX_LLONG},
+      {"__builtin_clz", &p_clz, FX_INT},
+      {"__builtin_clzl", &p_clz, FX_LONG},
+      {"__builtin_clzll", &p_clz, FX_LLONG},
+      {"__builtin_ctz", &p_ctz, FX_INT},
+      {"__builtin_ctzl", &p_ctz, FX_LONG},
+      {"__builtin_ctzll", &p_ctz, FX_LLONG},
+    };
+    for (int i = 0; i < (int)ARRAY_SIZE(kBitCounts); ++i) {
+      Vector *params = new_vector();
+      vec_push(params, get_fixnum_type(kBitCounts[i].kind, true, 0));
+      add_builtin_function(kBitCounts[i].name, new_func_type(&tyInt, params, false),
+                           kBitCounts[i].proc, true);
+    }
+  }
+
+  static BuiltinExprProc p_bswap16 = &proc_builtin_bswap16;
+  static BuiltinExprProc p_bswap32 = &proc_builtin_bswap32;
+  static BuiltinExprProc p_bswap64 = &proc_builtin_bswap64;
+  add_builtin_expr_ident("__builtin_bswap16", &p_bswap16);
+  add_builtin_expr_ident("__builtin_bswap32", &p_bswap32);
+  add_builtin_expr_ident("__builtin_bswap64", &p_bswap64);
 }
@@ -8,6 +8,7 @@
 #include "ast.h"
 #include "fe_misc.h"  // curscope
 #include "lexer.h"
+#include "loop.h"
 #include "table.h"
 #include "type.h"
 #include "util.h"
@@ -338,8 +339,54 @@ static void te_var(Expr **pexpr, bool needval) {
   }
 }
 
+// ((elem*)&var)[index]
+static Expr *vector_lane(Expr *var, int index) {
+  const Token *token = var->token;
+  Type *elem_type = var->type->struct_.info->members[0].type;
+  Expr *ptr = make_cast(ptrof(elem_type), token, make_refer(token, var), true);
+  return new_expr_deref(token, new_expr_addsub(EX_ADD, token, ptr,
+                                               new_expr_fixlit(&tyInt, token, index)));
+}
+
+static void te_vector_bop(Expr **pexpr, bool needval) {
+  Expr *expr = *pexpr;
+  const Token *token = expr->token;
+  Type *type = expr->type;
+  Expr *tmp = alloc_tmp_var(curscope, type);
+  Expr *assign = new_expr_bop(EX_ASSIGN, &tyVoid, token, tmp, expr->bop.lhs);
+  if (get_simd_opcode(expr) >= 0) {
+    // lhs @ rhs  =>  (tmp = lhs, tmp @= rhs)
+    // Keep the original expression intact, because it might be shared with the initializer.
+    Expr *op = new_expr_bop(expr->kind, type, token, tmp, expr->bop.rhs);
+    traverse_expr(&assign, false);
+    traverse_expr(&op->bop.rhs, true);
+    *pexpr = new_expr_bop(EX_COMMA, type, token, assign, op);
+    return;
+  }
+
+  // No SIMD instruction: calculate lane by lane.
+  // lhs @ rhs  =>  (tmp = lhs, tmp2 = rhs, tmp[0] = tmp[0] @ tmp2[0], ..., tmp)
+  Expr *tmp2 = alloc_tmp_var(curscope, type);
+  Expr *replaced = new_expr_bop(EX_COMMA, &tyVoid, token, assign,
+                                new_expr_bop(EX_ASSIGN, &tyVoid, token, tmp2, expr->bop.rhs));
+  const StructInfo *sinfo = type->struct_.info;
+  Type *elem_type = sinfo->members[0].type;
+  for (int i = 0; i < sinfo->member_count; ++i) {
+    Expr *value = new_expr_num_bop(expr->kind, token, vector_lane(tmp, i), vector_lane(tmp2, i));
+    Expr *lane = new_expr_bop(EX_ASSIGN, &tyVoid, token, vector_lane(tmp, i),
+                              make_cast(elem_type, token, value, false));
+    replaced = new_expr_bop(EX_COMMA, &tyVoid, token, replaced, lane);
+  }
+  *pexpr = new_expr_bop(EX_COMMA, type, token, replaced, tmp);
+  traverse_expr(pexpr, needval);
+}
+
 static void te_bop(Expr **pexpr, bool needval) {
   Expr *expr = *pexpr;
+  if (is_vector(expr->type) && expr->kind >= EX_ADD && expr->kind <= EX_BITXOR) {
+    te_vector_bop(pexpr, needval);
+    return;
+  }
   traverse_expr(&expr->bop.lhs, needval);
   traverse_expr(&expr->bop.rhs, needval);
 }
@@ -610,7 +657,19 @@ static void traverse_do_while(Stmt *stmt) {
   traverse_expr(&stmt->while_.cond, true);
 }
 
+static bool is_vectorizable_op(enum ExprKind kind, const Type *type) {
+  Expr expr = {.kind = kind, .type = (Type*)type};
+  return get_simd_opcode(&expr) >= 0;
+}
+
 static void traverse_for(Stmt *stmt) {
+  Stmt *vectorized = vectorize_loop(stmt, is_vectorizable_op);
+  if (vectorized != NULL) {
+    *stmt = *vectorized;
+    traverse_stmt(stmt);
+    return;
+  }
+
   traverse_expr(&stmt->for_.pre, false);
   traverse_expr(&stmt->for_.cond, true);
   traverse_expr(&stmt->for_.post, false);
@@ -1032,7 +1091,7 @@ void traverse_ast(Vector *decls) {
           continue;
 
         // Mapped to memory
-        address = ALIGN(address, align_size(varinfo->type));
+        address = ALIGN(address, MAX(align_size(varinfo->type), varinfo->global.align));
         info->non_prim.address = address;
         size_t size = type_size(varinfo->type);
         address += size;
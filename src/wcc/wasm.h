@@ -112,6 +112,9 @@ typedef struct {
 #define OP_F64_GT         (0x64)
 #define OP_F64_LE         (0x65)
 #define OP_F64_GE         (0x66)
+#define OP_I32_CLZ        (0x67)
+#define OP_I32_CTZ        (0x68)
+#define OP_I32_POPCNT     (0x69)
 #define OP_I32_ADD        (0x6a)
 #define OP_I32_SUB        (0x6b)
 #define OP_I32_MUL        (0x6c)
@@ -125,6 +128,9 @@ typedef struct {
 #define OP_I32_SHL        (0x74)
 #define OP_I32_SHR_S      (0x75)
 #define OP_I32_SHR_U      (0x76)
+#define OP_I64_CLZ        (0x79)
+#define OP_I64_CTZ        (0x7a)
+#define OP_I64_POPCNT     (0x7b)
 #define OP_I64_ADD        (0x7c)
 #define OP_I64_SUB        (0x7d)
 #define OP_I64_MUL        (0x7e)
@@ -178,6 +184,34 @@ typedef struct {
 #define OPEX_MEMORY_COPY  (0x0a)
 #define OPEX_MEMORY_FILL  (0x0b)
 
+#define OP_SIMD           (0xfd)
+
+// 128bit SIMD instructions (prefixed with OP_SIMD, encoded in ULEB128)
+#define OPSIMD_V128_LOAD   (0x00)
+#define OPSIMD_V128_STORE  (0x0b)
+#define OPSIMD_V128_AND    (0x4e)
+#define OPSIMD_V128_OR     (0x50)
+#define OPSIMD_V128_XOR    (0x51)
+#define OPSIMD_I8X16_ADD   (0x6e)
+#define OPSIMD_I8X16_SUB   (0x71)
+#define OPSIMD_I16X8_ADD   (0x8e)
+#define OPSIMD_I16X8_SUB   (0x91)
+#define OPSIMD_I16X8_MUL   (0x95)
+#define OPSIMD_I32X4_ADD   (0xae)
+#define OPSIMD_I32X4_SUB   (0xb1)
+#define OPSIMD_I32X4_MUL   (0xb5)
+#define OPSIMD_I64X2_ADD   (0xce)
+#define OPSIMD_I64X2_SUB   (0xd1)
+#define OPSIMD_I64X2_MUL   (0xd5)
+#define OPSIMD_F32X4_ADD   (0xe4)
+#define OPSIMD_F32X4_SUB   (0xe5)
+#define OPSIMD_F32X4_MUL   (0xe6)
+#define OPSIMD_F32X4_DIV   (0xe7)
+#define OPSIMD_F64X2_ADD   (0xf0)
+#define OPSIMD_F64X2_SUB   (0xf1)
+#define OPSIMD_F64X2_MUL   (0xf2)
+#define OPSIMD_F64X2_DIV   (0xf3)
+
 // Types
 #define WT_VOID           (0x40)
 #define WT_FUNC           (0x60)
@@ -583,7 +583,8 @@ struct File {
   };
 };
 
-static int resolve_symbols_wasmobj(WasmLinker *linker, WasmObj *wasmobj) {
+// Newly unresolved symbols are also pushed onto `queue`, if given.
+static int resolve_symbols_wasmobj(WasmLinker *linker, WasmObj *wasmobj, Vector *queue) {
   int err_count = 0;
   Vector *symtab = wasmobj->linking.symtab;
   for (int i = 0; i < symtab->len; ++i) {
@@ -591,6 +592,8 @@ static int resolve_symbols_wasmobj(WasmLinker *linker, WasmObj *wasmobj) {
     if (sym->flags & WASM_SYM_UNDEFINED) {
       SymbolInfo *prev;
       if (!table_try_get(&linker->defined, sym->name, (void**)&prev) || prev == NULL) {
+        if (queue != NULL && !table_try_get(&linker->unresolved, sym->name, NULL))
+          vec_push(queue, sym->name);
         table_put(&linker->unresolved, sym->name, sym);
       } else if (sym->kind != prev->kind) {
         fprintf(stderr, "different symbol type: %.*s\n", NAMES(sym->name));
@@ -623,27 +626,27 @@ static void *load_wasmobj(FILE *fp, const char *name, size_t size) {
 }
 
 static int resolve_symbols_archive(WasmLinker *linker, Archive *ar) {
+  // Worklist: each unresolved symbol is looked up in the archive exactly once,
+  // and symbols newly referenced by pulled members are appended to the queue.
   Table *unresolved = &linker->unresolved;
+  Vector *queue = new_vector();  // <const Name*>
+  const Name *name;
+  for (int it = 0; (it = table_iterate(unresolved, it, &name, NULL)) != -1;)
+    vec_push(queue, name);
+
   Table *table = &ar->symbol_table;
-  for (;;) {
-    bool retry = false;
-    const Name *name;
-    for (int it = 0; (it = table_iterate(unresolved, it, &name, NULL)) != -1;) {
-      ArSymbol *symbol;
-      if (!table_try_get(table, name, (void**)&symbol))
-        continue;
-      table_delete(unresolved, name);
+  for (int i = 0; i < queue->len; ++i) {
+    name = queue->data[i];
+    ArSymbol *symbol;
+    if (!table_try_get(unresolved, name, NULL) || !table_try_get(table, name, (void**)&symbol))
+      continue;
+    table_delete(unresolved, name);
 
-      WasmObj *wasmobj = load_archive_content(ar, symbol, load_wasmobj);
-      if (wasmobj != NULL) {
-        resolve_symbols_wasmobj(linker, wasmobj);
-        retry = true;
-        break;
-      }
-    }
-    if (!retry)
-      break;
+    WasmObj *wasmobj = load_archive_content(ar, symbol, load_wasmobj);
+    if (wasmobj != NULL)
+      resolve_symbols_wasmobj(linker, wasmobj, queue);
   }
+  free_vector(queue);
   return 0;
 }
 
@@ -693,7 +696,7 @@ static void resolve_symbols_auto_fill(WasmLinker *linker) {
   }
 
   if (obj != NULL) {
-    int err_count = resolve_symbols_wasmobj(linker, obj);
+    int err_count = resolve_symbols_wasmobj(linker, obj, NULL);
     UNUSED(err_count);
     assert(err_count == 0);
   }
@@ -707,7 +710,7 @@ static bool resolve_symbols(WasmLinker *linker) {
     File *file = linker->files->data[i];
     switch (file->kind) {
     case FK_WASMOBJ:
-      err_count += resolve_symbols_wasmobj(linker, file->wasmobj);
+      err_count += resolve_symbols_wasmobj(linker, file->wasmobj, NULL);
       break;
     case FK_ARCHIVE:
       err_count += resolve_symbols_archive(linker, file->archive);
@@ -89,6 +89,7 @@ void modify_ast_for_setjmp(int n);
 void gen(Vector *decls);
 void gen_expr(Expr *expr, bool needval);
 void gen_expr_stmt(Expr *expr);
+int get_simd_opcode(Expr *expr);
 
 enum BuiltinFunctionPhase {
   BFP_TRAVERSE,
@@ -305,6 +305,7 @@ static void parse_options(int argc, char *argv[], Options *opts) {
     OPT_NO_PIE,
 
     OPT_SSA,
+    OPT_DUMP_FRAME_SIZE,
   };
 
   static const struct option kOptions[] = {
@@ -345,6 +346,9 @@ static void parse_options(int argc, char *argv[], Options *opts) {
     // Feature flag.
     {"-apply-ssa", no_argument, OPT_SSA},
 
+    // Debug flag.
+    {"-dump-frame-size", no_argument, OPT_DUMP_FRAME_SIZE},
+
     {NULL},
   };
 
@@ -510,6 +514,7 @@ static void parse_options(int argc, char *argv[], Options *opts) {
       break;
 
     case OPT_SSA:
+    case OPT_DUMP_FRAME_SIZE:
       vec_push(opts->cc1_cmd, argv[optind - 1]);
       break;
     }
@@ -21,6 +21,10 @@ double mix_many_params(int n, int i1, double d1, int i2, double d2, int i3, doub
                        double d4, int i5, double d5, int i6, double d6) {
   return i1 * d1 + i2 * d2 + i3 * d3 + i4 * d4 + i5 * d5 + i6 * d6;
 }
+
+double mix_square(double x) {
+  return x * x;
+}
 #endif
 
 #include "flotest.inc"
@@ -43,6 +47,15 @@ TEST(mix) {
     snprintf(buf, sizeof(buf), "%" PRIx64, x);
     EXPECT_STREQ("ulltof", "f123456789012000", buf);
   }
+
+  {
+    double s = 0, t = 1;
+    for (int i = 1; i <= 10; ++i) {
+      s += mix_square(i);
+      t *= 1.5;
+    }
+    EXPECT_NEAR(385.0 + 57.6650390625, s + t);
+  }
 #endif
 }
 
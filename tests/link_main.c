@@ -14,6 +14,13 @@ extern void store_common(int x);
 #ifndef __NO_FLONUM
 extern double many_fargs(double a, double b, double c, double d, double e, double f, double g,
                          double h, double i);
+
+typedef double v2df __attribute__((vector_size(16)));
+typedef int v4si __attribute__((vector_size(16)));
+extern v4si vector_madd(int k, v4si a, double d, v4si b);
+extern double vector_callback(v2df v);
+
+v2df vector_scale(double k, v2df v) { return v * (v2df){k, k}; }
 #endif
 
 int export_var = 9876;
@@ -27,6 +34,11 @@ TEST(all) {
   expecti64("common_var", 4567, (store_common(4567), common_var));
 #ifndef __NO_FLONUM
   expectf64("many_dargs", 17.0, many_fargs(1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0));
+  {
+    v4si r = vector_madd(3, (v4si){1, 2, 3, 4}, 5.5, (v4si){10, 20, 30, 40});
+    expecti64("vector args", 135, r[0] + r[1] + r[2] + r[3]);
+    expectf64("vector callback", 21.0, vector_callback((v2df){2.5, 4.5}));
+  }
 #endif
 }
 
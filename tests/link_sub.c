@@ -24,3 +24,19 @@ double many_fargs(double a, double b, double c, double d, double e, double f, do
   return h + i;
 }
 #endif
+
+#ifndef __NO_FLONUM
+typedef double v2df __attribute__((vector_size(16)));
+typedef int v4si __attribute__((vector_size(16)));
+
+extern v2df vector_scale(double k, v2df v);
+
+v4si vector_madd(int k, v4si a, double d, v4si b) {
+  return a * k + b + (v4si){0, 0, 0, (int)d};
+}
+
+double vector_callback(v2df v) {
+  v2df r = vector_scale(3.0, v);
+  return r[0] + r[1];
+}
+#endif
@@ -139,6 +139,56 @@ link_error() {
   end_test "$err"
 }
 
+link_same() {
+  local title="$1"
+  local opt1="$2"
+  local opt2="$3"
+  shift 3
+  local input="$@"
+
+  begin_test "${title}"
+
+  if [[ -n "$RE_SKIP" ]]; then
+    echo -n "$title" | grep "$RE_SKIP" > /dev/null && {
+      end_test
+      return
+    };
+  fi
+
+  eval "$XCC" -o "${AOUT}.1" -Werror ${opt1} ${input} "$SILENT" &&
+      eval "$XCC" -o "${AOUT}.2" -Werror ${opt2} ${input} "$SILENT" || {
+    end_test 'Compile failed'
+    rm -f "${AOUT}.1" "${AOUT}.2"
+    return
+  }
+
+  local err=''; cmp -s "${AOUT}.1" "${AOUT}.2" || err="outputs differ"
+  rm -f "${AOUT}.1" "${AOUT}.2"
+  end_test "$err"
+}
+
+output_match() {
+  local title="$1"
+  local expected="$2"
+  local pattern="$3"
+  shift 3
+  local input="$@"
+
+  begin_test "${title}"
+
+  if [[ -n "$RE_SKIP" ]]; then
+    echo -n "$title" | grep "$RE_SKIP" > /dev/null && {
+      end_test
+      return
+    };
+  fi
+
+  local actual
+  actual=$(eval "$XCC" -Werror ${input} 2> /dev/null | grep -c -E "$pattern")
+  local err=''; [[ "$actual" == "$expected" ]] || err="${expected} lines expected, but ${actual}"
+  end_test "$err"
+}
+
 test_basic() {
   begin_test_suite "Basic"
 
@@ -404,6 +454,78 @@ test_link() {
   link_success 'weak function can be overridden' -DANS=22 tmp_link_weak1.c tmp_link_weak2.c
   link_success 'first weak function alive'       -DANS=11 tmp_link_weak1.c tmp_link_weak3.c
 
+  # Unreachable sections are removed.
+  echo 'int unused(void) {return 1;} int unused_data = 2; static int sq(int x) {return x * x;} int (*fp)(int) = sq; int bss;' > tmp_link_gc1.c
+  echo 'extern int (*fp)(int); extern int bss; int main(void){return !(fp(7) + bss == 49);}' > tmp_link_gc2.c
+  link_success 'gc-sections' -ffunction-sections -fdata-sections -Wl,--gc-sections tmp_link_gc1.c tmp_link_gc2.c
+  output_match 'unreferenced kept w/o gc //-WCC' 2 ' G unused' -o "$AOUT" -ffunction-sections -fdata-sections -Wl,-Map=- tmp_link_gc1.c tmp_link_gc2.c
+  output_match 'unreferenced discarded //-WCC'  0 ' G unused' -o "$AOUT" -ffunction-sections -fdata-sections -Wl,--gc-sections -Wl,-Map=- tmp_link_gc1.c tmp_link_gc2.c
+  link_success 'parallel output' -Wl,--threads=4 tmp_link_gc1.c tmp_link_gc2.c
+  link_same 'parallel output is same //-WCC' -Wl,--threads=1 -Wl,--threads=4 tmp_link_gc1.c tmp_link_gc2.c
+
+  # Identical functions are folded, unless their addresses are taken.
+  echo 'int add1(int x) {return x + 1;} int inc(int x) {return x + 1;} int add2(int x) {return x + 1;} int (*fp)(int) = add2;' > tmp_link_icf1.c
+  echo 'int add1(int), inc(int), add2(int); extern int (*fp)(int); int main(void){return !(add1(1) + inc(2) == 5 && fp(3) == 4);}' > tmp_link_icf2.c
+  link_success 'icf' -ffunction-sections -Wl,--icf=safe tmp_link_icf1.c tmp_link_icf2.c
+  output_match 'icf folds //-WCC' 1 '=>  \.text' -o "$AOUT" -ffunction-sections -Wl,--icf=safe -Wl,-Map=- tmp_link_icf1.c tmp_link_icf2.c
+  echo 'void *f(void){return (void*)f;} void *g(void){return (void*)g;}' > tmp_link_icf3.c
+  echo 'void *f(void), *g(void); int main(void){return !(f() != g());}' > tmp_link_icf4.c
+  link_success 'icf keeps self address' -ffunction-sections -Wl,--icf=safe tmp_link_icf3.c tmp_link_icf4.c
+  output_match 'icf no fold //-WCC' 0 '=>  \.text' -o "$AOUT" -ffunction-sections -Wl,--icf=safe -Wl,-Map=- tmp_link_icf3.c tmp_link_icf4.c
+
+  # Locals are addressed relative to stack pointer.
+  echo 'struct S {long a[6];}; int sum(struct S s, int n) { int buf[4] = {n, n, n, n}; return n <= 0 ? (int)s.a[5] : buf[3] + sum(s, n - 1); } int main(void){struct S s = {{0, 0, 0, 0, 0, 5}}; return !(sum(s, 3) == 11);}' > tmp_link_omitfp.c
+  link_success 'omit frame pointer' -fomit-frame-pointer tmp_link_omitfp.c
+
+  end_test_suite
+}
+
+test_optimize() {
+  begin_test_suite "Optimize"
+
+  # Loops are unrolled: fully for a constant trip count, otherwise by 4 plus a remainder loop.
+  echo 'void callee(int); void f(void){for (int i = 0; i < 4; ++i) callee(i);}' > tmp_unroll_full.c
+  echo 'void callee(int); void f(int n){for (int i = 0; i < n; ++i) callee(i);}' > tmp_unroll_partial.c
+  output_match 'no unroll at -O0 //-WCC'  1 callee -S -o - -O0 tmp_unroll_full.c
+  output_match 'full unroll //-WCC'       4 callee -S -o - -O2 tmp_unroll_full.c
+  output_match 'partial unroll //-WCC'    5 callee -S -o - -O2 tmp_unroll_partial.c
+
+  local vadd='' ujmp='' stk=''
+  case "$(echo -e '#if defined(__x86_64__)\nx64\n#elif defined(__aarch64__)\naarch64\n#elif defined(__riscv)\nriscv64\n#endif' |
+          eval "$XCC" -E -xc - 2> /dev/null | grep -E '^[a-z]')" in
+  x64)      vadd='paddd'; ujmp='^[[:space:]]+jmp[[:space:]]'; stk='%rsp' ;;
+  aarch64)  vadd='add[[:space:]]+v[0-9]+\.4s'; ujmp='^[[:space:]]+b[[:space:]]'; stk='[^a-z]sp[^a-z]' ;;
+  riscv64)  ujmp='^[[:space:]]+j[[:space:]]'; stk='[^a-z]sp[^a-z]' ;;
+  esac
+
+  # Builtins expanded inline make no call: the function stays a leaf without a stack frame.
+  if [[ -n "$stk" ]]; then
+    echo 'int f(unsigned x, int *p){ if (__builtin_expect(x > 3, 0)) *p = 1; return __builtin_popcount(x); }' > tmp_leaf_builtin.c
+    output_match 'builtins keep leaf //-WCC' 0 "$stk" -S -o - -O2 tmp_leaf_builtin.c
+  fi
+
+  # Unlikely blocks are placed after the epilogue: the likely path has no jump over them,
+  # and a block ending with a noreturn call needs no jump either.
+  if [[ -n "$ujmp" ]]; then
+    echo '_Noreturn void exit(int); int f(int x){ if (x < 0) exit(1); return x * 2; }' > tmp_cold_block.c
+    output_match 'cold block after epilogue //-WCC' 0 "$ujmp" -S -o - -O2 tmp_cold_block.c
+  fi
+
+  # Loops are vectorized at -O2, except reductions and small constant trip counts.
+  if [[ -n "$vadd" ]]; then
+    echo 'void f(int *a, const int *b, int n){for (int i = 0; i < n; ++i) a[i] = a[i] + b[i];}' > tmp_vec_add.c
+    echo 'int f(const int *a, int n){int s = 0; for (int i = 0; i < n; ++i) s = s + a[i]; return s;}' > tmp_vec_sum.c
+    echo 'void f(int *a, const int *b){for (int i = 0; i < 4; ++i) a[i] = a[i] + b[i];}' > tmp_vec_const.c
+    output_match 'no vectorize at -O0 //-WCC'              0 "$vadd" -S -o - -O0 tmp_vec_add.c
+    output_match 'vectorize //-WCC'                        1 "$vadd" -S -o - -O2 tmp_vec_add.c
+    output_match 'no vectorize reduction //-WCC'           0 "$vadd" -S -o - -O2 tmp_vec_sum.c
+    output_match 'no vectorize constant trip count //-WCC' 0 "$vadd" -S -o - -O2 tmp_vec_const.c
+
+    # Vector operations are done in registers, without a round trip through the stack.
+    echo 'typedef float v4sf __attribute__((vector_size(16))); v4sf f(v4sf a, v4sf b){ return (a + b) / a; }' > tmp_vec_reg.c
+    output_match 'vector op in registers //-WCC' 0 "$stk" -S -o - -O2 tmp_vec_reg.c
+  fi
+
   end_test_suite
 }
 
@@ -423,6 +545,7 @@ test_function
 test_error
 test_error_line
 test_link
+test_optimize
 test_ssa
 
 if [[ $FAILED_SUITE_COUNT -ne 0 ]]; then
@@ -0,0 +1 @@
+int unused(void) {return 1;} int unused_data = 2; static int sq(int x) {return x * x;} int (*fp)(int) = sq; int bss;
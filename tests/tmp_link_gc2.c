@@ -0,0 +1 @@
+extern int (*fp)(int); extern int bss; int main(void){return !(fp(7) + bss == 49);}
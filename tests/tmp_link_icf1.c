@@ -0,0 +1 @@
+int add1(int x) {return x + 1;} int inc(int x) {return x + 1;} int add2(int x) {return x + 1;} int (*fp)(int) = add2;
@@ -0,0 +1 @@
+int add1(int), inc(int), add2(int); extern int (*fp)(int); int main(void){return !(add1(1) + inc(2) == 5 && fp(3) == 4);}
@@ -0,0 +1 @@
+void *f(void){return (void*)f;} void *g(void){return (void*)g;}
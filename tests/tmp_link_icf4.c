@@ -0,0 +1 @@
+void *f(void), *g(void); int main(void){return !(f() != g());}
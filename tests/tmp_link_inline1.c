@@ -0,0 +1,4 @@
+inline int sq(int x){return x * x;} 
+#ifdef EXTERN
+ extern inline int sq(int x);
+#endif
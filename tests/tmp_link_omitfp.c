@@ -0,0 +1 @@
+struct S {long a[6];}; int sum(struct S s, int n) { int buf[4] = {n, n, n, n}; return n <= 0 ? (int)s.a[5] : buf[3] + sum(s, n - 1); } int main(void){struct S s = {{0, 0, 0, 0, 0, 5}}; return !(sum(s, 3) == 11);}
@@ -0,0 +1 @@
+__attribute__((weak)) int weakfunc(void) {return 33;}
@@ -0,0 +1 @@
+void callee(int); void f(void){for (int i = 0; i < 4; ++i) callee(i);}
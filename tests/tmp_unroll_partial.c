@@ -0,0 +1 @@
+void callee(int); void f(int n){for (int i = 0; i < n; ++i) callee(i);}
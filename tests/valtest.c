@@ -190,6 +190,38 @@ TEST(all) {
     unsigned int x = 0x80000000U;
     EXPECT("unsigned modulo", 80, x % 123);
   }
+  {
+    int x = -12345;
+    EXPECT("signed div by const", -1234, x / 10);
+    EXPECT("signed mod by const", -5, x % 10);
+    EXPECT("signed div by pow2", -1543, x / 8);
+    EXPECT("signed mod by pow2", -1, x % 8);
+    EXPECT("signed div by negative", 1763, x / -7);
+    EXPECT("signed mod by negative", -4, x % -7);
+    unsigned int y = 0xfffffff0U;
+    EXPECT("unsigned div by const", 613566754, y / 7);
+    EXPECT("unsigned mod by const", 2, y % 7);
+    EXPECT("unsigned mod by pow2", 0x70, y % 0x80);
+    int64_t z = -0x123456789abcdefLL;
+    EXPECT("int64 div by const", -81985529216486LL, z / 1000);
+    EXPECT("int64 mod by const", -895, z % 1000);
+    uint64_t w = 0xfedcba9876543210ULL;
+    EXPECT("uint64 div by const", 2623536934927580674ULL, w / 7);
+    EXPECT("uint64 mod by const", 2, w % 7);
+  }
+  {
+    int x = -123;
+    EXPECT("mul by lea", -1107, x * 9);
+    EXPECT("mul by lea and shift", -4920, x * 40);
+    EXPECT("mul by const", -861, x * 7);
+    EXPECT("mul by negative", 369, x * -3);
+    EXPECT("mul by pow2", -7872, x * 64);
+    short s = -5;
+    EXPECT("short mul by const", -60, s * 12);
+    uint64_t w = 0x123456789ULL;
+    EXPECT("uint64 mul by lea", 0x5b05b05adULL, w * 5);
+    EXPECT("uint64 mul by const", 0x159e26af2bULL, w * 0x13);
+  }
   {
     int a = 3;
     int b = 5 * 6 - 8;
@@ -635,6 +667,15 @@ TEST(all) {
     { int x = 2; }
     EXPECT("block scope", 1, x);
   }
+  {
+    int outer[4] = {1, 2, 3, 4};
+    int sum = 0;
+    for (int i = 0; i < 2; ++i) {
+      { int a[4] = {10, 20, 30, 40}; sum += a[i]; }
+      { int b[4] = {100, 200, 300, 400}; sum += b[i] + outer[i]; }
+    }
+    EXPECT("sibling scope arrays", 337, sum + outer[3]);
+  }
   {
     char a[2][3];
     a[1][0] = 1;
@@ -1037,6 +1078,22 @@ TEST(basic) {
       acc += i;
     }
     EXPECT("continue", 40, acc);
+
+    acc = 0;
+    for (int n = 0; n <= 9; ++n) {
+      for (int i = n; i >= 0; --i)
+        acc = acc * 3 + i;
+      for (unsigned int i = 1; i <= (unsigned int)n; i += 1)
+        acc -= i;
+    }
+    EXPECT("loop count down", 1776019474, acc);
+
+    acc = 0;
+    for (signed char c = 120; c < 127; c++)
+      acc += c;
+    for (long i = 9; 3 < i; i -= 2)
+      acc += i;
+    EXPECT("loop constant trips", 882, acc);
   }
 
   {
@@ -1121,6 +1178,39 @@ TTT:;
     default: y = 99; break;
     }
     EXPECT("switch table less", 99, y);
+
+    uint64_t acc = 0;
+    for (int i = -2; i < 1100; ++i) {
+      int v = 0;
+      switch (i) {
+      case 0: v = 1; break;
+      case 1: v = 2; break;
+      case 2: v = 3; break;
+      case 3: v = 4; break;
+      case ' ': case ',': case ';': case '(': case ')': v = 5; break;
+      case '[': case ']': case '{': v = 6; break;
+      case 1000: v = 7; break;
+      case 1001: v = 8; break;
+      case 1002: v = 9; break;
+      case 1004: v = 10; break;
+      case 1099: v = 11; break;
+      }
+      acc = acc * 3 + v;
+    }
+    EXPECT("switch clusters", 10611539974303914092ULL, acc);
+
+    acc = 0;
+    for (int i = -3; i < 3; ++i) {
+      unsigned int u = i;
+      switch (u) {
+      case 0: acc += 1; break;
+      case 1: acc += 20; break;
+      case 0x80000000U: acc += 300; break;
+      case 0xfffffffeU: acc += 4000; break;
+      case 0xffffffffU: acc += 50000; break;
+      }
+    }
+    EXPECT("switch unsigned", 54021, acc);
   }
 
   {  // "post inc pointer"
@@ -1229,11 +1319,49 @@ SVec3 vadd(SVec3 va, SVec3 vb) {
   return (SVec3){va.x + vb.x, va.y + vb.y, va.z + vb.z};
 }
 
+typedef struct { int64_t a[40]; } BigStruct;
+int64_t big_struct_arg(int x, BigStruct big, int y) { return big.a[0] + big.a[39] + x * y; }
+typedef struct { char c[37]; } OddStruct;
+int odd_struct_arg(int x, OddStruct odd, int y) { return odd.c[0] + odd.c[20] + odd.c[36] + x * y; }
+BigStruct return_big_struct(int64_t x) { BigStruct s = {{x}}; s.a[39] = x * 2; return s; }
+
 SVec3 refvadd(SVec3 va, SVec3 vb) {
   SVec3 *pa = &va, *pb = &vb;
   return (SVec3){pa->x + pb->x, pa->y + pb->y, pa->z + pb->z};
 }
 
+typedef struct { double x, y; } RegDD;
+typedef struct { float x, y, z; } RegFFF;
+typedef struct { float f; int i; } RegFI;
+typedef struct { char c[7]; } RegC7;
+typedef struct { double d; long l; } RegDL;
+typedef struct { float a, b, c, d; } RegF4;
+
+RegDD reg_dd(double x, double y) { return (RegDD){x, y}; }
+RegFFF reg_fff(RegFFF v, float k) { return (RegFFF){v.x * k, v.y * k, v.z * k}; }
+RegC7 reg_c7(RegC7 v) { for (int i = 0; i < 7; ++i) v.c[i] += 1; return v; }
+RegDL reg_dl(RegFI fi, RegDL dl) { return (RegDL){fi.f + dl.d, fi.i + dl.l}; }
+RegF4 reg_f4(RegF4 v) { return (RegF4){v.d, v.c, v.b, v.a}; }
+double reg_exhausted(RegDD a, RegDD b, RegDD c, RegDD d, RegDD e, double f, RegDL g) {
+  return a.x + b.y + c.x + d.y + e.x * 10 + e.y * 100 + f * 1000 + g.d + g.l;
+}
+long reg_exhausted_int(FooStruct a, FooStruct b, RegDL c, FooStruct d, FooStruct e, long f, RegC7 g) {
+  return a.x + b.y + c.l + d.x * 10 + d.y * 100 + e.x * 1000 + e.y * 10000 + f + g.c[6];
+}
+#if !defined(__WASM)
+double reg_vaargs(FooStruct first, int n, ...) {
+  va_list ap;
+  va_start(ap, n);
+  double s = first.x * 100 + first.y;
+  for (int i = 0; i < n; ++i) {
+    s += va_arg(ap, double);
+    s += va_arg(ap, int);
+  }
+  va_end(ap);
+  return s;
+}
+#endif
+
 TEST(struct) {
   FooStruct foo;
   foo.x = 123;
@@ -1309,6 +1437,35 @@ TEST(struct) {
     EXPECT("struct copy", 51, x.x);
   }
 
+  {
+    struct {char c[5];} sc = {"abcd"}, dc;
+    dc = sc;
+    EXPECT("small struct copy", 'd', dc.c[3]);
+
+    struct {int a[20];} sm = {{1, 2, 3}}, dm;
+    sm.a[19] = 77;
+    dm = sm;
+    EXPECT("medium struct copy", 80, dm.a[2] + dm.a[19]);
+
+    OddStruct so, dodd;
+    for (int i = 0; i < 37; ++i)
+      so.c[i] = i + 1;
+    dodd = so;
+    EXPECT("odd medium struct copy", 1 + 16 + 21 + 37, dodd.c[0] + dodd.c[15] + dodd.c[20] + dodd.c[36]);
+    EXPECT("odd medium struct arg", 65, odd_struct_arg(2, dodd, 3));
+
+    BigStruct big = return_big_struct(123);
+    BigStruct big2 = big;
+    EXPECT("big struct copy", 369, big2.a[0] + big2.a[39]);
+    EXPECT("big struct arg", 375, big_struct_arg(2, big2, 3));
+
+    BigStruct zero = {0};
+    int64_t sum = 0;
+    for (int i = 0; i < 40; ++i)
+      sum += zero.a[i];
+    EXPECT("big struct clear", 0, sum);
+  }
+
   {
     struct empty {};
     EXPECT("empty struct size", 0, sizeof(struct empty));
@@ -1384,6 +1541,41 @@ TEST(struct) {
     EXPECT_TRUE(pv.x == 110 && pv.y == 110 && pv.z == 110);
   }
 
+  {
+    RegDD dd = reg_dd(1.5, -2.25);
+    EXPECT_TRUE(dd.x == 1.5 && dd.y == -2.25);
+    RegFFF fff = reg_fff((RegFFF){1, 2, 3}, 1.5f);
+    EXPECT_TRUE(fff.x == 1.5f && fff.y == 3.0f && fff.z == 4.5f);
+    RegC7 c7 = reg_c7((RegC7){"abcdef"});
+    EXPECT("odd size struct", 'b' + 'g' + 1, c7.c[0] + c7.c[5] + c7.c[6]);
+    RegDL dl = reg_dl((RegFI){0.5f, 7}, (RegDL){2.25, 100});
+    EXPECT_TRUE(dl.d == 2.75 && dl.l == 107);
+    RegF4 f4 = reg_f4((RegF4){1, 2, 3, 4});
+    EXPECT_TRUE(f4.a == 4 && f4.b == 3 && f4.c == 2 && f4.d == 1);
+
+    RegDD a = {1, 2}, b = {3, 4}, c = {5, 6}, d = {7, 8}, e = {9, 10};
+    EXPECT_TRUE(reg_exhausted(a, b, c, d, e, 11, dl) == 12217.75);
+    FooStruct p = {1, 2}, q = {3, 4}, r = {5, 6}, t = {7, 8};
+    EXPECT("struct args exhausted", 87772, reg_exhausted_int(p, q, dl, r, t, 9, c7));
+#if !defined(__WASM)
+    EXPECT_TRUE(reg_vaargs(p, 3, 1.5, 2, 2.5, 3, 3.5, 4) == 118.5);
+#endif
+  }
+
+  {
+    typedef struct { double x, y; } DVec2;
+    DVec2 a = {1.5, -2.0}, b, c = {.y = 2.5};
+    b = a;
+    b.x += a.y;
+    b.y *= 3;
+    int n = 5;
+    int *pn = &n;
+    *pn += (int)(b.x * 10) + (int)b.y + (int)(c.x + c.y * 2);
+    union { float f; uint32_t u; } pun;
+    pun.f = 1.0f;
+    EXPECT("scalar replacement", 0x3f800000 - 1, (int)pun.u + n);
+  }
+
   {
     struct FlexibleArrayMember {
       int a;
@@ -1792,6 +1984,7 @@ static inline bool inline_even(int x);
 static inline bool inline_odd(int x)  { return x == 0 ? false : inline_even(x - 1); }
 static inline bool inline_even(int x)  { return x == 0 ? true : inline_odd(x - 1); }
 static inline MoreParamsReturnsStruct inline_returns_struct(int x, int y) { return (MoreParamsReturnsStruct){-x, ~y}; }
+static inline MoreParamsReturnsStruct inline_add_struct(MoreParamsReturnsStruct a, MoreParamsReturnsStruct b) { return (MoreParamsReturnsStruct){a.x + b.x, a.y + b.y}; }
 
 int mul2(int x) {return x * 2;}
 int div2(int x) {return x / 2;}
@@ -1837,8 +2030,111 @@ bool add_n_true(int *dst, int add) {
 
 int identity(int x) { return x; }
 
+static int local_divmod(int x, int y) { return (x / y) * 100 + (x % y) + (x << (y & 7)); }
+static int local_caller(int x) { return local_divmod(x, 7) - local_divmod(x, 3); }
+
+int find_index(const double *a, int n, double x) {
+  for (int i = 0; i < n; ++i) {
+    if (a[i] == x)
+      return i;
+    if (a[i] != a[i])
+      exit(1);
+  }
+  return identity(n >= 0 ? -1 : (exit(2), 0));
+}
+
+long long clamp_ll(long long x, long long lo, long long hi) {
+  if (x < lo)
+    x = lo;
+  if (x > hi)
+    x = hi;
+  return x;
+}
+
+int select_arith(int x, int y) {
+  int r = x;
+  if (y > 3)
+    r = x + y * 2;
+  return r;
+}
+
+int max_element(const int *p, int n) {
+  int m = p[0];
+  for (int i = 1; i < n; ++i) {
+    int v = p[i];
+    if (v > m)
+      m = v;
+  }
+  return m;
+}
+
+int expect_sign(int x) {
+  if (__builtin_expect(x < 0, 0))
+    return -1;
+  return x > 0;
+}
+
+int unreachable_default(int x) {
+  switch (x) {
+  case 0: return 11;
+  case 1: return 22;
+  default: __builtin_unreachable();
+  }
+}
+
+int pure_count;
+__attribute__((pure)) int pure_len(const char *s) { ++pure_count; return strlen(s); }
+__attribute__((const)) int const_sq(int x) { ++pure_count; return x * x; }
+int const_sq_changed_arg(int a) { int x = const_sq(a); a = a + 1; return x + const_sq(a); }
+__attribute__((noinline)) inline int noinline_twice(int x) { return x * 2; }
+__attribute__((always_inline)) static int always_inline_thrice(int x) { return x * 3; }
+__attribute__((cold)) int cold_func(int x) { return -x; }
+__attribute__((hot)) int hot_func(int x) { return x < 0 ? cold_func(x) : x; }
+int aligned_var __attribute__((aligned(32))) = 1;
+__attribute__((__aligned__(64))) char aligned_arr[3];
+
 int 漢字(int χ) { return χ * χ; }
 
+static const int const_table[] = {10, 20, 30, -4};
+static const unsigned char const_bytes[] = {200, 1};
+static const struct {int a; char b[3]; long c;} const_struct = {1, "xy", 0x123456789L};
+static const int const_kept[] = {5, 6, 7};
+static const char *const const_names[] = {"ab", "cd"};
+int const_fold(void) { return const_table[2] + const_table[3] + const_bytes[0] + "abc"[1]; }
+long const_fold_struct(void) { return const_struct.c + const_struct.b[1] + const_struct.a; }
+int const_fold_kept(int i) { return const_kept[1] + const_kept[i]; }
+int const_fold_local(void) { static const short local[] = {-7, 8}; return local[0] * local[1]; }
+
+int mem_g1, mem_g2;
+int mem_alias(int *p, int *q) { *p = 5; *q = 7; return *p; }
+int mem_restrict(int *restrict p, int *restrict q) { *p = 5; *q = 7; return *p; }
+int mem_globals(void) { mem_g1 = 3; mem_g2 = 4; mem_g1 += mem_g2; return mem_g1; }
+void mem_clobber(void) { mem_g1 = 99; }
+int mem_call(void) { mem_g1 = 1; mem_clobber(); return mem_g1; }
+int mem_overwrite(int *p, int x) { *p = x; *p = x * 2; return *p; }
+int mem_read_between(int *p, int *q) { *p = 1; int r = *q; *p = 2; return r; }
+int mem_partial(long *p) { *p = 0; *(char*)p = 1; return *p == 1; }
+int mem_branch(int *a, int n) {
+  a[0] = n;
+  if (n > 0)
+    return a[0] + 1;
+  a[0] = -n;
+  return a[0];
+}
+int mem_loop(int *a, int n) {
+  int i;
+  a[0] = 0;
+  for (i = 0; i < n; ++i)
+    a[0] += a[i + 1];
+  return a[0];
+}
+int mem_volatile(volatile int *p) { *p = 1; *p = 2; return *p + *p; }
+int mem_escape(void) {
+  int x = 1, *p = &x, *q = p;
+  *q = 5;
+  return *p;
+}
+
 const char *get_FUNCTION(void) { return __FUNCTION__; }
 const char *get_func(void) { return __func__; }
 
@@ -1913,6 +2209,8 @@ TEST(function) {
     MoreParamsReturnsStruct r = inline_returns_struct(1234, 5678);
     EXPECT("inline return struct 1", -1234, r.x);
     EXPECT("inline return struct 2", ~5678, r.y);
+    MoreParamsReturnsStruct s = inline_add_struct(r, inline_returns_struct(1, 2));
+    EXPECT("inline struct arg from inline", -1235, s.x);
   }
 
   EXPECT("stdarg", 55, vaarg_and_array(10, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10));
@@ -1931,6 +2229,114 @@ TEST(function) {
     EXPECT("funcall and shortcut 4", 1,  ({ int x=0; identity(add_n_true(&x, 1)  || add_n_true(&x, 10)), x;}));
   }
 
+  {
+    // Values living across calls to local functions.
+    int a = 0, b = 1, c = 2, d = 3, e = 4;
+    for (int i = 10; i < 20; ++i) {
+      a += local_caller(i);
+      b ^= local_divmod(i, b & 3 ? b & 3 : 5);
+      c += b; d *= 3; e -= a;
+    }
+    EXPECT("local callee", 14523, a);
+    EXPECT("local callee 2", 123094, b + c + d + e);
+  }
+
+  {
+    // Unlikely blocks are moved out of the loop.
+    static const double a[] = {1.5, 2.5, 3.5, 4.5};
+    EXPECT("block layout", 2, find_index(a, 4, 3.5));
+    EXPECT("block layout 2", -1, find_index(a, 4, 5.5));
+  }
+
+  {
+    // Small branches are converted to selects.
+    EXPECT("select clamp lo", 0, clamp_ll(-5, 0, 10));
+    EXPECT("select clamp hi", 10, clamp_ll(1LL << 40, 0, 10));
+    EXPECT("select clamp", 5, clamp_ll(5, 0, 10));
+    EXPECT("select arith", 1, select_arith(1, 2));
+    EXPECT("select arith 2", 11, select_arith(1, 5));
+    static const int a[] = {3, 9, -2, 7};
+    EXPECT("select loop", 9, max_element(a, 4));
+    unsigned int u = 3, v = -1U;
+    EXPECT("select unsigned", 3, u < v ? u : v);
+    char c1 = 1, c2 = 2;
+    EXPECT("select char", 'n', c1 == c2 ? 'y' : 'n');
+  }
+
+  {
+    unsigned int x = 0xf0f0f0f1U;
+    unsigned long long y = 0x0102030405060708ULL;
+    EXPECT("popcount", 17, __builtin_popcount(x));
+    EXPECT("popcountll", 64, __builtin_popcountll(-1ULL));
+    EXPECT("clz", 0, __builtin_clz(x));
+    EXPECT("clzll", 47, __builtin_clzll(y >> 40));
+    EXPECT("ctz", 31, __builtin_ctz(x << 31));
+    EXPECT("ctzll", 40, __builtin_ctzll(1ULL << 40));
+    EXPECT("bswap16", 0x3412, __builtin_bswap16(0x1234));
+    EXPECT("bswap32", 0xf1f0f0f0U, __builtin_bswap32(x));
+    EXPECT("bswap64", 0x0807060504030201ULL, __builtin_bswap64(y));
+    EXPECT("bswap64 expr", 0x0807060504030201ULL, __builtin_bswap64(y++));
+    EXPECT("bswap const", 8, __builtin_popcount(__builtin_bswap32(0xff)));
+    EXPECT("expect", -1, expect_sign(-5));
+    EXPECT("expect 2", 1, expect_sign(5));
+    EXPECT("unreachable", 22, unreachable_default(1));
+    int a = 0;
+    EXPECT("assume_aligned", 1, __builtin_assume_aligned(&a, sizeof(a)) == &a);
+  }
+
+  {
+    const char *s = "hello";
+    pure_count = 0;
+    int n = pure_len(s) + pure_len(s);
+    EXPECT("pure", 10, n);
+#if defined(__XCC) && !defined(__WASM)
+    EXPECT("pure call shared", 1, pure_count);
+#endif
+    int x = 7;
+    n = const_sq(x) + const_sq(x);
+    const_sq(3);
+    EXPECT("const", 98, n);
+#if defined(__XCC) && !defined(__WASM)
+    EXPECT("const call shared", 2, pure_count);
+#endif
+    EXPECT("const call changed arg", 30 * 30 + 31 * 31, const_sq_changed_arg(30));
+    EXPECT("noinline", 8, noinline_twice(4));
+    EXPECT("always_inline", 15, always_inline_thrice(5));
+    EXPECT("hot/cold", 5, hot_func(-5));
+    EXPECT("aligned var", 0, (int)((intptr_t)&aligned_var & 31));
+    EXPECT("aligned array", 0, (int)((intptr_t)aligned_arr & 63));
+  }
+
+  EXPECT("const global fold", 324, const_fold());
+  EXPECT("const struct fold", 0x123456789L + 'y' + 1, const_fold_struct());
+  EXPECT("const global kept", 13, const_fold_kept(2));
+  EXPECT_STREQ("const pointer table", "cd", const_names[1]);
+  EXPECT("const static local fold", -56, const_fold_local());
+
+  {
+    int x = 0, y = 0;
+    EXPECT("mem alias", 7, mem_alias(&x, &x));
+    EXPECT("mem no alias", 5, mem_alias(&x, &y));
+    EXPECT("mem restrict", 5, mem_restrict(&x, &y));
+    EXPECT("mem globals", 7, mem_globals());
+    EXPECT("mem call", 99, mem_call());
+    EXPECT("mem overwrite", 6, mem_overwrite(&x, 3));
+    y = 42;
+    EXPECT("mem read between", 1, mem_read_between(&x, &x));
+    EXPECT("mem read between 2", 42, mem_read_between(&x, &y));
+    EXPECT("mem read between 3", 2, x);
+    long l = -1;
+    EXPECT("mem partial", 1, mem_partial(&l));
+    int a[4] = {0, 1, 2, 3};
+    EXPECT("mem branch", 4, mem_branch(a, 3));
+    EXPECT("mem branch 2", 3, mem_branch(a, -3));
+    EXPECT("mem loop", 6, mem_loop(a, 3));
+    EXPECT("mem loop 2", 0, mem_loop(a, 0));
+    volatile int v = 0;
+    EXPECT("mem volatile", 4, mem_volatile(&v));
+    EXPECT("mem escape", 5, mem_escape());
+  }
+
   EXPECT("unicode", 121, 漢字(11));
 
   EXPECT_STREQ("__FUNCTION__", "get_FUNCTION", get_FUNCTION());
@@ -1942,6 +2348,104 @@ int extern_array_wo_size[] = {11, 22, 33};
 
 //
 
+typedef int v4si __attribute__((vector_size(16)));
+typedef short v8hi __attribute__((vector_size(16)));
+typedef unsigned char v16qu __attribute__((vector_size(16)));
+typedef long long v2di __attribute__((vector_size(16)));
+
+typedef float v2sf __attribute__((vector_size(8)));
+
+v4si vector_add(v4si a, v4si b) { return a + b; }
+v4si vector_mixed_args(int k, v4si a, double d, v4si b) {
+  return a * (v4si){k, k, k, k} + b + (v4si){0, 0, 0, (int)d};
+}
+v4si vector_across_call(v4si a) { v4si b = vector_add(a, a); return vector_add(a, b); }
+v2sf vector_short(v2sf a) { return a + a; }
+
+void vectorize_add(unsigned char *d, const unsigned char *s, int n) {
+  for (int i = 0; i < n; ++i)
+    d[i] = d[i] + (s[i] ^ 3);
+}
+
+int vectorize_sum(const int *a, int n) {
+  int s = 0;
+  for (int i = 0; i < n; ++i)
+    s += a[i] - 1;
+  return s;
+}
+
+TEST(vector) {
+  EXPECT("sizeof", 16, sizeof(v4si));
+  EXPECT("alignof", 16, _Alignof(v4si));
+  {
+    v4si a = {1, 2, 3, 4}, b = {10, 20, 30, 40};
+    v4si c = a + b;
+    EXPECT("add", 22, c[1]);
+    c = b - a;
+    EXPECT("sub", 36, c[3]);
+    c = a * b;
+    EXPECT("mul", 90, c[2]);
+    c = b / a;
+    EXPECT("div", 10, c[3]);
+    c = b % (v4si){3, 3, 3, 3};
+    EXPECT("mod", 2, c[1]);
+    c = (a | b) ^ (v4si){0, 0, 1, 1};
+    EXPECT("or, xor", 75, c[2] + c[3]);
+    c = a & (v4si){-1, 0, -1, 0};
+    EXPECT("and", 3, c[2] + c[3]);
+    c += a;
+    EXPECT("compound assign", 6, c[2]);
+    c[0] = 99;
+    EXPECT("subscript assign", 99, c[0]);
+    EXPECT("subscript rvalue", 33, (a + b)[2]);
+    EXPECT("param, return", 44, vector_add(a, b)[3]);
+    c = vector_mixed_args(3, a, 5.5, b);
+    EXPECT("mixed params", 135, c[0] + c[1] + c[2] + c[3]);
+    EXPECT("across call", 12, vector_across_call(a)[3]);
+    v2sf d = vector_short((v2sf){1.25f, -2.5f});
+    EXPECT("short vector", 1, d[0] == 2.5f && d[1] == -5.0f);
+  }
+  {
+    v8hi a = {1, 2, 3, 4, 5, 6, 7, 8};
+    a = a * a;
+    EXPECT("short mul", 64, a[7]);
+    v16qu b = {250, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+    b = b + b;
+    EXPECT("uchar add wraps", 244, b[0]);
+    b = b * b;
+    EXPECT("uchar mul wraps", 144, b[0]);
+    v2di c = {1LL << 40, -1};
+    c = c + c;
+    EXPECT("long long add", 1LL << 41, c[0]);
+    c = c * (v2di){3, 3};
+    EXPECT("long long mul", -6, c[1]);
+  }
+  {
+    v4si a = {0x01020304, 0, 0, 0};
+    v16qu b = (v16qu)a;
+    EXPECT("cast", 3, b[1]);
+  }
+  {
+    unsigned char d[37], s[37];
+    for (int i = 0; i < 37; ++i) {
+      d[i] = i * 7;
+      s[i] = 250 - i;
+    }
+    vectorize_add(d, s, 37);
+    EXPECT("loop vectorize", 249, d[0]);
+    EXPECT("loop epilogue", 209, d[36]);
+    for (int i = 0; i < 37; ++i)
+      d[i] = 0;
+    vectorize_add(d + 1, d, 20);
+    EXPECT("loop overlap", 3, d[19] + d[20]);
+
+    int a[23];
+    for (int i = 0; i < 23; ++i)
+      a[i] = i;
+    EXPECT("loop reduction", 230, vectorize_sum(a, 23));
+  }
+}
+
 #if !defined(__NO_VLA) && !defined(__STDC_NO_VLA__)
 int vla_funparam(int n, int a[n][n], int (*p)[n]) {
   int acc = 0;